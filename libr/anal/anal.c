@@ -5,6 +5,7 @@
 #include <r_list.h>
 #include <r_io.h>
 #include <config.h>
+#include "base_types.h"
 
 R_LIB_VERSION(r_anal);
 
@@ -63,9 +64,13 @@ static void zign_rename_for(REvent *ev, int type, void *user, void *data) {
 
 void r_anal_hint_storage_init(RAnal *a);
 void r_anal_hint_storage_fini(RAnal *a);
+bool r_anal_xrefs_set_concurrent(RAnal *anal, bool enable);
 
 static void r_meta_item_fini(RAnalMetaItem *item) {
-	free (item->str);
+	// comments belong to anal->constpool
+	if (item->type != R_META_TYPE_COMMENT) {
+		free (item->str);
+	}
 }
 
 static void r_meta_item_free(void *_item) {
@@ -87,6 +92,11 @@ R_API RAnal *r_anal_new(void) {
 		return NULL;
 	}
 	anal->bb_tree = NULL;
+	anal->bb_epoch = 1; // bb_index starts out stale
+	r_vector_init (&anal->dirty, sizeof (RAnalDirty), NULL, NULL);
+	anal->block_pool = r_mem_pool_new (sizeof (RAnalBlock), 0, 0);
+	anal->fcn_pool = r_mem_pool_new (sizeof (RAnalFunction), 0, 0);
+	anal->ref_pool = r_mem_pool_new (sizeof (RAnalRef), 1024, 0);
 	anal->ht_addr_fun = ht_up_new0 ();
 	anal->ht_name_fun = ht_pp_new0 ();
 	anal->os = strdup (R_SYS_OS);
@@ -110,6 +120,7 @@ R_API RAnal *r_anal_new(void) {
 	r_anal_hint_storage_init (anal);
 	r_interval_tree_init (&anal->meta, r_meta_item_free);
 	anal->sdb_types = sdb_ns (anal->sdb, "types", 1);
+	r_anal_type_cache_init (anal);
 	anal->sdb_fmts = sdb_ns (anal->sdb, "spec", 1);
 	anal->sdb_cc = sdb_ns (anal->sdb, "cc", 1);
 	anal->sdb_zigns = sdb_ns (anal->sdb, "zigns", 1);
@@ -158,12 +169,17 @@ R_API RAnal *r_anal_free(RAnal *a) {
 	ht_pp_free (a->ht_name_fun);
 	set_u_free (a->visited);
 	r_anal_hint_storage_fini (a);
+	while (a->meta_bulk_depth) {
+		r_meta_bulk_end (a);
+	}
 	r_interval_tree_fini (&a->meta);
 	free (a->cpu);
 	free (a->os);
 	free (a->zign_path);
 	r_list_free (a->plugins);
 	r_rbtree_free (a->bb_tree, __block_free_rb, NULL);
+	free (a->bb_index.entries);
+	r_vector_fini (&a->dirty);
 	r_spaces_fini (&a->meta_spaces);
 	r_spaces_fini (&a->zign_spaces);
 	r_anal_pin_fini (a);
@@ -172,17 +188,44 @@ R_API RAnal *r_anal_free(RAnal *a) {
 	ht_up_free (a->dict_refs);
 	ht_up_free (a->dict_xrefs);
 	r_list_free (a->leaddrs);
+	r_anal_opcache_free (a->opcache);
+	r_anal_type_cache_fini (a);
 	sdb_free (a->sdb);
 	if (a->esil) {
 		r_anal_esil_free (a->esil);
 		a->esil = NULL;
 	}
 	free (a->last_disasm_reg);
+	r_mem_pool_free (a->block_pool);
+	r_mem_pool_free (a->fcn_pool);
+	r_mem_pool_free (a->ref_pool);
+	r_th_lock_free (a->ref_lock);
 	r_str_constpool_fini (&a->constpool);
 	free (a);
 	return NULL;
 }
 
+/* Makes the function indexes, the xrefs and the hints by address safe to
+ * query and update from several threads. Everything else in RAnal (the
+ * function list, blocks, the other pools) still has to be serialized by
+ * the caller. Deleting is not safe against readers: r_anal_xrefs_deln and
+ * r_anal_function_delete free what another thread may have just found. */
+R_API bool r_anal_set_concurrent(RAnal *anal, bool enable) {
+	r_return_val_if_fail (anal, false);
+	anal->concurrent = enable;
+	if (enable && !anal->ref_lock) {
+		anal->ref_lock = r_th_lock_new (false);
+	} else if (!enable) {
+		anal->ref_lock = r_th_lock_free (anal->ref_lock);
+	}
+	bool ret = anal->ref_lock || !enable;
+	ret &= ht_up_set_concurrent (anal->ht_addr_fun, enable);
+	ret &= ht_pp_set_concurrent (anal->ht_name_fun, enable);
+	ret &= ht_up_set_concurrent (anal->addr_hints, enable);
+	ret &= r_anal_xrefs_set_concurrent (anal, enable);
+	return ret;
+}
+
 R_API void r_anal_set_user_ptr(RAnal *anal, void *user) {
 	anal->user = user;
 }
@@ -439,6 +482,13 @@ R_API bool r_anal_op_is_eob(RAnalOp *op) {
 R_API int r_anal_purge (RAnal *anal) {
 	sdb_reset (anal->sdb_fcns);
 	r_anal_hint_clear (anal);
+	RIntervalTreeIter it;
+	RAnalMetaItem *item;
+	r_interval_tree_foreach (&anal->meta, it, item) {
+		if (item->type == R_META_TYPE_COMMENT) {
+			r_str_constpool_unref (&anal->constpool, item->str);
+		}
+	}
 	r_interval_tree_fini (&anal->meta);
 	r_interval_tree_init (&anal->meta, r_meta_item_free);
 	sdb_reset (anal->sdb_types);
@@ -447,6 +497,13 @@ R_API int r_anal_purge (RAnal *anal) {
 	sdb_reset (anal->sdb_classes_attrs);
 	r_list_free (anal->fcns);
 	anal->fcns = r_list_newf (r_anal_function_free);
+	// hand the chunks back to the system if nothing else holds on to them
+	if (!anal->fcn_pool->live) {
+		r_mem_pool_deinit (anal->fcn_pool);
+	}
+	if (!anal->block_pool->live) {
+		r_mem_pool_deinit (anal->block_pool);
+	}
 	return 0;
 }
 
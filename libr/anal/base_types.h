@@ -1,7 +1,7 @@
 #ifndef R_BASE_TYPES_H
 #define R_BASE_TYPES_H
 
-#include "r_util.h"
+#include "r_anal.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -10,6 +10,8 @@ extern "C" {
 R_IPI void enum_type_case_free(void *e, void *user);
 R_IPI void struct_type_member_free(void *e, void *user);
 R_IPI void union_type_member_free(void *e, void *user);
+R_IPI void r_anal_type_cache_init(RAnal *anal);
+R_IPI void r_anal_type_cache_fini(RAnal *anal);
 
 #ifdef __cplusplus
 }
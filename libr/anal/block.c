@@ -43,7 +43,7 @@ R_API void r_anal_block_ref(RAnalBlock *bb) {
 #define DFLT_NINSTR 3
 
 static RAnalBlock *block_new(RAnal *a, ut64 addr, ut64 size) {
-	RAnalBlock *block = R_NEW0 (RAnalBlock);
+	RAnalBlock *block = r_mem_pool_alloc (a->block_pool);
 	if (!block) {
 		return NULL;
 	}
@@ -74,7 +74,7 @@ static void block_free(RAnalBlock *block) {
 	r_list_free (block->fcns);
 	free (block->op_pos);
 	free (block->parent_reg_arena);
-	free (block);
+	r_mem_pool_release (block->anal->block_pool, block);
 }
 
 void __block_free_rb(RBNode *node, void *user) {
@@ -87,6 +87,97 @@ R_API RAnalBlock *r_anal_get_block_at(RAnal *anal, ut64 addr) {
 	return node? unwrap (node): NULL;
 }
 
+static inline void block_tree_changed(RAnal *anal) {
+	anal->bb_epoch++;
+	anal->bb_index.stale_queries = 0;
+}
+
+// The flat index is only worth rebuilding once enough lookups happened
+// without any mutation in between, i.e. we are in a read-mostly phase.
+#define BLOCK_INDEX_MIN_QUERIES 64
+
+static size_t block_tree_count(RBNode *node) {
+	return node? 1 + block_tree_count (node->child[0]) + block_tree_count (node->child[1]): 0;
+}
+
+static bool block_index_build(RAnal *anal) {
+	RAnalBlockIndex *index = &anal->bb_index;
+	size_t count = block_tree_count (anal->bb_tree);
+	if (count > index->capacity) {
+		size_t capacity = R_MAX (count, index->capacity * 2);
+		RAnalBlockIndexEntry *entries = realloc (index->entries, capacity * sizeof (RAnalBlockIndexEntry));
+		if (!entries) {
+			return false;
+		}
+		index->entries = entries;
+		index->capacity = capacity;
+	}
+	RBIter iter;
+	RAnalBlock *block;
+	ut64 max_end = 0;
+	index->count = 0;
+	r_rbtree_foreach (anal->bb_tree, iter, block, RAnalBlock, _rb) {
+		RAnalBlockIndexEntry *e = &index->entries[index->count++];
+		e->addr = block->addr;
+		e->end = block->addr + block->size;
+		max_end = R_MAX (max_end, e->end);
+		e->max_end = max_end;
+		e->block = block;
+	}
+	index->epoch = anal->bb_epoch;
+	return true;
+}
+
+// Returns true if bb_index reflects bb_tree and may be used for this lookup
+static bool block_index_usable(RAnal *anal) {
+	RAnalBlockIndex *index = &anal->bb_index;
+	if (index->epoch == anal->bb_epoch) {
+		return true;
+	}
+	index->stale_queries++;
+	if (index->stale_queries < BLOCK_INDEX_MIN_QUERIES + index->count / 16) {
+		return false;
+	}
+	return block_index_build (anal);
+}
+
+// index of the first entry whose prefix max_end is > addr
+static size_t block_index_lower(RAnalBlockIndex *index, ut64 addr) {
+	size_t lo = 0, hi = index->count;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (index->entries[mid].max_end > addr) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return lo;
+}
+
+// Calls cb for all entries with addr < e->end and e->addr < end, in address order.
+// Stops early if cb mutates the tree since the remaining entries may be dangling then.
+static bool block_index_foreach(RAnal *anal, ut64 addr, ut64 end, RAnalBlockCb cb, void *user) {
+	RAnalBlockIndex *index = &anal->bb_index;
+	ut64 epoch = index->epoch;
+	size_t i;
+	for (i = block_index_lower (index, addr); i < index->count; i++) {
+		RAnalBlockIndexEntry *e = &index->entries[i];
+		if (e->addr >= end) {
+			break;
+		}
+		if (addr < e->end) {
+			if (!cb (e->block, user)) {
+				return false;
+			}
+			if (anal->bb_epoch != epoch) {
+				break;
+			}
+		}
+	}
+	return true;
+}
+
 // This is a special case of what r_interval_node_all_in() does
 static bool all_in(RAnalBlock *node, ut64 addr, RAnalBlockCb cb, void *user) {
 	while (node && addr < node->addr) {
@@ -99,15 +190,16 @@ static bool all_in(RAnalBlock *node, ut64 addr, RAnalBlockCb cb, void *user) {
 	if (addr >= node->_max_end) {
 		return true;
 	}
+	// in-order, so the results come sorted by address just like from bb_index
+	// This can be done more efficiently by building the stack manually
+	if (!all_in (unwrap (node->_rb.child[0]), addr, cb, user)) {
+		return false;
+	}
 	if (addr < node->addr + node->size) {
 		if (!cb (node, user)) {
 			return false;
 		}
 	}
-	// This can be done more efficiently by building the stack manually
-	if (!all_in (unwrap (node->_rb.child[0]), addr, cb, user)) {
-		return false;
-	}
 	if (!all_in (unwrap (node->_rb.child[1]), addr, cb, user)) {
 		return false;
 	}
@@ -115,6 +207,9 @@ static bool all_in(RAnalBlock *node, ut64 addr, RAnalBlockCb cb, void *user) {
 }
 
 R_API bool r_anal_blocks_foreach_in(RAnal *anal, ut64 addr, RAnalBlockCb cb, void *user) {
+	if (block_index_usable (anal)) {
+		return addr == UT64_MAX || block_index_foreach (anal, addr, addr + 1, cb, user);
+	}
 	return all_in (anal->bb_tree ? unwrap (anal->bb_tree) : NULL, addr, cb, user);
 }
 
@@ -133,8 +228,7 @@ R_API RList *r_anal_get_blocks_in(RAnal *anal, ut64 addr) {
 	return list;
 }
 
-static void all_intersect(RAnalBlock *node, ut64 addr, ut64 size, RAnalBlockCb cb, void *user) {
-	ut64 end = addr + size;
+static void all_intersect(RAnalBlock *node, ut64 addr, ut64 end, RAnalBlockCb cb, void *user) {
 	while (node && end <= node->addr) {
 		// less than the current node, but might still be contained further down
 		node = unwrap (node->_rb.child[0]);
@@ -145,16 +239,22 @@ static void all_intersect(RAnalBlock *node, ut64 addr, ut64 size, RAnalBlockCb c
 	if (addr >= node->_max_end) {
 		return;
 	}
+	// This can be done more efficiently by building the stack manually
+	all_intersect (unwrap (node->_rb.child[0]), addr, end, cb, user);
 	if (addr < node->addr + node->size) {
 		cb (node, user);
 	}
-	// This can be done more efficiently by building the stack manually
-	all_intersect (unwrap (node->_rb.child[0]), addr, size, cb, user);
-	all_intersect (unwrap (node->_rb.child[1]), addr, size, cb, user);
+	all_intersect (unwrap (node->_rb.child[1]), addr, end, cb, user);
 }
 
 R_API void r_anal_blocks_foreach_intersect(RAnal *anal, ut64 addr, ut64 size, RAnalBlockCb cb, void *user) {
-	all_intersect (anal->bb_tree ? unwrap (anal->bb_tree) : NULL, addr, size, cb, user);
+	// ranges reaching past the end of the address space are clamped
+	ut64 end = size > UT64_MAX - addr? UT64_MAX: addr + size;
+	if (block_index_usable (anal)) {
+		block_index_foreach (anal, addr, end, cb, user);
+		return;
+	}
+	all_intersect (anal->bb_tree ? unwrap (anal->bb_tree) : NULL, addr, end, cb, user);
 }
 
 R_API RList *r_anal_get_blocks_intersect(RAnal *anal, ut64 addr, ut64 size) {
@@ -175,6 +275,7 @@ R_API RAnalBlock *r_anal_create_block(RAnal *anal, ut64 addr, ut64 size) {
 		return NULL;
 	}
 	r_rbtree_aug_insert (&anal->bb_tree, &block->addr, &block->_rb, __bb_addr_cmp, NULL, __max_end);
+	block_tree_changed (anal);
 	return block;
 }
 
@@ -203,6 +304,7 @@ R_API void r_anal_block_set_size(RAnalBlock *block, ut64 size) {
 	// Do the actual resize
 	block->size = size;
 	r_rbtree_aug_update_sum (block->anal->bb_tree, &block->addr, &block->_rb, __bb_addr_cmp, NULL, __max_end);
+	block_tree_changed (block->anal);
 }
 
 R_API bool r_anal_block_relocate(RAnalBlock *block, ut64 addr, ut64 size) {
@@ -242,6 +344,7 @@ R_API bool r_anal_block_relocate(RAnalBlock *block, ut64 addr, ut64 size) {
 	block->addr = addr;
 	block->size = size;
 	r_rbtree_aug_insert (&block->anal->bb_tree, &block->addr, &block->_rb, __bb_addr_cmp, NULL, __max_end);
+	block_tree_changed (block->anal);
 	return true;
 }
 
@@ -266,6 +369,7 @@ R_API RAnalBlock *r_anal_block_split(RAnalBlock *bbi, ut64 addr) {
 	bb->jump = bbi->jump;
 	bb->fail = bbi->fail;
 	bb->parent_stackptr = bbi->stackptr;
+	bb->dirty = bbi->dirty;
 
 	// resize the first block
 	r_anal_block_set_size (bbi, addr - bbi->addr);
@@ -274,6 +378,7 @@ R_API RAnalBlock *r_anal_block_split(RAnalBlock *bbi, ut64 addr) {
 
 	// insert the second block into the tree
 	r_rbtree_aug_insert (&anal->bb_tree, &bb->addr, &bb->_rb, __bb_addr_cmp, NULL, __max_end);
+	block_tree_changed (anal);
 
 	// insert the second block into all functions of the first
 	RListIter *iter;
@@ -338,9 +443,11 @@ R_API bool r_anal_block_merge(RAnalBlock *a, RAnalBlock *b) {
 	a->size += b->size;
 	a->jump = b->jump;
 	a->fail = b->fail;
+	a->dirty |= b->dirty;
 
 	// kill b completely
 	r_rbtree_aug_delete (&a->anal->bb_tree, &b->addr, __bb_addr_cmp, NULL, __block_free_rb, NULL, __max_end);
+	block_tree_changed (a->anal);
 
 	// invalidate ranges of a's functions
 	r_list_foreach (a->fcns, iter, fcn) {
@@ -361,6 +468,7 @@ R_API void r_anal_block_unref(RAnalBlock *bb) {
 		RAnal *anal = bb->anal;
 		assert (!bb->fcns || r_list_empty (bb->fcns));
 		r_rbtree_aug_delete (&anal->bb_tree, &bb->addr, __bb_addr_cmp, NULL, __block_free_rb, NULL, __max_end);
+		block_tree_changed (anal);
 	}
 }
 
@@ -0,0 +1,122 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_anal.h>
+
+/*
+ * Tracking of the analysis invalidated by changes to the code.
+ *
+ * Writes to io and changes to the hints mark the basic blocks they touch
+ * as dirty, together with the functions owning them, and remember the
+ * range that caused it. Blocks are found through the bb_tree, so a change
+ * costs the same as a lookup and nothing is recorded when no analyzed
+ * code is hit. r_core_anal_update () analyzes again the functions with
+ * dirty blocks and leaves everything else alone.
+ */
+
+static bool invalidate_cb(RAnalBlock *bb, void *user) {
+	bool *hit = user;
+	RListIter *iter;
+	RAnalFunction *fcn;
+	bb->dirty = true;
+	r_list_foreach (bb->fcns, iter, fcn) {
+		fcn->has_changed = true;
+	}
+	*hit = true;
+	return true;
+}
+
+R_API bool r_anal_invalidate(RAnal *anal, ut64 addr, ut64 size, RAnalDirtyReason reason) {
+	r_return_val_if_fail (anal, false);
+	if (reason == R_ANAL_DIRTY_WRITE) {
+		// the analysis writing memory still changes what decodes there
+		r_anal_opcache_invalidate (anal, addr, size, reason);
+	}
+	if (!size || anal->dirty_lock) {
+		return false;
+	}
+	size = R_MIN (size, UT64_MAX - addr);
+	bool hit = false;
+	r_anal_blocks_foreach_intersect (anal, addr, size, invalidate_cb, &hit);
+	if (!hit) {
+		return false;
+	}
+	// ranges of the same reason overlapping or touching this one become one
+	ut64 end = addr + size;
+	size_t i = 0;
+	while (i < anal->dirty.len) {
+		RAnalDirty *d = r_vector_index_ptr (&anal->dirty, i);
+		if (d->reason == reason && d->addr <= end && addr <= d->addr + d->size) {
+			addr = R_MIN (addr, d->addr);
+			end = R_MAX (end, d->addr + d->size);
+			r_vector_remove_at (&anal->dirty, i, NULL);
+		} else {
+			i++;
+		}
+	}
+	RAnalDirty d = { addr, end - addr, reason };
+	return r_vector_push (&anal->dirty, &d);
+}
+
+typedef struct {
+	RList *fcns;
+	SetU *seen;
+} DirtyFcnsCtx;
+
+static bool dirty_fcns_cb(RAnalBlock *bb, void *user) {
+	DirtyFcnsCtx *ctx = user;
+	RListIter *iter;
+	RAnalFunction *fcn;
+	if (!bb->dirty) {
+		return true;
+	}
+	r_list_foreach (bb->fcns, iter, fcn) {
+		if (!set_u_contains (ctx->seen, (ut64)(size_t)fcn)) {
+			set_u_add (ctx->seen, (ut64)(size_t)fcn);
+			r_list_append (ctx->fcns, fcn);
+		}
+	}
+	return true;
+}
+
+// functions owning at least one dirty block, each one once
+R_API RList *r_anal_dirty_functions(RAnal *anal) {
+	r_return_val_if_fail (anal, NULL);
+	DirtyFcnsCtx ctx = { r_list_new (), set_u_new () };
+	if (!ctx.fcns || !ctx.seen) {
+		r_list_free (ctx.fcns);
+		set_u_free (ctx.seen);
+		return NULL;
+	}
+	RAnalDirty *d;
+	r_vector_foreach (&anal->dirty, d) {
+		r_anal_blocks_foreach_intersect (anal, d->addr, d->size, dirty_fcns_cb, &ctx);
+	}
+	set_u_free (ctx.seen);
+	return ctx.fcns;
+}
+
+static bool clear_cb(RAnalBlock *bb, void *user) {
+	bb->dirty = false;
+	return true;
+}
+
+R_API void r_anal_dirty_clear(RAnal *anal) {
+	r_return_if_fail (anal);
+	RAnalDirty *d;
+	r_vector_foreach (&anal->dirty, d) {
+		r_anal_blocks_foreach_intersect (anal, d->addr, d->size, clear_cb, NULL);
+	}
+	r_vector_clear (&anal->dirty);
+}
+
+R_API const char *r_anal_dirty_reason_tostring(RAnalDirtyReason reason) {
+	switch (reason) {
+	case R_ANAL_DIRTY_WRITE:
+		return "write";
+	case R_ANAL_DIRTY_HINT:
+		return "hint";
+	case R_ANAL_DIRTY_CALLEE:
+		return "callee";
+	}
+	return "unknown";
+}
@@ -2,14 +2,149 @@
 
 #include <r_anal.h>
 
-#define DB esil->db_trace
-#define KEY(x) sdb_fmt ("%d."x, esil->trace_idx)
-#define KEYAT(x,y) sdb_fmt ("%d."x".0x%"PFMT64x, esil->trace_idx, y)
-#define KEYREG(x,y) sdb_fmt ("%d."x".%s", esil->trace_idx, y)
-
 static int ocbs_set = false;
 static RAnalEsilCallbacks ocbs = {0};
 
+static void trace_mem_fini(void *e, void *user) {
+	RAnalEsilTraceMem *mem = e;
+	free (mem->data);
+}
+
+static void trace_step_fini(void *e, void *user) {
+	RAnalEsilTraceStep *step = e;
+	r_vector_fini (&step->reg_read);
+	r_vector_fini (&step->reg_write);
+	r_vector_fini (&step->mem_read);
+	r_vector_fini (&step->mem_write);
+}
+
+R_API RAnalEsilTrace *r_anal_esil_trace_new(void) {
+	RAnalEsilTrace *trace = R_NEW0 (RAnalEsilTrace);
+	if (!trace) {
+		return NULL;
+	}
+	trace->reg_ids = ht_pp_new0 ();
+	if (!trace->reg_ids) {
+		free (trace);
+		return NULL;
+	}
+	r_vector_init (&trace->steps, sizeof (RAnalEsilTraceStep), trace_step_fini, NULL);
+	r_pvector_init (&trace->regs, free);
+	return trace;
+}
+
+R_API void r_anal_esil_trace_free(RAnalEsilTrace *trace) {
+	if (!trace) {
+		return;
+	}
+	r_vector_fini (&trace->steps);
+	r_pvector_fini (&trace->regs);
+	ht_pp_free (trace->reg_ids);
+	free (trace);
+}
+
+/* drop all the steps, the interned register names are kept */
+R_API void r_anal_esil_trace_reset(RAnalEsilTrace *trace) {
+	r_return_if_fail (trace);
+	r_vector_clear (&trace->steps);
+	trace->idx = 0;
+}
+
+/* index of the last recorded step, 0 if there is none */
+R_API int r_anal_esil_trace_last(RAnalEsilTrace *trace) {
+	r_return_val_if_fail (trace, 0);
+	return trace->steps.len? trace->idx + (int)trace->steps.len - 1: 0;
+}
+
+R_API RAnalEsilTraceStep *r_anal_esil_trace_step(RAnalEsilTrace *trace, int idx) {
+	r_return_val_if_fail (trace, NULL);
+	if (idx < trace->idx || idx - trace->idx >= (int)trace->steps.len) {
+		return NULL;
+	}
+	return r_vector_index_ptr (&trace->steps, idx - trace->idx);
+}
+
+/* -1 if the register never showed up in the trace */
+R_API int r_anal_esil_trace_reg_id(RAnalEsilTrace *trace, const char *name) {
+	r_return_val_if_fail (trace && name, -1);
+	return (int)(size_t)ht_pp_find (trace->reg_ids, name, NULL) - 1;
+}
+
+static int trace_reg_intern(RAnalEsilTrace *trace, const char *name) {
+	int id = r_anal_esil_trace_reg_id (trace, name);
+	if (id < 0) {
+		char *s = strdup (name);
+		if (!s || !r_pvector_push (&trace->regs, s)) {
+			free (s);
+			return -1;
+		}
+		id = (int)r_pvector_len (&trace->regs) - 1;
+		ht_pp_insert (trace->reg_ids, name, (void *)(size_t)(id + 1));
+	}
+	return id;
+}
+
+static bool trace_reg_find(RVector *regs, int id, ut64 *value) {
+	size_t i;
+	if (id < 0) {
+		return false;
+	}
+	// the last access wins, like it did for the sdb keys
+	for (i = regs->len; i > 0; i--) {
+		RAnalEsilTraceReg *r = r_vector_index_ptr (regs, i - 1);
+		if (r->reg == id) {
+			if (value) {
+				*value = r->value;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+R_API bool r_anal_esil_trace_reg_read(RAnalEsilTrace *trace, int idx, const char *name, ut64 *value) {
+	RAnalEsilTraceStep *step = r_anal_esil_trace_step (trace, idx);
+	return step && trace_reg_find (&step->reg_read, r_anal_esil_trace_reg_id (trace, name), value);
+}
+
+R_API bool r_anal_esil_trace_reg_write(RAnalEsilTrace *trace, int idx, const char *name, ut64 *value) {
+	RAnalEsilTraceStep *step = r_anal_esil_trace_step (trace, idx);
+	return step && trace_reg_find (&step->reg_write, r_anal_esil_trace_reg_id (trace, name), value);
+}
+
+static bool trace_reg_seen(RVector *regs, size_t n, int id) {
+	size_t i;
+	for (i = 0; i < n; i++) {
+		RAnalEsilTraceReg *r = r_vector_index_ptr (regs, i);
+		if (r->reg == id) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static RAnalEsilTraceStep *trace_cur(RAnalEsil *esil) {
+	return r_anal_esil_trace_step (esil->trace, esil->trace_idx);
+}
+
+static void trace_reg_add(RAnalEsil *esil, bool write, const char *name, ut64 value) {
+	RAnalEsilTraceStep *step = trace_cur (esil);
+	if (step) {
+		RAnalEsilTraceReg r = { trace_reg_intern (esil->trace, name), value };
+		if (r.reg >= 0) {
+			r_vector_push (write? &step->reg_write: &step->reg_read, &r);
+		}
+	}
+}
+
+static void trace_mem_add(RAnalEsil *esil, bool write, ut64 addr, const ut8 *buf, int len) {
+	RAnalEsilTraceStep *step = trace_cur (esil);
+	if (step && len >= 0) {
+		RAnalEsilTraceMem m = { addr, r_mem_dup (buf, len), len };
+		r_vector_push (write? &step->mem_write: &step->mem_read, &m);
+	}
+}
+
 static int trace_hook_reg_read(RAnalEsil *esil, const char *name, ut64 *res, int *size) {
 	int ret = 0;
 	if (*name == '0') {
@@ -26,21 +161,14 @@ static int trace_hook_reg_read(RAnalEsil *esil, const char *name, ut64 *res, int
 		ret = esil->cb.reg_read (esil, name, res, size);
 	}
 	if (ret) {
-		ut64 val = *res;
-		//eprintf ("[ESIL] REG READ %s 0x%08"PFMT64x"\n", name, val);
-		sdb_array_add (DB, KEY ("reg.read"), name, 0);
-		sdb_num_set (DB, KEYREG ("reg.read", name), val, 0);
-	} //else {
-		//eprintf ("[ESIL] REG READ %s FAILED\n", name);
-	//}
+		trace_reg_add (esil, false, name, *res);
+	}
 	return ret;
 }
 
 static int trace_hook_reg_write(RAnalEsil *esil, const char *name, ut64 *val) {
 	int ret = 0;
-	//eprintf ("[ESIL] REG WRITE %s 0x%08"PFMT64x"\n", name, *val);
-	sdb_array_add (DB, KEY ("reg.write"), name, 0);
-	sdb_num_set (DB, KEYREG ("reg.write", name), *val, 0);
+	trace_reg_add (esil, true, name, *val);
 	if (ocbs.hook_reg_write) {
 		RAnalEsilCallbacks cbs = esil->cb;
 		esil->cb = ocbs;
@@ -51,17 +179,11 @@ static int trace_hook_reg_write(RAnalEsil *esil, const char *name, ut64 *val) {
 }
 
 static int trace_hook_mem_read(RAnalEsil *esil, ut64 addr, ut8 *buf, int len) {
-	char *hexbuf = calloc ((1 + len), 4);
 	int ret = 0;
 	if (esil->cb.mem_read) {
 		ret = esil->cb.mem_read (esil, addr, buf, len);
 	}
-	sdb_array_add_num (DB, KEY ("mem.read"), addr, 0);
-	r_hex_bin2str (buf, len, hexbuf);
-	sdb_set (DB, KEYAT ("mem.read.data", addr), hexbuf, 0);
-	//eprintf ("[ESIL] MEM READ 0x%08"PFMT64x" %s\n", addr, hexbuf);
-	free (hexbuf);
-
+	trace_mem_add (esil, false, addr, buf, len);
 	if (ocbs.hook_mem_read) {
 		RAnalEsilCallbacks cbs = esil->cb;
 		esil->cb = ocbs;
@@ -73,13 +195,7 @@ static int trace_hook_mem_read(RAnalEsil *esil, ut64 addr, ut8 *buf, int len) {
 
 static int trace_hook_mem_write(RAnalEsil *esil, ut64 addr, const ut8 *buf, int len) {
 	int ret = 0;
-	char *hexbuf = malloc ((1+len)*3);
-	sdb_array_add_num (DB, KEY ("mem.write"), addr, 0);
-	r_hex_bin2str (buf, len, hexbuf);
-	sdb_set (DB, KEYAT ("mem.write.data", addr), hexbuf, 0);
-	//eprintf ("[ESIL] MEM WRITE 0x%08"PFMT64x" %s\n", addr, hexbuf);
-	free (hexbuf);
-
+	trace_mem_add (esil, true, addr, buf, len);
 	if (ocbs.hook_mem_write) {
 		RAnalEsilCallbacks cbs = esil->cb;
 		esil->cb = ocbs;
@@ -89,6 +205,34 @@ static int trace_hook_mem_write(RAnalEsil *esil, ut64 addr, const ut8 *buf, int
 	return ret;
 }
 
+/* make room for the step esil->trace_idx, steps are contiguous */
+static bool trace_step_new(RAnalEsil *esil, ut64 addr) {
+	RAnalEsilTrace *trace = esil->trace;
+	if (!trace->steps.len || esil->trace_idx < trace->idx) {
+		r_vector_clear (&trace->steps);
+		trace->idx = esil->trace_idx;
+	}
+	size_t n = esil->trace_idx - trace->idx;
+	while (trace->steps.len > n) {
+		RAnalEsilTraceStep step;
+		r_vector_pop (&trace->steps, &step);
+		trace_step_fini (&step, NULL);
+	}
+	while (trace->steps.len <= n) {
+		RAnalEsilTraceStep step = { UT64_MAX };
+		r_vector_init (&step.reg_read, sizeof (RAnalEsilTraceReg), NULL, NULL);
+		r_vector_init (&step.reg_write, sizeof (RAnalEsilTraceReg), NULL, NULL);
+		r_vector_init (&step.mem_read, sizeof (RAnalEsilTraceMem), trace_mem_fini, NULL);
+		r_vector_init (&step.mem_write, sizeof (RAnalEsilTraceMem), trace_mem_fini, NULL);
+		if (!r_vector_push (&trace->steps, &step)) {
+			return false;
+		}
+	}
+	RAnalEsilTraceStep *step = trace_cur (esil);
+	step->addr = addr;
+	return true;
+}
+
 R_API void r_anal_esil_trace (RAnalEsil *esil, RAnalOp *op) {
 	if (!esil || !op) {
 		return;
@@ -102,19 +246,14 @@ R_API void r_anal_esil_trace (RAnalEsil *esil, RAnalOp *op) {
 	if (ocbs_set) {
 		eprintf ("cannot call recursively\n");
 	}
+	if (!esil->trace) {
+		esil->trace = r_anal_esil_trace_new ();
+	}
+	if (!esil->trace || !trace_step_new (esil, op->addr)) {
+		return;
+	}
 	ocbs = esil->cb;
 	ocbs_set = true;
-	if (!DB) {
-		DB = sdb_new0 ();
-	}
-	sdb_num_set (DB, "idx", esil->trace_idx, 0);
-	sdb_num_set (DB, KEY ("addr"), op->addr, 0);
-//	sdb_set (DB, KEY ("opcode"), op->mnemonic, 0);
-//	sdb_set (DB, KEY ("addr"), expr, 0);
-
-	//eprintf ("[ESIL] ADDR 0x%08"PFMT64x"\n", op->addr);
-	//eprintf ("[ESIL] OPCODE %s\n", op->mnemonic);
-	//eprintf ("[ESIL] EXPR = %s\n", expr);
 	/* set hooks */
 	esil->verbose = 0;
 	esil->cb.hook_reg_read = trace_hook_reg_read;
@@ -131,6 +270,58 @@ R_API void r_anal_esil_trace (RAnalEsil *esil, RAnalOp *op) {
 	esil->trace_idx ++;
 }
 
+static void trace_sdb_regs(Sdb *db, RAnalEsilTrace *trace, int idx, const char *kind, RVector *regs) {
+	const char *key = sdb_fmt ("%d.%s", idx, kind);
+	char *k = strdup (key);
+	RAnalEsilTraceReg *r;
+	r_vector_foreach (regs, r) {
+		const char *name = r_pvector_at (&trace->regs, r->reg);
+		sdb_array_add (db, k, name, 0);
+		sdb_num_set (db, sdb_fmt ("%s.%s", k, name), r->value, 0);
+	}
+	free (k);
+}
+
+static void trace_sdb_mem(Sdb *db, int idx, const char *kind, RVector *mems) {
+	char *k = strdup (sdb_fmt ("%d.%s", idx, kind));
+	RAnalEsilTraceMem *m;
+	r_vector_foreach (mems, m) {
+		char *hex = calloc (1 + m->len, 2);
+		if (hex) {
+			r_hex_bin2str (m->data, m->len, hex);
+			sdb_array_add_num (db, k, m->addr, 0);
+			sdb_set (db, sdb_fmt ("%s.data.0x%"PFMT64x, k, m->addr), hex, 0);
+			free (hex);
+		}
+	}
+	free (k);
+}
+
+/* the trace in the "<idx>.reg.read.<reg>" style keys used by dtek and older scripts */
+R_API Sdb *r_anal_esil_trace_sdb(RAnalEsilTrace *trace) {
+	r_return_val_if_fail (trace, NULL);
+	Sdb *db = sdb_new0 ();
+	if (!db) {
+		return NULL;
+	}
+	if (trace->steps.len) {
+		sdb_set (db, "idx", sdb_fmt ("%d", r_anal_esil_trace_last (trace)), 0);
+	}
+	int idx = trace->idx;
+	RAnalEsilTraceStep *step;
+	r_vector_foreach (&trace->steps, step) {
+		if (step->addr != UT64_MAX) {
+			sdb_num_set (db, sdb_fmt ("%d.addr", idx), step->addr, 0);
+			trace_sdb_regs (db, trace, idx, "reg.read", &step->reg_read);
+			trace_sdb_regs (db, trace, idx, "reg.write", &step->reg_write);
+			trace_sdb_mem (db, idx, "mem.read", &step->mem_read);
+			trace_sdb_mem (db, idx, "mem.write", &step->mem_write);
+		}
+		idx++;
+	}
+	return db;
+}
+
 static int cmp_strings_by_leading_number(void *data1, void *data2) {
 	const char* a = sdbkv_key ((const SdbKv *)data1);
 	const char* b = sdbkv_key ((const SdbKv *)data2);
@@ -187,69 +378,47 @@ R_API void r_anal_esil_trace_list (RAnalEsil *esil) {
 	PrintfCallback p = esil->anal->cb_printf;
 	SdbKv *kv;
 	SdbListIter *iter;
-	SdbList *list = sdb_foreach_list (esil->db_trace, true);
+	if (!esil->trace) {
+		return;
+	}
+	Sdb *db = r_anal_esil_trace_sdb (esil->trace);
+	if (!db) {
+		return;
+	}
+	SdbList *list = sdb_foreach_list (db, true);
 	ls_sort (list, (SdbListComparator) cmp_strings_by_leading_number);
 	ls_foreach (list, iter, kv) {
 		p ("%s=%s\n", sdbkv_key (kv), sdbkv_value (kv));
 	}
 	ls_free (list);
+	sdb_free (db);
 }
 
 R_API void r_anal_esil_trace_show(RAnalEsil *esil, int idx) {
 	PrintfCallback p = esil->anal->cb_printf;
-	const char *str2;
-	const char *str;
-	int trace_idx = esil->trace_idx;
-	esil->trace_idx = idx;
-
-	str2 = sdb_const_get (DB, KEY ("addr"), 0);
-	if (!str2) {
+	RAnalEsilTraceStep *step = esil->trace? r_anal_esil_trace_step (esil->trace, idx): NULL;
+	if (!step || step->addr == UT64_MAX) {
 		return;
 	}
-	p ("ar PC = %s\n", str2);
-	/* registers */
-	str = sdb_const_get (DB, KEY ("reg.read"), 0);
-	if (str) {
-		char regname[32];
-		const char *next, *ptr = str;
-		if (ptr && *ptr) {
-			do {
-				next = sdb_const_anext (ptr);
-				int len = next? (int)(size_t)(next-ptr)-1 : strlen (ptr);
-				if (len <sizeof(regname)) {
-					memcpy (regname, ptr, len);
-					regname[len] = 0;
-					str2 = sdb_const_get (DB, KEYREG ("reg.read", regname), 0);
-					p ("ar %s = %s\n", regname, str2);
-				} else {
-					eprintf ("Invalid entry in reg.read\n");
-				}
-				ptr = next;
-			} while (next);
+	p ("ar PC = %s\n", sdb_fmt (step->addr? "0x%"PFMT64x: "%"PFMT64d, step->addr));
+	/* registers, once each with the last value read */
+	size_t i;
+	for (i = 0; i < step->reg_read.len; i++) {
+		RAnalEsilTraceReg *r = r_vector_index_ptr (&step->reg_read, i);
+		ut64 value;
+		if (!trace_reg_seen (&step->reg_read, i, r->reg) && trace_reg_find (&step->reg_read, r->reg, &value)) {
+			const char *name = r_pvector_at (&esil->trace->regs, r->reg);
+			p ("ar %s = %s\n", name, sdb_fmt (value? "0x%"PFMT64x: "%"PFMT64d, value));
 		}
 	}
 	/* memory */
-	str = sdb_const_get (DB, KEY ("mem.read"), 0);
-	if (str) {
-		char addr[64];
-		const char *next, *ptr = str;
-		if (ptr && *ptr) {
-			do {
-				next = sdb_const_anext (ptr);
-				int len = next? (int)(size_t)(next-ptr)-1 : strlen (ptr);
-				if (len <sizeof(addr)) {
-					memcpy (addr, ptr, len);
-					addr[len] = 0;
-					str2 = sdb_const_get (DB, KEYAT ("mem.read.data",
-						r_num_get (NULL, addr)), 0);
-					p ("wx %s @ %s\n", str2, addr);
-				} else {
-					eprintf ("Invalid entry in reg.read\n");
-				}
-				ptr = next;
-			} while (next);
+	RAnalEsilTraceMem *m;
+	r_vector_foreach (&step->mem_read, m) {
+		char *hex = calloc (1 + m->len, 2);
+		if (hex) {
+			r_hex_bin2str (m->data, m->len, hex);
+			p ("wx %s @ 0x%"PFMT64x"\n", hex, m->addr);
+			free (hex);
 		}
 	}
-
-	esil->trace_idx = trace_idx;
 }
@@ -59,7 +59,7 @@ static void inst_vars_kv_free(HtUPKv *kv) {
 }
 
 R_API RAnalFunction *r_anal_function_new(RAnal *anal) {
-	RAnalFunction *fcn = R_NEW0 (RAnalFunction);
+	RAnalFunction *fcn = r_mem_pool_alloc (anal->fcn_pool);
 	if (!fcn) {
 		return NULL;
 	}
@@ -108,7 +108,7 @@ R_API void r_anal_function_free(void *_fcn) {
 	fcn->bbs = NULL;
 	free (fcn->fingerprint);
 	r_anal_diff_free (fcn->diff);
-	free (fcn);
+	r_mem_pool_release (anal->fcn_pool, fcn);
 }
 
 R_API bool r_anal_add_function(RAnal *anal, RAnalFunction *fcn) {
@@ -67,9 +67,30 @@ static void arch_hint_record_free_rb(RBNode *node, void *user) {
 	free (record);
 }
 
+// every change to the hints at [addr, addr + size) goes through here
+static void hint_changed(RAnal *a, ut64 addr, ut64 size) {
+	a->hint_epoch++;
+	r_anal_opcache_invalidate (a, addr, size, R_ANAL_DIRTY_HINT);
+	if (a->ev) {
+		REventHint ev = { addr, size };
+		r_event_send (a->ev, R_EVENT_ANAL_HINT, &ev);
+	}
+}
+
+// a ranged record affects every address until the next one in the tree
+static ut64 ranged_hint_size(RBTree tree, ut64 addr) {
+	ut64 next = addr + 1;
+	RBNode *node = next? r_rbtree_lower_bound (tree, &next, ranged_hint_record_cmp, NULL): NULL;
+	ut64 end = node? container_of (node, RAnalRangedHintRecordBase, rb)->addr: UT64_MAX;
+	return R_MAX (end - addr, 1);
+}
+
 // used in anal.c, but no API needed
 void r_anal_hint_storage_init(RAnal *a) {
 	a->addr_hints = ht_up_new (NULL, addr_hint_record_ht_free, NULL);
+	if (a->addr_hints && a->concurrent) {
+		ht_up_set_concurrent (a->addr_hints, true);
+	}
 	a->arch_hints = NULL;
 	a->bits_hints = NULL;
 }
@@ -82,6 +103,7 @@ void r_anal_hint_storage_fini(RAnal *a) {
 }
 
 R_API void r_anal_hint_clear(RAnal *a) {
+	hint_changed (a, 0, UT64_MAX);
 	r_anal_hint_storage_fini (a);
 	r_anal_hint_storage_init (a);
 }
@@ -102,6 +124,7 @@ static bool addr_hint_range_delete_cb(void *user, const ut64 key, const void *va
 }
 
 R_API void r_anal_hint_del(RAnal *a, ut64 addr, ut64 size) {
+	hint_changed (a, addr, R_MAX (size, 1));
 	if (size <= 1) {
 		// only single address
 		ht_up_delete (a->addr_hints, addr);
@@ -147,13 +170,15 @@ static void unset_addr_hint_record(RAnal *anal, RAnalAddrHintType type, ut64 add
 		if (record->type == type) {
 			addr_hint_record_fini (record, NULL);
 			r_vector_remove_at (records, i, NULL);
+			hint_changed (anal, addr, 1);
 			return;
 		}
 	}
 }
 
 // create or return the existing addr hint record of the given type at addr
-static RAnalAddrHintRecord *ensure_addr_hint_record(RAnal *anal, RAnalAddrHintType type, ut64 addr) {
+static RAnalAddrHintRecord *ensure_addr_hint_record(RAnal *anal, RAnalAddrHintType type, ut64 addr, bool *created) {
+	*created = false;
 	RVector *records = ht_up_find (anal->addr_hints, addr, NULL);
 	if (!records) {
 		records = r_vector_new (sizeof (RAnalAddrHintRecord), addr_hint_record_fini, NULL);
@@ -170,19 +195,32 @@ static RAnalAddrHintRecord *ensure_addr_hint_record(RAnal *anal, RAnalAddrHintTy
 		}
 	}
 	RAnalAddrHintRecord *record = r_vector_push (records, NULL);
+	if (!record) {
+		return NULL;
+	}
 	memset (record, 0, sizeof (*record));
 	record->type = type;
+	*created = true;
 	return record;
 }
 
-#define SET_HINT(type, setcode) do { \
-	RAnalAddrHintRecord *r = ensure_addr_hint_record (a, type, addr); \
+// setting a hint to the value it already has is not a change, changed
+// is evaluated before setcode
+#define SET_HINT(type, changed, setcode) do { \
+	bool created; \
+	RAnalAddrHintRecord *r = ensure_addr_hint_record (a, type, addr, &created); \
 	if (!r) { \
 		break; \
 	} \
+	const bool change = created || (changed); \
 	setcode \
+	if (change) { \
+		hint_changed (a, addr, 1); \
+	} \
 } while(0)
 
+#define STR_CHANGED(x, y) (!(x) || strcmp ((x), (y)))
+
 static RAnalRangedHintRecordBase *ensure_ranged_hint_record(RBTree *tree, ut64 addr, size_t sz) {
 	RBNode *node = r_rbtree_find (*tree, &addr, ranged_hint_record_cmp, NULL);
 	if (node) {
@@ -199,100 +237,110 @@ static RAnalRangedHintRecordBase *ensure_ranged_hint_record(RBTree *tree, ut64 a
 }
 
 R_API void r_anal_hint_set_offset(RAnal *a, ut64 addr, const char *typeoff) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_TYPE_OFFSET,
-			  free (r->type_offset);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_TYPE_OFFSET, STR_CHANGED (r->type_offset, typeoff),
+		free (r->type_offset);
 		r->type_offset = strdup (typeoff);
 	);
 }
 
 R_API void r_anal_hint_set_nword(RAnal *a, ut64 addr, int nword) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_NWORD, r->nword = nword;);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_NWORD, r->nword != nword, r->nword = nword;);
 }
 
 R_API void r_anal_hint_set_jump(RAnal *a, ut64 addr, ut64 jump) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_JUMP, r->jump = jump;);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_JUMP, r->jump != jump, r->jump = jump;);
 }
 
 R_API void r_anal_hint_set_fail(RAnal *a, ut64 addr, ut64 fail) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_FAIL, r->fail = fail;);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_FAIL, r->fail != fail, r->fail = fail;);
 }
 
 R_API void r_anal_hint_set_newbits(RAnal *a, ut64 addr, int bits) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_NEW_BITS, r->newbits = bits;);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_NEW_BITS, r->newbits != bits, r->newbits = bits;);
 }
 
 R_API void r_anal_hint_set_high(RAnal *a, ut64 addr) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_HIGH,);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_HIGH, false,);
 }
 
 R_API void r_anal_hint_set_immbase(RAnal *a, ut64 addr, int base) {
 	if (base) {
-		SET_HINT (R_ANAL_ADDR_HINT_TYPE_IMMBASE, r->immbase = base;);
+		SET_HINT (R_ANAL_ADDR_HINT_TYPE_IMMBASE, r->immbase != base, r->immbase = base;);
 	} else {
 		unset_addr_hint_record (a, R_ANAL_ADDR_HINT_TYPE_IMMBASE, addr);
 	}
 }
 
 R_API void r_anal_hint_set_pointer(RAnal *a, ut64 addr, ut64 ptr) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_PTR, r->ptr = ptr;);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_PTR, r->ptr != ptr, r->ptr = ptr;);
 }
 
 R_API void r_anal_hint_set_ret(RAnal *a, ut64 addr, ut64 val) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_RET, r->retval = val;);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_RET, r->retval != val, r->retval = val;);
 }
 
 R_API void r_anal_hint_set_syntax(RAnal *a, ut64 addr, const char *syn) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_SYNTAX,
-			  free (r->syntax);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_SYNTAX, STR_CHANGED (r->syntax, syn),
+		free (r->syntax);
 		r->syntax = strdup (syn);
 	);
 }
 
 R_API void r_anal_hint_set_opcode(RAnal *a, ut64 addr, const char *opcode) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_OPCODE,
-			  free (r->opcode);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_OPCODE, STR_CHANGED (r->opcode, opcode),
+		free (r->opcode);
 		r->opcode = strdup (opcode);
 	);
 }
 
 R_API void r_anal_hint_set_esil(RAnal *a, ut64 addr, const char *esil) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_ESIL,
-			  free (r->esil);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_ESIL, STR_CHANGED (r->esil, esil),
+		free (r->esil);
 		r->esil = strdup (esil);
 	);
 }
 
 R_API void r_anal_hint_set_type (RAnal *a, ut64 addr, int type) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_OPTYPE, r->optype = type;);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_OPTYPE, r->optype != type, r->optype = type;);
 }
 
 R_API void r_anal_hint_set_size(RAnal *a, ut64 addr, ut64 size) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_SIZE, r->size = size;);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_SIZE, r->size != size, r->size = size;);
 }
 
 R_API void r_anal_hint_set_stackframe(RAnal *a, ut64 addr, ut64 size) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_STACKFRAME, r->stackframe = size;);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_STACKFRAME, r->stackframe != size, r->stackframe = size;);
 }
 
 R_API void r_anal_hint_set_val(RAnal *a, ut64 addr, ut64 v) {
-	SET_HINT (R_ANAL_ADDR_HINT_TYPE_VAL, r->val = v;);
+	SET_HINT (R_ANAL_ADDR_HINT_TYPE_VAL, r->val != v, r->val = v;);
 }
 
 R_API void r_anal_hint_set_arch(RAnal *a, ut64 addr, const char *arch) {
+	bool found = r_rbtree_find (a->arch_hints, &addr, ranged_hint_record_cmp, NULL);
 	RAnalArchHintRecord *record = (RAnalArchHintRecord *)ensure_ranged_hint_record (&a->arch_hints, addr, sizeof (RAnalArchHintRecord));
 	if (!record) {
 		return;
 	}
+	bool changed = !found || ((arch && record->arch)? strcmp (arch, record->arch): arch != record->arch);
 	free (record->arch);
 	record->arch = arch ? strdup (arch) : NULL;
+	if (changed) {
+		hint_changed (a, addr, ranged_hint_size (a->arch_hints, addr));
+	}
 }
 
 R_API void r_anal_hint_set_bits(RAnal *a, ut64 addr, int bits) {
+	bool found = r_rbtree_find (a->bits_hints, &addr, ranged_hint_record_cmp, NULL);
 	RAnalBitsHintRecord *record = (RAnalBitsHintRecord *)ensure_ranged_hint_record (&a->bits_hints, addr, sizeof (RAnalBitsHintRecord));
 	if (!record) {
 		return;
 	}
+	bool changed = !found || record->bits != bits;
 	record->bits = bits;
+	if (changed) {
+		hint_changed (a, addr, ranged_hint_size (a->bits_hints, addr));
+	}
 	if (a->hint_cbs.on_bits) {
 		a->hint_cbs.on_bits (a, addr, bits, true);
 	}
@@ -363,11 +411,17 @@ R_API void r_anal_hint_unset_stackframe(RAnal *a, ut64 addr) {
 }
 
 R_API void r_anal_hint_unset_arch(RAnal *a, ut64 addr) {
-	r_rbtree_delete (&a->arch_hints, &addr, ranged_hint_record_cmp, NULL, arch_hint_record_free_rb, NULL);
+	ut64 size = ranged_hint_size (a->arch_hints, addr);
+	if (r_rbtree_delete (&a->arch_hints, &addr, ranged_hint_record_cmp, NULL, arch_hint_record_free_rb, NULL)) {
+		hint_changed (a, addr, size);
+	}
 }
 
 R_API void r_anal_hint_unset_bits(RAnal *a, ut64 addr) {
-	r_rbtree_delete (&a->bits_hints, &addr, ranged_hint_record_cmp, NULL, bits_hint_record_free_rb, NULL);
+	ut64 size = ranged_hint_size (a->bits_hints, addr);
+	if (r_rbtree_delete (&a->bits_hints, &addr, ranged_hint_record_cmp, NULL, bits_hint_record_free_rb, NULL)) {
+		hint_changed (a, addr, size);
+	}
 }
 
 R_API void r_anal_hint_free(RAnalHint *h) {
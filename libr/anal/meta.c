@@ -98,27 +98,153 @@ static RPVector *collect_nodes_intersect(RAnal *anal, RAnalMetaType type, R_NULL
 	return ctx.result;
 }
 
+typedef struct {
+	ut64 from;
+	ut64 to;
+	size_t seq;
+	RAnalMetaItem *item;
+} BulkItem;
+
+// comments repeat a lot and are interned, everything else is owned
+static char *meta_str_new(RAnal *a, RAnalMetaType type, const char *str) {
+	if (!str) {
+		return NULL;
+	}
+	return type == R_META_TYPE_COMMENT? (char *)r_str_constpool_ref (&a->constpool, str): strdup (str);
+}
+
+static void meta_str_free(RAnal *a, RAnalMetaItem *item) {
+	if (item->type == R_META_TYPE_COMMENT) {
+		r_str_constpool_unref (&a->constpool, item->str);
+	} else {
+		free (item->str);
+	}
+	item->str = NULL;
+}
+
+static void meta_item_free(RAnal *a, RAnalMetaItem *item) {
+	if (item) {
+		meta_str_free (a, item);
+		free (item);
+	}
+}
+
+static bool bulk_set(RAnal *a, RSpace *space, RAnalMetaType type, int subtype, ut64 from, ut64 to, const char *str) {
+	BulkItem b = { .from = from, .to = to, .seq = a->meta_bulk.len, .item = R_NEW0 (RAnalMetaItem) };
+	if (!b.item) {
+		return false;
+	}
+	b.item->type = type;
+	b.item->subtype = subtype;
+	b.item->space = space;
+	b.item->str = meta_str_new (a, type, str);
+	if ((str && !b.item->str) || !r_vector_push (&a->meta_bulk, &b)) {
+		meta_item_free (a, b.item);
+		return false;
+	}
+	return true;
+}
+
+static int bulk_cmp(const void *a, const void *b) {
+	const BulkItem *x = a, *y = b;
+	if (x->from != y->from) {
+		return x->from < y->from? -1: 1;
+	}
+	return x->seq < y->seq? -1: x->seq > y->seq;
+}
+
+R_API void r_meta_bulk_begin(RAnal *a) {
+	r_return_if_fail (a);
+	if (!a->meta_bulk_depth++) {
+		r_vector_init (&a->meta_bulk, sizeof (BulkItem), NULL, NULL);
+	}
+}
+
+R_API void r_meta_bulk_end(RAnal *a) {
+	r_return_if_fail (a && a->meta_bulk_depth > 0);
+	if (--a->meta_bulk_depth) {
+		return;
+	}
+	BulkItem *b;
+	size_t group = 0, n = 0;
+	RIntervalTreeItem *items = R_NEWS (RIntervalTreeItem, a->meta_bulk.len + 1);
+	if (!items) {
+		r_vector_foreach (&a->meta_bulk, b) {
+			meta_item_free (a, b->item);
+		}
+		r_vector_fini (&a->meta_bulk);
+		return;
+	}
+	qsort (a->meta_bulk.a, a->meta_bulk.len, sizeof (BulkItem), bulk_cmp);
+	r_vector_foreach (&a->meta_bulk, b) {
+		RAnalMetaItem *item = b->item;
+		if (!n || items[n - 1].start != b->from) {
+			group = n;
+		}
+		// same rules as meta_set, the last item set wins
+		RIntervalNode *node = find_node_at (a, item->type, item->space, b->from);
+		RIntervalTreeItem *prev = NULL;
+		size_t i;
+		for (i = group; !node && i < n; i++) {
+			if (item_matches_filter (items[i].data, item->type, item->space)) {
+				prev = &items[i];
+				break;
+			}
+		}
+		RAnalMetaItem *dst = node? node->data: prev? prev->data: NULL;
+		if (!dst) {
+			items[n++] = (RIntervalTreeItem){ .start = b->from, .end = b->to, .data = item };
+			continue;
+		}
+		meta_str_free (a, dst);
+		dst->type = item->type;
+		dst->subtype = item->subtype;
+		dst->space = item->space;
+		dst->str = item->str;
+		item->str = NULL;
+		meta_item_free (a, item);
+		if (prev) {
+			prev->end = b->to;
+		} else if (node->end != b->to) {
+			r_interval_tree_resize (&a->meta, node, b->from, b->to);
+		}
+	}
+	r_vector_fini (&a->meta_bulk);
+	if (!r_interval_tree_insert_all (&a->meta, items, n)) {
+		size_t i;
+		for (i = 0; i < n; i++) {
+			meta_item_free (a, items[i].data);
+		}
+	}
+	free (items);
+}
+
 static bool meta_set(RAnal *a, RAnalMetaType type, int subtype, ut64 from, ut64 to, const char *str) {
 	if (to < from) {
 		return false;
 	}
 	RSpace *space = r_spaces_current (&a->meta_spaces);
+	if (a->meta_bulk_depth) {
+		return bulk_set (a, space, type, subtype, from, to, str);
+	}
 	RIntervalNode *node = find_node_at (a, type, space, from);
 	RAnalMetaItem *item = node ? node->data : R_NEW0 (RAnalMetaItem);
 	if (!item) {
 		return false;
 	}
-	item->type = type;
-	item->subtype = subtype;
-	item->space = space;
-	free (item->str);
-	item->str = str ? strdup (str) : NULL;
-	if (str && !item->str) {
+	// str may be the one of item
+	char *nstr = meta_str_new (a, type, str);
+	if (str && !nstr) {
 		if (!node) { // If we just created this
 			free (item);
 		}
 		return false;
 	}
+	meta_str_free (a, item);
+	item->type = type;
+	item->subtype = subtype;
+	item->space = space;
+	item->str = nstr;
 	if (!node) {
 		r_interval_tree_insert (&a->meta, from, to, item);
 	} else if (node->end != to) {
@@ -168,7 +294,9 @@ static void del(RAnal *a, RAnalMetaType type, const RSpace *space, ut64 addr, ut
 	}
 	void **it;
 	r_pvector_foreach (victims, it) {
-		r_interval_tree_delete (&a->meta, *it, true);
+		RIntervalNode *node = *it;
+		meta_str_free (a, node->data);
+		r_interval_tree_delete (&a->meta, node, true);
 	}
 	r_pvector_free (victims);
 }
@@ -88,6 +88,52 @@ static int defaultCycles(RAnalOp *op) {
 	}
 }
 
+// notes the decoders reading memory out of the op, see opcache.c
+static bool op_read_at(RAnal *anal, ut64 addr, ut8 *buf, int len) {
+	RAnalOpCache *c = anal->opcache;
+	c->read = true;
+	return c->read_at (anal, addr, buf, len);
+}
+
+static bool op_watch_reads(RAnal *anal) {
+	RAnalOpCache *c = anal->opcache;
+	if (!c || !anal->read_at || anal->read_at == op_read_at) {
+		return false;
+	}
+	c->read = false;
+	c->read_at = anal->read_at;
+	anal->read_at = op_read_at;
+	return true;
+}
+
+static void op_unwatch_reads(RAnal *anal, bool watched) {
+	if (watched) {
+		anal->read_at = anal->opcache->read_at;
+	}
+}
+
+static void op_decoded(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int len, RAnalOpMask mask, int ret) {
+	if (ret < 1) {
+		op->type = R_ANAL_OP_TYPE_ILL;
+	}
+	op->addr = addr;
+	/* consider at least 1 byte to be part of the opcode */
+	if (op->nopcode < 1) {
+		op->nopcode = 1;
+	}
+	r_anal_opcache_set (anal, op, addr, data, len, mask, ret);
+}
+
+static void op_apply_hint(RAnal *anal, RAnalOp *op, ut64 addr, RAnalOpMask mask) {
+	if (mask & R_ANAL_OP_MASK_HINT) {
+		RAnalHint *hint = r_anal_hint_get (anal, addr);
+		if (hint) {
+			r_anal_op_hint (op, hint);
+			r_anal_hint_free (hint);
+		}
+	}
+}
+
 R_API int r_anal_op(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int len, RAnalOpMask mask) {
 	r_anal_op_init (op);
 	r_return_val_if_fail (anal && op && len > 0, -1);
@@ -106,14 +152,11 @@ R_API int r_anal_op(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int le
 			op->size = 1;
 			return -1;
 		}
-		ret = anal->cur->op (anal, op, addr, data, len, mask);
-		if (ret < 1) {
-			op->type = R_ANAL_OP_TYPE_ILL;
-		}
-		op->addr = addr;
-		/* consider at least 1 byte to be part of the opcode */
-		if (op->nopcode < 1) {
-			op->nopcode = 1;
+		if (!r_anal_opcache_get (anal, op, addr, data, len, mask, &ret)) {
+			bool watched = op_watch_reads (anal);
+			ret = anal->cur->op (anal, op, addr, data, len, mask);
+			op_decoded (anal, op, addr, data, len, mask, ret);
+			op_unwatch_reads (anal, watched);
 		}
 	} else if (!memcmp (data, "\xff\xff\xff\xff", R_MIN (4, len))) {
 		op->type = R_ANAL_OP_TYPE_ILL;
@@ -128,14 +171,73 @@ R_API int r_anal_op(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int le
 			eprintf ("Warning: unhandled R_ANAL_OP_MASK_DISASM in r_anal_op\n");
 		}
         }
-	if (mask & R_ANAL_OP_MASK_HINT) {
-		RAnalHint *hint = r_anal_hint_get (anal, addr);
-		if (hint) {
-			r_anal_op_hint (op, hint);
-			r_anal_hint_free (hint);
+	op_apply_hint (anal, op, addr, mask);
+	return ret;
+}
+
+static void op_archbits(RAnal *anal, ut64 addr) {
+	if (anal->coreb.archbits) {
+		anal->coreb.archbits (anal->coreb.core, addr);
+	}
+}
+
+/* Decodes up to n consecutive ops of data starting at addr. This is the
+ * same as calling r_anal_op for each of them, but plugins implementing
+ * op_batch decode the whole run at once. Ops that do not decode are one
+ * byte long, each op starts where the previous one ends. Returns the
+ * number of ops filled, which stops short of n only when data runs out.
+ * Every filled op must be released with r_anal_op_fini. */
+R_API int r_anal_op_batch(RAnal *anal, RAnalOp *ops, int n, ut64 addr, const ut8 *data, int len, RAnalOpMask mask) {
+	r_return_val_if_fail (anal && ops && data, -1);
+	int i = 0, off = 0;
+	while (i < n && off < len) {
+		const ut64 at = addr + off;
+		int j, count = 0;
+		op_archbits (anal, at);
+		RAnalPlugin *cur = anal->cur;
+		const int bits = anal->bits;
+		if (cur && cur->op_batch && !anal->pcalign) {
+			if (r_anal_opcache_get (anal, &ops[i], at, data + off, len - off, mask, NULL)) {
+				op_apply_hint (anal, &ops[i], at, mask);
+				off += R_MAX (ops[i].size, 1);
+				i++;
+				continue;
+			}
+			for (j = i; j < n; j++) {
+				r_anal_op_init (&ops[j]);
+			}
+			bool watched = op_watch_reads (anal);
+			count = cur->op_batch (anal, ops + i, n - i, at, data + off, len - off, mask);
+			for (j = i; j < i + count; j++) {
+				const ut64 opaddr = addr + off;
+				if (j > i) {
+					// hints and arm/thumb ranges can switch modes at any op
+					op_archbits (anal, opaddr);
+					if (anal->cur != cur || anal->bits != bits) {
+						break;
+					}
+				}
+				op_decoded (anal, &ops[j], opaddr, data + off, len - off, mask, ops[j].size);
+				op_apply_hint (anal, &ops[j], opaddr, mask);
+				off += R_MAX (ops[j].size, 1);
+			}
+			op_unwatch_reads (anal, watched);
+			count = j - i;
+			for (; j < n; j++) {
+				r_anal_op_fini (&ops[j]);
+			}
 		}
+		if (count < 1) {
+			// the plugin leaves what it can not decode in bulk to r_anal_op
+			if (r_anal_op (anal, &ops[i], at, data + off, len - off, mask) < 1) {
+				ops[i].size = 1;
+			}
+			off += R_MAX (ops[i].size, 1);
+			count = 1;
+		}
+		i += count;
 	}
-	return ret;
+	return i;
 }
 
 R_API RAnalOp *r_anal_op_copy(RAnalOp *op) {
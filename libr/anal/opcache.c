@@ -0,0 +1,328 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_anal.h>
+
+/*
+ * Bounded cache of decoded instructions.
+ *
+ * Entries are looked up by address and validated against the bytes the
+ * decoder consumed, so a different buffer at the same address simply
+ * misses. A change of the decoder state (plugin, bits, cpu, endianness,
+ * register profile) starts a new epoch which makes every entry stale.
+ *
+ * Some decoders also read memory out of the op, like x86 looking at call
+ * targets for thunks or bf searching the matching bracket. Those reads go
+ * through anal->read_at, which r_anal_op () watches while decoding: once
+ * such an op is cached any write to io starts a new epoch, otherwise only
+ * the entries overlapping the written bytes are dropped. Hint changes drop
+ * the entries in the hinted range, see r_anal_opcache_invalidate ().
+ *
+ * Besides RAnalOps decoded with a given mask the cache also keeps the
+ * disassembly text of RAsm, keyed by a hash of the assembler state the
+ * caller computes, see r_core_asm_disassemble ().
+ */
+
+#define OPCACHE_MAXBYTES 32
+#define OPCACHE_TEXT -1
+
+typedef struct op_cache_entry_t {
+	struct op_cache_entry_t *next; // other entries at the same address
+	ut64 addr;
+	ut64 epoch;
+	ut64 state; // assembler state of text entries
+	int kind; // mask without R_ANAL_OP_MASK_HINT or OPCACHE_TEXT
+	int ret;
+	int size; // bytes consumed by the decoder
+	int payload;
+	ut8 bytes[OPCACHE_MAXBYTES];
+	RAnalOp op;
+	char *text;
+} OpCacheEntry;
+
+static void op_copy(RAnalOp *dst, const RAnalOp *src) {
+	int i;
+	*dst = *src;
+	dst->mnemonic = src->mnemonic? strdup (src->mnemonic): NULL;
+	for (i = 0; i < 3; i++) {
+		dst->src[i] = src->src[i]? r_anal_value_copy (src->src[i]): NULL;
+	}
+	dst->dst = src->dst? r_anal_value_copy (src->dst): NULL;
+	dst->access = NULL;
+	if (src->access) {
+		RListIter *it;
+		RAnalValue *val;
+		dst->access = r_list_newf ((RListFree)r_anal_value_free);
+		r_list_foreach (src->access, it, val) {
+			r_list_append (dst->access, r_anal_value_copy (val));
+		}
+	}
+	r_strbuf_init (&dst->esil);
+	r_strbuf_copy (&dst->esil, (RStrBuf *)&src->esil);
+	r_strbuf_init (&dst->opex);
+	r_strbuf_copy (&dst->opex, (RStrBuf *)&src->opex);
+	dst->switch_op = NULL;
+}
+
+static void entry_fini(OpCacheEntry *e) {
+	if (e->kind != OPCACHE_TEXT) {
+		r_anal_op_fini (&e->op);
+	}
+	R_FREE (e->text);
+}
+
+static void entry_free(OpCacheEntry *e) {
+	while (e) {
+		OpCacheEntry *next = e->next;
+		entry_fini (e);
+		free (e);
+		e = next;
+	}
+}
+
+static void ht_entry_free(HtUPKv *kv) {
+	entry_free (kv->value);
+}
+
+R_API RAnalOpCache *r_anal_opcache_new(size_t size) {
+	r_return_val_if_fail (size > 0, NULL);
+	RAnalOpCache *c = R_NEW0 (RAnalOpCache);
+	if (!c) {
+		return NULL;
+	}
+	c->ht = ht_up_new (NULL, ht_entry_free, NULL);
+	c->ring = R_NEWS0 (void *, size);
+	if (!c->ht || !c->ring) {
+		r_anal_opcache_free (c);
+		return NULL;
+	}
+	c->size = size;
+	return c;
+}
+
+R_API void r_anal_opcache_free(RAnalOpCache *c) {
+	if (c) {
+		ht_up_free (c->ht);
+		free (c->ring);
+		free (c->cpu);
+		free (c);
+	}
+}
+
+R_API void r_anal_opcache_clear(RAnalOpCache *c) {
+	r_return_if_fail (c);
+	ht_up_free (c->ht);
+	c->ht = ht_up_new (NULL, ht_entry_free, NULL);
+	memset (c->ring, 0, c->size * sizeof (void *));
+	c->pos = 0;
+	c->hits = c->misses = 0;
+	c->text_hits = c->text_misses = 0;
+}
+
+// start a new epoch when the decoder state differs from the last lookup
+static void opcache_sync(RAnal *anal, RAnalOpCache *c) {
+	const char *cpu = r_str_get (anal->cpu);
+	ut64 reg_epoch = anal->reg? anal->reg->epoch: 0;
+	if (c->cpu && c->cur == anal->cur && c->bits == anal->bits
+			&& c->big_endian == anal->big_endian && c->pcalign == anal->pcalign
+			&& c->reg_epoch == reg_epoch && !strcmp (c->cpu, cpu)) {
+		return;
+	}
+	free (c->cpu);
+	c->cpu = strdup (cpu);
+	c->cur = anal->cur;
+	c->bits = anal->bits;
+	c->big_endian = anal->big_endian;
+	c->pcalign = anal->pcalign;
+	c->reg_epoch = reg_epoch;
+	c->reads = false;
+	c->epoch++;
+}
+
+static OpCacheEntry *entry_find(RAnalOpCache *c, ut64 addr, int kind, ut64 state) {
+	OpCacheEntry *e = ht_up_find (c->ht, addr, NULL);
+	for (; e; e = e->next) {
+		if (e->kind == kind && e->state == state) {
+			return e;
+		}
+	}
+	return NULL;
+}
+
+static bool entry_valid(RAnalOpCache *c, OpCacheEntry *e, const ut8 *data, int len) {
+	return e->epoch == c->epoch && e->size <= len && !memcmp (e->bytes, data, e->size);
+}
+
+static void entry_evict(RAnalOpCache *c, OpCacheEntry *victim) {
+	HtUPKv *kv = ht_up_find_kv (c->ht, victim->addr, NULL);
+	if (!kv) {
+		return;
+	}
+	OpCacheEntry **p = (OpCacheEntry **)&kv->value;
+	for (; *p; p = &(*p)->next) {
+		if (*p == victim) {
+			*p = victim->next;
+			victim->next = NULL;
+			entry_free (victim);
+			break;
+		}
+	}
+	if (!kv->value) {
+		ht_up_delete (c->ht, kv->key);
+	}
+}
+
+// returns the entry for addr/kind/state to be filled, reusing a stale one
+static OpCacheEntry *entry_slot(RAnalOpCache *c, ut64 addr, int kind, ut64 state) {
+	OpCacheEntry *e = entry_find (c, addr, kind, state);
+	if (e) {
+		entry_fini (e);
+		return e;
+	}
+	OpCacheEntry *victim = c->ring[c->pos];
+	if (victim) {
+		entry_evict (c, victim);
+	}
+	e = R_NEW0 (OpCacheEntry);
+	if (!e) {
+		c->ring[c->pos] = NULL;
+		return NULL;
+	}
+	e->addr = addr;
+	e->kind = kind;
+	e->state = state;
+	HtUPKv *kv = ht_up_find_kv (c->ht, addr, NULL);
+	if (kv) {
+		e->next = kv->value;
+		kv->value = e;
+	} else {
+		ht_up_insert (c->ht, addr, e);
+	}
+	c->ring[c->pos] = e;
+	c->pos = (c->pos + 1) % c->size;
+	return e;
+}
+
+R_API bool r_anal_opcache_get(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int len, int mask, int *ret) {
+	r_return_val_if_fail (anal && op && data, false);
+	RAnalOpCache *c = anal->opcache;
+	if (!c) {
+		return false;
+	}
+	opcache_sync (anal, c);
+	OpCacheEntry *e = entry_find (c, addr, mask & ~R_ANAL_OP_MASK_HINT, 0);
+	if (!e || !entry_valid (c, e, data, len)) {
+		c->misses++;
+		return false;
+	}
+	c->hits++;
+	op_copy (op, &e->op);
+	if (ret) {
+		*ret = e->ret;
+	}
+	return true;
+}
+
+R_API void r_anal_opcache_set(RAnal *anal, const RAnalOp *op, ut64 addr, const ut8 *data, int len, int mask, int ret) {
+	r_return_if_fail (anal && op && data);
+	RAnalOpCache *c = anal->opcache;
+	// invalid ops may just be missing bytes, switch tables are owned by the op
+	if (!c || ret < 1 || op->type == R_ANAL_OP_TYPE_ILL || op->switch_op
+			|| op->size < 1 || op->size > len || op->size > OPCACHE_MAXBYTES) {
+		return;
+	}
+	opcache_sync (anal, c);
+	OpCacheEntry *e = entry_slot (c, addr, mask & ~R_ANAL_OP_MASK_HINT, 0);
+	if (e) {
+		e->epoch = c->epoch;
+		c->reads |= c->read;
+		e->ret = ret;
+		e->size = op->size;
+		memcpy (e->bytes, data, op->size);
+		op_copy (&e->op, op);
+	}
+}
+
+R_API const char *r_anal_opcache_get_text(RAnal *anal, ut64 addr, ut64 state, const ut8 *data, int len, int *size, int *payload, int *ret) {
+	r_return_val_if_fail (anal && data, NULL);
+	RAnalOpCache *c = anal->opcache;
+	if (!c) {
+		return NULL;
+	}
+	opcache_sync (anal, c);
+	OpCacheEntry *e = entry_find (c, addr, OPCACHE_TEXT, state);
+	if (!e || !entry_valid (c, e, data, len)) {
+		c->text_misses++;
+		return NULL;
+	}
+	c->text_hits++;
+	if (size) {
+		*size = e->size;
+	}
+	if (payload) {
+		*payload = e->payload;
+	}
+	if (ret) {
+		*ret = e->ret;
+	}
+	return e->text;
+}
+
+R_API void r_anal_opcache_set_text(RAnal *anal, ut64 addr, ut64 state, const ut8 *data, int size, int payload, const char *text, int ret) {
+	r_return_if_fail (anal && data && text);
+	RAnalOpCache *c = anal->opcache;
+	if (!c || size < 1 || size > OPCACHE_MAXBYTES) {
+		return;
+	}
+	opcache_sync (anal, c);
+	OpCacheEntry *e = entry_slot (c, addr, OPCACHE_TEXT, state);
+	if (e) {
+		e->epoch = c->epoch;
+		e->ret = ret;
+		e->size = size;
+		e->payload = payload;
+		memcpy (e->bytes, data, size);
+		e->text = strdup (text);
+	}
+}
+
+// no epoch starts at 0, see opcache_sync ()
+static void entry_stale(OpCacheEntry *e, ut64 addr, ut64 end) {
+	if (e->addr < end && addr < e->addr + e->size) {
+		e->epoch = 0;
+	}
+}
+
+/* Drops the entries decoded from bytes in [addr, addr + size) after they
+ * were written (R_ANAL_DIRTY_WRITE) or their hints changed. Writes make
+ * everything stale when an op decoded reading memory is cached. */
+R_API void r_anal_opcache_invalidate(RAnal *anal, ut64 addr, ut64 size, RAnalDirtyReason reason) {
+	r_return_if_fail (anal);
+	RAnalOpCache *c = anal->opcache;
+	if (!c || !size) {
+		return;
+	}
+	if (reason == R_ANAL_DIRTY_WRITE && c->reads) {
+		c->reads = false;
+		c->epoch++;
+		return;
+	}
+	size = R_MIN (size, UT64_MAX - addr);
+	const ut64 end = addr + size;
+	if (size >= c->size) {
+		size_t i;
+		for (i = 0; i < c->size; i++) {
+			if (c->ring[i]) {
+				entry_stale (c->ring[i], addr, end);
+			}
+		}
+		return;
+	}
+	// entries are at most OPCACHE_MAXBYTES long, look up the ones reaching addr
+	ut64 at = addr > OPCACHE_MAXBYTES - 1? addr - (OPCACHE_MAXBYTES - 1): 0;
+	for (; at < end; at++) {
+		OpCacheEntry *e = ht_up_find (c->ht, at, NULL);
+		for (; e; e = e->next) {
+			entry_stale (e, addr, end);
+		}
+	}
+}
@@ -3227,13 +3227,13 @@ static void op_fillval(RAnalOp *op , csh handle, cs_insn *insn, int bits) {
 	}
 }
 
-static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
-	static csh handle = 0;
+static csh handle = 0;
+
+static bool cs_setup(RAnal *a) {
 	static int omode = -1;
 	static int obits = 32;
-	cs_insn *insn = NULL;
 	int mode = (a->bits==16)? CS_MODE_THUMB: CS_MODE_ARM;
-	int n, ret;
+	int ret;
 	mode |= (a->big_endian)? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
 	if (a->cpu && strstr (a->cpu, "cortex")) {
 		mode |= CS_MODE_MCLASS;
@@ -3245,8 +3245,6 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 		omode = mode;
 		obits = a->bits;
 	}
-	op->size = (a->bits==16)? 2: 4;
-	op->addr = addr;
 	if (handle == 0) {
 		ret = (a->bits == 64)?
 			cs_open (CS_ARCH_ARM64, mode, &handle):
@@ -3254,9 +3252,54 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 		cs_option (handle, CS_OPT_DETAIL, CS_OPT_ON);
 		if (ret != CS_ERR_OK) {
 			handle = 0;
-			return -1;
+			return false;
 		}
 	}
+	return true;
+}
+
+static void anop_insn(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask, cs_insn *insn) {
+	if (mask & R_ANAL_OP_MASK_DISASM) {
+		op->mnemonic = r_str_newf ("%s%s%s",
+			insn->mnemonic,
+			insn->op_str[0]?" ":"",
+			insn->op_str);
+	}
+	//bool thumb = cs_insn_group (handle, insn, ARM_GRP_THUMB);
+	bool thumb = a->bits == 16;
+	op->size = insn->size;
+	op->id = insn->id;
+	if (a->bits == 64) {
+		anop64 (handle, op, insn);
+		if (mask & R_ANAL_OP_MASK_OPEX) {
+			opex64 (&op->opex, handle, insn);
+		}
+		if (mask & R_ANAL_OP_MASK_ESIL) {
+			analop64_esil (a, op, addr, buf, len, &handle, insn);
+		}
+	} else {
+		anop32 (a, handle, op, insn, thumb, (ut8*)buf, len);
+		if (mask & R_ANAL_OP_MASK_OPEX) {
+			opex (&op->opex, handle, insn);
+		}
+		if (mask & R_ANAL_OP_MASK_ESIL) {
+			analop_esil (a, op, addr, buf, len, &handle, insn, thumb);
+		}
+	}
+	set_opdir (op);
+	if (mask & R_ANAL_OP_MASK_VAL) {
+		op_fillval (op, handle, insn, a->bits);
+	}
+}
+
+static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
+	cs_insn *insn = NULL;
+	int n;
+	op->size = (a->bits==16)? 2: 4;
+	op->addr = addr;
+	if (!cs_setup (a)) {
+		return -1;
+	}
 	int haa = hackyArmAnal (a, op, buf, len);
 	if (haa > 0) {
 		return haa;
@@ -3269,43 +3312,37 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 			op->mnemonic = strdup ("invalid");
 		}
 	} else {
-		if (mask & R_ANAL_OP_MASK_DISASM) {
-			op->mnemonic = r_str_newf ("%s%s%s",
-				insn->mnemonic,
-				insn->op_str[0]?" ":"",
-				insn->op_str);
-		}
-		//bool thumb = cs_insn_group (handle, insn, ARM_GRP_THUMB);
-		bool thumb = a->bits == 16;
-		op->size = insn->size;
-		op->id = insn->id;
-		if (a->bits == 64) {
-			anop64 (handle, op, insn);
-			if (mask & R_ANAL_OP_MASK_OPEX) {
-				opex64 (&op->opex, handle, insn);
-			}
-			if (mask & R_ANAL_OP_MASK_ESIL) {
-				analop64_esil (a, op, addr, buf, len, &handle, insn);
-			}
-		} else {
-			anop32 (a, handle, op, insn, thumb, (ut8*)buf, len);
-			if (mask & R_ANAL_OP_MASK_OPEX) {
-				opex (&op->opex, handle, insn);
-			}
-			if (mask & R_ANAL_OP_MASK_ESIL) {
-				analop_esil (a, op, addr, buf, len, &handle, insn, thumb);
-			}
-		}
-		set_opdir (op);
-		if (mask & R_ANAL_OP_MASK_VAL) {
-			op_fillval (op, handle, insn, a->bits);
-		}
+		anop_insn (a, op, addr, buf, len, mask, insn);
 		cs_free (insn, n);
 	}
 //		cs_close (&handle);
 	return op->size;
 }
 
+/* the whole run comes from a single cs_disasm call, it stops at the
+ * first instruction the hacks know better */
+static int analop_batch(RAnal *a, RAnalOp *ops, int count, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
+	cs_insn *insn = NULL;
+	int i, n;
+	if (!cs_setup (a)) {
+		return 0;
+	}
+	n = cs_disasm (handle, (ut8*)buf, len, addr, count, &insn);
+	for (i = 0; i < n; i++) {
+		const int at = insn[i].address - addr;
+		RAnalOp *op = &ops[i];
+		op->addr = insn[i].address;
+		if (hackyArmAnal (a, op, buf + at, len - at) > 0) {
+			break;
+		}
+		anop_insn (a, op, insn[i].address, buf + at, len - at, mask, &insn[i]);
+	}
+	if (insn) {
+		cs_free (insn, n);
+	}
+	return i;
+}
+
 static char *get_reg_profile(RAnal *anal) {
 	const char *p;
 	if (anal->bits == 64) {
@@ -3787,6 +3824,7 @@ RAnalPlugin r_anal_plugin_arm_cs = {
 	.preludes = anal_preludes,
 	.bits = 16 | 32 | 64,
 	.op = &analop,
+	.op_batch = &analop_batch,
 };
 
 #ifndef R2_PLUGIN_INCORE
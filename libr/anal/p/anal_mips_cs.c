@@ -704,12 +704,11 @@ static void set_opdir(RAnalOp *op) {
         }
 }
 
-static int analop(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
-	int n, ret, opsize = -1;
-	static csh hndl = 0;
+static csh hndl = 0;
+
+static bool cs_setup(RAnal *anal) {
 	static int omode = -1;
 	static int obits = 32;
-	cs_insn* insn;
 	int mode = anal->big_endian? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
 
 	if (anal->cpu && *anal->cpu) {
@@ -733,20 +732,20 @@ static int analop(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *buf, int len,
 		obits = anal->bits;
 	}
 // XXX no arch->cpu ?!?! CS_MODE_MICRO, N64
-	op->addr = addr;
-	if (len < 4) {
-		return -1;
-	}
-	op->size = 4;
 	if (hndl == 0) {
-		ret = cs_open (CS_ARCH_MIPS, mode, &hndl);
-		if (ret != CS_ERR_OK) {
-			goto fin;
+		if (cs_open (CS_ARCH_MIPS, mode, &hndl) != CS_ERR_OK) {
+			hndl = 0;
+			return false;
 		}
 		cs_option (hndl, CS_OPT_DETAIL, CS_OPT_ON);
 	}
-	n = cs_disasm (hndl, (ut8*)buf, len, addr, 1, &insn);
-	if (n < 1 || insn->size < 1) {
+	return true;
+}
+
+// insn is NULL when capstone could not decode anything
+static int anop_insn(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask, cs_insn *insn) {
+	int opsize = -1;
+	if (!insn || insn->size < 1) {
 		if (mask & R_ANAL_OP_MASK_DISASM) {
 			op->mnemonic = strdup ("invalid");
 		}
@@ -1076,12 +1075,52 @@ beach:
 	if (mask & R_ANAL_OP_MASK_VAL) {
 		op_fillval (anal, op, &hndl, insn);
 	}
+	return opsize;
+}
+
+static int analop(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
+	cs_insn* insn;
+	int n, opsize = -1;
+	op->addr = addr;
+	if (len < 4) {
+		return -1;
+	}
+	op->size = 4;
+	if (!cs_setup (anal)) {
+		goto fin;
+	}
+	n = cs_disasm (hndl, (ut8*)buf, len, addr, 1, &insn);
+	opsize = anop_insn (anal, op, addr, buf, len, mask, (n > 0)? insn: NULL);
 	cs_free (insn, n);
 	//cs_close (&handle);
 fin:
 	return opsize;
 }
 
+// one cs_disasm call for the whole run
+static int analop_batch(RAnal *anal, RAnalOp *ops, int count, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
+	cs_insn *insn = NULL;
+	int i, n;
+	if (!cs_setup (anal)) {
+		return 0;
+	}
+	n = cs_disasm (hndl, (ut8*)buf, len, addr, count, &insn);
+	for (i = 0; i < n && insn[i].size > 0; i++) {
+		const int at = insn[i].address - addr;
+		if (len - at < 4) {
+			// analop refuses to look at less than a word
+			break;
+		}
+		ops[i].addr = insn[i].address;
+		ops[i].size = 4;
+		anop_insn (anal, &ops[i], insn[i].address, buf + at, len - at, mask, &insn[i]);
+	}
+	if (insn) {
+		cs_free (insn, n);
+	}
+	return i;
+}
+
 static char *get_reg_profile(RAnal *anal) {
 	const char *p = NULL;
 	switch (anal->bits) {
@@ -1208,6 +1247,7 @@ RAnalPlugin r_anal_plugin_mips_cs = {
 	.preludes = anal_preludes,
 	.bits = 16|32|64,
 	.op = &analop,
+	.op_batch = &analop_batch,
 };
 
 #ifndef R2_PLUGIN_INCORE
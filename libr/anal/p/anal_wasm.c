@@ -42,7 +42,7 @@ static bool advance_till_scope_end(RAnal* anal, RAnalOp *op, ut64 address, ut32
 	ut8 *end = ptr + sizeof (buffer);
 	WasmOp wop = {{0}};
 	int size = 0;
-	while (anal->iob.read_at (anal->iob.io, address, buffer, sizeof (buffer))) {
+	while (anal->read_at && anal->read_at (anal, address, buffer, sizeof (buffer))) {
 		size = wasm_dis (&wop, ptr, end - ptr);
 		if (!wop.txt || (wop.type == WASM_TYPE_OP_CORE && wop.op.core == WASM_OP_TRAP)) {
 			// if invalid stop here.
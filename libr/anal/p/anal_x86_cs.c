@@ -3125,17 +3125,14 @@ static int cs_len_prefix_opcode(uint8_t *item) {
 	return len;
 }
 
-static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
-	static int omode = 0;
-#if USE_ITER_API
-	static
-#endif
-	cs_insn *insn = NULL;
-	int mode = (a->bits==64)? CS_MODE_64:
+static int cs_mode_bits(RAnal *a) {
+	return (a->bits==64)? CS_MODE_64:
 		(a->bits==32)? CS_MODE_32:
 		(a->bits==16)? CS_MODE_16: 0;
-	int n, ret;
+}
 
+static bool cs_setup(int mode) {
+	static int omode = 0;
 	if (handle && mode != omode) {
 		if (handle != 0) {
 			cs_close (&handle);
@@ -3144,14 +3141,79 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	}
 	omode = mode;
 	if (handle == 0) {
-		ret = cs_open (CS_ARCH_X86, mode, &handle);
+		int ret = cs_open (CS_ARCH_X86, mode, &handle);
 		if (ret != CS_ERR_OK) {
 			handle = 0;
-			return 0;
+			return false;
 		}
 	}
-	op->cycles = 1; // aprox
 	cs_option (handle, CS_OPT_DETAIL, CS_OPT_ON);
+	return true;
+}
+
+static void anop_insn(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask, int mode, cs_insn *insn) {
+	if (mask & R_ANAL_OP_MASK_DISASM) {
+		op->mnemonic = r_str_newf ("%s%s%s",
+			insn->mnemonic,
+			insn->op_str[0]?" ":"",
+			insn->op_str);
+	}
+	// int rs = a->bits / 8;
+	//const char *pc = (a->bits==16)?"ip": (a->bits==32)?"eip":"rip";
+	//const char *sp = (a->bits==16)?"sp": (a->bits==32)?"esp":"rsp";
+	//const char *bp = (a->bits==16)?"bp": (a->bits==32)?"ebp":"rbp";
+	op->nopcode = cs_len_prefix_opcode (insn->detail->x86.prefix)
+		+ cs_len_prefix_opcode (insn->detail->x86.opcode);
+	op->size = insn->size;
+	op->id = insn->id;
+	op->family = R_ANAL_OP_FAMILY_CPU; // almost everything is CPU
+	op->prefix = 0;
+	op->cond = cond_x862r2 (insn->id);
+	switch (insn->detail->x86.prefix[0]) {
+	case X86_PREFIX_REPNE:
+		op->prefix |= R_ANAL_OP_PREFIX_REPNE;
+		break;
+	case X86_PREFIX_REP:
+		op->prefix |= R_ANAL_OP_PREFIX_REP;
+		break;
+	case X86_PREFIX_LOCK:
+		op->prefix |= R_ANAL_OP_PREFIX_LOCK;
+		op->family = R_ANAL_OP_FAMILY_THREAD; // XXX ?
+		break;
+	}
+	anop (a, op, addr, buf, len, &handle, insn);
+	set_opdir (op, insn);
+	if (mask & R_ANAL_OP_MASK_ESIL) {
+		anop_esil (a, op, addr, buf, len, &handle, insn);
+	}
+	if (mask & R_ANAL_OP_MASK_OPEX) {
+		opex (&op->opex, insn, mode);
+	}
+	if (mask & R_ANAL_OP_MASK_VAL) {
+		op_fillval (a, op, &handle, insn, mode);
+	}
+}
+
+static void anop_group(RAnalOp *op, cs_insn *insn) {
+#if HAVE_CSGRP_PRIVILEGE
+	if (cs_insn_group (handle, insn, X86_GRP_PRIVILEGE)) {
+		op->family = R_ANAL_OP_FAMILY_PRIV;
+	}
+#endif
+}
+
+static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
+#if USE_ITER_API
+	static
+#endif
+	cs_insn *insn = NULL;
+	int mode = cs_mode_bits (a);
+	int n;
+
+	if (!cs_setup (mode)) {
+		return 0;
+	}
+	op->cycles = 1; // aprox
 	// capstone-next
 #if USE_ITER_API
 	{
@@ -3172,54 +3234,11 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 			op->mnemonic = strdup ("invalid");
 		}
 	} else {
-		if (mask & R_ANAL_OP_MASK_DISASM) {
-			op->mnemonic = r_str_newf ("%s%s%s",
-				insn->mnemonic,
-				insn->op_str[0]?" ":"",
-				insn->op_str);
-		}
-		// int rs = a->bits / 8;
-		//const char *pc = (a->bits==16)?"ip": (a->bits==32)?"eip":"rip";
-		//const char *sp = (a->bits==16)?"sp": (a->bits==32)?"esp":"rsp";
-		//const char *bp = (a->bits==16)?"bp": (a->bits==32)?"ebp":"rbp";
-		op->nopcode = cs_len_prefix_opcode (insn->detail->x86.prefix)
-			+ cs_len_prefix_opcode (insn->detail->x86.opcode);
-		op->size = insn->size;
-		op->id = insn->id;
-		op->family = R_ANAL_OP_FAMILY_CPU; // almost everything is CPU
-		op->prefix = 0;
-		op->cond = cond_x862r2 (insn->id);
-		switch (insn->detail->x86.prefix[0]) {
-		case X86_PREFIX_REPNE:
-			op->prefix |= R_ANAL_OP_PREFIX_REPNE;
-			break;
-		case X86_PREFIX_REP:
-			op->prefix |= R_ANAL_OP_PREFIX_REP;
-			break;
-		case X86_PREFIX_LOCK:
-			op->prefix |= R_ANAL_OP_PREFIX_LOCK;
-			op->family = R_ANAL_OP_FAMILY_THREAD; // XXX ?
-			break;
-		}
-		anop (a, op, addr, buf, len, &handle, insn);
-		set_opdir (op, insn);
-		if (mask & R_ANAL_OP_MASK_ESIL) {
-			anop_esil (a, op, addr, buf, len, &handle, insn);
-		}
-		if (mask & R_ANAL_OP_MASK_OPEX) {
-			opex (&op->opex, insn, mode);
-		}
-		if (mask & R_ANAL_OP_MASK_VAL) {
-			op_fillval (a, op, &handle, insn, mode);
-		}
+		anop_insn (a, op, addr, buf, len, mask, mode, insn);
 	}
 //#if X86_GRP_PRIVILEGE>0
 	if (insn) {
-#if HAVE_CSGRP_PRIVILEGE
-		if (cs_insn_group (handle, insn, X86_GRP_PRIVILEGE)) {
-			op->family = R_ANAL_OP_FAMILY_PRIV;
-		}
-#endif
+		anop_group (op, insn);
 #if !USE_ITER_API
 		cs_free (insn, n);
 #endif
@@ -3228,6 +3247,27 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	return op->size;
 }
 
+// the whole run comes from a single cs_disasm call
+static int analop_batch(RAnal *a, RAnalOp *ops, int count, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
+	cs_insn *insn = NULL;
+	int mode = cs_mode_bits (a);
+	int i, n;
+	if (!cs_setup (mode)) {
+		return 0;
+	}
+	n = cs_disasm (handle, (const ut8*)buf, len, addr, count, &insn);
+	for (i = 0; i < n; i++) {
+		const int at = insn[i].address - addr;
+		ops[i].cycles = 1; // aprox
+		anop_insn (a, &ops[i], insn[i].address, buf + at, len - at, mask, mode, &insn[i]);
+		anop_group (&ops[i], &insn[i]);
+	}
+	if (insn) {
+		cs_free (insn, n);
+	}
+	return R_MAX (n, 0);
+}
+
 #if 0
 static int x86_int_0x80(RAnalEsil *esil, int interrupt) {
 	int syscall;
@@ -3739,6 +3779,7 @@ RAnalPlugin r_anal_plugin_x86_cs = {
 	.arch = "x86",
 	.bits = 16|32|64,
 	.op = &analop,
+	.op_batch = &analop_batch,
 	.preludes = anal_preludes,
 	.archinfo = archinfo,
 	.get_reg_profile = &get_reg_profile,
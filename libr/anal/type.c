@@ -140,7 +140,7 @@ R_API RList *r_anal_types_from_fcn(RAnal *anal, RAnalFunction *fcn) {
 	RList *list = r_anal_var_all_list (anal, fcn);
 	RList *type_used = r_list_new ();
 	r_list_foreach (list, iter, var) {
-		r_list_append (type_used, var->type);
+		r_list_append (type_used, (void *)var->type);
 	}
 	RList *uniq = r_list_uniq (type_used, typecmp);
 	r_list_free (type_used);
@@ -178,14 +178,14 @@ static RAnalBaseType *get_enum_type(RAnal *anal, const char *sname) {
 
 	RAnalBaseTypeEnum base_enum;
 
+	RVector cases;
+	r_vector_init (&cases, sizeof (RAnalEnumCase), enum_type_case_free, NULL);
+
 	char *members = get_type_data (anal->sdb_types, "enum", sname);
 	if (!members) {
 		goto error;
 	}
 
-	RVector cases;
-	r_vector_init (&cases, sizeof (RAnalEnumCase), enum_type_case_free, NULL);
-
 	if (!r_vector_reserve (&cases, (size_t)sdb_alen (members))) {
 		goto error;
 	}
@@ -236,14 +236,14 @@ static RAnalBaseType *get_struct_type(RAnal *anal, const char *sname) {
 
 	RAnalBaseTypeStruct base_struct;
 
+	RVector members;
+	r_vector_init (&members, sizeof (RAnalStructMember), struct_type_member_free, NULL);
+
 	char *sdb_members = get_type_data (anal->sdb_types, "struct", sname);
 	if (!sdb_members) {
 		goto error;
 	}
 
-	RVector members;
-	r_vector_init (&members, sizeof (RAnalStructMember), struct_type_member_free, NULL);
-
 	if (!r_vector_reserve (&members, (size_t)sdb_alen (sdb_members))) {
 		goto error;
 	}
@@ -306,14 +306,14 @@ static RAnalBaseType *get_union_type(RAnal *anal, const char *sname) {
 
 	RAnalBaseTypeUnion base_union;
 
+	RVector members;
+	r_vector_init (&members, sizeof (RAnalUnionMember), union_type_member_free, NULL);
+
 	char *sdb_members = get_type_data (anal->sdb_types, "union", sname);
 	if (!sdb_members) {
 		goto error;
 	}
 
-	RVector members;
-	r_vector_init (&members, sizeof (RAnalUnionMember), union_type_member_free, NULL);
-
 	if (!r_vector_reserve (&members, (size_t)sdb_alen (sdb_members))) {
 		goto error;
 	}
@@ -354,36 +354,352 @@ error:
 	return NULL;
 }
 
-// returns NULL if name is not found or any failure happened
-R_API RAnalBaseType *r_anal_get_base_type(RAnal *anal, const char *name) {
-	r_return_val_if_fail (anal && name, NULL);
-
-	char *sname = r_str_sanitize_sdb_key (name);
-	const char *type = sdb_const_get (anal->sdb_types, sname, NULL);
-
+static RAnalBaseType *compile_base_type(RAnal *anal, const char *sname, const char *kind) {
 	// Right now just types: struct, enum, union are supported
-	if (!type || !(strcmp (type, "enum") || strcmp (type, "struct") || strcmp (type, "union"))) {
-		free (sname);
-		return NULL;
-	}
-	// Taking advantage that all 3 types start with distinct letter
-	// because the strcmp condition guarantees that only those will get to this flow
 	RAnalBaseType *base_type = NULL;
-
-	switch (type[0]) {
-	case 's': // struct
+	switch (kind[0]) {
+	case 's':
 		base_type = get_struct_type (anal, sname);
 		break;
-	case 'e': // enum
+	case 'e':
 		base_type = get_enum_type (anal, sname);
 		break;
-	case 'u': // union
+	case 'u':
 		base_type = get_union_type (anal, sname);
 		break;
 	}
+	if (base_type) {
+		base_type->name = strdup (sname);
+		char *key = r_str_newf ("%s.%s.!size", kind, sname);
+		base_type->size = sdb_num_get (anal->sdb_types, key, NULL);
+		free (key);
+	}
+	return base_type;
+}
+
+/*
+ * Lookups in sdb_types are cached, sdb_types stays the only source of
+ * truth and the sdb hook below drops what a written key may change.
+ *
+ * Compiled base types are cached by their sanitized name: every key
+ * written drops the entry of the type it belongs to, so the next lookup
+ * parses it again. Misses are cached too, they are the common case when
+ * resolving arbitrary names.
+ *
+ * The results of r_type_get_bitsize () and r_type_get_struct_memb (),
+ * which disasm, "ts", "aht" and the variable naming use, are kept as they
+ * are. They depend on the member types too, so any write drops all of
+ * them. sdb_reset () bypasses the hooks, it is noticed by the number of
+ * keys changing without a write.
+ */
+typedef struct {
+	RAnalBaseType *type; // NULL if the name is not a valid struct, enum or union
+	const char *kind; // "name=kind" the entry was compiled from
+	HtPP *members; // member name -> RAnalStructMember/RAnalUnionMember, built on demand
+} TypeCacheEntry;
+
+static void type_cache_kv_free(HtPPKv *kv) {
+	free (kv->key);
+	TypeCacheEntry *e = kv->value;
+	if (e) {
+		if (e->type) {
+			r_anal_free_base_type (e->type);
+		}
+		ht_pp_free (e->members);
+		free (e);
+	}
+}
+
+static void type_membs_kv_free(HtPPKv *kv) {
+	free (kv->key);
+	free (kv->value);
+}
+
+static void type_results_reset(RAnalTypeCache *cache, ut32 count) {
+	if (cache->bitsizes->count) {
+		ht_pp_free (cache->bitsizes);
+		cache->bitsizes = ht_pp_new0 ();
+	}
+	if (cache->membs->count) {
+		ht_pp_free (cache->membs);
+		cache->membs = ht_pp_new (NULL, type_membs_kv_free, NULL);
+	}
+	cache->count = count;
+}
+
+// sdb_types keys look like "name", "kind.name" or "kind.name.field"
+static void type_cache_hook(Sdb *s, void *user, const char *k, const char *v) {
+	RAnalTypeCache *cache = &((RAnal *)user)->type_cache;
+	if (!cache->types) {
+		return;
+	}
+	type_results_reset (cache, s->ht->count);
+	if (!cache->types->count) {
+		return;
+	}
+	ht_pp_delete (cache->types, k);
+	const char *name = strchr (k, '.');
+	if (name) {
+		name++;
+		const char *end = strchr (name, '.');
+		char *sname = end? r_str_ndup (name, end - name): strdup (name);
+		if (sname) {
+			ht_pp_delete (cache->types, sname);
+			free (sname);
+		}
+	}
+}
+
+R_IPI void r_anal_type_cache_init(RAnal *anal) {
+	RAnalTypeCache *cache = &anal->type_cache;
+	cache->types = ht_pp_new (NULL, type_cache_kv_free, NULL);
+	cache->bitsizes = ht_pp_new0 ();
+	cache->membs = ht_pp_new (NULL, type_membs_kv_free, NULL);
+	cache->count = anal->sdb_types->ht->count;
+	sdb_hook (anal->sdb_types, type_cache_hook, anal);
+}
+
+R_IPI void r_anal_type_cache_fini(RAnal *anal) {
+	RAnalTypeCache *cache = &anal->type_cache;
+	ht_pp_free (cache->types);
+	ht_pp_free (cache->bitsizes);
+	ht_pp_free (cache->membs);
+	memset (cache, 0, sizeof (*cache));
+}
+
+static RAnalTypeCache *type_results(RAnal *anal) {
+	RAnalTypeCache *cache = &anal->type_cache;
+	if (!cache->types) {
+		return NULL;
+	}
+	if (cache->count != anal->sdb_types->ht->count) {
+		type_results_reset (cache, anal->sdb_types->ht->count);
+	}
+	return cache;
+}
+
+/**
+ * @brief Cached r_type_get_bitsize () of the types database
+ */
+R_API ut64 r_anal_type_get_bitsize(RAnal *anal, const char *type) {
+	r_return_val_if_fail (anal && type, 0);
+	RAnalTypeCache *cache = type_results (anal);
+	if (!cache) {
+		return r_type_get_bitsize (anal->sdb_types, type);
+	}
+	bool found = false;
+	void *bits = ht_pp_find (cache->bitsizes, type, &found);
+	if (!found) {
+		bits = (void *)(size_t)r_type_get_bitsize (anal->sdb_types, type);
+		ht_pp_insert (cache->bitsizes, type, bits);
+	}
+	return (ut64)(size_t)bits;
+}
+
+/**
+ * @brief Cached r_type_get_struct_memb () of the types database
+ *
+ * @return "type.member" at offset bytes into the struct type, to be freed
+ */
+R_API char *r_anal_type_get_struct_memb(RAnal *anal, const char *type, int offset) {
+	r_return_val_if_fail (anal && type, NULL);
+	RAnalTypeCache *cache = type_results (anal);
+	if (!cache || offset < 0) {
+		return r_type_get_struct_memb (anal->sdb_types, type, offset);
+	}
+	char *key = r_str_newf ("%d:%s", offset, type);
+	if (!key) {
+		return NULL;
+	}
+	bool found = false;
+	char *res = ht_pp_find (cache->membs, key, &found);
+	if (!found) {
+		res = r_type_get_struct_memb (anal->sdb_types, type, offset);
+		ht_pp_insert (cache->membs, key, res);
+	}
+	free (key);
+	return res? strdup (res): NULL;
+}
+
+/**
+ * @brief r_type_get_by_offset () with the member lookups cached
+ *
+ * @return list of "type.member" at offset bytes into every struct
+ */
+R_API RList *r_anal_type_get_by_offset(RAnal *anal, ut64 offset) {
+	r_return_val_if_fail (anal, NULL);
+	RList *offtypes = r_list_newf (free);
+	SdbList *ls = sdb_foreach_list (anal->sdb_types, true);
+	SdbListIter *lsi;
+	SdbKv *kv;
+	ls_foreach (ls, lsi, kv) {
+		// TODO: Add unions support
+		if (!strncmp (sdbkv_value (kv), "struct", 6) && strncmp (sdbkv_key (kv), "struct.", 7)) {
+			char *res = r_anal_type_get_struct_memb (anal, sdbkv_key (kv), offset);
+			if (res) {
+				r_list_append (offtypes, res);
+			}
+		}
+	}
+	ls_free (ls);
+	return offtypes;
+}
 
+static const char *cached_kind(const char *kind) {
+	if (kind) {
+		if (!strcmp (kind, "struct")) {
+			return "struct";
+		}
+		if (!strcmp (kind, "enum")) {
+			return "enum";
+		}
+		if (!strcmp (kind, "union")) {
+			return "union";
+		}
+	}
+	return NULL;
+}
+
+static TypeCacheEntry *type_cache_get(RAnal *anal, const char *name) {
+	HtPP *types = anal->type_cache.types;
+	if (!types) {
+		return NULL;
+	}
+	char *sname = r_str_sanitize_sdb_key (name);
+	if (!sname) {
+		return NULL;
+	}
+	// sdb_reset () empties the table without calling the hooks, so make
+	// sure the kind the entry was compiled from is still there
+	const char *kind = cached_kind (sdb_const_get (anal->sdb_types, sname, NULL));
+	bool found = false;
+	TypeCacheEntry *e = ht_pp_find (types, sname, &found);
+	if (found && e && e->kind != kind) {
+		ht_pp_delete (types, sname);
+		found = false;
+	}
+	if (!found) {
+		e = R_NEW0 (TypeCacheEntry);
+		if (e) {
+			e->kind = kind;
+			e->type = kind? compile_base_type (anal, sname, kind): NULL;
+			ht_pp_insert (types, sname, e);
+		}
+	}
 	free (sname);
-	return base_type;
+	return e;
+}
+
+/**
+ * @brief Looks up a struct, enum or union in the types database
+ *
+ * The returned type is owned by the cache and stays valid until
+ * sdb_types is modified, use r_anal_get_base_type () to keep a copy.
+ */
+R_API const RAnalBaseType *r_anal_base_type_get(RAnal *anal, const char *name) {
+	r_return_val_if_fail (anal && name, NULL);
+	TypeCacheEntry *e = type_cache_get (anal, name);
+	return e? e->type: NULL;
+}
+
+/**
+ * @brief Resolves the offset in bytes of a member of a struct or union
+ *
+ * @return false if the type or the member do not exist
+ */
+R_API bool r_anal_base_type_member_offset(RAnal *anal, const char *type, const char *member, ut64 *offset) {
+	r_return_val_if_fail (anal && type && member, false);
+	TypeCacheEntry *e = type_cache_get (anal, type);
+	if (!e || !e->type) {
+		return false;
+	}
+	RAnalBaseType *t = e->type;
+	if (t->kind != R_ANAL_BASE_TYPE_KIND_STRUCT && t->kind != R_ANAL_BASE_TYPE_KIND_UNION) {
+		return false;
+	}
+	if (!e->members) {
+		e->members = ht_pp_new0 ();
+		if (!e->members) {
+			return false;
+		}
+		if (t->kind == R_ANAL_BASE_TYPE_KIND_STRUCT) {
+			RAnalStructMember *m;
+			r_vector_foreach (&t->struct_data.members, m) {
+				ht_pp_insert (e->members, m->name, m);
+			}
+		} else {
+			RAnalUnionMember *m;
+			r_vector_foreach (&t->union_data.members, m) {
+				ht_pp_insert (e->members, m->name, m);
+			}
+		}
+	}
+	void *m = ht_pp_find (e->members, member, NULL);
+	if (!m) {
+		return false;
+	}
+	if (offset) {
+		*offset = t->kind == R_ANAL_BASE_TYPE_KIND_STRUCT
+			? ((RAnalStructMember *)m)->offset
+			: ((RAnalUnionMember *)m)->offset;
+	}
+	return true;
+}
+
+static RAnalBaseType *base_type_clone(const RAnalBaseType *type) {
+	RAnalBaseType *copy = r_anal_new_base_type (type->kind);
+	if (!copy) {
+		return NULL;
+	}
+	copy->name = type->name? strdup (type->name): NULL;
+	copy->type = type->type? strdup (type->type): NULL;
+	copy->size = type->size;
+	switch (type->kind) {
+	case R_ANAL_BASE_TYPE_KIND_STRUCT: {
+		RAnalStructMember *m;
+		r_vector_init (&copy->struct_data.members, sizeof (RAnalStructMember), struct_type_member_free, NULL);
+		r_vector_reserve (&copy->struct_data.members, type->struct_data.members.len);
+		r_vector_foreach (&type->struct_data.members, m) {
+			RAnalStructMember c = *m;
+			c.name = strdup (m->name);
+			c.type = strdup (m->type);
+			r_vector_push (&copy->struct_data.members, &c);
+		}
+		break;
+	}
+	case R_ANAL_BASE_TYPE_KIND_UNION: {
+		RAnalUnionMember *m;
+		r_vector_init (&copy->union_data.members, sizeof (RAnalUnionMember), union_type_member_free, NULL);
+		r_vector_reserve (&copy->union_data.members, type->union_data.members.len);
+		r_vector_foreach (&type->union_data.members, m) {
+			RAnalUnionMember c = *m;
+			c.name = strdup (m->name);
+			c.type = strdup (m->type);
+			r_vector_push (&copy->union_data.members, &c);
+		}
+		break;
+	}
+	case R_ANAL_BASE_TYPE_KIND_ENUM: {
+		RAnalEnumCase *c;
+		r_vector_init (&copy->enum_data.cases, sizeof (RAnalEnumCase), enum_type_case_free, NULL);
+		r_vector_reserve (&copy->enum_data.cases, type->enum_data.cases.len);
+		r_vector_foreach (&type->enum_data.cases, c) {
+			RAnalEnumCase cas = { .name = strdup (c->name), .val = c->val };
+			r_vector_push (&copy->enum_data.cases, &cas);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+	return copy;
+}
+
+// returns NULL if name is not found or any failure happened
+R_API RAnalBaseType *r_anal_get_base_type(RAnal *anal, const char *name) {
+	r_return_val_if_fail (anal && name, NULL);
+	const RAnalBaseType *type = r_anal_base_type_get (anal, name);
+	return type? base_type_clone (type): NULL;
 }
 
 static void save_struct(const RAnal *anal, const RAnalBaseType *type) {
@@ -646,7 +962,10 @@ R_API RAnalBaseType *r_anal_new_base_type(RAnalBaseTypeKind kind) {
 
 /**
  * @brief Saves RAnalBaseType into the SDB
- * 
+ *
+ * The sdb hook drops any compiled copy of the type, so lookups see
+ * the new definition.
+ *
  * @param anal 
  * @param type RAnalBaseType to save
  * @param name Name of the type
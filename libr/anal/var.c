@@ -158,14 +158,16 @@ R_API RAnalVar *r_anal_function_set_var(RAnalFunction *fcn, int delta, char kind
 		r_pvector_push (&fcn->vars, var);
 		var->fcn = fcn;
 		r_vector_init (&var->accesses, sizeof (RAnalVarAccess), NULL, NULL);
-	} else {
-		free (var->name);
-		free (var->regname);
-		free (var->type);
 	}
-	var->name = strdup (name);
-	var->regname = reg ? strdup (reg->name) : NULL; // TODO: no strdup here? pool? or not keep regname at all?
-	var->type = strdup (type);
+	// names and types repeat in every function, keep a single copy of them
+	RStrConstPool *pool = &fcn->anal->constpool;
+	const char *oname = var->name, *oregname = var->regname, *otype = var->type;
+	var->name = (char *)r_str_constpool_ref (pool, name);
+	var->regname = reg ? (char *)r_str_constpool_ref (pool, reg->name) : NULL;
+	var->type = (char *)r_str_constpool_ref (pool, type);
+	r_str_constpool_unref (pool, oname);
+	r_str_constpool_unref (pool, oregname);
+	r_str_constpool_unref (pool, otype);
 	var->kind = kind;
 	var->isarg = isarg;
 	var->delta = delta;
@@ -174,11 +176,12 @@ R_API RAnalVar *r_anal_function_set_var(RAnalFunction *fcn, int delta, char kind
 }
 
 R_API void r_anal_var_set_type(RAnalVar *var, const char *type) {
-	char *nt = strdup (type);
+	RStrConstPool *pool = &var->fcn->anal->constpool;
+	char *nt = (char *)r_str_constpool_ref (pool, type);
 	if (!nt) {
 		return;
 	}
-	free (var->type);
+	r_str_constpool_unref (pool, var->type);
 	var->type = nt;
 	shadow_var_struct_members (var);
 }
@@ -188,9 +191,10 @@ static void var_free(RAnalVar *var) {
 		return;
 	}
 	r_anal_var_clear_accesses (var);
-	free (var->name);
-	free (var->regname);
-	free (var->type);
+	RStrConstPool *pool = &var->fcn->anal->constpool;
+	r_str_constpool_unref (pool, var->name);
+	r_str_constpool_unref (pool, var->regname);
+	r_str_constpool_unref (pool, var->type);
 	free (var->comment);
 	free (var);
 }
@@ -344,11 +348,12 @@ R_API bool r_anal_var_rename(RAnalVar *var, const char *new_name, bool verbose)
 		}
 		return false;
 	}
-	char *nn = strdup (new_name);
+	RStrConstPool *pool = &var->fcn->anal->constpool;
+	char *nn = (char *)r_str_constpool_ref (pool, new_name);
 	if (!nn) {
 		return false;
 	}
-	free (var->name);
+	r_str_constpool_unref (pool, var->name);
 	var->name = nn;
 	return true;
 }
@@ -701,7 +706,7 @@ static void extract_arg(RAnal *anal, RAnalFunction *fcn, RAnalOp *op, const char
 						varname = strdup (r_type_func_args_name (anal->sdb_types, fname, i));
 						break;
 					}
-					ut64 bit_sz = r_type_get_bitsize (anal->sdb_types, tp);
+					ut64 bit_sz = r_anal_type_get_bitsize (anal, tp);
 					sum_sz += bit_sz ? bit_sz / 8 : bytes;
 					sum_sz = R_ROUND (sum_sz, bytes);
 					free (tp);
@@ -46,10 +46,6 @@ static void xrefs_ht_free(HtUPKv *kv) {
 	ht_up_free (kv->value);
 }
 
-static void xrefs_ref_free(HtUPKv *kv) {
-	r_anal_ref_free (kv->value);
-}
-
 static bool appendRef(void *u, const ut64 k, const void *v) {
 	RList *list = (RList *)u;
 	RAnalRef *ref = (RAnalRef *)v;
@@ -101,19 +97,74 @@ static void listxrefs(HtUP *m, ut64 addr, RList *list) {
 	}
 }
 
-static void setxref(HtUP *m, ut64 from, ut64 to, int type) {
+// RMemoryPool is not thread safe, ref_lock is only there while concurrent
+static RAnalRef *ref_alloc(RAnal *anal) {
+	if (!anal->ref_lock) {
+		return r_mem_pool_alloc (anal->ref_pool);
+	}
+	r_th_lock_enter (anal->ref_lock);
+	RAnalRef *ref = r_mem_pool_alloc (anal->ref_pool);
+	r_th_lock_leave (anal->ref_lock);
+	return ref;
+}
+
+static void ref_release(RAnal *anal, RAnalRef *ref) {
+	if (!anal->ref_lock) {
+		r_mem_pool_release (anal->ref_pool, ref);
+		return;
+	}
+	r_th_lock_enter (anal->ref_lock);
+	r_mem_pool_release (anal->ref_pool, ref);
+	r_th_lock_leave (anal->ref_lock);
+}
+
+// the refs stored in the dicts are owned by anal->ref_pool, not by their ht
+static void setxref(RAnal *anal, HtUP *m, ut64 from, ut64 to, int type) {
 	bool found;
 	HtUP *ht = ht_up_find (m, from, &found);
 	if (!found) {
-		ht = ht_up_new (NULL, xrefs_ref_free, NULL);
+		ht = ht_up_new0 ();
 		if (!ht) {
 			return;
 		}
-		ht_up_insert (m, from, ht);
+		if (anal->concurrent) {
+			ht_up_set_concurrent (ht, true);
+		}
+		if (!ht_up_insert (m, from, ht)) {
+			// another thread added it meanwhile
+			ht_up_free (ht);
+			ht = ht_up_find (m, from, NULL);
+		}
 	}
-	RAnalRef *ref = r_anal_ref_new (to, from, type);
-	if (ref) {
-		ht_up_update (ht, to, ref);
+	RAnalRef *ref = ht_up_find (ht, to, NULL);
+	if (!ref) {
+		ref = ref_alloc (anal);
+		if (!ref) {
+			return;
+		}
+		if (!ht_up_insert (ht, to, ref)) {
+			ref_release (anal, ref);
+			ref = ht_up_find (ht, to, NULL);
+		}
+	}
+	ref->addr = to;
+	ref->at = from;
+	ref->type = (type == -1)? R_ANAL_REF_TYPE_CODE: type;
+}
+
+static bool release_ref_cb(void *user, const ut64 k, const void *v) {
+	RAnal *anal = user;
+	ref_release (anal, (RAnalRef *)v);
+	return true;
+}
+
+// the refs and the dict of FROM are freed right away, so this must not
+// run while other threads look at the xrefs of the same addresses
+static void delxrefs(RAnal *anal, HtUP *m, ut64 from) {
+	HtUP *ht = ht_up_find (m, from, NULL);
+	if (ht) {
+		ht_up_foreach (ht, release_ref_cb, anal);
+		ht_up_delete (m, from);
 	}
 }
 
@@ -130,8 +181,8 @@ R_API int r_anal_xrefs_set(RAnal *anal, ut64 from, ut64 to, const RAnalRefType t
 			return false;
 		}
 	}
-	setxref (anal->dict_xrefs, to, from, type);
-	setxref (anal->dict_refs, from, to, type);
+	setxref (anal, anal->dict_xrefs, to, from, type);
+	setxref (anal, anal->dict_refs, from, to, type);
 	return true;
 }
 
@@ -139,8 +190,8 @@ R_API int r_anal_xrefs_deln(RAnal *anal, ut64 from, ut64 to, const RAnalRefType
 	if (!anal) {
 		return false;
 	}
-	ht_up_delete (anal->dict_refs, from);
-	ht_up_delete (anal->dict_xrefs, to);
+	delxrefs (anal, anal->dict_refs, from);
+	delxrefs (anal, anal->dict_xrefs, to);
 	return true;
 }
 
@@ -154,6 +205,33 @@ R_API int r_anal_xref_del(RAnal *anal, ut64 from, ut64 to) {
 	return res;
 }
 
+static bool del_xref_cb(void *user, const ut64 to, const void *v) {
+	RAnal *anal = user;
+	const RAnalRef *ref = v;
+	HtUP *ht = ht_up_find (anal->dict_xrefs, to, NULL);
+	if (ht) {
+		RAnalRef *xref = ht_up_find (ht, ref->at, NULL);
+		if (xref) {
+			ht_up_delete (ht, ref->at);
+			ref_release (anal, xref);
+		}
+		if (!ht->count) {
+			ht_up_delete (anal->dict_xrefs, to);
+		}
+	}
+	return true;
+}
+
+// remove the references made from an address, other xrefs to their targets stay
+R_API void r_anal_refs_del(RAnal *anal, ut64 from) {
+	r_return_if_fail (anal);
+	HtUP *ht = ht_up_find (anal->dict_refs, from, NULL);
+	if (ht) {
+		ht_up_foreach (ht, del_xref_cb, anal);
+		delxrefs (anal, anal->dict_refs, from);
+	}
+}
+
 R_API int r_anal_xrefs_from(RAnal *anal, RList *list, const char *kind, const RAnalRefType type, ut64 addr) {
 	listxrefs (anal->dict_refs, addr, list);
 	sortxrefs (list);
@@ -313,6 +391,7 @@ R_API bool r_anal_xrefs_init(RAnal *anal) {
 	anal->dict_refs = NULL;
 	ht_up_free (anal->dict_xrefs);
 	anal->dict_xrefs = NULL;
+	r_mem_pool_deinit (anal->ref_pool);
 
 	HtUP *tmp = ht_up_new (NULL, xrefs_ht_free, NULL);
 	if (!tmp) {
@@ -327,9 +406,26 @@ R_API bool r_anal_xrefs_init(RAnal *anal) {
 		return false;
 	}
 	anal->dict_xrefs = tmp;
+	if (anal->concurrent) {
+		ht_up_set_concurrent (anal->dict_refs, true);
+		ht_up_set_concurrent (anal->dict_xrefs, true);
+	}
 	return true;
 }
 
+static bool set_concurrent_cb(void *user, const ut64 k, const void *v) {
+	ht_up_set_concurrent ((HtUP *)v, *(bool *)user);
+	return true;
+}
+
+// used in anal.c, but no API needed
+bool r_anal_xrefs_set_concurrent(RAnal *anal, bool enable) {
+	ht_up_foreach (anal->dict_refs, set_concurrent_cb, &enable);
+	ht_up_foreach (anal->dict_xrefs, set_concurrent_cb, &enable);
+	return ht_up_set_concurrent (anal->dict_refs, enable)
+		&& ht_up_set_concurrent (anal->dict_xrefs, enable);
+}
+
 static bool count_cb(void *user, const ut64 k, const void *v) {
 	(*(ut64 *)user) += ((HtUP *)v)->count;
 	return true;
@@ -412,38 +412,14 @@ static bool __isInvalid (RAsmOp *op) {
 	return (buf_asm && *buf_asm && !strcmp (buf_asm, "invalid"));
 }
 
-R_API int r_asm_disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
+static void op_reset(RAsmOp *op) {
 	r_asm_op_init (op);
-	r_return_val_if_fail (a && buf && op, -1);
-	if (len < 1) {
-		return 0;
-	}
-
-	int ret = op->payload = 0;
 	op->size = 4;
-	op->bitsize = 0;
 	r_asm_op_set_asm (op, "");
-	if (a->pcalign) {
-		const int mod = a->pc % a->pcalign;
-		if (mod) {
-			op->size = a->pcalign - mod;
-			r_strbuf_set (&op->buf_asm, "unaligned");
-			return -1;
-		}
-	}
-	if (a->cur && a->cur->disassemble) {
-		// shift buf N bits
-		if (a->bitshift > 0) {
-			ut8 *tmp = calloc (len, 1);
-			if (tmp) {
-				r_mem_copybits_delta (tmp, 0, buf, a->bitshift, (len * 8) - a->bitshift);
-				ret = a->cur->disassemble (a, op, tmp, len);
-				free (tmp);
-			}
-		} else {
-			ret = a->cur->disassemble (a, op, buf, len);
-		}
-	}
+}
+
+// common fixups of what the plugin decoded from buf
+static int op_finish(RAsm *a, RAsmOp *op, const ut8 *buf, int len, int ret) {
 	if (ret < 0) {
 		ret = 0;
 	}
@@ -479,6 +455,79 @@ R_API int r_asm_disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	return ret;
 }
 
+R_API int r_asm_disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
+	r_asm_op_init (op);
+	r_return_val_if_fail (a && buf && op, -1);
+	if (len < 1) {
+		return 0;
+	}
+
+	int ret = 0;
+	op_reset (op);
+	if (a->pcalign) {
+		const int mod = a->pc % a->pcalign;
+		if (mod) {
+			op->size = a->pcalign - mod;
+			r_strbuf_set (&op->buf_asm, "unaligned");
+			return -1;
+		}
+	}
+	if (a->cur && a->cur->disassemble) {
+		// shift buf N bits
+		if (a->bitshift > 0) {
+			ut8 *tmp = calloc (len, 1);
+			if (tmp) {
+				r_mem_copybits_delta (tmp, 0, buf, a->bitshift, (len * 8) - a->bitshift);
+				ret = a->cur->disassemble (a, op, tmp, len);
+				free (tmp);
+			}
+		} else {
+			ret = a->cur->disassemble (a, op, buf, len);
+		}
+	}
+	return op_finish (a, op, buf, len, ret);
+}
+
+/* Decodes up to n consecutive instructions of buf starting at a->pc,
+ * which is left untouched. Plugins implementing disassemble_batch get
+ * the whole run in one call, otherwise this is the same as calling
+ * r_asm_disassemble for every instruction. Bytes that do not decode
+ * take one op too, so it only stops early when buf runs out. Returns
+ * the number of ops filled, the caller must r_asm_op_fini all of them. */
+R_API int r_asm_disassemble_batch(RAsm *a, RAsmOp *ops, int n, const ut8 *buf, int len) {
+	r_return_val_if_fail (a && ops && buf, -1);
+	const ut64 pc = a->pc;
+	// bit-shifted and aligned decoding depend on the previous instruction
+	const bool batch = a->cur && a->cur->disassemble_batch && !a->bitshift && !a->pcalign;
+	int i = 0, off = 0;
+	while (i < n && off < len) {
+		int j, count = 0;
+		a->pc = pc + off;
+		if (batch) {
+			for (j = i; j < n; j++) {
+				op_reset (&ops[j]);
+			}
+			count = a->cur->disassemble_batch (a, ops + i, n - i, buf + off, len - off);
+			for (j = i; j < i + count; j++) {
+				op_finish (a, &ops[j], buf + off, len - off, ops[j].size);
+				off += R_MAX (ops[j].size, 1);
+			}
+			for (j = i + count; j < n; j++) {
+				r_asm_op_fini (&ops[j]);
+			}
+		}
+		if (count < 1) {
+			// the plugin stops at what it can not decode in bulk
+			r_asm_disassemble (a, &ops[i], buf + off, len - off);
+			off += R_MAX (ops[i].size, 1);
+			count = 1;
+		}
+		i += count;
+	}
+	a->pc = pc;
+	return i;
+}
+
 typedef int (*Ase)(RAsm *a, RAsmOp *op, const char *buf);
 
 static bool assemblerMatches(RAsm *a, RAsmPlugin *h) {
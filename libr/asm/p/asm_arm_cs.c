@@ -8,10 +8,14 @@
 
 bool arm64ass(const char *str, ut64 addr, ut32 *op);
 static csh cd = 0;
+// the batch path keeps its own handle open across calls
+static csh bcd = 0;
+static int bmode = -1;
+static int bbits = 0;
 
 #include "cs_mnemonics.c"
 
-static bool check_features(RAsm *a, cs_insn *insn) {
+static bool check_features(RAsm *a, csh handle, cs_insn *insn) {
 	int i;
 	if (!insn || !insn->detail) {
 		return true;
@@ -29,7 +33,7 @@ static bool check_features(RAsm *a, cs_insn *insn) {
 				continue;
 			}
 		}
-		const char *name = cs_group_name (cd, id);
+		const char *name = cs_group_name (handle, id);
 		if (!name) {
 			return true;
 		}
@@ -40,22 +44,8 @@ static bool check_features(RAsm *a, cs_insn *insn) {
 	return true;
 }
 
-static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
-	static int omode = -1;
-	static int obits = 32;
-	bool disp_hash = a->immdisp;
-	cs_insn* insn = NULL;
-	cs_mode mode = 0;
-	int ret, n = 0;
-	mode |= (a->bits == 16)? CS_MODE_THUMB: CS_MODE_ARM;
-	mode |= (a->big_endian)? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
-	if (mode != omode || a->bits != obits) {
-		cs_close (&cd);
-		cd = 0; // unnecessary
-		omode = mode;
-		obits = a->bits;
-	}
-
+static int cpu_mode(RAsm *a) {
+	int mode = 0;
 	if (a->cpu) {
 		if (strstr (a->cpu, "cortex")) {
 			mode |= CS_MODE_MCLASS;
@@ -71,6 +61,37 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 			mode |= CS_MODE_V8;
 		}
 	}
+	return mode;
+}
+
+static void op_set_insn(RAsm *a, RAsmOp *op, cs_insn *insn) {
+	op->size = insn->size;
+	char *buf_asm = sdb_fmt ("%s%s%s",
+		insn->mnemonic,
+		insn->op_str[0]?" ":"",
+		insn->op_str);
+	if (!a->immdisp) {
+		r_str_replace_char (buf_asm, '#', 0);
+	}
+	r_strbuf_set (&op->buf_asm, buf_asm);
+}
+
+static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
+	static int omode = -1;
+	static int obits = 32;
+	cs_insn* insn = NULL;
+	cs_mode mode = 0;
+	int ret, n = 0;
+	mode |= (a->bits == 16)? CS_MODE_THUMB: CS_MODE_ARM;
+	mode |= (a->big_endian)? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
+	if (mode != omode || a->bits != obits) {
+		cs_close (&cd);
+		cd = 0; // unnecessary
+		omode = mode;
+		obits = a->bits;
+	}
+
+	mode |= cpu_mode (a);
 	if (op) {
 		op->size = 4;
 		r_strbuf_set (&op->buf_asm, "");
@@ -106,21 +127,13 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 		op->size = 0;
 	}
 	if (a->features && *a->features) {
-		if (!check_features (a, insn) && op) {
+		if (!check_features (a, cd, insn) && op) {
 			op->size = insn->size;
 			r_strbuf_set (&op->buf_asm, "illegal");
 		}
 	}
 	if (op && !op->size) {
-		op->size = insn->size;
-		char *buf_asm = sdb_fmt ("%s%s%s",
-			insn->mnemonic,
-			insn->op_str[0]?" ":"",
-			insn->op_str);
-		if (!disp_hash) {
-			r_str_replace_char (buf_asm, '#', 0);
-		}
-		r_strbuf_set (&op->buf_asm, buf_asm);
+		op_set_insn (a, op, insn);
 	}
 	cs_free (insn, n);
 	beach:
@@ -134,6 +147,84 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	return ret;
 }
 
+// length of the run of up to count arm64 ops before the first one the hacks handle
+static int hacky_run_len(RAsm *a, int count, const ut8 *buf, int len) {
+	RAsmOp tmp;
+	int at;
+	r_asm_op_init (&tmp);
+	for (at = 0; at + 4 <= len && at / 4 < count; at += 4) {
+		if (hackyArmAsm (a, &tmp, buf + at, len - at) > 0) {
+			break;
+		}
+	}
+	r_asm_op_fini (&tmp);
+	return at;
+}
+
+/* decodes the whole run with one cs_disasm call, stopping at the first
+ * instruction that needs the hacks or does not decode at all. The run
+ * ends before a hacked op so capstone never decodes what the next call
+ * decodes again. The handle is only reopened when the mode or the bits
+ * change */
+static int disassemble_batch(RAsm *a, RAsmOp *ops, int count, const ut8 *buf, int len) {
+	cs_insn *insn = NULL;
+	int i, ninsn;
+	int mode = (a->bits == 16)? CS_MODE_THUMB: CS_MODE_ARM;
+	mode |= (a->big_endian)? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
+	mode |= cpu_mode (a);
+	if (a->bits == 64) {
+		// the hacks are for arm64 only, where every op is 4 bytes
+		len = hacky_run_len (a, count, buf, len);
+		if (len < 4) {
+			return 0;
+		}
+	}
+	if (!bcd || mode != bmode || a->bits != bbits) {
+		if (bcd) {
+			cs_close (&bcd);
+		}
+		bcd = 0;
+		if (cs_open ((a->bits == 64)? CS_ARCH_ARM64: CS_ARCH_ARM, mode, &bcd)) {
+			bcd = 0;
+			return 0;
+		}
+		bmode = mode;
+		bbits = a->bits;
+	}
+	cs_option (bcd, CS_OPT_SYNTAX, (a->syntax == R_ASM_SYNTAX_REGNUM)
+			? CS_OPT_SYNTAX_NOREGNAME
+			: CS_OPT_SYNTAX_DEFAULT);
+	cs_option (bcd, CS_OPT_DETAIL, (a->features && *a->features)
+		? CS_OPT_ON: CS_OPT_OFF);
+	ninsn = cs_disasm (bcd, buf, len, a->pc, count, &insn);
+	for (i = 0; i < ninsn; i++) {
+		RAsmOp *op = &ops[i];
+		if (insn[i].size < 1) {
+			// leave this one to the single instruction path
+			break;
+		}
+		if (a->features && *a->features && !check_features (a, bcd, &insn[i])) {
+			op->size = insn[i].size;
+			r_strbuf_set (&op->buf_asm, "illegal");
+		} else {
+			op_set_insn (a, op, &insn[i]);
+		}
+	}
+	if (insn) {
+		cs_free (insn, ninsn);
+	}
+	return i;
+}
+
+static bool the_end(void *p) {
+	if (bcd) {
+		cs_close (&bcd);
+		bcd = 0;
+	}
+	bmode = -1;
+	return true;
+}
+
 static int assemble(RAsm *a, RAsmOp *op, const char *buf) {
 	const bool is_thumb = (a->bits == 16);
 	int opsize;
@@ -193,6 +284,8 @@ RAsmPlugin r_asm_plugin_arm_cs = {
 	.bits = 16 | 32 | 64,
 	.endian = R_SYS_ENDIAN_LITTLE | R_SYS_ENDIAN_BIG,
 	.disassemble = &disassemble,
+	.fini = the_end,
+	.disassemble_batch = &disassemble_batch,
 	.mnemonics = mnemonics,
 	.assemble = &assemble,
 #if 0
@@ -9,13 +9,8 @@ R_IPI int mips_assemble(const char *str, ut64 pc, ut8 *out);
 static csh cd = 0;
 #include "cs_mnemonics.c"
 
-static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
-	cs_insn* insn;
-	int mode, n, ret = -1;
-	mode = (a->big_endian)? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
-	if (!op) {
-		return 0;
-	}
+static bool cs_setup(RAsm *a) {
+	int mode = (a->big_endian)? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
 	if (a->cpu && *a->cpu) {
 		if (!strcmp (a->cpu, "micro")) {
 			mode |= CS_MODE_MICRO;
@@ -30,14 +25,11 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 		}
 	}
 	mode |= (a->bits == 64)? CS_MODE_MIPS64 : CS_MODE_MIPS32;
-	memset (op, 0, sizeof (RAsmOp));
-	op->size = 4;
 	if (cd != 0) {
 		cs_close (&cd);
 	}
-	ret = cs_open (CS_ARCH_MIPS, mode, &cd);
-	if (ret) {
-		goto fin;
+	if (cs_open (CS_ARCH_MIPS, mode, &cd)) {
+		return false;
 	}
 	if (a->syntax == R_ASM_SYNTAX_REGNUM) {
 		cs_option (cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_NOREGNAME);
@@ -45,6 +37,31 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 		cs_option (cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_DEFAULT);
 	}
 	cs_option (cd, CS_OPT_DETAIL, CS_OPT_OFF);
+	return true;
+}
+
+static void op_set_insn(RAsmOp *op, cs_insn *insn) {
+	op->size = insn->size;
+	char *str = r_str_newf ("%s%s%s", insn->mnemonic, insn->op_str[0]? " ": "", insn->op_str);
+	if (str) {
+		r_str_replace_char (str, '$', 0);
+		// remove the '$'<registername> in the string
+		r_asm_op_set_asm (op, str);
+		free (str);
+	}
+}
+
+static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
+	cs_insn* insn;
+	int n;
+	if (!op) {
+		return 0;
+	}
+	memset (op, 0, sizeof (RAsmOp));
+	op->size = 4;
+	if (!cs_setup (a)) {
+		goto fin;
+	}
 	n = cs_disasm (cd, (ut8*)buf, len, a->pc, 1, &insn);
 	if (n < 1) {
 		r_asm_op_set_asm (op, "invalid");
@@ -54,14 +71,7 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	if (insn->size < 1) {
 		goto beach;
 	}
-	op->size = insn->size;
-	char *str = r_str_newf ("%s%s%s", insn->mnemonic, insn->op_str[0]? " ": "", insn->op_str);
-	if (str) {
-		r_str_replace_char (str, '$', 0);
-		// remove the '$'<registername> in the string
-		r_asm_op_set_asm (op, str);
-		free (str);
-	}
+	op_set_insn (op, insn);
 	cs_free (insn, n);
 beach:
 	// cs_close (&cd);
@@ -69,6 +79,23 @@ fin:
 	return op->size;
 }
 
+// one cs_open for the whole run instead of one per instruction
+static int disassemble_batch(RAsm *a, RAsmOp *ops, int count, const ut8 *buf, int len) {
+	cs_insn *insn = NULL;
+	int i, n;
+	if (!cs_setup (a)) {
+		return 0;
+	}
+	n = cs_disasm (cd, buf, len, a->pc, count, &insn);
+	for (i = 0; i < n && insn[i].size > 0; i++) {
+		op_set_insn (&ops[i], &insn[i]);
+	}
+	if (insn) {
+		cs_free (insn, n);
+	}
+	return i;
+}
+
 static int assemble(RAsm *a, RAsmOp *op, const char *str) {
 	ut8 *opbuf = (ut8*)r_strbuf_get (&op->buf);
 	int ret = mips_assemble (str, a->pc, opbuf);
@@ -93,6 +120,7 @@ RAsmPlugin r_asm_plugin_mips_cs = {
 	.bits = 16|32|64,
 	.endian = R_SYS_ENDIAN_LITTLE | R_SYS_ENDIAN_BIG,
 	.disassemble = &disassemble,
+	.disassemble_batch = &disassemble_batch,
 	.mnemonics = mnemonics,
 	.assemble = &assemble
 };
@@ -31,26 +31,42 @@ static int check_features(RAsm *a, cs_insn *insn);
 
 #include "asm_x86_vm.c"
 
-static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
-	static int omode = 0;
-	int mode, ret;
-	ut64 off = a->pc;
+static void op_set_insn(RAsmOp *op, cs_insn *insn) {
+	op->size = insn->size;
+	char *buf_asm = sdb_fmt ("%s%s%s",
+			insn->mnemonic, insn->op_str[0]?" ":"",
+			insn->op_str);
+	char *ptrstr = strstr (buf_asm, "ptr ");
+	if (ptrstr) {
+		memmove (ptrstr, ptrstr + 4, strlen (ptrstr + 4) + 1);
+	}
+	r_asm_op_set_asm (op, buf_asm);
+}
 
-	mode =  (a->bits == 64)? CS_MODE_64:
+static void op_fix_syntax(RAsm *a, RAsmOp *op) {
+	if (a->syntax == R_ASM_SYNTAX_JZ) {
+		char *buf_asm = r_strbuf_get (&op->buf_asm);
+		if (!strncmp (buf_asm, "je ", 3)) {
+			memcpy (buf_asm, "jz", 2);
+		} else if (!strncmp (buf_asm, "jne ", 4)) {
+			memcpy (buf_asm, "jnz", 3);
+		}
+	}
+}
+
+static bool cs_setup(RAsm *a) {
+	static int omode = 0;
+	int mode =  (a->bits == 64)? CS_MODE_64:
 		(a->bits == 32)? CS_MODE_32:
 		(a->bits == 16)? CS_MODE_16: 0;
 	if (cd && mode != omode) {
 		cs_close (&cd);
 		cd = 0;
 	}
-	if (op) {
-		op->size = 0;
-	}
 	omode = mode;
 	if (cd == 0) {
-		ret = cs_open (CS_ARCH_X86, mode, &cd);
-		if (ret) {
-			return 0;
+		if (cs_open (CS_ARCH_X86, mode, &cd)) {
+			return false;
 		}
 	}
 	if (a->features && *a->features) {
@@ -72,7 +88,19 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	} else {
 		cs_option (cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_INTEL);
 	}
+	return true;
+}
+
+static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
+	ut64 off = a->pc;
+	if (op) {
+		op->size = 0;
+	}
+	if (!cs_setup (a)) {
+		return 0;
+	}
 	if (!op) {
+		// mnemonics () only wants the handle
 		return true;
 	}
 	op->size = 1;
@@ -104,27 +132,11 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 		}
 	}
 	if (op->size == 0 && n > 0 && insn->size > 0) {
-		char *ptrstr;
-		op->size = insn->size;
-		char *buf_asm = sdb_fmt ("%s%s%s",
-				insn->mnemonic, insn->op_str[0]?" ":"",
-				insn->op_str);
-		ptrstr = strstr (buf_asm, "ptr ");
-		if (ptrstr) {
-			memmove (ptrstr, ptrstr + 4, strlen (ptrstr + 4) + 1);
-		}
-		r_asm_op_set_asm (op, buf_asm);
+		op_set_insn (op, insn);
 	} else {
 		decompile_vm (a, op, buf, len);
 	}
-	if (a->syntax == R_ASM_SYNTAX_JZ) {
-		char *buf_asm = r_strbuf_get (&op->buf_asm);
-		if (!strncmp (buf_asm, "je ", 3)) {
-			memcpy (buf_asm, "jz", 2);
-		} else if (!strncmp (buf_asm, "jne ", 4)) {
-			memcpy (buf_asm, "jnz", 3);
-		}
-	}
+	op_fix_syntax (a, op);
 #if 0
 	// [eax + ebx*4]  =>  [eax + ebx * 4]
 	char *ast = strchr (op->buf_asm, '*');
@@ -155,6 +167,31 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	return op->size;
 }
 
+/* decodes the whole run with one cs_disasm call, stopping at the first
+ * instruction capstone can not decode so the vm fallback gets it */
+static int disassemble_batch(RAsm *a, RAsmOp *ops, int count, const ut8 *buf, int len) {
+	cs_insn *insn = NULL;
+	int i, ninsn;
+	if (!cs_setup (a)) {
+		return 0;
+	}
+	ninsn = cs_disasm (cd, buf, len, a->pc, count, &insn);
+	for (i = 0; i < ninsn; i++) {
+		RAsmOp *op = &ops[i];
+		if (a->features && *a->features && !check_features (a, &insn[i])) {
+			op->size = insn[i].size;
+			r_asm_op_set_asm (op, "illegal");
+		} else {
+			op_set_insn (op, &insn[i]);
+		}
+		op_fix_syntax (a, op);
+	}
+	if (insn) {
+		cs_free (insn, ninsn);
+	}
+	return R_MAX (ninsn, 0);
+}
+
 RAsmPlugin r_asm_plugin_x86_cs = {
 	.name = "x86",
 	.desc = "Capstone X86 disassembler",
@@ -165,6 +202,7 @@ RAsmPlugin r_asm_plugin_x86_cs = {
 	.fini = the_end,
 	.mnemonics = mnemonics,
 	.disassemble = &disassemble,
+	.disassemble_batch = &disassemble_batch,
 	.features = "vm,3dnow,aes,adx,avx,avx2,avx512,bmi,bmi2,cmov,"
 		"f16c,fma,fma4,fsgsbase,hle,mmx,rtm,sha,sse1,sse2,"
 		"sse3,sse41,sse42,sse4a,ssse3,pclmul,xop"
@@ -849,6 +849,8 @@ R_API RBin *r_bin_new(void) {
 	bin->strpurge = NULL;
 	bin->strenc = NULL;
 	bin->want_dbginfo = true;
+	bin->dbginfo_threads = 1;
+	bin->demangle_threads = 1;
 	bin->cur = NULL;
 	bin->ids = r_id_storage_new (0, ST32_MAX);
 
@@ -46,6 +46,7 @@ static void object_delete_items(RBinObject *o) {
 	r_list_free (o->classes);
 	ht_pp_free (o->classes_ht);
 	ht_pp_free (o->methods_ht);
+	ht_pp_free (o->demangled);
 	r_list_free (o->lines);
 	sdb_free (o->kv);
 	r_list_free (o->mem);
@@ -276,6 +277,9 @@ R_API int r_bin_object_set_items(RBinFile *bf, RBinObject *o) {
 	RBinPlugin *p = o->plugin;
 	int minlen = (bf->rbin->minstrlen > 0) ? bf->rbin->minstrlen : p->minstrlen;
 	bf->o = o;
+	// classes are reloaded, demangling again registers the c++ methods
+	ht_pp_free (o->demangled);
+	o->demangled = NULL;
 
 	if (p->file_type) {
 		int type = p->file_type (bf);
@@ -426,6 +430,9 @@ R_API int r_bin_object_set_items(RBinFile *bf, RBinObject *o) {
 	if (bin->filter_rules & (R_BIN_REQ_INFO | R_BIN_REQ_SYMBOLS | R_BIN_REQ_IMPORTS)) {
 		o->lang = isSwift? R_BIN_NM_SWIFT: r_bin_load_languages (bf);
 	}
+	if (bin->demangle_threads > 1 && o->symbols && o->lang) {
+		r_bin_demangle_batch (bf, r_bin_lang_tostring (o->lang), o->symbols, bin->demangle_threads);
+	}
 	return true;
 }
 
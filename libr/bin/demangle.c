@@ -62,15 +62,13 @@ R_API int r_bin_demangle_type(const char *str) {
 	return R_BIN_NM_NONE;
 }
 
-R_API char *r_bin_demangle(RBinFile *bf, const char *def, const char *str, ut64 vaddr, bool libs) {
-	int type = -1;
-	if (!str || !*str) {
-		return NULL;
-	}
+// strips the known prefixes and library names, returns NULL if nothing is left
+static const char *demangle_prepare(RBinFile *bf, const char *def, const char *str, int *type, const char **olib) {
 	RBin *bin = bf? bf->rbin: NULL;
 	RBinObject *o = bf? bf->o: NULL;
 	RListIter *iter;
 	const char *lib = NULL;
+	*type = -1;
 	if (!strncmp (str, "reloc.", 6)) {
 		str += 6;
 	}
@@ -107,9 +105,9 @@ R_API char *r_bin_demangle(RBinFile *bf, const char *def, const char *str, ut64
 	}
 	if (!strncmp (str, "__", 2)) {
 		if (str[2] == 'T') {
-			type = R_BIN_NM_SWIFT;
+			*type = R_BIN_NM_SWIFT;
 		} else {
-			type = R_BIN_NM_CXX;
+			*type = R_BIN_NM_CXX;
 		//	str++;
 		}
 	}
@@ -117,19 +115,82 @@ R_API char *r_bin_demangle(RBinFile *bf, const char *def, const char *str, ut64
 	if (!*str) {
 		return NULL;
 	}
-	if (type == -1) {
-		type = r_bin_lang_type (bf, def, str);
+	if (*type == -1) {
+		*type = r_bin_lang_type (bf, def, str);
 	}
-	char *demangled = NULL;
+	*olib = lib;
+	return str;
+}
+
+static char *demangle_as(RBinFile *bf, int type, const char *str, ut64 vaddr) {
+	RBin *bin = bf? bf->rbin: NULL;
 	switch (type) {
-	case R_BIN_NM_JAVA: demangled = r_bin_demangle_java (str); break;
-	case R_BIN_NM_RUST: demangled = r_bin_demangle_rust (bf, str, vaddr); break;
-	case R_BIN_NM_OBJC: demangled = r_bin_demangle_objc (NULL, str); break;
-	case R_BIN_NM_SWIFT: demangled = r_bin_demangle_swift (str, bin? bin->demanglercmd: false); break;
-	case R_BIN_NM_CXX: demangled = r_bin_demangle_cxx (bf, str, vaddr); break;
-	case R_BIN_NM_MSVC: demangled = r_bin_demangle_msvc (str); break;
-	case R_BIN_NM_DLANG: demangled = r_bin_demangle_plugin (bin, "dlang", str); break;
+	case R_BIN_NM_JAVA: return r_bin_demangle_java (str);
+	case R_BIN_NM_RUST: return r_bin_demangle_rust (bf, str, vaddr);
+	case R_BIN_NM_OBJC: return r_bin_demangle_objc (NULL, str);
+	case R_BIN_NM_SWIFT: return r_bin_demangle_swift (str, bin? bin->demanglercmd: false);
+	case R_BIN_NM_CXX: return r_bin_demangle_cxx (bf, str, vaddr);
+	case R_BIN_NM_MSVC: return r_bin_demangle_msvc (str);
+	case R_BIN_NM_DLANG: return r_bin_demangle_plugin (bin, "dlang", str);
+	}
+	return NULL;
+}
+
+static void demangled_kv_free(HtPPKv *kv) {
+	free (kv->key);
+	free (kv->value);
+}
+
+// the same mangled names show up in symbols, imports, relocs and methods,
+// so the results (failures included) are cached in the bin object
+static HtPP *demangle_cache(RBinFile *bf) {
+	RBinObject *o = bf? bf->o: NULL;
+	if (o && !o->demangled) {
+		o->demangled = ht_pp_new (NULL, demangled_kv_free, NULL);
+	}
+	return o? o->demangled: NULL;
+}
+
+// "type.mangled", the swift names also depend on bin.demanglercmd so
+// they get a "c" after the type when the external demangler is used
+static char *demangle_key(RBinFile *bf, int type, const char *str) {
+	RBin *bin = bf? bf->rbin: NULL;
+	bool syscmd = type == R_BIN_NM_SWIFT && bin && bin->demanglercmd;
+	return r_str_newf ("%d%s.%s", type, syscmd? "c": "", str);
+}
+
+static char *demangle_cached(RBinFile *bf, int type, const char *str, ut64 vaddr) {
+	HtPP *cache = demangle_cache (bf);
+	if (!cache) {
+		return demangle_as (bf, type, str, vaddr);
+	}
+	char *key = demangle_key (bf, type, str);
+	if (!key) {
+		return NULL;
+	}
+	bool found = false;
+	const char *res = ht_pp_find (cache, key, &found);
+	if (found) {
+		free (key);
+		return res? strdup (res): NULL;
+	}
+	char *demangled = demangle_as (bf, type, str, vaddr);
+	ht_pp_insert (cache, key, demangled? strdup (demangled): NULL);
+	free (key);
+	return demangled;
+}
+
+R_API char *r_bin_demangle(RBinFile *bf, const char *def, const char *str, ut64 vaddr, bool libs) {
+	int type = -1;
+	const char *lib = NULL;
+	if (!str || !*str) {
+		return NULL;
 	}
+	str = demangle_prepare (bf, def, str, &type, &lib);
+	if (!str) {
+		return NULL;
+	}
+	char *demangled = demangle_cached (bf, type, str, vaddr);
 	if (libs && demangled && lib) {
 		char *d = r_str_newf ("%s_%s", lib, demangled);
 		free (demangled);
@@ -138,6 +199,143 @@ R_API char *r_bin_demangle(RBinFile *bf, const char *def, const char *str, ut64
 	return demangled;
 }
 
+typedef struct {
+	char **keys; // "type.mangled" names, the mangled part starts after the dot
+	char **outs;
+	size_t start;
+	size_t end;
+} DemangleJob;
+
+static void demangle_cxx_job(DemangleJob *job) {
+	size_t i;
+	for (i = job->start; i < job->end; i++) {
+		// no RBinFile, the methods are registered back in the caller thread
+		job->outs[i] = r_bin_demangle_cxx (NULL, strchr (job->keys[i], '.') + 1, 0);
+	}
+}
+
+static RThreadFunctionRet demangle_cxx_th(RThread *th) {
+	demangle_cxx_job (th->user);
+	return R_TH_STOP;
+}
+
+/**
+ * @brief Fills the demangling cache of the current object with the given symbols
+ *
+ * Subsequent r_bin_demangle calls for these names are served from the cache.
+ * The c++ names, which are the bulk of big binaries, can be demangled in
+ * parallel, the rest of languages are demangled in the calling thread
+ *
+ * @param bf Bin file owning the symbols
+ * @param lang Default language, as in r_bin_demangle
+ * @param symbols List of RBinSymbol to demangle
+ * @param threads Number of threads used for the c++ names
+ * @return int Number of names that were not cached yet
+ */
+R_API int r_bin_demangle_batch(RBinFile *bf, const char *lang, RList *symbols, int threads) {
+	r_return_val_if_fail (bf && symbols, 0);
+	HtPP *cache = demangle_cache (bf);
+	if (!cache) {
+		return 0;
+	}
+	int i, count = 0, cxx = 0;
+	int n = r_list_length (symbols);
+	char **keys = R_NEWS0 (char *, n);
+	char **outs = R_NEWS0 (char *, n);
+	RBinSymbol **syms = R_NEWS0 (RBinSymbol *, n);
+	RList *others = r_list_new ();
+	if (!keys || !outs || !syms || !others) {
+		goto beach;
+	}
+	HtPP *pending = ht_pp_new0 ();
+	if (!pending) {
+		goto beach;
+	}
+	RListIter *iter;
+	RBinSymbol *sym;
+	char *key;
+	// c++ names go first, so they can be split between the threads
+	r_list_foreach (symbols, iter, sym) {
+		int type = -1;
+		const char *lib = NULL;
+		const char *str = sym->name? demangle_prepare (bf, lang, sym->name, &type, &lib): NULL;
+		if (!str) {
+			continue;
+		}
+		key = demangle_key (bf, type, str);
+		if (!key) {
+			continue;
+		}
+		bool found = false;
+		ht_pp_find (cache, key, &found);
+		if (found || ht_pp_find (pending, key, NULL)) {
+			free (key);
+			continue;
+		}
+		ht_pp_insert (pending, key, sym);
+		if (type == R_BIN_NM_CXX) {
+			keys[cxx] = key;
+			syms[cxx] = sym;
+			cxx++;
+		} else {
+			r_list_append (others, key);
+		}
+	}
+	count = cxx;
+	r_list_foreach (others, iter, key) {
+		keys[count] = key;
+		syms[count] = ht_pp_find (pending, key, NULL);
+		count++;
+	}
+	ht_pp_free (pending);
+
+	threads = R_MAX (1, R_MIN (threads, cxx));
+	DemangleJob *jobs = R_NEWS0 (DemangleJob, threads);
+	RThread **ths = R_NEWS0 (RThread *, threads);
+	if (threads > 1 && jobs && ths) {
+		for (i = 0; i < threads; i++) {
+			jobs[i].keys = keys;
+			jobs[i].outs = outs;
+			jobs[i].start = (size_t)cxx * i / threads;
+			jobs[i].end = (size_t)cxx * (i + 1) / threads;
+			ths[i] = r_th_new (demangle_cxx_th, &jobs[i], 0);
+			if (!ths[i]) {
+				demangle_cxx_job (&jobs[i]);
+			}
+		}
+		for (i = 0; i < threads; i++) {
+			if (ths[i]) {
+				r_th_wait (ths[i]);
+				r_th_free (ths[i]);
+			}
+		}
+	} else {
+		DemangleJob job = { keys, outs, 0, cxx };
+		demangle_cxx_job (&job);
+	}
+	free (jobs);
+	free (ths);
+	for (i = 0; i < count; i++) {
+		char *out = outs[i];
+		if (i < cxx) {
+			if (out) {
+				r_bin_demangle_cxx_add_method (bf, out, syms[i]->vaddr);
+			}
+		} else {
+			int type = atoi (keys[i]);
+			out = demangle_as (bf, type, strchr (keys[i], '.') + 1, syms[i]->vaddr);
+		}
+		ht_pp_insert (cache, keys[i], out);
+		free (keys[i]);
+	}
+beach:
+	r_list_free (others);
+	free (keys);
+	free (outs);
+	free (syms);
+	return count;
+}
+
 #ifdef TEST
 main() {
 	char *out, str[128];
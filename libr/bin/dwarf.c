@@ -1852,11 +1852,11 @@ static const ut8 *parse_attr_value(const ut8 *obuf, int obuf_len,
  * @param die DIE to store the parsed info into
  * @param debug_str Ptr to string section start
  * @param debug_str_len Length of the string section
- * @param sdb 
+ * @param comp_dir Set to the DW_AT_comp_dir string if the DIE has one
  * @return const ut8* Updated buffer
  */
-static const ut8 *parse_die(const ut8 *buf, const ut8 *buf_end, RBinDwarfAbbrevDecl *abbrev, 
-		RBinDwarfCompUnitHdr *hdr, RBinDwarfDie *die, const ut8 *debug_str, size_t debug_str_len, Sdb *sdb) {
+static const ut8 *parse_die(const ut8 *buf, const ut8 *buf_end, RBinDwarfAbbrevDecl *abbrev,
+		RBinDwarfCompUnitHdr *hdr, RBinDwarfDie *die, const ut8 *debug_str, size_t debug_str_len, const char **comp_dir) {
 	size_t i;
 	for (i = 0; i < abbrev->count - 1; i++) {
 		memset (&die->attr_values[i], 0, sizeof (die->attr_values[i]));
@@ -1869,12 +1869,8 @@ static const ut8 *parse_die(const ut8 *buf, const ut8 *buf_end, RBinDwarfAbbrevD
 		bool is_valid_string_form = (attribute->attr_form == DW_FORM_strp ||
 			attribute->attr_form == DW_FORM_string) &&
 			attribute->string.content;
-		// TODO  does this have a purpose anymore?
-		// Or atleast it needs to rework becase there will be
-		// more comp units -> more comp dirs and only the last one will be kept
 		if (attribute->attr_name == DW_AT_comp_dir && is_valid_string_form) {
-			const char *name = attribute->string.content;
-			sdb_set (sdb, "DW_AT_comp_dir", name, 0);
+			*comp_dir = attribute->string.content;
 		}
 		die->count++;
 	}
@@ -1882,22 +1878,55 @@ static const ut8 *parse_die(const ut8 *buf, const ut8 *buf_end, RBinDwarfAbbrevD
 	return buf;
 }
 
+/**
+ * @brief Checks if the code of the unit DIE can intersect [from, to)
+ *
+ * Units without a contiguous pc range (DW_AT_ranges) are always kept
+ */
+static bool comp_unit_in_range(const RBinDwarfDie *die, ut64 from, ut64 to) {
+	if (to <= from) {
+		return true;
+	}
+	const RBinDwarfAttrValue *low = NULL, *high = NULL;
+	size_t i;
+	for (i = 0; i < die->count; i++) {
+		const RBinDwarfAttrValue *val = &die->attr_values[i];
+		if (val->attr_name == DW_AT_low_pc && val->kind == DW_AT_KIND_ADDRESS) {
+			low = val;
+		} else if (val->attr_name == DW_AT_high_pc) {
+			high = val;
+		}
+	}
+	if (!low || !high) {
+		return true;
+	}
+	ut64 start = low->address;
+	ut64 end = high->kind == DW_AT_KIND_ADDRESS ? high->address : start + high->uconstant;
+	return start < to && end > from;
+}
+
 /**
  * @brief Reads throught comp_unit buffer and parses all its DIEntries
- * 
- * @param sdb
+ *
+ * Only touches the unit itself and the read-only abbrevs, so different
+ * units can be parsed concurrently
+ *
  * @param buf_start Start of the compilation unit data
  * @param unit Unit to store the newly parsed information
  * @param abbrevs Parsed abbrev section info of *all* abbreviations
  * @param first_abbr_idx index for first abbrev of the current comp unit in abbrev array
  * @param debug_str Ptr to string section start
  * @param debug_str_len Length of the string section
- * 
+ * @param comp_dir Set to the last DW_AT_comp_dir string found in the unit
+ * @param from Lower bound of the address range of interest
+ * @param to Upper bound of the address range of interest, ignored when <= from
+ *
  * @return const ut8* Update buffer
  */
-static const ut8 *parse_comp_unit(RBinDwarfDebugInfo *info, Sdb *sdb, const ut8 *buf_start,
+static const ut8 *parse_comp_unit(const ut8 *buf_start,
 		RBinDwarfCompUnit *unit, const RBinDwarfDebugAbbrev *abbrevs,
-		size_t first_abbr_idx, const ut8 *debug_str, size_t debug_str_len) {
+		size_t first_abbr_idx, const ut8 *debug_str, size_t debug_str_len,
+		const char **comp_dir, ut64 from, ut64 to) {
 
 	const ut8 *buf = buf_start;
 	const ut8 *buf_end = buf_start + unit->hdr.length - unit->hdr.header_size;
@@ -1941,12 +1970,16 @@ static const ut8 *parse_comp_unit(RBinDwarfDebugInfo *info, Sdb *sdb, const ut8
 		die->tag = abbrev->tag;
 		die->has_children = abbrev->has_children;
 
-		buf = parse_die (buf, buf_end, abbrev, &unit->hdr, die, debug_str, debug_str_len, sdb);
+		buf = parse_die (buf, buf_end, abbrev, &unit->hdr, die, debug_str, debug_str_len, comp_dir);
 		if (!buf) {
 			return NULL;
 		}
 
 		unit->count++;
+		// keep just the unit DIE of units outside of the wanted range
+		if (unit->count == 1 && die->tag == DW_TAG_compile_unit && !comp_unit_in_range (die, from, to)) {
+			return buf_end;
+		}
 	}
 	return buf;
 }
@@ -2005,35 +2038,59 @@ static int expand_info(RBinDwarfDebugInfo *info) {
 	return 0;
 }
 
-/**
- * @brief Parses whole .debug_info section
- * 
- * @param sdb Sdb to store line related information into
- * @param da Parsed Abbreviations
- * @param obuf .debug_info section buffer start
- * @param len length of the section buffer
- * @param debug_str start of the .debug_str section
- * @param debug_str_len length of the debug_str section
- * @param mode 
- * @return R_API* parse_info_raw Parsed information
- */
-static RBinDwarfDebugInfo *parse_info_raw(Sdb *sdb, RBinDwarfDebugAbbrev *da,
-		const ut8 *obuf, size_t len,
-		const ut8 *debug_str, size_t debug_str_len) {
-
-	r_return_val_if_fail (da && sdb && obuf, false);
+typedef struct {
+	RBinDwarfDebugInfo *info;
+	const RBinDwarfDebugAbbrev *da;
+	const ut8 *obuf;
+	const ut8 *debug_str;
+	size_t debug_str_len;
+	size_t *first_abbr_idx; // per unit index of its first abbrev
+	const char **comp_dirs; // per unit DW_AT_comp_dir
+	ut64 from;
+	ut64 to;
+} DwarfInfoCtx;
+
+typedef struct {
+	DwarfInfoCtx *ctx;
+	size_t start; // first unit to parse
+	size_t end; // one past the last unit
+	bool failed;
+} DwarfInfoJob;
+
+static bool parse_comp_units(DwarfInfoJob *job) {
+	DwarfInfoCtx *ctx = job->ctx;
+	size_t i;
+	for (i = job->start; i < job->end; i++) {
+		RBinDwarfCompUnit *unit = &ctx->info->comp_units[i];
+		if (init_comp_unit (unit) < 0) {
+			return false;
+		}
+		const ut8 *buf = ctx->obuf + unit->offset + unit->hdr.header_size;
+		buf += unit->hdr.is_64bit ? 12 : 4;
+		if (!parse_comp_unit (buf, unit, ctx->da, ctx->first_abbr_idx[i],
+				ctx->debug_str, ctx->debug_str_len, &ctx->comp_dirs[i], ctx->from, ctx->to)) {
+			return false;
+		}
+	}
+	return true;
+}
 
-	const ut8 *buf = obuf;
-	const ut8 *buf_end = obuf + len;
+static RThreadFunctionRet parse_comp_units_th(RThread *th) {
+	DwarfInfoJob *job = th->user;
+	job->failed = !parse_comp_units (job);
+	return R_TH_STOP;
+}
 
-	RBinDwarfDebugInfo *info = R_NEW0 (RBinDwarfDebugInfo);
-	if (!info) {
-		return NULL;
-	}
-	if (init_debug_info (info) < 0) {
-		goto cleanup;
-	}
-	int unit_idx = 0;
+/**
+ * @brief Indexes all the unit headers of .debug_info without parsing any DIE
+ *
+ * @return bool false if the section is malformed
+ */
+static bool index_comp_units(RBinDwarfDebugInfo *info, DwarfInfoCtx *ctx, size_t len) {
+	const RBinDwarfDebugAbbrev *da = ctx->da;
+	const ut8 *buf = ctx->obuf;
+	const ut8 *buf_end = ctx->obuf + len;
+	size_t capacity = 0;
 
 	while (buf < buf_end) {
 		if (info->count >= info->capacity) {
@@ -2041,22 +2098,23 @@ static RBinDwarfDebugInfo *parse_info_raw(Sdb *sdb, RBinDwarfDebugAbbrev *da,
 				break;
 			}
 		}
-
-		RBinDwarfCompUnit *unit = &info->comp_units[unit_idx];
-		if (init_comp_unit (unit) < 0) {
-			unit_idx--;
-			goto cleanup;
+		if (info->count >= capacity) {
+			capacity = info->capacity;
+			size_t *idxs = realloc (ctx->first_abbr_idx, capacity * sizeof (size_t));
+			if (!idxs) {
+				return false;
+			}
+			ctx->first_abbr_idx = idxs;
 		}
-		info->count++;
-
-		unit->offset = buf - obuf;
+		RBinDwarfCompUnit *unit = &info->comp_units[info->count];
+		unit->offset = buf - ctx->obuf;
 		// small redundancy, because it was easiest solution at a time
-		unit->hdr.unit_offset = buf - obuf;
+		unit->hdr.unit_offset = buf - ctx->obuf;
 
 		buf = info_comp_unit_read_hdr (buf, buf_end, &unit->hdr);
 
-		if (unit->hdr.length > len) {
-			goto cleanup;
+		if (unit->hdr.length > len || unit->hdr.length < unit->hdr.header_size) {
+			return false;
 		}
 
 		if (da->decls->count >= da->capacity) {
@@ -2065,28 +2123,139 @@ static RBinDwarfDebugInfo *parse_info_raw(Sdb *sdb, RBinDwarfDebugAbbrev *da,
 		r_warn_if_fail (da->count <= da->capacity);
 
 		// find abbrev start for current comp unit
-		// we could also do naive, ((char *)da->decls) + abbrev_offset, 
+		// we could also do naive, ((char *)da->decls) + abbrev_offset,
 		// but this is more bulletproof to invalid DWARF
 		RBinDwarfAbbrevDecl key = { .offset = unit->hdr.abbrev_offset };
 		RBinDwarfAbbrevDecl *abbrev_start = bsearch (&key, da->decls, da->count, sizeof (key), abbrev_cmp);
 		if (!abbrev_start) {
-			goto cleanup;
+			return false;
 		}
 		// They point to the same array object, so should be def. behaviour
-		size_t first_abbr_idx = abbrev_start - da->decls;
-
-		buf = parse_comp_unit (info, sdb, buf, unit, da, first_abbr_idx, debug_str, debug_str_len);
+		ctx->first_abbr_idx[info->count] = abbrev_start - da->decls;
+		info->count++;
 
-		if (!buf) {
-			goto cleanup;
+		// the unit length does not include the length field itself
+		ut64 unit_end = unit->offset + unit->hdr.length + (unit->hdr.is_64bit ? 12 : 4);
+		if (unit_end > len) {
+			// truncated unit, parse what is there
+			unit->hdr.length = len - unit->offset - (unit->hdr.is_64bit ? 12 : 4);
+			break;
 		}
+		buf = ctx->obuf + unit_end;
+	}
+	return true;
+}
+
+/**
+ * @brief Parses whole .debug_info section
+ *
+ * Unit headers are indexed first, then the units are parsed independently,
+ * in parallel when more than one thread is requested. Each thread works on
+ * a contiguous slice of units, so the result keeps the section order
+ *
+ * @param sdb Sdb to store line related information into
+ * @param da Parsed Abbreviations
+ * @param obuf .debug_info section buffer start
+ * @param len length of the section buffer
+ * @param debug_str start of the .debug_str section
+ * @param debug_str_len length of the debug_str section
+ * @param threads Number of threads to parse the units with
+ * @param from Only parse fully the units whose code intersects [from, to)
+ * @param to Upper bound of the range, ignored when <= from
+ * @return R_API* parse_info_raw Parsed information
+ */
+static RBinDwarfDebugInfo *parse_info_raw(Sdb *sdb, RBinDwarfDebugAbbrev *da,
+		const ut8 *obuf, size_t len,
+		const ut8 *debug_str, size_t debug_str_len,
+		int threads, ut64 from, ut64 to) {
 
-		unit_idx++;
+	r_return_val_if_fail (da && sdb && obuf, false);
+
+	DwarfInfoJob *jobs = NULL;
+	DwarfInfoCtx ctx = {
+		.da = da,
+		.obuf = obuf,
+		.debug_str = debug_str,
+		.debug_str_len = debug_str_len,
+		.from = from,
+		.to = to
+	};
+	RBinDwarfDebugInfo *info = R_NEW0 (RBinDwarfDebugInfo);
+	if (!info) {
+		return NULL;
+	}
+	ctx.info = info;
+	if (init_debug_info (info) < 0) {
+		goto cleanup;
+	}
+	if (!index_comp_units (info, &ctx, len) || !info->count) {
+		goto cleanup;
+	}
+	ctx.comp_dirs = R_NEWS0 (const char *, info->count);
+	if (!ctx.comp_dirs) {
+		goto cleanup;
 	}
 
+	size_t i, n = R_MAX (1, R_MIN ((size_t)threads, info->count));
+	jobs = R_NEWS0 (DwarfInfoJob, n);
+	if (!jobs) {
+		goto cleanup;
+	}
+	// split the units in slices of about the same amount of bytes
+	size_t unit_idx = 0;
+	for (i = 0; i < n; i++) {
+		ut64 limit = (ut64)len * (i + 1) / n;
+		jobs[i].ctx = &ctx;
+		jobs[i].start = unit_idx;
+		while (unit_idx < info->count && (i + 1 == n || info->comp_units[unit_idx].offset < limit)) {
+			unit_idx++;
+		}
+		jobs[i].end = unit_idx;
+	}
+	if (n > 1) {
+		RThread **ths = R_NEWS0 (RThread *, n);
+		if (!ths) {
+			goto cleanup;
+		}
+		for (i = 1; i < n; i++) {
+			ths[i] = r_th_new (parse_comp_units_th, &jobs[i], 0);
+			if (!ths[i]) {
+				jobs[i].failed = !parse_comp_units (&jobs[i]);
+			}
+		}
+		jobs[0].failed = !parse_comp_units (&jobs[0]);
+		for (i = 1; i < n; i++) {
+			if (ths[i]) {
+				r_th_wait (ths[i]);
+				r_th_free (ths[i]);
+			}
+		}
+		free (ths);
+	} else {
+		jobs[0].failed = !parse_comp_units (&jobs[0]);
+	}
+	for (i = 0; i < n; i++) {
+		if (jobs[i].failed) {
+			goto cleanup;
+		}
+	}
+	// TODO  does this have a purpose anymore?
+	// Or atleast it needs to rework becase there will be
+	// more comp units -> more comp dirs and only the last one will be kept
+	for (i = 0; i < info->count; i++) {
+		if (ctx.comp_dirs[i]) {
+			sdb_set (sdb, "DW_AT_comp_dir", ctx.comp_dirs[i], 0);
+		}
+	}
+	free (jobs);
+	free (ctx.comp_dirs);
+	free (ctx.first_abbr_idx);
 	return info;
 
 cleanup:
+	free (jobs);
+	free (ctx.comp_dirs);
+	free (ctx.first_abbr_idx);
 	r_bin_dwarf_free_debug_info (info);
 	return NULL;
 }
@@ -2231,7 +2400,8 @@ R_API RBinDwarfDebugInfo *r_bin_dwarf_parse_info(RBinDwarfDebugAbbrev *da, RBin
 		/* set the endianity global [HOTFIX] */
 		big_end = r_bin_is_big_endian (bin);
 		info = parse_info_raw (binfile->sdb_addrinfo, da, buf, len,
-			debug_str_buf, debug_str_len);
+			debug_str_buf, debug_str_len, bin->dbginfo_threads,
+			bin->dbginfo_from, bin->dbginfo_to);
 
 		if (mode == R_MODE_PRINT && info) {
 			print_debug_info (info, bin->cb_printf);
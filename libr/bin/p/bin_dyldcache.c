@@ -62,19 +62,23 @@ typedef struct {
 	ut32 entries_size;
 } RDyldRebaseInfo1;
 
+// the nlists and strings stay in the cache file and are
+// read per image, only the small per-image table is kept
 typedef struct {
-	char *strings;
+	ut64 strings_offset;
 	ut64 strings_size;
-	struct MACH0_(nlist) *nlists;
+	ut64 nlists_offset;
 	ut64 nlists_count;
 	cache_locsym_entry_t *entries;
 	ut64 entries_count;
+	HtUP/*<dylibOffset, cache_locsym_entry_t *>*/ *entries_by_dylib;
 } RDyldLocSym;
 
 typedef struct _r_dyldcache {
 	ut8 magic[8];
 	RList *bins;
 	RBuffer *buf;
+	RMmap *map; // read-only mapping of the cache file, NULL when it is not a local file
 	int (*original_io_read)(RIO *io, RIODesc *fd, ut8 *buf, int count);
 	RDyldRebaseInfo *rebase_info;
 	cache_hdr_t *hdr;
@@ -86,6 +90,7 @@ typedef struct _r_dyldcache {
 typedef struct _r_bin_image {
 	char *file;
 	ut64 header_at;
+	bool locals; // named in R_DYLDCACHE_FILTER, its local symbols are decoded
 } RDyldBinImage;
 
 static RList * pending_bin_files = NULL;
@@ -156,9 +161,8 @@ static RDyldLocSym *r_dyld_locsym_new(RBuffer *cache_buf, cache_hdr_t *hdr) {
 	}
 
 	cache_locsym_info_t *info = NULL;
-	char *strings = NULL;
 	cache_locsym_entry_t *entries = NULL;
-	struct MACH0_(nlist) *nlists = NULL;
+	HtUP *entries_by_dylib = NULL;
 
 	ut64 info_size = sizeof (cache_locsym_info_t);
 	info = R_NEW0 (cache_locsym_info_t);
@@ -169,25 +173,6 @@ static RDyldLocSym *r_dyld_locsym_new(RBuffer *cache_buf, cache_hdr_t *hdr) {
 		goto beach;
 	}
 
-	ut64 nlists_size = sizeof (struct MACH0_(nlist)) * info->nlistCount;
-	nlists = R_NEWS0 (struct MACH0_(nlist), info->nlistCount);
-	if (!nlists) {
-		goto beach;
-	}
-	if (r_buf_fread_at (cache_buf, hdr->localSymbolsOffset + info->nlistOffset, (ut8*) nlists, "iccsl",
-			info->nlistCount) != nlists_size) {
-		goto beach;
-	}
-
-	strings = malloc (info->stringsSize);
-	if (!strings) {
-		goto beach;
-	}
-	if (r_buf_read_at (cache_buf, hdr->localSymbolsOffset + info->stringsOffset, (ut8*) strings,
-			info->stringsSize) != info->stringsSize) {
-		goto beach;
-	}
-
 	ut64 entries_size = sizeof (cache_locsym_entry_t) * info->entriesCount;
 	entries = R_NEWS0 (cache_locsym_entry_t, info->entriesCount);
 	if (!entries) {
@@ -198,17 +183,28 @@ static RDyldLocSym *r_dyld_locsym_new(RBuffer *cache_buf, cache_hdr_t *hdr) {
 		goto beach;
 	}
 
+	entries_by_dylib = ht_up_new0 ();
+	if (!entries_by_dylib) {
+		goto beach;
+	}
+	ut32 i;
+	for (i = 0; i < info->entriesCount; i++) {
+		// keep the first entry of each image, like the linear scan did
+		ht_up_insert (entries_by_dylib, entries[i].dylibOffset, &entries[i]);
+	}
+
 	RDyldLocSym * locsym = R_NEW0 (RDyldLocSym);
 	if (!locsym) {
 		goto beach;
 	}
 
-	locsym->nlists = nlists;
+	locsym->nlists_offset = hdr->localSymbolsOffset + info->nlistOffset;
 	locsym->nlists_count = info->nlistCount;
-	locsym->strings = strings;
+	locsym->strings_offset = hdr->localSymbolsOffset + info->stringsOffset;
 	locsym->strings_size = info->stringsSize;
 	locsym->entries = entries;
 	locsym->entries_count = info->entriesCount;
+	locsym->entries_by_dylib = entries_by_dylib;
 
 	free (info);
 
@@ -216,9 +212,8 @@ static RDyldLocSym *r_dyld_locsym_new(RBuffer *cache_buf, cache_hdr_t *hdr) {
 
 beach:
 	free (info);
-	free (strings);
 	free (entries);
-	free (nlists);
+	ht_up_free (entries_by_dylib);
 
 	eprintf ("dyldcache: malformed local symbols metadata\n");
 	return NULL;
@@ -228,71 +223,113 @@ static void r_dyld_locsym_free(RDyldLocSym *locsym) {
 	if (!locsym) {
 		return;
 	}
-	R_FREE (locsym->strings);
 	R_FREE (locsym->entries);
-	R_FREE (locsym->nlists);
+	ht_up_free (locsym->entries_by_dylib);
 	free (locsym);
 }
 
-static void r_dyld_locsym_entries_by_offset(RDyldCache *cache, RList *symbols, HtPP *hash, ut64 bin_header_offset) {
+static void r_dyld_locsym_entries_by_offset(RDyldCache *cache, RList *symbols, SetU *hash, ut64 bin_header_offset) {
 	RDyldLocSym *locsym = cache->locsym;
 	if (!locsym->entries) {
 		return;
 	}
 
-	ut64 i;
-	for (i = 0; i != locsym->entries_count; i++) {
-		cache_locsym_entry_t *entry = &locsym->entries[i];
-		if (entry->dylibOffset != bin_header_offset) {
-			continue;
+	cache_locsym_entry_t *entry = ht_up_find (locsym->entries_by_dylib, bin_header_offset, NULL);
+	if (!entry || !entry->nlistCount) {
+		return;
+	}
+	if (entry->nlistStartIndex >= locsym->nlists_count ||
+			entry->nlistStartIndex + entry->nlistCount > locsym->nlists_count) {
+		eprintf ("dyldcache: malformed local symbol entry\n");
+		return;
+	}
+
+	// read only the nlists of this image and the strings they point to
+	ut64 nlists_size = sizeof (struct MACH0_(nlist)) * entry->nlistCount;
+	struct MACH0_(nlist) *nlists = R_NEWS0 (struct MACH0_(nlist), entry->nlistCount);
+	if (!nlists) {
+		return;
+	}
+	ut64 nlists_at = locsym->nlists_offset + sizeof (struct MACH0_(nlist)) * entry->nlistStartIndex;
+	if (r_buf_fread_at (cache->buf, nlists_at, (ut8*) nlists, "iccsl", entry->nlistCount) != nlists_size) {
+		free (nlists);
+		return;
+	}
+	ut64 strx_min = UT64_MAX, strx_max = 0;
+	ut32 j;
+	for (j = 0; j != entry->nlistCount; j++) {
+		ut64 strx = nlists[j].n_strx;
+		if (strx < locsym->strings_size) {
+			strx_min = R_MIN (strx_min, strx);
+			strx_max = R_MAX (strx_max, strx);
+		}
+	}
+	const char *strings = NULL;
+	char *owned = NULL;
+	ut64 strings_size = 0;
+	RMmap *map = cache->map;
+	if (map && locsym->strings_offset + locsym->strings_size <= (ut64)map->len) {
+		// the names are used in place from the mapped file
+		strx_min = 0;
+		strings = (const char *)map->buf + locsym->strings_offset;
+		strings_size = locsym->strings_size;
+	}
+	ut64 extra = 256;
+	while (!strings && strx_min != UT64_MAX) {
+		// read past the last name until its terminator is in the buffer
+		strings_size = R_MIN (strx_max + extra, locsym->strings_size) - strx_min;
+		owned = malloc (strings_size);
+		if (!owned || r_buf_read_at (cache->buf, locsym->strings_offset + strx_min,
+				(ut8*) owned, strings_size) != strings_size) {
+			free (owned);
+			free (nlists);
+			return;
+		}
+		ut64 last = strx_max - strx_min;
+		if (memchr (owned + last, 0, strings_size - last) || strx_min + strings_size >= locsym->strings_size) {
+			strings = owned;
+			break;
 		}
+		R_FREE (owned);
+		extra *= 2;
+	}
 
-		if (entry->nlistStartIndex >= locsym->nlists_count ||
-				entry->nlistStartIndex + entry->nlistCount > locsym->nlists_count) {
-			eprintf ("dyldcache: malformed local symbol entry\n");
+	for (j = 0; j != entry->nlistCount; j++) {
+		struct MACH0_(nlist) *nlist = &nlists[j];
+		if (set_u_contains (hash, nlist->n_value)) {
+			continue;
+		}
+		set_u_add (hash, nlist->n_value);
+		if (nlist->n_strx >= locsym->strings_size) {
+			continue;
+		}
+		const char *symstr = &strings[nlist->n_strx - strx_min];
+		RBinSymbol *sym = R_NEW0 (RBinSymbol);
+		if (!sym) {
 			break;
 		}
+		sym->type = "LOCAL";
+		sym->vaddr = nlist->n_value;
+		sym->paddr = va2pa (nlist->n_value, cache->hdr, cache->maps, cache->buf, cache->rebase_info->slide, NULL, NULL);
 
-		ut32 j;
-		for (j = 0; j != entry->nlistCount; j++) {
-			struct MACH0_(nlist) *nlist = &locsym->nlists[j + entry->nlistStartIndex];
-			bool found;
-			const char *key = sdb_fmt ("%"PFMT64x, nlist->n_value);
-			ht_pp_find (hash, key, &found);
-			if (found) {
-				continue;
-			}
-			ht_pp_insert (hash, key, "1");
-			if (nlist->n_strx >= locsym->strings_size) {
-				continue;
-			}
-			char *symstr = &locsym->strings[nlist->n_strx];
-			RBinSymbol *sym = R_NEW0 (RBinSymbol);
-			if (!sym) {
-				return;
-			}
-			sym->type = "LOCAL";
-			sym->vaddr = nlist->n_value;
-			sym->paddr = va2pa (nlist->n_value, cache->hdr, cache->maps, cache->buf, cache->rebase_info->slide, NULL, NULL);
-
-			int len = locsym->strings_size - nlist->n_strx;
-			ut32 k;
-			for (k = 0; k < len; k++) {
-				if (((ut8) symstr[k] & 0xff) == 0xff || !symstr[k]) {
-					len = k;
-					break;
-				}
-			}
-			if (len > 0) {
-				sym->name = r_str_ndup (symstr, len);
-			} else {
-				sym->name = r_str_newf ("unk_local%d", k);
+		int len = strings_size - (nlist->n_strx - strx_min);
+		ut32 k;
+		for (k = 0; k < len; k++) {
+			if (((ut8) symstr[k] & 0xff) == 0xff || !symstr[k]) {
+				len = k;
+				break;
 			}
-
-			r_list_append (symbols, sym);
 		}
-		break;
+		if (len > 0) {
+			sym->name = r_str_ndup (symstr, len);
+		} else {
+			sym->name = r_str_newf ("unk_local%d", k);
+		}
+
+		r_list_append (symbols, sym);
 	}
+	free (owned);
+	free (nlists);
 }
 
 static void r_dyldcache_free(RDyldCache *cache) {
@@ -304,6 +341,8 @@ static void r_dyldcache_free(RDyldCache *cache) {
 	cache->bins = NULL;
 	r_buf_free (cache->buf);
 	cache->buf = NULL;
+	r_file_mmap_free (cache->map);
+	cache->map = NULL;
 	rebase_info_free (cache->rebase_info);
 	cache->rebase_info = NULL;
 	R_FREE (cache->hdr);
@@ -874,6 +913,7 @@ static RList *create_cache_bins(RBinFile *bf, RBuffer *cache_buf, cache_hdr_t *h
 
 	int i;
 	int *deps = NULL;
+	bool *targets = NULL;
 	char *target_libs = NULL;
 	target_libs = r_sys_getenv ("R_DYLDCACHE_FILTER");
 	RList *target_lib_names = NULL;
@@ -886,7 +926,8 @@ static RList *create_cache_bins(RBinFile *bf, RBuffer *cache_buf, cache_hdr_t *h
 		}
 
 		deps = R_NEWS0 (int, hdr->imagesCount);
-		if (!deps) {
+		targets = R_NEWS0 (bool, hdr->imagesCount);
+		if (!deps || !targets) {
 			goto error;
 		}
 
@@ -924,6 +965,7 @@ static RList *create_cache_bins(RBinFile *bf, RBuffer *cache_buf, cache_hdr_t *h
 			eprintf ("FILTER: %s\n", lib_name);
 			R_FREE (lib_name);
 			deps[i]++;
+			targets[i] = true;
 
 			if (extras && depArray) {
 				ut32 j;
@@ -974,6 +1016,7 @@ static RList *create_cache_bins(RBinFile *bf, RBuffer *cache_buf, cache_hdr_t *h
 				goto error;
 			}
 			bin->header_at = pa;
+			bin->locals = targets && targets[i];
 			if (r_buf_read_at (cache_buf, img[i].pathFileOffset, (ut8*) &file, sizeof (file)) == sizeof (file)) {
 				file[255] = 0;
 				char *last_slash = strrchr (file, '/');
@@ -1018,6 +1061,7 @@ beach:
 		r_list_free (target_lib_names);
 	}
 	R_FREE (deps);
+	R_FREE (targets);
 	R_FREE (img);
 	return bins;
 }
@@ -1348,6 +1392,22 @@ static cache_accel_t *read_cache_accel(RBuffer *cache_buf, cache_hdr_t *hdr, cac
 	return accel;
 }
 
+// map the cache file when the buffer is the whole of a local file, so the
+// local symbol names can be used from it without reading them. RMmap can
+// not describe files past 2GB, those keep reading through the buffer
+static RMmap *dyldcache_map(RBinFile *bf, RBuffer *buf) {
+	ut64 size = r_buf_size (buf);
+	if (!bf->file || size > ST32_MAX || !r_file_is_regular (bf->file) || r_file_size (bf->file) != size) {
+		return NULL;
+	}
+	RMmap *map = r_file_mmap (bf->file, false, 0);
+	if (map && (ut64)map->len != size) {
+		r_file_mmap_free (map);
+		return NULL;
+	}
+	return map;
+}
+
 static bool load_buffer(RBinFile *bf, void **bin_obj, RBuffer *buf, ut64 loadaddr, Sdb *sdb) {
 	RDyldCache *cache = R_NEW0 (RDyldCache);
 	memcpy (cache->magic, "dyldcac", 7);
@@ -1363,6 +1423,7 @@ static bool load_buffer(RBinFile *bf, void **bin_obj, RBuffer *buf, ut64 loadadd
 		return false;
 	}
 	cache->accel = read_cache_accel (cache->buf, cache->hdr, cache->maps);
+	cache->map = dyldcache_map (bf, buf);
 	cache->locsym = r_dyld_locsym_new (cache->buf, cache->hdr);
 	if (!cache->locsym) {
 		r_dyldcache_free (cache);
@@ -1448,7 +1509,7 @@ static ut64 baddr(RBinFile *bf) {
 	return 0x180000000;
 }
 
-void symbols_from_bin(RList *ret, RBinFile *bf, RDyldBinImage *bin, HtPP *hash) {
+static void symbols_from_bin(RList *ret, RBinFile *bf, RDyldBinImage *bin, SetU *hash) {
 	struct MACH0_(obj_t) *mach0 = bin_to_mach0 (bf, bin);
 	if (!mach0) {
 		return;
@@ -1457,6 +1518,7 @@ void symbols_from_bin(RList *ret, RBinFile *bf, RDyldBinImage *bin, HtPP *hash)
 	// const RList*symbols = MACH0_(get_symbols_list) (mach0);
 	const struct symbol_t *symbols = MACH0_(get_symbols) (mach0);
 	if (!symbols) {
+		MACH0_(mach0_free) (mach0);
 		return;
 	}
 	int i;
@@ -1480,8 +1542,7 @@ void symbols_from_bin(RList *ret, RBinFile *bf, RDyldBinImage *bin, HtPP *hash)
 		sym->size = symbols[i].size;
 		sym->ordinal = i;
 
-		const char *key = sdb_fmt ("%"PFMT64x, sym->vaddr);
-		ht_pp_insert (hash, key, "1");
+		set_u_add (hash, sym->vaddr);
 		r_list_append (ret, sym);
 	}
 	MACH0_(mach0_free) (mach0);
@@ -1604,15 +1665,24 @@ static RList *symbols(RBinFile *bf) {
 
 	RListIter *iter;
 	RDyldBinImage *bin;
+	bool locals = false;
 	r_list_foreach (cache->bins, iter, bin) {
-		HtPP *hash = ht_pp_new0 ();
+		SetU *hash = set_u_new ();
 		if (!hash) {
 			r_list_free (ret);
 			return NULL;
 		}
 		symbols_from_bin (ret, bf, bin, hash);
-		r_dyld_locsym_entries_by_offset (cache, ret, hash, bin->header_at);
-		ht_pp_free (hash);
+		// the local symbols are the bulk of a cache, only decode them for
+		// the images that were asked for and not for their dependencies
+		if (bin->locals) {
+			r_dyld_locsym_entries_by_offset (cache, ret, hash, bin->header_at);
+			locals = true;
+		}
+		set_u_free (hash);
+	}
+	if (!locals && cache->locsym->entries_count) {
+		eprintf ("dyldcache: use R_DYLDCACHE_FILTER to load the local symbols of an image\n");
 	}
 
 	if (cache->rebase_info->slide > 0) {
@@ -31,6 +31,9 @@ R_API RBreakpoint *r_bp_new(void) {
 	bp->traces = r_bp_traptrace_new ();
 	bp->cb_printf = (PrintfCallback)printf;
 	bp->bps = r_list_newf ((RListFree)r_bp_item_free);
+	bp->bps_at = ht_up_new0 ();
+	r_interval_tree_init (&bp->bps_in, NULL);
+	r_vector_init (&bp->cov_addrs, sizeof (ut64), NULL, NULL);
 	bp->plugins = r_list_newf ((RListFree)free);
 	bp->nhwbps = 0;
 	for (i = 0; bp_static_plugins[i]; i++) {
@@ -48,6 +51,12 @@ R_API RBreakpoint *r_bp_free(RBreakpoint *bp) {
 	r_list_free (bp->plugins);
 	r_list_free (bp->traces);
 	free (bp->bps_idx);
+	ht_up_free (bp->bps_at);
+	r_interval_tree_fini (&bp->bps_in);
+	r_vector_fini (&bp->cov_addrs);
+	if (bp->cov_hits) {
+		r_bitmap_free (bp->cov_hits);
+	}
 	free (bp);
 	return NULL;
 }
@@ -89,35 +98,76 @@ repeat:
 }
 
 R_API RBreakpointItem *r_bp_get_at(RBreakpoint *bp, ut64 addr) {
-	RListIter *iter;
+	return ht_up_find (bp->bps_at, addr, NULL);
+}
+
+static inline bool matchProt(RBreakpointItem *b, int perm) {
+	return (!perm || (perm && b->perm));
+}
+
+typedef struct {
+	int perm;
 	RBreakpointItem *b;
-	r_list_foreach(bp->bps, iter, b) {
-		if (b->addr == addr) {
-			return b;
-		}
+} BpInCtx;
+
+static bool bp_in_cb(RIntervalNode *node, void *user) {
+	BpInCtx *ctx = user;
+	RBreakpointItem *b = node->data;
+	if (matchProt (b, ctx->perm)) {
+		ctx->b = b;
+		return false;
 	}
-	return NULL;
+	return true;
 }
 
-static inline bool inRange(RBreakpointItem *b, ut64 addr) {
-	return (addr >= b->addr && addr < (b->addr + b->size));
+R_API RBreakpointItem *r_bp_get_in(RBreakpoint *bp, ut64 addr, int perm) {
+	// Check addr within range and provided perm matches (or null)
+	BpInCtx ctx = { perm, NULL };
+	r_interval_tree_all_in (&bp->bps_in, addr, false, bp_in_cb, &ctx);
+	return ctx.b;
 }
 
-static inline bool matchProt(RBreakpointItem *b, int perm) {
-	return (!perm || (perm && b->perm));
+static bool bp_first_cb(RIntervalNode *node, void *user) {
+	*(RBreakpointItem **)user = node->data;
+	return false;
 }
 
-R_API RBreakpointItem *r_bp_get_in(RBreakpoint *bp, ut64 addr, int perm) {
-	RBreakpointItem *b;
-	RListIter *iter;
-	r_list_foreach (bp->bps, iter, b) {
-		// eprintf ("---ataddr--- 0x%08"PFMT64x" %d %d %x\n", b->addr, b->size, b->recoil, b->perm);
-		// Check addr within range and provided perm matches (or null)
-		if (inRange (b, addr) && matchProt (b, perm)) {
-			return b;
+static void indexBreakpoint(RBreakpoint *bp, RBreakpointItem *b) {
+	if (!ht_up_find (bp->bps_at, b->addr, NULL)) {
+		ht_up_insert (bp->bps_at, b->addr, b);
+	}
+	r_interval_tree_insert (&bp->bps_in, b->addr, b->addr + R_MAX (b->size, 1), b);
+}
+
+static void unindexBreakpoint(RBreakpoint *bp, RBreakpointItem *b) {
+	RIntervalNode *node = r_interval_tree_node_at_data (&bp->bps_in, b->addr, b);
+	if (!node) {
+		return;
+	}
+	r_interval_tree_delete (&bp->bps_in, node, false);
+	if (ht_up_find (bp->bps_at, b->addr, NULL) == b) {
+		// another breakpoint may still start at the same address
+		RBreakpointItem *other = NULL;
+		r_interval_tree_all_at (&bp->bps_in, b->addr, bp_first_cb, &other);
+		if (other) {
+			ht_up_update (bp->bps_at, b->addr, other);
+		} else {
+			ht_up_delete (bp->bps_at, b->addr);
 		}
 	}
-	return NULL;
+}
+
+R_IPI void r_bp_item_link(RBreakpoint *bp, RBreakpointItem *b) {
+	r_list_append (bp->bps, b);
+	indexBreakpoint (bp, b);
+}
+
+R_API void r_bp_item_relocate(RBreakpoint *bp, RBreakpointItem *b, ut64 addr) {
+	if (b->addr != addr) {
+		unindexBreakpoint (bp, b);
+		b->addr = addr;
+		indexBreakpoint (bp, b);
+	}
 }
 
 R_API RBreakpointItem *r_bp_enable(RBreakpoint *bp, ut64 addr, int set, int count) {
@@ -145,13 +195,17 @@ R_API int r_bp_stepy_continuation(RBreakpoint *bp) {
 }
 
 static void unlinkBreakpoint(RBreakpoint *bp, RBreakpointItem *b) {
-	int i;
-	for (i = 0; i < bp->bps_idx_count; i++) {
-		if (bp->bps_idx[i] == b) {
-			bp->bps_idx[i] = NULL;
+	if (b->idx >= 0 && b->idx < bp->bps_idx_count && bp->bps_idx[b->idx] == b) {
+		bp->bps_idx[b->idx] = NULL;
+		if (b->idx < bp->bps_idx_free) {
+			bp->bps_idx_free = b->idx;
 		}
 	}
-	r_list_delete_data (bp->bps, b);
+	unindexBreakpoint (bp, b);
+	if (!r_list_delete_data (bp->bps, b)) {
+		// not linked yet
+		r_bp_item_free (b);
+	}
 }
 
 /* TODO: detect overlapping of breakpoints */
@@ -182,12 +236,13 @@ static RBreakpointItem *r_bp_add(RBreakpoint *bp, const ut8 *obytes, ut64 addr,
 	if (!hw) {
 		b->bbytes = calloc (size + 16, 1);
 		if (!b->bbytes) {
+			unlinkBreakpoint (bp, b);
 			return NULL;
 		}
 		if (obytes) {
 			b->obytes = malloc (size);
 			if (!b->obytes) {
-				free (b->bbytes);
+				unlinkBreakpoint (bp, b);
 				return NULL;
 			}
 			memcpy (b->obytes, obytes, size);
@@ -204,7 +259,7 @@ static RBreakpointItem *r_bp_add(RBreakpoint *bp, const ut8 *obytes, ut64 addr,
 		b->recoil = ret;
 	}
 	bp->nbps++;
-	r_list_append (bp->bps, b);
+	r_bp_item_link (bp, b);
 	return b;
 }
 
@@ -235,6 +290,140 @@ R_API RBreakpointItem* r_bp_add_hw(RBreakpoint *bp, ut64 addr, int size, int per
 	return r_bp_add (bp, NULL, addr, size, R_BP_TYPE_HW, perm);
 }
 
+#define BP_PAGE_SIZE 0x1000
+
+static int cov_addr_cmp(const void *a, const void *b) {
+	ut64 x = *(const ut64 *)a;
+	ut64 y = *(const ut64 *)b;
+	return (x > y) - (x < y);
+}
+
+static bool cov_hits_grow(RBreakpoint *bp, size_t count) {
+	RBitmap *hits = r_bitmap_new (count);
+	if (!hits || !hits->bitmap) {
+		free (hits);
+		return false;
+	}
+	if (bp->cov_hits) {
+		size_t i;
+		for (i = 0; i < bp->cov_hits->length; i++) {
+			if (r_bitmap_test (bp->cov_hits, i) == 1) {
+				r_bitmap_set (hits, i);
+			}
+		}
+		r_bitmap_free (bp->cov_hits);
+	}
+	bp->cov_hits = hits;
+	return true;
+}
+
+/* Add one-shot breakpoints at all the given addresses, typically every basic
+ * block start. Hitting one records it in bp->cov_hits and removes it without
+ * stopping (see r_debug_continue_kill). The original bytes are read one page
+ * at a time. Returns the number of breakpoints added. */
+R_API int r_bp_add_coverage(RBreakpoint *bp, const ut64 *addrs, int count) {
+	r_return_val_if_fail (bp, 0);
+	int size = r_bp_size (bp);
+	if (!addrs || count < 1 || size < 1) {
+		return 0;
+	}
+	ut64 *sorted = r_mem_dup (addrs, count * sizeof (ut64));
+	ut8 *page = malloc (BP_PAGE_SIZE + size);
+	if (!sorted || !page || !cov_hits_grow (bp, bp->cov_addrs.len + count)) {
+		free (sorted);
+		free (page);
+		return 0;
+	}
+	qsort (sorted, count, sizeof (ut64), cov_addr_cmp);
+	ut64 page_addr = UT64_MAX;
+	int i, added = 0;
+	for (i = 0; i < count; i++) {
+		ut64 addr = sorted[i];
+		if ((i && addr == sorted[i - 1]) || addr == UT64_MAX || r_bp_get_in (bp, addr, 0)) {
+			continue;
+		}
+		if ((addr & ~(ut64)(BP_PAGE_SIZE - 1)) != page_addr) {
+			page_addr = addr & ~(ut64)(BP_PAGE_SIZE - 1);
+			memset (page, 0, BP_PAGE_SIZE + size);
+			if (bp->iob.read_at) {
+				bp->iob.read_at (bp->iob.io, page_addr, page, BP_PAGE_SIZE + size);
+			}
+		}
+		RBreakpointItem *b = r_bp_add (bp, page + (addr - page_addr), addr, size, R_BP_TYPE_SW, R_BP_PROT_EXEC);
+		if (!b) {
+			continue;
+		}
+		b->coverage = true;
+		b->cov_idx = bp->cov_addrs.len;
+		r_vector_push (&bp->cov_addrs, &addr);
+		added++;
+	}
+	free (page);
+	free (sorted);
+	return added;
+}
+
+/* Record a hit on a coverage breakpoint and disable it so it won't be
+ * written back. Returns false if b isn't a coverage breakpoint. */
+R_API bool r_bp_coverage_hit(RBreakpoint *bp, RBreakpointItem *b) {
+	r_return_val_if_fail (bp && b, false);
+	if (!b->coverage) {
+		return false;
+	}
+	if (bp->cov_hits) {
+		r_bitmap_set (bp->cov_hits, b->cov_idx);
+	}
+	b->hits++;
+	b->enabled = false;
+	return true;
+}
+
+/* Remove all pending coverage breakpoints and forget the recorded hits */
+R_API int r_bp_del_coverage(RBreakpoint *bp) {
+	RListIter *iter, *iter2;
+	RBreakpointItem *b;
+	int n = 0;
+	r_list_foreach_safe (bp->bps, iter, iter2, b) {
+		if (b->coverage) {
+			unlinkBreakpoint (bp, b);
+			n++;
+		}
+	}
+	r_vector_clear (&bp->cov_addrs);
+	if (bp->cov_hits) {
+		r_bitmap_free (bp->cov_hits);
+		bp->cov_hits = NULL;
+	}
+	return n;
+}
+
+/* List the addresses of the coverage breakpoints hit so far */
+R_API int r_bp_coverage_list(RBreakpoint *bp, int rad) {
+	size_t i, total = bp->cov_addrs.len;
+	int n = 0;
+	if (rad == 'j') {
+		bp->cb_printf ("[");
+	}
+	for (i = 0; i < total; i++) {
+		if (r_bitmap_test (bp->cov_hits, i) != 1) {
+			continue;
+		}
+		ut64 addr = *(ut64 *)r_vector_index_ptr (&bp->cov_addrs, i);
+		if (rad == 'j') {
+			bp->cb_printf ("%s%"PFMT64d, n? ",": "", addr);
+		} else if (rad != 's') {
+			bp->cb_printf ("0x%08"PFMT64x"\n", addr);
+		}
+		n++;
+	}
+	if (rad == 'j') {
+		bp->cb_printf ("]\n");
+	} else if (rad == 's') {
+		bp->cb_printf ("%d/%d\n", n, (int)total);
+	}
+	return n;
+}
+
 R_API int r_bp_del_all(RBreakpoint *bp) {
 	int i;
 	if (!r_list_empty (bp->bps)) {
@@ -242,21 +431,21 @@ R_API int r_bp_del_all(RBreakpoint *bp) {
 		for (i = 0; i < bp->bps_idx_count; i++) {
 			bp->bps_idx[i] = NULL;
 		}
+		bp->bps_idx_free = 0;
+		ht_up_free (bp->bps_at);
+		bp->bps_at = ht_up_new0 ();
+		r_interval_tree_fini (&bp->bps_in);
+		r_interval_tree_init (&bp->bps_in, NULL);
 		return true;
 	}
 	return false;
 }
 
 R_API int r_bp_del(RBreakpoint *bp, ut64 addr) {
-	RListIter *iter;
-	RBreakpointItem *b;
-	/* No _safe loop necessary because we return immediately after the delete. */
-	r_list_foreach (bp->bps, iter, b) {
-		if (b->addr == addr) {
-			unlinkBreakpoint (bp, b);
-			// r_list_delete (bp->bps, iter);
-			return true;
-		}
+	RBreakpointItem *b = r_bp_get_at (bp, addr);
+	if (b) {
+		unlinkBreakpoint (bp, b);
+		return true;
 	}
 	return false;
 }
@@ -350,26 +539,31 @@ R_API int r_bp_list(RBreakpoint *bp, int rad) {
 
 R_API RBreakpointItem *r_bp_item_new (RBreakpoint *bp) {
 	int i, j;
-	/* find empty slot */
-	for (i = 0; i < bp->bps_idx_count; i++) {
+	/* find empty slot, there are none below bps_idx_free */
+	for (i = bp->bps_idx_free; i < bp->bps_idx_count; i++) {
 		if (!bp->bps_idx[i]) {
 			goto return_slot;
 		}
 	}
-	/* allocate new slot */
-	bp->bps_idx_count += 16; // allocate space for 16 more bps
-	RBreakpointItem **newbps = realloc (bp->bps_idx, bp->bps_idx_count * sizeof (RBreakpointItem*));
-	if (newbps) {
-		bp->bps_idx = newbps;
-	} else {
-		bp->bps_idx_count -= 16; // allocate space for 16 more bps
+	/* allocate new slots */
+	int count = R_MAX (bp->bps_idx_count * 2, 16);
+	RBreakpointItem **newbps = realloc (bp->bps_idx, count * sizeof (RBreakpointItem*));
+	if (!newbps) {
+		return NULL;
 	}
+	bp->bps_idx = newbps;
+	bp->bps_idx_count = count;
 	for (j = i; j < bp->bps_idx_count; j++) {
 		bp->bps_idx[j] = NULL;
 	}
 return_slot:
 	/* empty slot */
-	return (bp->bps_idx[i] = R_NEW0 (RBreakpointItem));
+	bp->bps_idx_free = i + 1;
+	bp->bps_idx[i] = R_NEW0 (RBreakpointItem);
+	if (bp->bps_idx[i]) {
+		bp->bps_idx[i]->idx = i;
+	}
+	return bp->bps_idx[i];
 }
 
 R_API RBreakpointItem *r_bp_get_index(RBreakpoint *bp, int idx) {
@@ -380,19 +574,13 @@ R_API RBreakpointItem *r_bp_get_index(RBreakpoint *bp, int idx) {
 }
 
 R_API int r_bp_get_index_at (RBreakpoint *bp, ut64 addr) {
-	int i;
-	for (i = 0; i< bp->bps_idx_count; i++) {
-		if (bp->bps_idx[i] && bp->bps_idx[i]->addr == addr) {
-			return i;
-		}
-	}
-	return -1;
+	RBreakpointItem *b = r_bp_get_at (bp, addr);
+	return b? b->idx: -1;
 }
 
 R_API int r_bp_del_index(RBreakpoint *bp, int idx) {
-	if (idx >= 0 && idx < bp->bps_idx_count) {
-		r_list_delete_data (bp->bps, bp->bps_idx[idx]);
-		bp->bps_idx[idx] = 0;
+	if (idx >= 0 && idx < bp->bps_idx_count && bp->bps_idx[idx]) {
+		unlinkBreakpoint (bp, bp->bps_idx[idx]);
 		return true;
 	}
 	return false;
@@ -3,22 +3,38 @@
 #include <r_bp.h>
 #include <config.h>
 
-R_API void r_bp_restore_one(RBreakpoint *bp, RBreakpointItem *b, bool set) {
+// breakpoints are not changes to the code, they send no R_EVENT_IO_WRITE
+static bool bp_write_at(RBreakpoint *bp, ut64 addr, const ut8 *buf, int len) {
+	RIO *io = bp->iob.io;
+	if (io) {
+		io->ev_lock++;
+	}
+	bool ret = bp->iob.write_at (io, addr, buf, len);
+	if (io) {
+		io->ev_lock--;
+	}
+	return ret;
+}
+
+static bool restore_one(RBreakpoint *bp, RBreakpointItem *b, bool set) {
 	if (set) {
 		//eprintf ("Setting bp at 0x%08"PFMT64x"\n", b->addr);
 		if (b->hw || !b->bbytes) {
 			eprintf ("hw breakpoints not yet supported\n");
-		} else {
-			bp->iob.write_at (bp->iob.io, b->addr, b->bbytes, b->size);
-		}
-	} else {
-		//eprintf ("Clearing bp at 0x%08"PFMT64x"\n", b->addr);
-		if (b->hw || !b->obytes) {
-			eprintf ("hw breakpoints not yet supported\n");
-		} else {
-			bp->iob.write_at (bp->iob.io, b->addr, b->obytes, b->size);
+			return true;
 		}
+		return bp_write_at (bp, b->addr, b->bbytes, b->size);
 	}
+	//eprintf ("Clearing bp at 0x%08"PFMT64x"\n", b->addr);
+	if (b->hw || !b->obytes) {
+		eprintf ("hw breakpoints not yet supported\n");
+		return true;
+	}
+	return bp_write_at (bp, b->addr, b->obytes, b->size);
+}
+
+R_API void r_bp_restore_one(RBreakpoint *bp, RBreakpointItem *b, bool set) {
+	restore_one (bp, b, set);
 }
 
 /**
@@ -28,6 +44,47 @@ R_API int r_bp_restore(RBreakpoint *bp, bool set) {
 	return r_bp_restore_except (bp, set, UT64_MAX);
 }
 
+#define BP_PAGE_MASK (~(ut64)0xfff)
+
+/* write the (o|b)bytes of an address-sorted run of breakpoints living in
+ * the same page with a single read-modify-write of the whole span */
+static bool restore_each(RBreakpoint *bp, RPVector *run, bool set) {
+	bool ret = true;
+	void **it;
+	r_pvector_foreach (run, it) {
+		ret &= restore_one (bp, *it, set);
+	}
+	return ret;
+}
+
+static bool restore_run(RBreakpoint *bp, RPVector *run, bool set) {
+	if (r_pvector_len (run) == 1) {
+		return restore_one (bp, r_pvector_at (run, 0), set);
+	}
+	RBreakpointItem *first = r_pvector_at (run, 0);
+	ut64 from = first->addr, to = from;
+	void **it;
+	r_pvector_foreach (run, it) {
+		RBreakpointItem *b = *it;
+		to = R_MAX (to, b->addr + b->size);
+	}
+	int len = (int)(to - from);
+	ut8 *buf = malloc (len);
+	// the span includes the bytes between the breakpoints, never write
+	// them back unless they were read
+	if (!buf || !bp->iob.read_at (bp->iob.io, from, buf, len)) {
+		free (buf);
+		return restore_each (bp, run, set);
+	}
+	r_pvector_foreach (run, it) {
+		RBreakpointItem *b = *it;
+		memcpy (buf + (b->addr - from), set? b->bbytes: b->obytes, b->size);
+	}
+	bool ret = bp_write_at (bp, from, buf, len);
+	free (buf);
+	return ret;
+}
+
 /**
  * reflect all r_bp stuff in the process using dbg->bp_write or ->breakpoint
  *
@@ -35,14 +92,16 @@ R_API int r_bp_restore(RBreakpoint *bp, bool set) {
  */
 R_API bool r_bp_restore_except(RBreakpoint *bp, bool set, ut64 addr) {
 	bool rc = true;
-	RListIter *iter;
+	RIntervalTreeIter iter;
 	RBreakpointItem *b;
+	RPVector run;
 
 	if (set && bp->bpinmaps) {
 		bp->corebind.syncDebugMaps (bp->corebind.core);
 	}
 
-	r_list_foreach (bp->bps, iter, b) {
+	r_pvector_init (&run, NULL);
+	r_interval_tree_foreach (&bp->bps_in, iter, b) {
 		if (addr && b->addr == addr) {
 			continue;
 		}
@@ -59,8 +118,22 @@ R_API bool r_bp_restore_except(RBreakpoint *bp, bool set, ut64 addr) {
 		}
 
 		/* write (o|b)bytes from every breakpoint in r_bp if not handled by plugin */
-		r_bp_restore_one (bp, b, set);
-		rc = true;
+		if (b->hw || !(set? b->bbytes: b->obytes)) {
+			rc &= restore_one (bp, b, set);
+			continue;
+		}
+		if (!r_pvector_empty (&run)) {
+			RBreakpointItem *head = r_pvector_at (&run, 0);
+			if ((head->addr & BP_PAGE_MASK) != (b->addr & BP_PAGE_MASK)) {
+				rc &= restore_run (bp, &run, set);
+				r_pvector_clear (&run);
+			}
+		}
+		r_pvector_push (&run, b);
+	}
+	if (!r_pvector_empty (&run)) {
+		rc &= restore_run (bp, &run, set);
 	}
+	r_pvector_fini (&run);
 	return rc;
 }
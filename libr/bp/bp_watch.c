@@ -18,6 +18,9 @@ R_API RBreakpointItem* r_bp_watch_add(RBreakpoint *bp, ut64 addr, int size, int
 		return NULL;
 	}
 	b = r_bp_item_new (bp);
+	if (!b) {
+		return NULL;
+	}
 	b->addr = addr + bp->delta;
 	b->size = size;
 	b->enabled = true;
@@ -30,7 +33,7 @@ R_API RBreakpointItem* r_bp_watch_add(RBreakpoint *bp, ut64 addr, int size, int
 		/* TODO */
 	}
 	bp->nbps++;
-	r_list_append (bp->bps, b);
+	r_bp_item_link (bp, b);
 	return b;
 }
 
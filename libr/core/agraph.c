@@ -47,11 +47,10 @@ static const char *mousemodes[] = {
 
 #define NORMALIZE_MOV(x) ((x) < 0 ? -1 : ((x) > 0 ? 1 : 0))
 
-#define hash_set(sdb, k, v) (sdb_num_set (sdb, sdb_fmt ("%"PFMT64u, (ut64) (size_t) (k)), (ut64) (size_t) (v), 0))
-#define hash_get(sdb, k) (sdb_num_get (sdb, sdb_fmt ("%"PFMT64u, (ut64) (size_t) (k)), NULL))
-#define hash_get_rnode(sdb, k) ((RGraphNode *) (size_t) hash_get (sdb, k))
-#define hash_get_rlist(sdb, k) ((RList *) (size_t) hash_get (sdb, k))
-#define hash_get_int(sdb, k) ((int) hash_get (sdb, k))
+/* layers with more nodes than this are ordered with the barycenter
+ * heuristic instead of the quadratic crossing matrix */
+#define LAYER_MATRIX_MAX 64
+
 /* don't use macros for this */
 #define get_anode(gn) ((gn)? (RANode *) (gn)->data: NULL)
 
@@ -63,12 +62,6 @@ struct len_pos_t {
 	int pos;
 };
 
-struct dist_t {
-	const RGraphNode *from;
-	const RGraphNode *to;
-	int dist;
-};
-
 struct g_cb {
 	RAGraph *graph;
 	RANodeCallback node_cb;
@@ -775,18 +768,88 @@ static void create_layers(RAGraph *g) {
 	}
 }
 
+struct bary_t {
+	RGraphNode *gn;
+	int bary; /* average position of the neighbours, scaled by 256 */
+	int pos;
+};
+
+static int bary_cmp(const void *a, const void *b) {
+	const struct bary_t *ba = a, *bb = b;
+	if (ba->bary != bb->bary) {
+		return ba->bary < bb->bary? -1: 1;
+	}
+	return ba->pos - bb->pos;
+}
+
+/* barycenter heuristic: sort the layer by the mean position of the
+ * neighbours in the previous (from_up) or next layer. Linear in the number
+ * of edges, used for the layers where the crossing matrix is too big */
+static int layer_sweep_bary(const RGraph *g, const struct layer_t layers[], int maxlayer, int i, int from_up) {
+	int j, len = layers[i].n_nodes, changed = false;
+	int adj = from_up? i - 1: i + 1;
+	if (adj < 0 || adj >= maxlayer) {
+		return false;
+	}
+	struct bary_t *b = R_NEWS (struct bary_t, len);
+	if (!b) {
+		return -1;
+	}
+	for (j = 0; j < len; j++) {
+		RGraphNode *gn = layers[i].nodes[j];
+		const RList *neigh = from_up? r_graph_innodes (g, gn): r_graph_get_neighbours (g, gn);
+		const RListIter *it;
+		const RGraphNode *gk;
+		const RANode *ak;
+		int sum = 0, n = 0;
+		graph_foreach_anode (neigh, it, gk, ak) {
+			if (ak->layer == adj) {
+				sum += ak->pos_in_layer;
+				n++;
+			}
+		}
+		b[j].gn = gn;
+		b[j].pos = j;
+		/* nodes without neighbours there keep their place */
+		b[j].bary = n? (sum * 256) / n: j * 256;
+	}
+	qsort (b, len, sizeof (struct bary_t), bary_cmp);
+	for (j = 0; j < len; j++) {
+		if (b[j].pos != j) {
+			changed = true;
+		}
+		layers[i].nodes[j] = b[j].gn;
+		get_anode (b[j].gn)->pos_in_layer = j;
+	}
+	free (b);
+	return changed;
+}
+
+static int layer_sweep_any(const RGraph *g, const struct layer_t layers[], int maxlayer, int i, int from_up) {
+	if (r_cons_is_breaked ()) {
+		return -1;
+	}
+	if (layers[i].n_nodes > LAYER_MATRIX_MAX) {
+		return layer_sweep_bary (g, layers, maxlayer, i, from_up);
+	}
+	return layer_sweep (g, layers, maxlayer, i, from_up);
+}
+
 /* layer-by-layer sweep */
 /* it permutes each layer, trying to find the best ordering for each layer
  * to minimize the number of crossing edges */
 static void minimize_crossings(const RAGraph *g) {
-	int i, cross_changed, max_changes = 4096;
+	int i, cross_changed;
+	/* big graphs get fewer passes, each one already costs more */
+	const int passes = R_MAX (8, R_MIN (4096, 4096 * LAYER_MATRIX_MAX / R_MAX (1, (int)g->graph->n_nodes)));
+	int max_changes = passes;
 
 	do {
 		cross_changed = false;
 		max_changes--;
 
 		for (i = 0; i < g->n_layers; i++) {
-			int rc = layer_sweep (g->graph, g->layers, g->n_layers, i, true);
+			int rc = layer_sweep_any (g->graph, g->layers, g->n_layers, i, true);
 			if (rc == -1) {
 				return;
 			}
@@ -794,14 +857,14 @@ static void minimize_crossings(const RAGraph *g) {
 		}
 	} while (cross_changed && max_changes);
 
-	max_changes = 4096;
+	max_changes = passes;
 
 	do {
 		cross_changed = false;
 		max_changes--;
 
 		for (i = g->n_layers - 1; i >= 0; i--) {
-			int rc = layer_sweep (g->graph, g->layers, g->n_layers, i, false);
+			int rc = layer_sweep_any (g->graph, g->layers, g->n_layers, i, false);
 			if (rc == -1) {
 				return;
 			}
@@ -810,27 +873,29 @@ static void minimize_crossings(const RAGraph *g) {
 	} while (cross_changed && max_changes);
 }
 
-static int find_dist(const struct dist_t *a, const struct dist_t *b) {
-	return a->from == b->from && a->to == b->to? 0: 1;
+static inline ut64 dist_key(const RGraphNode *a, const RGraphNode *b) {
+	return ((ut64)a->idx << 32) | b->idx;
+}
+
+/* distance explicitly set with set_dist_nodes */
+static bool find_dist(const RAGraph *g, const RGraphNode *a, const RGraphNode *b, int *dist) {
+	bool found = false;
+	if (g->dists) {
+		ut64 d = ht_uu_find (g->dists, dist_key (a, b), &found);
+		*dist = (int)(st64)d;
+	}
+	return found;
 }
 
 /* returns the distance between two nodes */
 /* if the distance between two nodes were explicitly set, returns that;
  * otherwise calculate the distance of two nodes on the same layer */
 static int dist_nodes(const RAGraph *g, const RGraphNode *a, const RGraphNode *b) {
-	struct dist_t d;
 	const RANode *aa, *ab;
-	RListIter *it;
-	int res = 0;
+	int res = 0, dist;
 
-	if (g->dists) {
-		d.from = a;
-		d.to = b;
-		it = r_list_find (g->dists, &d, (RListComparator) find_dist);
-		if (it) {
-			struct dist_t *old = (struct dist_t *) r_list_iter_get_data (it);
-			return old->dist;
-		}
+	if (find_dist (g, a, b, &dist)) {
+		return dist;
 	}
 
 	aa = get_anode (a);
@@ -844,17 +909,9 @@ static int dist_nodes(const RAGraph *g, const RGraphNode *a, const RGraphNode *b
 			const RGraphNode *next = g->layers[aa->layer].nodes[i + 1];
 			const RANode *anext = get_anode (next);
 			const RANode *acur = get_anode (cur);
-			int found = false;
-
-			if (g->dists) {
-				d.from = cur;
-				d.to = next;
-				it = r_list_find (g->dists, &d, (RListComparator) find_dist);
-				if (it) {
-					struct dist_t *old = (struct dist_t *) r_list_iter_get_data (it);
-					res += old->dist;
-					found = true;
-				}
+			int found = find_dist (g, cur, next, &dist);
+			if (found) {
+				res += dist;
 			}
 
 			if (acur && anext && !found) {
@@ -878,10 +935,8 @@ static int dist_nodes(const RAGraph *g, const RGraphNode *a, const RGraphNode *b
 
 /* explicitly set the distance between two nodes on the same layer */
 static void set_dist_nodes(const RAGraph *g, int l, int cur, int next) {
-	struct dist_t *d, find_el;
 	const RGraphNode *vi, *vip;
 	const RANode *avi, *avip;
-	RListIter *it;
 
 	if (!g->dists) {
 		return;
@@ -890,18 +945,8 @@ static void set_dist_nodes(const RAGraph *g, int l, int cur, int next) {
 	vip = g->layers[l].nodes[next];
 	avi = get_anode (vi);
 	avip = get_anode (vip);
-
-	find_el.from = vi;
-	find_el.to = vip;
-	it = r_list_find (g->dists, &find_el, (RListComparator) find_dist);
-	d = it? (struct dist_t *) r_list_iter_get_data (it): R_NEW0 (struct dist_t);
-
-	d->from = vi;
-	d->to = vip;
-	d->dist = (avip && avi)? avip->x - avi->x: 0;
-	if (!it) {
-		r_list_push (g->dists, d);
-	}
+	int dist = (avip && avi)? avip->x - avi->x: 0;
+	ht_uu_update (g->dists, dist_key (vi, vip), (ut64)(st64)dist);
 }
 
 static int is_valid_pos(const RAGraph *g, int l, int pos) {
@@ -912,19 +957,22 @@ static int is_valid_pos(const RAGraph *g, int l, int pos) {
 /* if v is an original node, L(v) = { v }
  * if v is a dummy node, L(v) is the set of all the dummies node that belongs
  *      to the same long edge */
-static Sdb *compute_vertical_nodes(const RAGraph *g) {
-	Sdb *res = sdb_new0 ();
+static RList **compute_vertical_nodes(const RAGraph *g) {
+	RList **res = R_NEWS0 (RList *, g->graph->last_index);
 	int i, j;
 
+	if (!res) {
+		return NULL;
+	}
 	for (i = 0; i < g->n_layers; i++) {
 		for (j = 0; j < g->layers[i].n_nodes; j++) {
 			RGraphNode *gn = g->layers[i].nodes[j];
-			const RList *Ln = hash_get_rlist (res, gn);
+			const RList *Ln = res[gn->idx];
 			const RANode *an = get_anode (gn);
 
 			if (!Ln) {
 				RList *vert = r_list_new ();
-				hash_set (res, gn, vert);
+				res[gn->idx] = vert;
 				if (an->is_dummy) {
 					RGraphNode *next = gn;
 					const RANode *anext = get_anode (next);
@@ -952,7 +1000,7 @@ static Sdb *compute_vertical_nodes(const RAGraph *g) {
  * - v E C
  * - w E C => L(v) is a subset of C
  * - w E C, the s+(w) exists and is not in any class yet => s+(w) E C */
-static RList **compute_classes(const RAGraph *g, Sdb *v_nodes, int is_left, int *n_classes) {
+static RList **compute_classes(const RAGraph *g, RList **v_nodes, int is_left, int *n_classes) {
 	int i, j, c;
 	RList **res = R_NEWS0 (RList *, g->n_layers);
 	RGraphNode *gn;
@@ -973,7 +1021,7 @@ static RList **compute_classes(const RAGraph *g, Sdb *v_nodes, int is_left, int
 			const RANode *aj = get_anode (gj);
 
 			if (aj->klass == -1) {
-				const RList *laj = hash_get_rlist (v_nodes, gj);
+				const RList *laj = v_nodes[gj->idx];
 
 				if (!res[c]) {
 					res[c] = r_list_new ();
@@ -1014,16 +1062,16 @@ static RGraphNode *get_sibling(const RAGraph *g, const RANode *n, int is_left, i
 	return res;
 }
 
-static int adjust_class_val(const RAGraph *g, const RGraphNode *gn, const RGraphNode *sibl, Sdb *res, int is_left) {
+static int adjust_class_val(const RAGraph *g, const RGraphNode *gn, const RGraphNode *sibl, int *res, int is_left) {
 	if (is_left) {
-		return hash_get_int (res, sibl) - hash_get_int (res, gn) - dist_nodes (g, gn, sibl);
+		return res[sibl->idx] - res[gn->idx] - dist_nodes (g, gn, sibl);
 	}
-	return hash_get_int (res, gn) - hash_get_int (res, sibl) - dist_nodes (g, sibl, gn);
+	return res[gn->idx] - res[sibl->idx] - dist_nodes (g, sibl, gn);
 }
 
 /* adjusts the position of previously placed left/right classes */
 /* tries to place classes as close as possible */
-static void adjust_class(const RAGraph *g, int is_left, RList **classes, Sdb *res, int c) {
+static void adjust_class(const RAGraph *g, int is_left, RList **classes, int *res, int c) {
 	const RGraphNode *gn;
 	const RListIter *it;
 	const RANode *an;
@@ -1078,17 +1126,15 @@ static void adjust_class(const RAGraph *g, int is_left, RList **classes, Sdb *re
 	}
 
 	graph_foreach_anode (classes[c], it, gn, an) {
-		const int old_val = hash_get_int (res, gn);
-		const int new_val = is_left? old_val + dist: old_val - dist;
-		hash_set (res, gn, new_val);
+		res[gn->idx] += is_left? dist: -dist;
 	}
 }
 
-static int place_nodes_val(const RAGraph *g, const RGraphNode *gn, const RGraphNode *sibl, Sdb *res, int is_left) {
+static int place_nodes_val(const RAGraph *g, const RGraphNode *gn, const RGraphNode *sibl, int *res, int is_left) {
 	if (is_left) {
-		return hash_get_int (res, sibl) + dist_nodes (g, sibl, gn);
+		return res[sibl->idx] + dist_nodes (g, sibl, gn);
 	}
-	return hash_get_int (res, sibl) - dist_nodes (g, gn, sibl);
+	return res[sibl->idx] - dist_nodes (g, gn, sibl);
 }
 
 static int place_nodes_sel_p(int newval, int oldval, int is_first, int is_left) {
@@ -1102,8 +1148,8 @@ static int place_nodes_sel_p(int newval, int oldval, int is_first, int is_left)
 }
 
 /* places left/right the nodes of a class */
-static void place_nodes(const RAGraph *g, const RGraphNode *gn, int is_left, Sdb *v_nodes, RList **classes, Sdb *res, Sdb *placed) {
-	const RList *lv = hash_get_rlist (v_nodes, gn);
+static void place_nodes(const RAGraph *g, const RGraphNode *gn, int is_left, RList **v_nodes, RList **classes, int *res, ut8 *placed) {
+	const RList *lv = v_nodes[gn->idx];
 	int p = 0, v, is_first = true;
 	const RGraphNode *gk;
 	const RListIter *itk;
@@ -1119,7 +1165,7 @@ static void place_nodes(const RAGraph *g, const RGraphNode *gn, int is_left, Sdb
 		}
 		sibl_anode = get_anode (sibling);
 		if (ak->klass == sibl_anode->klass) {
-			if (!hash_get (placed, sibling)) {
+			if (!placed[sibling->idx]) {
 				place_nodes (g, sibling, is_left, v_nodes, classes, res, placed);
 			}
 
@@ -1134,13 +1180,13 @@ static void place_nodes(const RAGraph *g, const RGraphNode *gn, int is_left, Sdb
 	}
 
 	graph_foreach_anode (lv, itk, gk, ak) {
-		hash_set (res, gk, p);
-		hash_set (placed, gk, true);
+		res[gk->idx] = p;
+		placed[gk->idx] = true;
 	}
 }
 
 /* computes the position to the left/right of all the nodes */
-static Sdb *compute_pos(const RAGraph *g, int is_left, Sdb *v_nodes) {
+static int *compute_pos(const RAGraph *g, int is_left, RList **v_nodes) {
 	int n_classes, i;
 
 	RList **classes = compute_classes (g, v_nodes, is_left, &n_classes);
@@ -1148,22 +1194,24 @@ static Sdb *compute_pos(const RAGraph *g, int is_left, Sdb *v_nodes) {
 		return NULL;
 	}
 
-	Sdb *res = sdb_new0 ();
-	Sdb *placed = sdb_new0 ();
-	for (i = 0; i < n_classes; i++) {
+	int *res = R_NEWS0 (int, g->graph->last_index);
+	ut8 *placed = R_NEWS0 (ut8, g->graph->last_index);
+	for (i = 0; res && placed && i < n_classes; i++) {
 		const RGraphNode *gn;
 		const RListIter *it;
 
 		r_list_foreach (classes[i], it, gn) {
-			if (!hash_get_rnode (placed, gn)) {
+			if (!placed[gn->idx]) {
 				place_nodes (g, gn, is_left, v_nodes, classes, res, placed);
 			}
 		}
 
 		adjust_class (g, is_left, classes, res, i);
 	}
-
-	sdb_free (placed);
+	if (!placed) {
+		R_FREE (res);
+	}
+	free (placed);
 	for (i = 0; i < n_classes; i++) {
 		if (classes[i]) {
 			r_list_free (classes[i]);
@@ -1173,11 +1221,6 @@ static Sdb *compute_pos(const RAGraph *g, int is_left, Sdb *v_nodes) {
 	return res;
 }
 
-static int free_vertical_nodes_cb(void *user UNUSED, const char *k UNUSED, const char *v) {
-	r_list_free ((RList *) (size_t) sdb_atoi (v));
-	return 1;
-}
-
 /* calculates position of all nodes, but in particular dummies nodes */
 /* computes two different placements (called "left"/"right") and set the final
  * position of each node to the average of the values in the two placements */
@@ -1187,30 +1230,34 @@ static void place_dummies(const RAGraph *g) {
 	const RListIter *it;
 	RANode *n;
 
-	Sdb *vertical_nodes = compute_vertical_nodes (g);
+	int i;
+
+	RList **vertical_nodes = compute_vertical_nodes (g);
 	if (!vertical_nodes) {
 		return;
 	}
-	Sdb *xminus = compute_pos (g, true, vertical_nodes);
+	int *xminus = compute_pos (g, true, vertical_nodes);
 	if (!xminus) {
 		goto xminus_err;
 	}
-	Sdb *xplus = compute_pos (g, false, vertical_nodes);
+	int *xplus = compute_pos (g, false, vertical_nodes);
 	if (!xplus) {
 		goto xplus_err;
 	}
 
 	nodes = r_graph_get_nodes (g->graph);
 	graph_foreach_anode (nodes, it, gn, n) {
-		n->x = (hash_get_int (xminus, gn) + hash_get_int (xplus, gn)) / 2;
+		n->x = (xminus[gn->idx] + xplus[gn->idx]) / 2;
 	}
 
-	sdb_free (xplus);
+	free (xplus);
 xplus_err:
-	sdb_free (xminus);
+	free (xminus);
 xminus_err:
-	sdb_foreach (vertical_nodes, (SdbForeachCallback)free_vertical_nodes_cb, NULL);
-	sdb_free (vertical_nodes);
+	for (i = 0; i < g->graph->last_index; i++) {
+		r_list_free (vertical_nodes[i]);
+	}
+	free (vertical_nodes);
 }
 
 static RGraphNode *get_right_dummy(const RAGraph *g, const RGraphNode *n) {
@@ -1234,7 +1281,7 @@ static RGraphNode *get_right_dummy(const RAGraph *g, const RGraphNode *n) {
 	return NULL;
 }
 
-static void adjust_directions(const RAGraph *g, int i, int from_up, Sdb *D, Sdb *P) {
+static void adjust_directions(const RAGraph *g, int i, int from_up, int *D, int *P) {
 	const RGraphNode *vm = NULL, *wm = NULL;
 	const RANode *vma = NULL, *wma = NULL;
 	int j, d = from_up? 1: -1;
@@ -1259,23 +1306,23 @@ static void adjust_directions(const RAGraph *g, int i, int from_up, Sdb *D, Sdb
 			continue;
 		}
 		if (vm) {
-			int p = hash_get_int (P, wm);
+			int p = P[wm->idx];
 			int k;
 
 			for (k = wma->pos_in_layer + 1; k < wpa->pos_in_layer; k++) {
 				const RGraphNode *w = g->layers[wma->layer].nodes[k];
 				const RANode *aw = get_anode (w);
 				if (aw && aw->is_dummy) {
-					p &= hash_get_int (P, w);
+					p &= P[w->idx];
 				}
 			}
 			if (p) {
-				hash_set (D, vm, from_up);
+				D[vm->idx] = from_up;
 				for (k = vma->pos_in_layer + 1; k < vpa->pos_in_layer; k++) {
 					const RGraphNode *v = g->layers[vma->layer].nodes[k];
 					const RANode *av = get_anode (v);
 					if (av && av->is_dummy) {
-						hash_set (D, v, from_up);
+						D[v->idx] = from_up;
 					}
 				}
 			}
@@ -1493,7 +1540,7 @@ static void place_sequence(const RAGraph *g, int l, const RGraphNode *bm, const
 /* finds the placements of nodes while traversing the graph in the given
  * direction */
 /* places all the sequences of consecutive original nodes in each layer. */
-static void original_traverse_l(const RAGraph *g, Sdb *D, Sdb *P, int from_up) {
+static void original_traverse_l(const RAGraph *g, int *D, int *P, int from_up) {
 	int i, k, va, vr;
 
 	for (i = from_up? 0: g->n_layers - 1;
@@ -1542,12 +1589,12 @@ static void original_traverse_l(const RAGraph *g, Sdb *D, Sdb *P, int from_up) {
 				if (is_valid_pos (g, i, va)) {
 					set_dist_nodes (g, i, bma->pos_in_layer, va);
 				}
-			} else if (hash_get_int (D, bm) == from_up) {
+			} else if (D[bm->idx] == from_up) {
 				bpa = get_anode (bp);
 				va = bma->pos_in_layer + 1;
 				vr = bpa->pos_in_layer;
 				place_sequence (g, i, bm, bp, from_up, va, vr);
-				hash_set (P, bm, true);
+				P[bm->idx] = true;
 			}
 			bm = bp;
 		}
@@ -1564,19 +1611,14 @@ static void place_original(RAGraph *g) {
 	const RListIter *itn;
 	const RANode *an;
 
-	Sdb *D = sdb_new0 ();
-	if (!D) {
-		return;
-	}
-	Sdb *P = sdb_new0 ();
-	if (!P) {
-		sdb_free (D);
-		return;
-	}
-	g->dists = r_list_newf ((RListFree) free);
-	if (!g->dists) {
-		sdb_free (D);
-		sdb_free (P);
+	int *D = R_NEWS0 (int, g->graph->last_index);
+	int *P = R_NEWS0 (int, g->graph->last_index);
+	g->dists = ht_uu_new0 ();
+	if (!D || !P || !g->dists) {
+		free (D);
+		free (P);
+		ht_uu_free (g->dists);
+		g->dists = NULL;
 		return;
 	}
 
@@ -1587,19 +1629,18 @@ static void place_original(RAGraph *g) {
 		const RGraphNode *right_v = get_right_dummy (g, gn);
 		const RANode *right = get_anode (right_v);
 		if (right_v && right) {
-			hash_set (D, gn, 0);
-			int dt_eq = right->x - an->x == dist_nodes (g, gn, right_v);
-			hash_set (P, gn, dt_eq);
+			D[gn->idx] = 0;
+			P[gn->idx] = right->x - an->x == dist_nodes (g, gn, right_v);
 		}
 	}
 
 	original_traverse_l (g, D, P, true);
 	original_traverse_l (g, D, P, false);
 
-	r_list_free (g->dists);
+	ht_uu_free (g->dists);
 	g->dists = NULL;
-	sdb_free (P);
-	sdb_free (D);
+	free (P);
+	free (D);
 }
 
 #if 0
@@ -1922,6 +1963,87 @@ static void backedge_info (RAGraph *g) {
 	return;
 }
 
+#define SIG_MIX(h, v) (((h) ^ (ut64)(v)) * 0x100000001b3ULL)
+
+/* fingerprint of everything the layout depends on, 0 when not cacheable */
+static ut64 layout_signature(const RAGraph *g) {
+	const RList *nodes = r_graph_get_nodes (g->graph);
+	const RListIter *it, *itn;
+	RGraphNode *gn, *gk;
+	RANode *n;
+	ut64 h = 0xcbf29ce484222325ULL;
+
+	h = SIG_MIX (h, g->graph->n_nodes);
+	h = SIG_MIX (h, g->layout);
+	h = SIG_MIX (h, g->dummy);
+	h = SIG_MIX (h, g->is_tiny);
+	h = SIG_MIX (h, g->is_callgraph);
+	graph_foreach_anode (nodes, it, gn, n) {
+		if (n->is_dummy) {
+			return 0;
+		}
+		h = SIG_MIX (h, gn->idx);
+		h = SIG_MIX (h, r_str_hash64 (n->title));
+		h = SIG_MIX (h, n->w);
+		h = SIG_MIX (h, n->h);
+		r_list_foreach (r_graph_get_neighbours (g->graph, gn), itn, gk) {
+			h = SIG_MIX (h, gk->idx);
+		}
+		h = SIG_MIX (h, -1);
+	}
+	return h? h: 1;
+}
+
+static void layout_cache_store(RAGraph *g, ut64 sig) {
+	const RList *nodes = r_graph_get_nodes (g->graph);
+	const RListIter *it;
+	RGraphNode *gn;
+	RANode *n;
+	int i = 0, len = r_list_length (nodes) * 2;
+
+	R_FREE (g->layout_cache);
+	g->layout_cache_len = 0;
+	g->layout_sig = 0;
+	if (!sig || !(g->layout_cache = R_NEWS (int, len))) {
+		return;
+	}
+	graph_foreach_anode (nodes, it, gn, n) {
+		g->layout_cache[i++] = n->pos_in_layer;
+		g->layout_cache[i++] = n->x;
+	}
+	g->layout_cache_len = len;
+	g->layout_sig = sig;
+}
+
+/* restore the node ordering and x coordinates computed by a previous layout
+ * of the same graph, skipping crossing minimization and x assignment */
+static bool layout_cache_load(RAGraph *g, ut64 sig) {
+	const RList *nodes = r_graph_get_nodes (g->graph);
+	const RListIter *it;
+	RGraphNode *gn;
+	RANode *n;
+	int i = 0;
+
+	if (!sig || sig != g->layout_sig || !g->layout_cache
+			|| g->layout_cache_len != r_list_length (nodes) * 2) {
+		return false;
+	}
+	graph_foreach_anode (nodes, it, gn, n) {
+		int pos = g->layout_cache[i];
+		if (pos < 0 || pos >= g->layers[n->layer].n_nodes) {
+			return false;
+		}
+		i += 2;
+	}
+	i = 0;
+	graph_foreach_anode (nodes, it, gn, n) {
+		n->pos_in_layer = g->layout_cache[i++];
+		n->x = g->layout_cache[i++];
+		g->layers[n->layer].nodes[n->pos_in_layer] = gn;
+	}
+	return true;
+}
+
 /* 1) trasform the graph into a DAG
  * 2) partition the nodes in layers
  * 3) split long edges that traverse multiple layers
@@ -1934,11 +2056,15 @@ static void set_layout(RAGraph *g) {
 	r_list_free (g->edges);
 	g->edges = r_list_new ();
 
+	const ut64 sig = layout_signature (g);
 	remove_cycles (g);
 	assign_layers (g);
 	create_dummy_nodes (g);
 	create_layers (g);
-	minimize_crossings (g);
+	const bool cached = layout_cache_load (g, sig);
+	if (!cached) {
+		minimize_crossings (g);
+	}
 
 	if (r_cons_is_breaked ()) {
 		r_cons_break_end ();
@@ -1979,8 +2105,11 @@ static void set_layout(RAGraph *g) {
 	/* x-coordinate assignment: algorithm based on:
 	 * A Fast Layout Algorithm for k-Level Graphs
 	 * by C. Buchheim, M. Junger, S. Leipert */
-	place_dummies (g);
-	place_original (g);
+	if (!cached) {
+		place_dummies (g);
+		place_original (g);
+		layout_cache_store (g, sig);
+	}
 
 	/* IDEA: need to put this hack because of the way algorithm is implemented.
 	 * I think backedges should be restored to their original state instead of
@@ -2014,15 +2143,12 @@ static void set_layout(RAGraph *g) {
 		set_layer_gap (g);
 
 		/* vertical align */
+		k = g->n_layers > 0? g->layers[0].gap: 0; //TODO: XXX: set properly
 		for (i = 0; i < g->n_layers; i++) {
-			int tmp_y = 0;
-			tmp_y = g->layers[0].gap; //TODO: XXX: set properly
-			for (k = 1; k <= i; k++) {
-				tmp_y += g->layers[k-1].height + g->layers[k].gap + 3; //XXX: should be 4?
-			}
-			if (g->is_tiny) {
-				tmp_y = i;
+			if (i > 0) {
+				k += g->layers[i - 1].height + g->layers[i].gap + 3; //XXX: should be 4?
 			}
+			const int tmp_y = g->is_tiny? i: k;
 			for (j = 0; j < g->layers[i].n_nodes; j++) {
 				RANode *n = get_anode (g->layers[i].nodes[j]);
 				if (n) {
@@ -2035,24 +2161,23 @@ static void set_layout(RAGraph *g) {
 	case 1: // horizontal layout
 		/* vertical y coordinate */
 		for (i = 0; i < g->n_layers; i++) {
+			int yval = 1;
 			for (j = 0; j < g->layers[i].n_nodes; j++) {
 				RANode *n = get_anode (g->layers[i].nodes[j]);
-				n->y = 1;
-				for (k = 0; k < j; k++) {
-					RANode *m = get_anode (g->layers[i].nodes[k]);
-					n->y -= (m->h + VERTICAL_NODE_SPACING);
-				}
+				n->y = yval;
+				yval -= (n->h + VERTICAL_NODE_SPACING);
 			}
 		}
 
 		set_layer_gap (g);
 
 		/* horizontal align */
+		k = g->n_layers > 0? 1 + g->layers[0].gap + 1: 0;
 		for (i = 0; i < g->n_layers; i++) {
-			int xval = 1 + g->layers[0].gap + 1;
-			for (k = 1; k <= i; k++) {
-				xval += g->layers[k-1].width + g->layers[k].gap + 3;
+			if (i > 0) {
+				k += g->layers[i - 1].width + g->layers[i].gap + 3;
 			}
+			const int xval = k;
 			for (j = 0; j < g->layers[i].n_nodes; j++) {
 				RANode *n = get_anode (g->layers[i].nodes[j]);
 				n->x = xval;
@@ -3646,6 +3771,13 @@ R_API Sdb *r_agraph_get_sdb(RAGraph *g) {
 	return g->db;
 }
 
+R_API void r_agraph_layout(RAGraph *g) {
+	update_node_dimension (g->graph, is_mini (g), g->zoom, g->edgemode, g->is_callgraph, g->layout);
+	agraph_set_layout (g);
+	g->need_update_dim = false;
+	g->need_set_layout = false;
+}
+
 R_API void r_agraph_print(RAGraph *g) {
 	agraph_print (g, false, NULL, NULL);
 	if (g->graph->n_nodes > 0) {
@@ -3872,6 +4004,7 @@ R_API void r_agraph_free(RAGraph *g) {
 		r_agraph_set_title (g, NULL);
 		sdb_free (g->db);
 		r_cons_canvas_free (g->can);
+		free (g->layout_cache);
 		free (g);
 	}
 }
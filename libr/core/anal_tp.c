@@ -38,16 +38,45 @@ static void r_anal_emul_restore(RCore *core, RConfigHold *hc) {
 	r_config_hold_free (hc);
 }
 
-#define SDB_CONTAINS(i,s) sdb_array_contains (trace, sdb_fmt ("%d.reg.write", i), s, 0)
+static ut64 trace_addr(RAnalEsilTrace *trace, int idx) {
+	RAnalEsilTraceStep *step = r_anal_esil_trace_step (trace, idx);
+	return step? step->addr: 0;
+}
+
+/* comma separated list of the registers written by the step */
+static char *trace_reg_writes(RAnalEsilTrace *trace, int idx) {
+	RAnalEsilTraceStep *step = r_anal_esil_trace_step (trace, idx);
+	if (!step || r_vector_empty (&step->reg_write)) {
+		return NULL;
+	}
+	RStrBuf *sb = r_strbuf_new ("");
+	size_t i, j;
+	for (i = 0; i < step->reg_write.len; i++) {
+		RAnalEsilTraceReg *r = r_vector_index_ptr (&step->reg_write, i);
+		for (j = 0; j < i; j++) {
+			RAnalEsilTraceReg *q = r_vector_index_ptr (&step->reg_write, j);
+			if (q->reg == r->reg) {
+				break;
+			}
+		}
+		if (j == i) {
+			const char *name = r_pvector_at (&trace->regs, r->reg);
+			r_strbuf_appendf (sb, "%s%s", i? ",": "", name);
+		}
+	}
+	return r_strbuf_drain (sb);
+}
 
-static bool type_pos_hit(RAnal *anal, Sdb *trace, bool in_stack, int idx, int size, const char *place) {
+static bool type_pos_hit(RAnal *anal, RAnalEsilTrace *trace, bool in_stack, int idx, int size, const char *place) {
 	if (in_stack) {
 		const char *sp_name = r_reg_get_name (anal->reg, R_REG_NAME_SP);
 		ut64 sp = r_reg_getv (anal->reg, sp_name);
-		ut64 write_addr = sdb_num_get (trace, sdb_fmt ("%d.mem.write", idx), 0);
+		RAnalEsilTraceStep *step = r_anal_esil_trace_step (trace, idx);
+		RAnalEsilTraceMem *m = step? r_vector_index_ptr (&step->mem_write, 0): NULL;
+		ut64 write_addr = (m && step->mem_write.len)? m->addr: 0;
 		return (write_addr == sp + size);
 	}
-	return SDB_CONTAINS (idx, place);
+	return place && r_anal_esil_trace_reg_write (trace, idx, place, NULL);
 }
 
 static void __var_rename(RAnal *anal, RAnalVar *v, const char *name, ut64 addr) {
@@ -170,12 +199,13 @@ static void get_src_regname(RCore *core, ut64 addr, char *regname, int size) {
 	r_anal_op_free (op);
 }
 
-static ut64 get_addr(Sdb *trace, const char *regname, int idx) {
+static ut64 get_addr(RAnalEsilTrace *trace, const char *regname, int idx) {
 	if (!regname || !*regname) {
 		return UT64_MAX;
 	}
-	const char *query = sdb_fmt ("%d.reg.read.%s", idx, regname);
-	return r_num_math (NULL, sdb_const_get (trace, query, 0));
+	ut64 value = 0;
+	r_anal_esil_trace_reg_read (trace, idx, regname, &value);
+	return value;
 }
 
 static _RAnalCond cond_invert(RAnal *anal, _RAnalCond cond) {
@@ -298,11 +328,11 @@ static RList *parse_format(RCore *core, char *fmt) {
 
 static void type_match(RCore *core, char *fcn_name, ut64 addr, ut64 baddr, const char* cc,
 		int prev_idx, bool userfnc, ut64 caddr) {
-	Sdb *trace = core->anal->esil->db_trace;
+	RAnalEsilTrace *trace = core->anal->esil->trace;
 	Sdb *TDB = core->anal->sdb_types;
 	RAnal *anal = core->anal;
 	RList *types = NULL;
-	int idx = sdb_num_get (trace, "idx", 0);
+	int idx = r_anal_esil_trace_last (trace);
 	bool verbose = r_config_get_i (core->config, "anal.types.verbose");
 	bool stack_rev = false, in_stack = false, format = false;
 
@@ -360,7 +390,7 @@ static void type_match(RCore *core, char *fcn_name, ut64 addr, ut64 baddr, const
 		bool res = false;
 		// Backtrace instruction from source sink to prev source sink
 		for (j = idx; j >= prev_idx; j--) {
-			ut64 instr_addr = sdb_num_get (trace, sdb_fmt ("%d.addr", j), 0);
+			ut64 instr_addr = trace_addr (trace, j);
 			if (instr_addr < baddr) {
 				break;
 			}
@@ -383,8 +413,8 @@ static void type_match(RCore *core, char *fcn_name, ut64 addr, ut64 baddr, const
 			} else {
 				key = sdb_fmt ("fcn.0x%08"PFMT64x".arg.%d", caddr, size);
 			}
-			const char *query = sdb_fmt ("%d.mem.read", j);
-			if (op->type == R_ANAL_OP_TYPE_MOV && sdb_const_get (trace, query, 0)) {
+			RAnalEsilTraceStep *step = r_anal_esil_trace_step (trace, j);
+			if (op->type == R_ANAL_OP_TYPE_MOV && step && !r_vector_empty (&step->mem_read)) {
 				memref = ! (!memref && var && (var->kind != R_ANAL_VAR_KIND_REG));
 			}
 			// Match type from function param to instr
@@ -423,7 +453,7 @@ static void type_match(RCore *core, char *fcn_name, ut64 addr, ut64 baddr, const
 				}
 			}
 			// Type propagate by following source reg
-			if (!res && *regname && SDB_CONTAINS (j, regname)) {
+			if (!res && *regname && r_anal_esil_trace_reg_write (trace, j, regname, NULL)) {
 				if (var) {
 					if (!userfnc) {
 						__var_retype (anal, var, name, type, memref, false);
@@ -468,6 +498,176 @@ static int bb_cmpaddr(const void *_a, const void *_b) {
 	return a->addr > b->addr ? 1 : (a->addr < b->addr ? -1 : 0);
 }
 
+static ut64 tp_hash(ut64 h, const void *data, size_t len) {
+	const ut8 *p = data;
+	size_t i;
+	for (i = 0; i < len; i++) {
+		h = (h ^ p[i]) * 0x100000001b3ULL;
+	}
+	return h;
+}
+
+static ut64 tp_hash_str(ut64 h, const char *s) {
+	return s? tp_hash (h, s, strlen (s) + 1): tp_hash (h, "", 1);
+}
+
+static ut64 tp_hash_proto(RAnal *anal, ut64 h, const char *name) {
+	Sdb *TDB = anal->sdb_types;
+	char *fname = r_type_func_exist (TDB, name)? strdup (name): r_type_func_guess (TDB, (char *)name);
+	h = tp_hash_str (h, name);
+	if (!fname) {
+		return h;
+	}
+	h = tp_hash_str (h, fname);
+	h = tp_hash_str (h, r_type_func_ret (TDB, fname));
+	h = tp_hash_str (h, r_anal_cc_func (anal, fname));
+	int i, n = r_type_func_args_count (TDB, fname);
+	for (i = 0; i < n; i++) {
+		char *type = r_type_func_args_type (TDB, fname, i);
+		h = tp_hash_str (h, type);
+		h = tp_hash_str (h, r_type_func_args_name (TDB, fname, i));
+		free (type);
+	}
+	free (fname);
+	return h;
+}
+
+// the definition of a type as stored in the types db, following typedefs
+// and struct/union members a few levels down
+static ut64 tp_hash_type(Sdb *TDB, ut64 h, const char *type, int depth) {
+	if (!type || depth < 1) {
+		return h;
+	}
+	char *name = strdup (type);
+	if (!name) {
+		return h;
+	}
+	r_str_replace_char (name, '*', ' ');
+	char *t = name;
+	if (r_str_startswith (t, "const ")) {
+		t += 6;
+	}
+	if (r_str_startswith (t, "struct ")) {
+		t += 7;
+	} else if (r_str_startswith (t, "union ")) {
+		t += 6;
+	}
+	r_str_trim (t);
+	const char *kind = sdb_const_get (TDB, t, NULL);
+	h = tp_hash_str (h, kind);
+	if (!kind) {
+		free (name);
+		return h;
+	}
+	if (!strcmp (kind, "typedef")) {
+		const char *target = sdb_const_get (TDB, sdb_fmt ("typedef.%s", t), NULL);
+		h = tp_hash_str (h, target);
+		h = tp_hash_type (TDB, h, target, depth - 1);
+	} else if (!strcmp (kind, "type")) {
+		h = tp_hash_str (h, sdb_const_get (TDB, sdb_fmt ("type.%s", t), NULL));
+		h = tp_hash_str (h, sdb_const_get (TDB, sdb_fmt ("type.%s.size", t), NULL));
+	} else if (!strcmp (kind, "struct") || !strcmp (kind, "union")) {
+		char *members = sdb_get (TDB, sdb_fmt ("%s.%s", kind, t), NULL);
+		h = tp_hash_str (h, members);
+		char *next, *ptr = members;
+		while (ptr) {
+			char *memb = sdb_anext (ptr, &next);
+			if (!memb) {
+				break;
+			}
+			char *def = sdb_get (TDB, sdb_fmt ("%s.%s.%s", kind, t, memb), NULL);
+			h = tp_hash_str (h, def);
+			if (def) {
+				char *comma = strchr (def, ',');
+				if (comma) {
+					*comma = 0;
+				}
+				h = tp_hash_type (TDB, h, def, depth - 1);
+				free (def);
+			}
+			ptr = next;
+		}
+		free (members);
+	}
+	free (name);
+	return h;
+}
+
+/* Hash of everything r_core_anal_type_match reads for a function: its code,
+ * its variables and the definitions of their types, the prototypes and
+ * noreturn state of its callees and the argument types its callers
+ * propagated into it. aaft skips functions whose key did not change since
+ * their last pass. */
+R_API ut64 r_core_anal_type_match_key(RCore *core, RAnalFunction *fcn) {
+	r_return_val_if_fail (core && fcn, 0);
+	RAnal *anal = core->anal;
+	RListIter *it;
+	RAnalBlock *bb;
+	ut64 h = 0xcbf29ce484222325ULL;
+	bool chk_constraint = r_config_get_i (core->config, "anal.types.constraint");
+	h = tp_hash (h, &chk_constraint, sizeof (chk_constraint));
+	h = tp_hash_str (h, fcn->cc);
+	h = tp_hash (h, &fcn->bits, sizeof (fcn->bits));
+	h = tp_hash (h, &fcn->bp_off, sizeof (fcn->bp_off));
+	r_list_sort (fcn->bbs, bb_cmpaddr);
+	r_list_foreach (fcn->bbs, it, bb) {
+		h = tp_hash (h, &bb->addr, sizeof (bb->addr));
+		h = tp_hash (h, &bb->size, sizeof (bb->size));
+		ut8 *buf = bb->size? malloc (bb->size): NULL;
+		if (buf) {
+			r_io_read_at (core->io, bb->addr, buf, bb->size);
+			h = tp_hash (h, buf, bb->size);
+			free (buf);
+		}
+	}
+	void **v;
+	r_pvector_foreach (&fcn->vars, v) {
+		RAnalVar *var = *v;
+		h = tp_hash_str (h, var->name);
+		h = tp_hash_str (h, var->type);
+		h = tp_hash_type (anal->sdb_types, h, var->type, 3);
+		h = tp_hash (h, &var->kind, sizeof (var->kind));
+		h = tp_hash (h, &var->delta, sizeof (var->delta));
+		h = tp_hash (h, &var->isarg, sizeof (var->isarg));
+		const char *query = NULL;
+		if (var->kind == R_ANAL_VAR_KIND_REG) {
+			RRegItem *ri = r_reg_index_get (anal->reg, var->delta);
+			if (ri) {
+				query = sdb_fmt ("fcn.0x%08"PFMT64x".arg.%s", fcn->addr, ri->name);
+			}
+		} else if (var->kind == R_ANAL_VAR_KIND_BPV && var->isarg) {
+			query = sdb_fmt ("fcn.0x%08"PFMT64x".arg.%d",
+				fcn->addr, (int)(var->delta + fcn->bp_off - 8));
+		}
+		if (query) {
+			h = tp_hash_str (h, sdb_const_get (anal->sdb_fcns, query, NULL));
+		}
+	}
+	// callees are summed so that the order of the refs does not matter
+	ut64 callees = 0;
+	RList *refs = r_anal_function_get_refs (fcn);
+	RAnalRef *ref;
+	r_list_foreach (refs, it, ref) {
+		ut64 rh = tp_hash (0xcbf29ce484222325ULL, &ref->addr, sizeof (ref->addr));
+		RAnalFunction *callee = r_anal_get_fcn_in (anal, ref->addr, -1);
+		if (callee) {
+			rh = tp_hash_proto (anal, rh, callee->name);
+			rh = tp_hash (rh, &callee->is_noreturn, sizeof (callee->is_noreturn));
+		}
+		if (ref->type == R_ANAL_REF_TYPE_CALL || ref->type == R_ANAL_REF_TYPE_CODE) {
+			bool noreturn = r_anal_noreturn_at (anal, ref->addr);
+			rh = tp_hash (rh, &noreturn, sizeof (noreturn));
+		}
+		RFlagItem *flag = r_flag_get_by_spaces (core->flags, ref->addr, R_FLAGS_FS_IMPORTS, NULL);
+		if (flag && flag->realname) {
+			rh = tp_hash_proto (anal, rh, flag->realname);
+		}
+		callees += rh;
+	}
+	r_list_free (refs);
+	return tp_hash (h, &callees, sizeof (callees));
+}
+
 R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 	RAnalBlock *bb;
 	RListIter *it;
@@ -507,7 +707,7 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 	bool prop = false;
 	bool prev_var = false;
 	char prev_type[256] = {0};
-	const char *prev_dest = NULL;
+	char *prev_dest = NULL;
 	char *ret_reg = NULL;
 	const char *pc = r_reg_get_name (core->dbg->reg, R_REG_NAME_PC);
 	if (!pc) {
@@ -517,6 +717,17 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 	if (!r) {
 		return;
 	}
+	if (!anal->esil->trace) {
+		anal->esil->trace = r_anal_esil_trace_new ();
+	}
+	RAnalEsilTrace *trace = anal->esil->trace;
+	HtUU *loops = ht_uu_new0 ();
+	if (!trace || !loops) {
+		ht_uu_free (loops);
+		free (buf);
+		r_anal_emul_restore (core, hc);
+		return;
+	}
 	r_cons_break_push (NULL, NULL);
 	r_list_sort (fcn->bbs, bb_cmpaddr); // TODO: The algorithm can be more accurate if blocks are followed by their jmp/fail, not just by address
 	r_list_foreach (fcn->bbs, it, bb) {
@@ -544,20 +755,19 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 				r_anal_op_fini (&aop);
 				continue;
 			}
-			int loop_count = sdb_num_get (anal->esil->db_trace, sdb_fmt ("0x%"PFMT64x".count", addr), 0);
+			ut64 loop_count = ht_uu_find (loops, addr, NULL);
 			if (loop_count > LOOP_MAX || aop.type == R_ANAL_OP_TYPE_RET) {
 				r_anal_op_fini (&aop);
 				break;
 			}
-			sdb_num_set (anal->esil->db_trace, sdb_fmt ("0x%"PFMT64x".count", addr), loop_count + 1, 0);
+			ht_uu_update (loops, addr, loop_count + 1);
 			if (r_anal_op_nonlinear (aop.type)) {   // skip the instr
 				r_reg_set_value (core->dbg->reg, r, addr + ret);
 			} else {
 				r_core_esil_step (core, UT64_MAX, NULL, NULL, false);
 			}
 			bool userfnc = false;
-			Sdb *trace = anal->esil->db_trace;
-			cur_idx = sdb_num_get (trace, "idx", 0);
+			cur_idx = r_anal_esil_trace_last (trace);
 			RAnalVar *var = r_anal_get_used_function_var (anal, aop.addr);
 			RAnalOp *next_op = r_core_anal_op (core, addr + ret, R_ANAL_OP_MASK_BASIC); // | _VAL ?
 			ut32 type = aop.type & R_ANAL_OP_TYPE_MASK;
@@ -606,8 +816,7 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 						free (cc);
 					}
 					if (!strcmp (fcn_name, "__stack_chk_fail")) {
-						const char *query = sdb_fmt ("%d.addr", cur_idx - 1);
-						ut64 mov_addr = sdb_num_get (trace, query, 0);
+						ut64 mov_addr = trace_addr (trace, cur_idx - 1);
 						RAnalOp *mop = r_core_anal_op (core, mov_addr, R_ANAL_OP_MASK_VAL | R_ANAL_OP_MASK_BASIC);
 						if (mop) {
 							RAnalVar *mopvar = r_anal_get_used_function_var (anal, mop->addr);
@@ -623,8 +832,7 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 			} else if (!resolved && ret_type && ret_reg) {
 				// Forward propgation of function return type
 				char src[REGNAME_SIZE] = {0};
-				const char *query = sdb_fmt ("%d.reg.write", cur_idx);
-				const char *cur_dest = sdb_const_get (trace, query, 0);
+				char *cur_dest = trace_reg_writes (trace, cur_idx);
 				get_src_regname (core, aop.addr, src, sizeof (src));
 				if (ret_reg && *src && strstr (ret_reg, src)) {
 					if (var && aop.direction == R_ANAL_OP_DIR_WRITE) {
@@ -658,6 +866,7 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 					}
 					free (foo);
 				}
+				free (cur_dest);
 			}
 			// Type propagation using instruction access pattern
 			if (var) {
@@ -716,7 +925,7 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 			prev_var = (var && aop.direction == R_ANAL_OP_DIR_READ);
 			str_flag = false;
 			prop = false;
-			prev_dest = NULL;
+			R_FREE (prev_dest);
 			switch (type) {
 			case R_ANAL_OP_TYPE_MOV:
 			case R_ANAL_OP_TYPE_LEA:
@@ -740,8 +949,7 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 				if (var && str_flag) {
 					__var_retype (anal, var, NULL, "const char *", false, false);
 				}
-				const char *query = sdb_fmt ("%d.reg.write", cur_idx);
-				prev_dest = sdb_const_get (trace, query, 0);
+				prev_dest = trace_reg_writes (trace, cur_idx);
 				if (var) {
 					strncpy (prev_type, var->type, sizeof (prev_type) - 1);
 					prop = true;
@@ -815,10 +1023,12 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 		R_LOG_DEBUG ("No calling convention set for function '%s'\n", fcn->name);
 	}
 out_function:
+	R_FREE (prev_dest);
 	R_FREE (ret_reg);
 	R_FREE (ret_type);
 	free (buf);
 	r_cons_break_pop();
 	r_anal_emul_restore (core, hc);
-	sdb_reset (anal->esil->db_trace);
+	ht_uu_free (loops);
+	r_anal_esil_trace_reset (trace);
 }
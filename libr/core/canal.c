@@ -1003,7 +1003,7 @@ R_API RAnalOp* r_core_anal_op(RCore *core, ut64 addr, int mask) {
 		}
 		r_asm_set_pc (core->rasm, addr);
 		r_asm_op_init (&asmop);
-		if (r_asm_disassemble (core->rasm, &asmop, ptr, len) > 0) {
+		if (r_core_asm_disassemble (core, &asmop, ptr, len) > 0) {
 			op->mnemonic = strdup (r_strbuf_get (&asmop.buf_asm));
 		}
 		r_asm_op_fini (&asmop);
@@ -2013,7 +2013,10 @@ R_API int r_core_anal_fcn(RCore *core, ut64 at, ut64 from, int reftype, int dept
 			return true;
 		}
 	}
-	if (__core_anal_fcn (core, at, from, reftype, depth - 1)) {
+	core->anal->dirty_lock++;
+	bool ret = __core_anal_fcn (core, at, from, reftype, depth - 1);
+	core->anal->dirty_lock--;
+	if (ret) {
 		// split function if overlaps
 		if (fcn) {
 			r_anal_function_resize (fcn, at - fcn->addr);
@@ -2044,6 +2047,96 @@ R_API int r_core_anal_fcn_clean(RCore *core, ut64 addr) {
 	return true;
 }
 
+// callers of a function that stopped returning can stop returning too
+#define UPDATE_ROUNDS 8
+
+typedef struct {
+	ut64 addr;
+	char *name;
+	int type;
+	int bits;
+	const char *cc;
+	bool noreturn;
+} UpdateFcn;
+
+// forget the functions with dirty blocks and the refs made by those blocks
+static RVector *update_collect(RCore *core) {
+	RAnal *anal = core->anal;
+	RList *fcns = r_anal_dirty_functions (anal);
+	RVector *todo = r_vector_new (sizeof (UpdateFcn), NULL, NULL);
+	if (!fcns || !todo) {
+		r_list_free (fcns);
+		r_vector_free (todo);
+		return NULL;
+	}
+	RListIter *iter, *it;
+	RAnalFunction *fcn;
+	RAnalBlock *bb;
+	r_list_foreach (fcns, iter, fcn) {
+		r_list_foreach (fcn->bbs, it, bb) {
+			int i;
+			for (i = 0; bb->dirty && i < bb->ninstr; i++) {
+				r_anal_refs_del (anal, bb->addr + r_anal_bb_offset_inst (bb, i));
+			}
+		}
+		UpdateFcn u = { fcn->addr, strdup (fcn->name), fcn->type, fcn->bits, fcn->cc, fcn->is_noreturn };
+		r_vector_push (todo, &u);
+	}
+	r_anal_dirty_clear (anal);
+	r_list_foreach (fcns, iter, fcn) {
+		r_anal_function_delete (fcn);
+	}
+	r_list_free (fcns);
+	return todo;
+}
+
+/* Analyze again the functions owning basic blocks that were invalidated by
+ * io writes or hint changes since the last update, keeping their name,
+ * type and calling convention. When that changes whether a function
+ * returns, the blocks calling it are invalidated and analyzed next.
+ * Returns the number of functions analyzed. */
+R_API int r_core_anal_update(RCore *core) {
+	r_return_val_if_fail (core, 0);
+	RAnal *anal = core->anal;
+	const int depth = r_config_get_i (core->config, "anal.depth");
+	int round, count = 0;
+	for (round = 0; round < UPDATE_ROUNDS && anal->dirty.len; round++) {
+		RVector *todo = update_collect (core);
+		if (!todo) {
+			break;
+		}
+		UpdateFcn *u;
+		r_vector_foreach (todo, u) {
+			r_core_anal_fcn (core, u->addr, UT64_MAX, R_ANAL_REF_TYPE_NULL, depth);
+			RAnalFunction *fcn = r_anal_get_function_at (anal, u->addr);
+			if (fcn) {
+				if (u->name && strcmp (fcn->name, u->name)) {
+					r_anal_function_rename (fcn, u->name);
+				}
+				fcn->type = u->type;
+				fcn->bits = u->bits;
+				fcn->cc = u->cc;
+				count++;
+			}
+			bool noreturn = fcn && fcn->is_noreturn;
+			if (noreturn != u->noreturn) {
+				RList *xrefs = r_anal_xrefs_get (anal, u->addr);
+				RListIter *iter;
+				RAnalRef *ref;
+				r_list_foreach (xrefs, iter, ref) {
+					if (ref->type == R_ANAL_REF_TYPE_CALL) {
+						r_anal_invalidate (anal, ref->addr, 1, R_ANAL_DIRTY_CALLEE);
+					}
+				}
+				r_list_free (xrefs);
+			}
+			free (u->name);
+		}
+		r_vector_free (todo);
+	}
+	return count;
+}
+
 R_API int r_core_print_bb_custom(RCore *core, RAnalFunction *fcn) {
 	RAnalBlock *bb;
 	RListIter *iter;
@@ -3733,6 +3826,7 @@ static bool opiscall(RCore *core, RAnalOp *aop, ut64 addr, const ut8* buf, int l
 
 // TODO(maskray) RAddrInterval API
 #define OPSZ 8
+#define XREFS_BATCH 64
 R_API int r_core_anal_search(RCore *core, ut64 from, ut64 to, ut64 ref, int mode) {
 	ut8 *buf = (ut8 *)malloc (core->blocksize);
 	if (!buf) {
@@ -3968,6 +4062,8 @@ R_API int r_core_anal_search_xrefs(RCore *core, ut64 from, ut64 to, int rad) {
 	int count = 0;
 	const int bsz = 8096;
 	RAnalOp op = { 0 };
+	RAnalOp ops[XREFS_BATCH];
+	int k = 0, nops = 0;
 
 	if (from == to) {
 		return -1;
@@ -4015,8 +4111,17 @@ R_API int r_core_anal_search_xrefs(RCore *core, ut64 from, ut64 to, int rad) {
 			continue;
 		}
 		while (i < bsz && !r_cons_is_breaked ()) {
-			ret = r_anal_op (core->anal, &op, at + i, buf + i, bsz - i, R_ANAL_OP_MASK_BASIC | R_ANAL_OP_MASK_HINT);
-			ret = ret > 0 ? ret : 1;
+			if (k == nops) {
+				// linear sweep, let the plugin decode a whole run at once
+				nops = r_anal_op_batch (core->anal, ops, XREFS_BATCH, at + i, buf + i, bsz - i, R_ANAL_OP_MASK_BASIC | R_ANAL_OP_MASK_HINT);
+				k = 0;
+				if (nops < 1) {
+					nops = 0;
+					break;
+				}
+			}
+			op = ops[k++];
+			ret = op.size > 0 ? op.size : 1;
 			i += ret;
 			if (ret <= 0 || i > bsz) {
 				break;
@@ -4076,6 +4181,10 @@ R_API int r_core_anal_search_xrefs(RCore *core, ut64 from, ut64 to, int rad) {
 			}
 			r_anal_op_fini (&op);
 		}
+		for (; k < nops; k++) {
+			r_anal_op_fini (&ops[k]);
+		}
+		k = nops = 0;
 		at += bsz;
 		r_anal_op_fini (&op);
 	}
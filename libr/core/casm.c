@@ -5,6 +5,7 @@
 #include <r_asm.h>
 
 #define IFDBG if (0)
+#define ASM_BATCH 32
 
 static RCoreAsmHit * find_addr(RList *hits, ut64 addr);
 static int prune_hits_in_hit_range(RList *hits, RCoreAsmHit *hit);
@@ -51,6 +52,94 @@ R_API void r_core_asm_hit_free(void *_hit) {
 	}
 }
 
+// everything besides pc and the bytes that changes the output of r_asm_disassemble
+static ut64 asm_state(RAsm *a) {
+	ut64 h = (ut64)(size_t)a->cur;
+	h = h * 31 + (ut64)(size_t)a->ofilter;
+	h = h * 31 + a->bits;
+	h = h * 31 + a->big_endian;
+	h = h * 31 + a->syntax;
+	h = h * 31 + a->invhex;
+	h = h * 31 + a->pcalign;
+	h = h * 31 + a->seggrn;
+	h = h * 31 + a->immdisp;
+	h = h * 31 + a->pseudo;
+	h = h * 31 + sdb_hash (r_str_get (a->cpu));
+	// the pseudo syntax comes from the parse plugin that asm.arch selected
+	const char *parser = (a->ofilter && a->ofilter->cur)? a->ofilter->cur->name: NULL;
+	h = h * 31 + sdb_hash (r_str_get (parser));
+	return h * 31 + sdb_hash (r_str_get (a->features));
+}
+
+// invalid instructions may just be short of bytes
+static void asm_cache_op(RCore *core, ut64 addr, ut64 state, const ut8 *buf, int len, RAsmOp *op, int ret) {
+	RAsm *a = core->rasm;
+	const char *asm_str = r_strbuf_get (&op->buf_asm);
+	if (ret > 0 && op->size > 0 && op->size <= len && !op->bitsize && !a->bitshift
+			&& !a->invhex && strcmp (asm_str, "invalid")) {
+		r_anal_opcache_set_text (core->anal, addr, state, buf, op->size, op->payload, asm_str, ret);
+	}
+}
+
+/* r_asm_disassemble at the current asm pc, served from the decoded op
+ * cache of the analysis when the same bytes were disassembled before */
+R_API int r_core_asm_disassemble(RCore *core, RAsmOp *op, const ut8 *buf, int len) {
+	r_return_val_if_fail (core && op && buf, -1);
+	RAsm *a = core->rasm;
+	if (!core->anal->opcache || len < 1 || a->bitshift) {
+		return r_asm_disassemble (a, op, buf, len);
+	}
+	ut64 state = asm_state (a);
+	int size = 0, payload = 0, ret = 0;
+	const char *text = r_anal_opcache_get_text (core->anal, a->pc, state, buf, len, &size, &payload, &ret);
+	if (text) {
+		r_asm_op_init (op);
+		op->size = size;
+		op->payload = payload;
+		r_asm_op_set_asm (op, text);
+		r_asm_op_set_buf (op, buf, size);
+		return ret;
+	}
+	ret = r_asm_disassemble (a, op, buf, len);
+	asm_cache_op (core, a->pc, state, buf, len, op, ret);
+	return ret;
+}
+
+/* Decodes up to n instructions of buf at addr into the op cache in as few
+ * plugin calls as possible, for linear sweeps that are about to call
+ * r_core_asm_disassemble on each of them. Does nothing unless the plugin
+ * can decode in batches. Returns the number of instructions decoded. */
+R_API int r_core_asm_prefetch(RCore *core, ut64 addr, const ut8 *buf, int len, int n) {
+	r_return_val_if_fail (core && buf, 0);
+	RAsm *a = core->rasm;
+	RAnalOpCache *c = core->anal->opcache;
+	if (!c || !a->cur || !a->cur->disassemble_batch || a->bitshift || len < 1) {
+		return 0;
+	}
+	// leave room for what the sweep decodes on its own
+	n = R_MIN (n, (int)(c->size / 2));
+	RAsmOp ops[ASM_BATCH];
+	const ut64 pc = a->pc;
+	const ut64 state = asm_state (a);
+	int i, count, total = 0, off = 0;
+	while (total < n && off < len) {
+		a->pc = addr + off;
+		count = r_asm_disassemble_batch (a, ops, R_MIN (n - total, ASM_BATCH), buf + off, len - off);
+		if (count < 1) {
+			break;
+		}
+		for (i = 0; i < count; i++) {
+			RAsmOp *op = &ops[i];
+			asm_cache_op (core, addr + off, state, buf + off, len - off, op, op->size);
+			off += R_MAX (op->size, 1);
+			r_asm_op_fini (op);
+		}
+		total += count;
+	}
+	a->pc = pc;
+	return total;
+}
+
 R_API char* r_core_asm_search(RCore *core, const char *input) {
 	RAsmCode *acode;
 	char *ret;
@@ -129,6 +218,9 @@ R_API RList *r_core_asm_strsearch(RCore *core, const char *input, ut64 from, ut6
 			break;
 		}
 		(void)r_io_read_at (core->io, at, buf, core->blocksize);
+		if (mode != 'i' && mode != 'e' && !everyByte && addrbytes == 1) {
+			r_core_asm_prefetch (core, at, buf, core->blocksize, core->blocksize);
+		}
 		idx = 0, matchcount = 0;
 		while (addrbytes * (idx + 1) <= core->blocksize) {
 			ut64 addr = at + idx;
@@ -186,8 +278,8 @@ R_API RList *r_core_asm_strsearch(RCore *core, const char *input, ut64 from, ut6
 				opst = strdup (r_strbuf_get (&analop.esil));
 				r_anal_op_fini (&analop);
 			} else {
-				if (!(len = r_asm_disassemble (
-					      core->rasm, &op,
+				if (!(len = r_core_asm_disassemble (
+					      core, &op,
 					      buf + addrbytes * idx,
 					      core->blocksize - addrbytes * idx))) {
 					idx = (matchcount)? tidx + 1: idx + 1;
@@ -394,6 +394,9 @@ static void _print_strings(RCore *r, RList *list, int mode, int va) {
 		r_cons_printf ("[Strings]\n");
 		r_table_set_columnsf (table, "nXXnnsss", "nth", "paddr", "vaddr", "len", "size", "section", "type", "string");
 	}
+	if (IS_MODE_SET (mode)) {
+		r_meta_bulk_begin (r->anal);
+	}
 	RBinString b64 = { 0 };
 	r_list_foreach (list, iter, string) {
 		const char *section_name, *type_string;
@@ -559,6 +562,7 @@ static void _print_strings(RCore *r, RList *list, int mode, int va) {
 		pj = NULL;
 	} else if (IS_MODE_SET (mode)) {
 		r_cons_break_pop ();
+		r_meta_bulk_end (r->anal);
 	} else if (IS_MODE_NORMAL (mode)) {
 		if (r->table_query) {
 			r_table_query (table, r->table_query);
@@ -1620,12 +1624,15 @@ static void set_bin_relocs(RCore *r, RBinReloc *reloc, ut64 addr, Sdb **db, char
 }
 
 /* Define new data at relocation address if it's not in an executable section */
-static void add_metadata(RCore *r, RBinReloc *reloc, ut64 addr, int mode) {
+// size of the Cd set on relocations, 0 when the bin has no known word size
+static int reloc_data_size(RCore *r) {
 	RBinFile * binfile = r->bin->cur;
 	RBinObject *binobj = binfile ? binfile->o: NULL;
 	RBinInfo *info = binobj ? binobj->info: NULL;
+	return info? (info->bits == 64? 8: info->bits == 32? 4: info->bits == 16 ? 4: 0): 0;
+}
 
-	int cdsz = info? (info->bits == 64? 8: info->bits == 32? 4: info->bits == 16 ? 4: 0): 0;
+static void add_metadata(RCore *r, RBinReloc *reloc, ut64 addr, int mode, int cdsz) {
 	if (cdsz == 0) {
 		return;
 	}
@@ -1678,6 +1685,9 @@ static int bin_relocs(RCore *r, int mode, int va) {
 	PJ *pj = NULL;
 	char *sdb_module = NULL;
 	int i = 0;
+	const int cdsz = reloc_data_size (r);
+	// the Cd of the relocations in data go into the meta tree at once
+	const bool bulk = IS_MODE_SET (mode) && cdsz;
 
 	R_TIME_PROFILE_BEGIN;
 
@@ -1702,6 +1712,9 @@ static int bin_relocs(RCore *r, int mode, int va) {
 	} else if (IS_MODE_SET (mode)) {
 		r_flag_space_set (r->flags, R_FLAGS_FS_RELOCS);
 	}
+	if (bulk) {
+		r_meta_bulk_begin (r->anal);
+	}
 
 	r_rbtree_foreach (relocs, iter, reloc, RBinReloc, vrb) {
 		ut64 addr = rva (r->bin, reloc->paddr, reloc->vaddr, va);
@@ -1712,7 +1725,7 @@ static int bin_relocs(RCore *r, int mode, int va) {
 			 */
 		} else if (IS_MODE_SET (mode)) {
 			set_bin_relocs (r, reloc, addr, &db, &sdb_module);
-			add_metadata (r, reloc, addr, mode);
+			add_metadata (r, reloc, addr, mode, cdsz);
 		} else if (IS_MODE_SIMPLE (mode)) {
 			r_cons_printf ("0x%08"PFMT64x"  %s\n", addr, reloc->import ? reloc->import->name : "");
 		} else if (IS_MODE_RAD (mode)) {
@@ -1732,7 +1745,7 @@ static int bin_relocs(RCore *r, int mode, int va) {
 				r_cons_printf ("\"f %s%s%s %d 0x%08"PFMT64x"\"\n",
 					r->bin->prefix ? r->bin->prefix : "reloc.",
 					r->bin->prefix ? "." : "", n, reloc_size, addr);
-				add_metadata (r, reloc, addr, mode);
+				add_metadata (r, reloc, addr, mode, cdsz);
 				free (n);
 				free (name);
 			}
@@ -1823,6 +1836,9 @@ static int bin_relocs(RCore *r, int mode, int va) {
 		r_cons_printf ("\n%i relocations\n", i);
 
 	}
+	if (bulk) {
+		r_meta_bulk_end (r->anal);
+	}
 
 	// free PJ object if used
 	if (pj) {
@@ -2263,6 +2279,7 @@ static int bin_symbols(RCore *r, int mode, ut64 laddr, int va, ut64 at, const ch
 		pj_a (pj);
 	} else if (IS_MODE_SET (mode)) {
 		r_flag_space_set (r->flags, R_FLAGS_FS_SYMBOLS);
+		r_meta_bulk_begin (r->anal);
 	} else if (at == UT64_MAX && exponly) {
 		if (IS_MODE_RAD (mode)) {
 			r_cons_printf ("fs exports\n");
@@ -2502,6 +2519,9 @@ next:
 	}
 	pj_free (pj);
 
+	if (IS_MODE_SET (mode)) {
+		r_meta_bulk_end (r->anal);
+	}
 	r_spaces_pop (&r->anal->meta_spaces);
 	r_table_free (table);
 	return true;
@@ -4145,6 +4165,9 @@ R_API int r_core_bin_info(RCore *core, int action, int mode, int va, RCoreBinFil
 
 	// use our internal values for va
 	va = va ? VA_TRUE : VA_FALSE;
+	if (IS_MODE_SET (mode)) {
+		r_flag_bulk_begin (core->flags);
+	}
 #if 0
 	if (r_config_get_i (core->config, "anal.strings")) {
 		r_core_cmd0 (core, "aar");
@@ -4239,6 +4262,9 @@ R_API int r_core_bin_info(RCore *core, int action, int mode, int va, RCoreBinFil
 			}
 		}
 	}
+	if (IS_MODE_SET (mode)) {
+		r_flag_bulk_end (core->flags);
+	}
 	return ret;
 }
 
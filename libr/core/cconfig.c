@@ -239,6 +239,14 @@ static bool cb_analdepth(void *user, void *data) {
 	return true;
 }
 
+static bool cb_anal_opcache(void *user, void *data) {
+	RCore *core = (RCore*) user;
+	RConfigNode *node = (RConfigNode*) data;
+	r_anal_opcache_free (core->anal->opcache);
+	core->anal->opcache = node->i_value? r_anal_opcache_new (node->i_value): NULL;
+	return true;
+}
+
 static bool cb_analgraphdepth(void *user, void *data) {
 	RCore *core = (RCore *)user;
 	RConfigNode *node = (RConfigNode *)data;
@@ -1871,6 +1879,12 @@ static bool cb_cmddepth(void *user, void *data) {
 	return true;
 }
 
+static bool cb_cmdtimeslice(void *user, void *data) {
+	RCore *core = (RCore *)user;
+	core->tasks.slice = R_MAX (((RConfigNode*)data)->i_value, 0);
+	return true;
+}
+
 static bool cb_hexcols(void *user, void *data) {
 	RCore *core = (RCore *)user;
 	int c = R_MIN (1024, R_MAX (((RConfigNode*)data)->i_value, 0));
@@ -2438,6 +2452,50 @@ static bool cb_bindbginfo(void *user, void *data) {
 	return true;
 }
 
+static bool cb_bindbginfothreads(void *user, void *data) {
+	RCore *core = (RCore *) user;
+	RConfigNode *node = (RConfigNode *) data;
+	if (node->i_value < 1 || node->i_value > 64) {
+		eprintf ("bin.dbginfo.threads must be between 1 and 64\n");
+		return false;
+	}
+	core->bin->dbginfo_threads = node->i_value;
+	return true;
+}
+
+static bool cb_bindbginforange(void *user, void *data) {
+	RCore *core = (RCore *) user;
+	RConfigNode *node = (RConfigNode *) data;
+	ut64 from = 0, to = 0;
+	if (*node->value) {
+		char *s = strdup (node->value);
+		char *p = strchr (s, '-');
+		if (!p) {
+			eprintf ("Usage: e bin.dbginfo.range=0x1000-0x2000\n");
+			free (s);
+			return false;
+		}
+		*p++ = 0;
+		from = r_num_math (core->num, s);
+		to = r_num_math (core->num, p);
+		free (s);
+	}
+	core->bin->dbginfo_from = from;
+	core->bin->dbginfo_to = to;
+	return true;
+}
+
+static bool cb_demanglethreads(void *user, void *data) {
+	RCore *core = (RCore *) user;
+	RConfigNode *node = (RConfigNode *) data;
+	if (node->i_value < 1 || node->i_value > 64) {
+		eprintf ("bin.demangle.threads must be between 1 and 64\n");
+		return false;
+	}
+	core->bin->demangle_threads = node->i_value;
+	return true;
+}
+
 static bool cb_binprefix(void *user, void *data) {
 	RCore *core = (RCore *) user;
 	RConfigNode *node = (RConfigNode *) data;
@@ -2903,11 +2961,13 @@ R_API int r_core_config_init(RCore *core) {
 	SETCB ("anal.delay", "true", &cb_anal_delay, "Enable delay slot analysis if supported by the architecture");
 	SETICB ("anal.depth", 64, &cb_analdepth, "Max depth at code analysis"); // XXX: warn if depth is > 50 .. can be problematic
 	SETICB ("anal.graph_depth", 256, &cb_analgraphdepth, "Max depth for path search");
+	SETICB ("anal.opcache", 4096, &cb_anal_opcache, "Number of decoded instructions to cache (0 to disable, see aoC)");
 	SETICB ("anal.sleep", 0, &cb_analsleep, "Sleep N usecs every so often during analysis. Avoid 100% CPU usage");
 	SETCB ("anal.ignbithints", "false", &cb_anal_ignbithints, "Ignore the ahb hints (only obey asm.bits)");
 	SETBPREF ("anal.calls", "false", "Make basic af analysis walk into calls");
 	SETBPREF ("anal.autoname", "false", "Speculatively set a name for the functions, may result in some false positives");
 	SETBPREF ("anal.hasnext", "false", "Continue analysis after each function");
+	SETBPREF ("anal.incremental", "false", "Analyze again the functions invalidated by writes and hint changes after every command (see aaU)");
 	SETICB ("anal.nonull", 0, &cb_anal_nonull, "Do not analyze regions of N null bytes");
 	SETBPREF ("anal.esil", "false", "Use the new ESIL code analysis");
 	SETCB ("anal.strings", "false", &cb_analstrings, "Identify and register strings during analysis (aar only)");
@@ -3164,9 +3224,12 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("bin.lang", "", "Language for bin.demangle");
 	SETBPREF ("bin.demangle", "true", "Import demangled symbols from RBin");
 	SETBPREF ("bin.demangle.libs", "false", "Show library name on demangled symbols names");
+	SETICB ("bin.demangle.threads", 1, &cb_demanglethreads, "Demangle the c++ symbols in parallel when loading binaries");
 	SETI ("bin.baddr", -1, "Base address of the binary");
 	SETI ("bin.laddr", 0, "Base address for loading library ('*.so')");
 	SETCB ("bin.dbginfo", "true", &cb_bindbginfo, "Load debug information at startup if available");
+	SETICB ("bin.dbginfo.threads", 1, &cb_bindbginfothreads, "Number of threads used to parse the DWARF compilation units");
+	SETCB ("bin.dbginfo.range", "", &cb_bindbginforange, "Only parse the DWARF compilation units covering this range (from-to)");
 	SETBPREF ("bin.relocs", "true", "Load relocs information at startup if available");
 	SETICB ("bin.minstr", 0, &cb_binminstr, "Minimum string length for r_bin");
 	SETICB ("bin.maxstr", 0, &cb_binmaxstr, "Maximum string length for r_bin");
@@ -3365,6 +3428,8 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("cmd.xterm", "xterm -bg black -fg gray -e", "xterm command to spawn with V@");
 	SETCB ("cmd.demangle", "false", &cb_bdc, "run xcrun swift-demangle and similar if available (SLOW)");
 	SETICB ("cmd.depth", 10, &cb_cmddepth, "Maximum command depth");
+	SETI ("cmd.workers", 0, "Run read-only commands over @@ flags, @@f, @@i and @@s in N forked workers, only from single threaded processes (0 = disabled)");
+	SETICB ("cmd.timeslice", 20, &cb_cmdtimeslice, "Milliseconds a background task runs before yielding to the prompt (0 = wait for it)");
 	SETPREF ("cmd.bp", "", "Run when a breakpoint is hit");
 	SETPREF ("cmd.onsyscall", "", "Run when a syscall is hit");
 	SETICB ("cmd.hitinfo", 1, &cb_debug_hitinfo, "Show info when a tracepoint/breakpoint is hit");
@@ -3457,6 +3522,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("http.ui", "m", "Default webui (enyo, m, p, t)");
 	SETBPREF ("http.sandbox", "true", "Sandbox the HTTP server");
 	SETI ("http.timeout", 3, "Disconnect clients after N seconds of inactivity");
+	SETI ("http.workers", 0, "Serve up to N keep-alive clients at once, read-only commands run as tasks sharing cmd.timeslice (0 = one client at a time)");
 	SETI ("http.dietime", 0, "Kill server after N seconds with no client");
 	SETBPREF ("http.verbose", "false", "Output server logs to stdout");
 	SETBPREF ("http.upget", "false", "/up/ answers GET requests, in addition to POST");
@@ -414,6 +414,9 @@ R_API bool r_core_write_at(RCore *core, ut64 addr, const ut8 *buf, int size) {
 	if (size < 1) {
 		return false;
 	}
+	if (core->tasks.unsafe > 0) {
+		r_core_task_wait_safe (&core->tasks);
+	}
 	bool ret = r_io_write_at (core->io, addr, buf, size);
 	if (addr >= core->offset && addr <= core->offset + core->blocksize - 1) {
 		r_core_block_read (core);
@@ -26,6 +26,10 @@
 #if __UNIX__
 #include <sys/utsname.h>
 #endif
+#if LIBC_HAVE_FORK
+#include <sys/wait.h>
+#include <poll.h>
+#endif
 
 #include <tree_sitter/api.h>
 TSLanguage *tree_sitter_r2cmd ();
@@ -219,6 +223,7 @@ static const char *help_msg_equalh[] = {
 	"=h--", "", "stop foreground webserver",
 	"=h*", "", "restart current webserver",
 	"=h&", " port", "start http server in background",
+	"=hb", " [n] [c] [cmd]", "load test http.bind:http.port with n requests from c clients",
 	"=H", " port", "launch browser and listen for http",
 	"=H&", " port", "launch browser and listen for http in background",
 	NULL
@@ -828,6 +833,8 @@ static int cmd_rap(void *data, const char *input) {
 	case 'h': // "=h"
 		if (input[1] == '?') {
 			r_core_cmd_help (core, help_msg_equalh);
+		} else if (input[1] == 'b') { // "=hb"
+			r_core_rtr_http_bench (core, input + 2);
 		} else {
 			r_core_rtr_http (core, getArg (input[1], 'h'), 'h', input + 1);
 		}
@@ -2013,6 +2020,28 @@ static int cmd_tasks(void *data, const char *input) {
 		r_core_task_enqueue (&core->tasks, task);
 		break;
 	}
+	case 'p': { // "&p"
+		if (r_sandbox_enable (0)) {
+			eprintf ("This command is disabled in sandbox mode\n");
+			return 0;
+		}
+		const char *arg = r_str_trim_head_ro (input + 1);
+		const char *cmd = strchr (arg, ' ');
+		if (!cmd) {
+			eprintf ("Usage: &p <priority> <cmd>\n");
+			break;
+		}
+		char *num = r_str_ndup (arg, cmd - arg);
+		int prio = (int)r_num_math (core->num, num);
+		free (num);
+		RCoreTask *task = r_core_task_new (core, true, r_str_trim_head_ro (cmd), NULL, core);
+		if (!task) {
+			break;
+		}
+		task->priority = R_MAX (R_MIN (prio, R_CORE_TASK_PRIORITY_INTERACTIVE), 0);
+		r_core_task_enqueue (&core->tasks, task);
+		break;
+	}
 	}
 	return 0;
 }
@@ -4162,8 +4191,11 @@ R_API int r_core_cmd_foreach3(RCore *core, const char *cmd, char *each) { // "@@
 	return 0;
 }
 
+static bool foreach_wants_parallel(RCore *core, RCoreCmdPrepared *pc);
+static void foreach_parallel(RCore *core, RCoreCmdPrepared *pc, RVector *addrs);
+
 static void foreachOffset(RCore *core, const char *_cmd, const char *each) {
-	char *cmd = strdup (_cmd);
+	RCoreCmdPrepared *pc = r_core_cmd_prepare (core, _cmd);
 	char *nextLine = NULL;
 	ut64 addr;
 	/* foreach list of items */
@@ -4208,13 +4240,12 @@ static void foreachOffset(RCore *core, const char *_cmd, const char *each) {
 				addr = r_num_math (core->num, each);
 				each = NULL;
 			}
-			r_core_seek (core, addr, true);
-			r_core_cmd (core, cmd, 0);
+			r_core_cmd_prepared_at (core, pc, addr);
 			r_cons_flush ();
 		}
 		each = nextLine;
 	}
-	free (cmd);
+	r_core_cmd_prepared_free (pc);
 }
 
 R_API int r_core_cmd_foreach(RCore *core, const char *cmd, char *each) {
@@ -4224,6 +4255,7 @@ R_API int r_core_cmd_foreach(RCore *core, const char *cmd, char *each) {
 	char *str, *ostr = NULL;
 	RListIter *iter;
 	RFlagItem *flag;
+	RCoreCmdPrepared *pc = NULL;
 	ut64 oseek, addr;
 
 	for (; *cmd == ' '; cmd++) {
@@ -4232,6 +4264,13 @@ R_API int r_core_cmd_foreach(RCore *core, const char *cmd, char *each) {
 
 	oseek = core->offset;
 	ostr = str = strdup (each);
+	if (each[0] != '/' && each[0] != '?') {
+		pc = r_core_cmd_prepare (core, cmd);
+		if (!pc) {
+			free (ostr);
+			return false;
+		}
+	}
 	r_cons_break_push (NULL, NULL); //pop on return
 	switch (each[0]) {
 	case '/': // "@@/"
@@ -4257,8 +4296,7 @@ R_API int r_core_cmd_foreach(RCore *core, const char *cmd, char *each) {
 				r_list_sort (fcn->bbs, bb_cmp);
 				r_list_foreach (fcn->bbs, iter, bb) {
 					r_core_block_size (core, bb->size);
-					r_core_seek (core, bb->addr, true);
-					r_core_cmd (core, cmd, 0);
+					r_core_cmd_prepared_at (core, pc, bb->addr);
 					if (r_cons_is_breaked ()) {
 						break;
 					}
@@ -4280,9 +4318,18 @@ R_API int r_core_cmd_foreach(RCore *core, const char *cmd, char *each) {
 				ut64 from = r_num_math (core->num, r_str_word_get0 (str, 0));
 				ut64 to = r_num_math (core->num, r_str_word_get0 (str, 1));
 				ut64 step = r_num_math (core->num, r_str_word_get0 (str, 2));
+				if (step && foreach_wants_parallel (core, pc)) {
+					RVector addrs;
+					r_vector_init (&addrs, sizeof (ut64), NULL, NULL);
+					for (cur = from; cur <= to && cur >= from; cur += step) {
+						r_vector_push (&addrs, &cur);
+					}
+					foreach_parallel (core, pc, &addrs);
+					r_vector_fini (&addrs);
+					goto out_finish;
+				}
 				for (cur = from; cur <= to; cur += step) {
-					(void) r_core_seek (core, cur, true);
-					r_core_cmd (core, cmd, 0);
+					r_core_cmd_prepared_at (core, pc, cur);
 					if (r_cons_is_breaked ()) {
 						break;
 					}
@@ -4299,13 +4346,24 @@ R_API int r_core_cmd_foreach(RCore *core, const char *cmd, char *each) {
 			RAnalBlock *bb;
 			int i;
 			RAnalFunction *fcn = r_anal_get_function_at (core->anal, core->offset);
-			if (fcn) {
+			if (fcn && foreach_wants_parallel (core, pc)) {
+				RVector addrs;
+				r_vector_init (&addrs, sizeof (ut64), NULL, NULL);
 				r_list_sort (fcn->bbs, bb_cmp);
 				r_list_foreach (fcn->bbs, iter, bb) {
 					for (i = 0; i < bb->op_pos_size; i++) {
 						ut64 addr = bb->addr + bb->op_pos[i];
-						r_core_seek (core, addr, true);
-						r_core_cmd (core, cmd, 0);
+						r_vector_push (&addrs, &addr);
+					}
+				}
+				foreach_parallel (core, pc, &addrs);
+				r_vector_fini (&addrs);
+			} else if (fcn) {
+				r_list_sort (fcn->bbs, bb_cmp);
+				r_list_foreach (fcn->bbs, iter, bb) {
+					for (i = 0; i < bb->op_pos_size; i++) {
+						ut64 addr = bb->addr + bb->op_pos[i];
+						r_core_cmd_prepared_at (core, pc, addr);
 						if (r_cons_is_breaked ()) {
 							break;
 						}
@@ -4322,8 +4380,7 @@ R_API int r_core_cmd_foreach(RCore *core, const char *cmd, char *each) {
 			if (core->anal) {
 				r_list_foreach (core->anal->fcns, iter, fcn) {
 					if (each[2] && strstr (fcn->name, each + 2)) {
-						r_core_seek (core, fcn->addr, true);
-						r_core_cmd (core, cmd, 0);
+						r_core_cmd_prepared_at (core, pc, fcn->addr);
 						if (r_cons_is_breaked ()) {
 							break;
 						}
@@ -4334,13 +4391,20 @@ R_API int r_core_cmd_foreach(RCore *core, const char *cmd, char *each) {
 		} else {
 			RAnalFunction *fcn;
 			RListIter *iter;
-			if (core->anal) {
+			if (core->anal && foreach_wants_parallel (core, pc)) {
+				RVector addrs;
+				r_vector_init (&addrs, sizeof (ut64), NULL, NULL);
+				r_list_foreach (core->anal->fcns, iter, fcn) {
+					r_vector_push (&addrs, &fcn->addr);
+				}
+				foreach_parallel (core, pc, &addrs);
+				r_vector_fini (&addrs);
+			} else if (core->anal) {
 				RConsGrep grep = core->cons->context->grep;
 				r_list_foreach (core->anal->fcns, iter, fcn) {
 					char *buf;
-					r_core_seek (core, fcn->addr, true);
 					r_cons_push ();
-					r_core_cmd (core, cmd, 0);
+					r_core_cmd_prepared_at (core, pc, fcn->addr);
 					buf = (char *)r_cons_get_buffer ();
 					if (buf) {
 						buf = strdup (buf);
@@ -4441,8 +4505,7 @@ R_API int r_core_cmd_foreach(RCore *core, const char *cmd, char *each) {
 				}
 				//eprintf ("; 0x%08"PFMT64x":\n", addr);
 				each = str + 1;
-				r_core_seek (core, addr, true);
-				r_core_cmd (core, cmd, 0);
+				r_core_cmd_prepared_at (core, pc, addr);
 				r_cons_flush ();
 			} while (str != NULL);
 			free (out);
@@ -4531,6 +4594,17 @@ R_API int r_core_cmd_foreach(RCore *core, const char *cmd, char *each) {
 				};
 				r_flag_foreach_space (core->flags, flagspace, duplicate_flag, &u);
 
+				if (foreach_wants_parallel (core, pc)) {
+					RVector addrs;
+					r_vector_init (&addrs, sizeof (ut64), NULL, NULL);
+					r_list_foreach (match_flag_items, iter, flag) {
+						r_vector_push (&addrs, &flag->offset);
+					}
+					foreach_parallel (core, pc, &addrs);
+					r_vector_fini (&addrs);
+					r_list_purge (match_flag_items);
+				}
+
 				/* for all flags that match */
 				r_list_foreach (match_flag_items, iter, flag) {
 					if (r_cons_is_breaked ()) {
@@ -4539,9 +4613,8 @@ R_API int r_core_cmd_foreach(RCore *core, const char *cmd, char *each) {
 
 					char *buf = NULL;
 					const char *tmp = NULL;
-					r_core_seek (core, flag->offset, true);
 					r_cons_push ();
-					r_core_cmd (core, cmd, 0);
+					r_core_cmd_prepared_at (core, pc, flag->offset);
 					tmp = r_cons_get_buffer ();
 					buf = tmp? strdup (tmp): NULL;
 					r_cons_pop ();
@@ -4562,9 +4635,11 @@ R_API int r_core_cmd_foreach(RCore *core, const char *cmd, char *each) {
 
 	free (word);
 	free (ostr);
+	r_core_cmd_prepared_free (pc);
 	return true;
 out_finish:
 	free (ostr);
+	r_core_cmd_prepared_free (pc);
 	r_cons_break_pop ();
 	return false;
 }
@@ -6723,6 +6798,11 @@ static int run_cmd_depth(RCore *core, char *cmd) {
 			eprintf ("|ERROR| Invalid command '%s' (0x%02x)\n", rcmd, *rcmd);
 			break;
 		}
+		// reanalyze what the line invalidated before running the next one
+		if (core->anal->dirty.len && core->cons->context->cmd_depth + 1 == core->max_cmd_depth
+				&& r_config_get_i (core->config, "anal.incremental")) {
+			r_core_anal_update (core);
+		}
 		if (!ptr) {
 			break;
 		}
@@ -6733,6 +6813,11 @@ static int run_cmd_depth(RCore *core, char *cmd) {
 }
 
 R_API int r_core_cmd(RCore *core, const char *cstr, int log) {
+	// nested commands too: visual mode and r_core_cmd_str callers can run
+	// while a task is preempted
+	if (core->tasks.unsafe > 0 && !r_core_cmd_is_readonly (cstr)) {
+		r_core_task_wait_safe (&core->tasks);
+	}
 	if (core->use_tree_sitter_r2cmd) {
 		return cmdstatus2int(core_cmd_tsr2cmd (core, cstr, false, log));
 	}
@@ -6800,6 +6885,322 @@ beach:
 	return ret;
 }
 
+struct r_core_cmd_prepared_t {
+	char *cmd;
+	char *buf;
+	size_t len;
+	bool simple;
+	bool readonly;
+	TSParser *parser;
+	TSTree *tree;
+};
+
+/* commands without any of these can be dispatched straight to r_cmd_call */
+static bool is_simple_cmd(const char *cmd) {
+	if (!*cmd || IS_DIGIT (*cmd) || strchr ("\".(#|!", *cmd)) {
+		return false;
+	}
+	if (strstr (cmd, "?*") || r_str_startswith (cmd, "GET /cmd/")) {
+		return false;
+	}
+	return !strpbrk (cmd, ";|>@~`$\"'&#\\\n\r");
+}
+
+/* commands that only read core state, safe to run in forked @@ workers */
+static const char *readonly_cmds[] = {
+	"pd", "pdj", "pdf", "pdfj", "pdr", "pdrj", "pds", "pdsf", "pdsj",
+	"pi", "pij", "pif", "pifj", "pid", "pidj",
+	"px", "pxj", "pxw", "pxq", "pxx", "p8", "p8j", "pc", "pcj", "ps", "psz", "pszj",
+	"afi", "afij", "afb", "afbj", "afvj", "afl", "aflj",
+	"ao", "aoj", "axt", "axtj", "axf", "axfj", "?v", "?vi", "?e",
+	NULL
+};
+
+static bool is_readonly_cmd(const char *cmd) {
+	const char *sp = strchr (cmd, ' ');
+	size_t len = sp? sp - cmd: strlen (cmd);
+	int i;
+	for (i = 0; readonly_cmds[i]; i++) {
+		if (strlen (readonly_cmds[i]) == len && !strncmp (readonly_cmds[i], cmd, len)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* true if cmd is a single command known not to modify the core state, so
+ * it can be run from a forked snapshot of the session */
+R_API bool r_core_cmd_is_readonly(const char *cmd) {
+	r_return_val_if_fail (cmd, false);
+	cmd = r_str_trim_head_ro (cmd);
+	return is_simple_cmd (cmd) && is_readonly_cmd (cmd);
+}
+
+/* parse a command once so that it can be run many times, usually at different
+ * offsets, without paying for the tokenization and substitution every time */
+R_API RCoreCmdPrepared *r_core_cmd_prepare(RCore *core, const char *cmd) {
+	r_return_val_if_fail (core && cmd, NULL);
+	RCoreCmdPrepared *pc = R_NEW0 (RCoreCmdPrepared);
+	if (!pc) {
+		return NULL;
+	}
+	pc->cmd = strdup (r_str_trim_head_ro (cmd));
+	if (!pc->cmd) {
+		free (pc);
+		return NULL;
+	}
+	r_str_trim_tail (pc->cmd);
+	pc->readonly = is_simple_cmd (pc->cmd) && is_readonly_cmd (pc->cmd);
+	if (core->use_tree_sitter_r2cmd) {
+		ts_symbols_init (core->rcmd);
+		pc->parser = ts_parser_new ();
+		ts_parser_set_language (pc->parser, (TSLanguage *)core->rcmd->language);
+		pc->tree = ts_parser_parse_string (pc->parser, NULL, pc->cmd, strlen (pc->cmd));
+		TSNode root = ts_tree_root_node (pc->tree);
+		if (!is_ts_commands (root) || ts_node_has_error (root)) {
+			ts_tree_delete (pc->tree);
+			pc->tree = NULL;
+		}
+		return pc;
+	}
+	pc->simple = is_simple_cmd (pc->cmd);
+	if (pc->simple) {
+		pc->len = strlen (pc->cmd);
+		pc->buf = malloc (pc->len + 1);
+		pc->simple = pc->buf;
+	}
+	return pc;
+}
+
+R_API int r_core_cmd_prepared_call(RCore *core, RCoreCmdPrepared *pc) {
+	r_return_val_if_fail (core && pc, -1);
+	if (pc->tree) {
+		struct tsr2cmd_state state = {
+			.parser = pc->parser,
+			.core = core,
+			.input = pc->cmd,
+			.tree = pc->tree,
+		};
+		return cmdstatus2int (handle_ts_commands (&state, ts_tree_root_node (pc->tree)));
+	}
+	if (!pc->simple || core->cmdfilter || core->cmdremote || core->incomment) {
+		return r_core_cmd (core, pc->cmd, 0);
+	}
+	if (core->cons->context->cmd_depth < 1) {
+		eprintf ("r_core_cmd: That was too deep (%s)...\n", pc->cmd);
+		return false;
+	}
+	/* callbacks are allowed to scribble over their input */
+	memcpy (pc->buf, pc->cmd, pc->len + 1);
+	core->cons->context->cmd_depth--;
+	int ret = r_cmd_call (core->rcmd, pc->buf);
+	core->cons->context->cmd_depth++;
+	if (ret == -1) {
+		eprintf ("|ERROR| Invalid command '%s' (0x%02x)\n", pc->cmd, *pc->cmd);
+	}
+	return ret;
+}
+
+R_API int r_core_cmd_prepared_at(RCore *core, RCoreCmdPrepared *pc, ut64 addr) {
+	r_core_seek (core, addr, true);
+	return r_core_cmd_prepared_call (core, pc);
+}
+
+#if LIBC_HAVE_FORK
+static void foreach_worker(RCore *core, RCoreCmdPrepared *pc, const ut64 *addrs, int n, int fd) {
+	int i;
+	/* anything flushed by the commands must end up in order too */
+	dup2 (fd, STDOUT_FILENO);
+	r_cons_push ();
+	for (i = 0; i < n; i++) {
+		r_core_cmd_prepared_at (core, pc, addrs[i]);
+		int len = r_cons_get_buffer_len ();
+		if (len > 0 && (len > 0x10000 || i + 1 == n)) {
+			if (write (fd, r_cons_get_buffer (), len) != len) {
+				break;
+			}
+			r_cons_pop ();
+			r_cons_push ();
+		}
+	}
+	close (fd);
+	_exit (0);
+}
+#endif
+
+#if LIBC_HAVE_FORK
+/* a child forked from a threaded process may inherit locks that another
+ * thread was holding (tasks, cons, malloc arenas) and hang on them, so the
+ * workers are only forked from single threaded processes */
+static bool process_is_threaded(RCore *core) {
+	if (core->http_up || r_core_task_running_tasks_count (&core->tasks) > 0) {
+		return true;
+	}
+#if __linux__
+	// also covers the threads of programs embedding r_core
+	char *status = r_file_slurp ("/proc/self/status", NULL);
+	const char *threads = status? strstr (status, "\nThreads:"): NULL;
+	bool ret = !threads || atoi (threads + 9) > 1;
+	free (status);
+	return ret;
+#else
+	return false;
+#endif
+}
+#endif
+
+static bool foreach_wants_parallel(RCore *core, RCoreCmdPrepared *pc) {
+#if LIBC_HAVE_FORK
+	if (!pc || !pc->readonly || r_config_get_i (core->config, "cmd.workers") < 2 || r_sandbox_enable (0)) {
+		return false;
+	}
+	if (process_is_threaded (core)) {
+		return false;
+	}
+	/* a forked child can't talk to the debuggee of its parent */
+	if (r_config_get_i (core->config, "cfg.debug") || (core->bin && core->bin->is_debugger)) {
+		return false;
+	}
+	RIODesc *desc = core->io? core->io->desc: NULL;
+	return !(desc && desc->plugin && desc->plugin->isdbg);
+#else
+	return false;
+#endif
+}
+
+/* run a read-only prepared command at each address splitting the work across
+ * cmd.workers forked processes, each one owning a copy of the core and a cons
+ * context, and concatenate their outputs in iteration order. RCore can't be
+ * shared by threads running commands (seek, block, analysis caches), so the
+ * workers are processes. Only @@ globs, @@f, @@i and @@s come here, the
+ * other iterators run serially */
+static void foreach_parallel(RCore *core, RCoreCmdPrepared *pc, RVector *vaddrs) {
+	const ut64 *addrs = vaddrs->a;
+	const int n = vaddrs->len;
+	int i;
+#if LIBC_HAVE_FORK
+	int nworkers = R_MIN (r_config_get_i (core->config, "cmd.workers"), n);
+	if (nworkers < 2) {
+		for (i = 0; i < n && !r_cons_is_breaked (); i++) {
+			r_core_cmd_prepared_at (core, pc, addrs[i]);
+		}
+		return;
+	}
+	int *pids = R_NEWS0 (int, nworkers);
+	int *fds = R_NEWS0 (int, nworkers);
+	RStrBuf **outs = R_NEWS0 (RStrBuf *, nworkers);
+	struct pollfd *pfds = R_NEWS0 (struct pollfd, nworkers);
+	if (!pids || !fds || !outs || !pfds) {
+		free (pids);
+		free (fds);
+		free (outs);
+		free (pfds);
+		return;
+	}
+#define SLICE(x) ((int)((st64)n * (x) / nworkers))
+	for (i = 0; i < nworkers; i++) {
+		int p[2];
+		pids[i] = -1;
+		if (pipe (p) == -1) {
+			continue;
+		}
+		pids[i] = r_sys_fork ();
+		if (pids[i] == 0) {
+			close (p[0]);
+			foreach_worker (core, pc, addrs + SLICE (i), SLICE (i + 1) - SLICE (i), p[1]);
+		}
+		close (p[1]);
+		fds[i] = p[0];
+		if (pids[i] == -1) {
+			close (p[0]);
+		}
+	}
+	/* drain all the pipes at once so no worker blocks on a full pipe, the
+	 * output of the workers behind the current one is kept until it's their turn */
+	char buf[0x4000];
+	int head = 0, alive = 0;
+	for (i = 0; i < nworkers; i++) {
+		pfds[i].fd = (pids[i] == -1)? -1: fds[i];
+		pfds[i].events = POLLIN;
+		if (pfds[i].fd != -1) {
+			alive++;
+		}
+	}
+	while (head < nworkers && !r_cons_is_breaked ()) {
+		if (pids[head] == -1 || pfds[head].fd == -1) {
+			if (pids[head] == -1) {
+				/* could not spawn this worker, do its share here */
+				int j;
+				for (j = SLICE (head); j < SLICE (head + 1) && !r_cons_is_breaked (); j++) {
+					r_core_cmd_prepared_at (core, pc, addrs[j]);
+				}
+			}
+			/* the next worker's turn, starting with what it already wrote */
+			if (++head < nworkers && outs[head]) {
+				r_cons_memcat (r_strbuf_get (outs[head]), r_strbuf_length (outs[head]));
+				r_strbuf_free (outs[head]);
+				outs[head] = NULL;
+			}
+			continue;
+		}
+		if (alive < 1 || poll (pfds, nworkers, 100) < 1) {
+			continue;
+		}
+		for (i = head; i < nworkers; i++) {
+			if (pfds[i].fd == -1 || !pfds[i].revents) {
+				continue;
+			}
+			ssize_t r = read (fds[i], buf, sizeof (buf));
+			if (r < 1) {
+				pfds[i].fd = -1;
+				alive--;
+			} else if (i == head) {
+				r_cons_memcat (buf, r);
+			} else {
+				if (!outs[i]) {
+					outs[i] = r_strbuf_new (NULL);
+				}
+				r_strbuf_append_n (outs[i], buf, r);
+			}
+		}
+	}
+	for (i = 0; i < nworkers; i++) {
+		if (pids[i] == -1) {
+			continue;
+		}
+		if (head <= i) {
+			kill (pids[i], SIGKILL);
+		}
+		close (fds[i]);
+		waitpid (pids[i], NULL, 0);
+		r_strbuf_free (outs[i]);
+	}
+#undef SLICE
+	free (pids);
+	free (fds);
+	free (outs);
+	free (pfds);
+#else
+	for (i = 0; i < n && !r_cons_is_breaked (); i++) {
+		r_core_cmd_prepared_at (core, pc, addrs[i]);
+	}
+#endif
+}
+
+R_API void r_core_cmd_prepared_free(RCoreCmdPrepared *pc) {
+	if (pc) {
+		if (pc->tree) {
+			ts_tree_delete (pc->tree);
+		}
+		if (pc->parser) {
+			ts_parser_delete (pc->parser);
+		}
+		free (pc->buf);
+		free (pc->cmd);
+		free (pc);
+	}
+}
+
 R_API int r_core_cmd_lines(RCore *core, const char *lines) {
 	if (core->use_tree_sitter_r2cmd) {
 		RCmdStatus status = core_cmd_tsr2cmd (core, lines, true, false);
@@ -49,6 +49,7 @@ static const char *help_msg_aa[] = {
 	"aaF", " [sym*]", "set anal.in=block for all the spaces between flags matching glob",
 	"aaFa", " [sym*]", "same as aaF but uses af/a2f instead of af+/afb+ (slower but more accurate)",
 	"aai", "[j]", "show info of all analysis parameters",
+	"aaim", "[j]", "show memory stats of the analysis object pools and interned strings",
 	"aan", "[gr?]", "autoname functions (aang = golang, aanr = noreturn propagation)",
 	"aao", "", "analyze all objc references",
 	"aap", "", "find and analyze function preludes",
@@ -58,10 +59,19 @@ static const char *help_msg_aa[] = {
 	"aat", " [fcn]", "Analyze all/given function to convert immediate to linked structure offsets (see tl?)",
 	"aaT", " [len]", "analyze code after trap-sleds",
 	"aau", " [len]", "list mem areas (larger than len bytes) not covered by functions",
+	"aaU", "[?]", "analyze again the functions invalidated by writes and hint changes",
 	"aav", " [sat]", "find values referencing a specific section or map",
 	NULL
 };
 
+static const char *help_msg_aaU[] = {
+	"Usage:", "aaU", "[l-] # incremental analysis (see anal.incremental)",
+	"aaU", "", "analyze again the functions invalidated by writes and hint changes",
+	"aaUl", "[j]", "list what was invalidated and the functions affected",
+	"aaU-", "", "forget the invalidations without analyzing anything",
+	NULL
+};
+
 static const char *help_msg_afls[] = {
 	"Usage:", "afls", "[afls] # sort function list",
 	"afls", "", "same as aflsa",
@@ -626,6 +636,7 @@ static const char *help_msg_ao[] = {
 	"aod", " [mnemonic]", "describe opcode for asm.arch",
 	"aoda", "", "show all mnemonic descriptions",
 	"aoc", " [cycles]", "analyze which op could be executed in [cycles]",
+	"aoC", "[-]", "show decoded op cache hit rates (aoC- to flush it)",
 	"ao", " 5", "display opcode analysis of 5 opcodes",
 	"ao*", "", "display opcode in r commands",
 	NULL
@@ -886,8 +897,15 @@ static bool cmd_anal_aaft(RCore *core) {
 	r_reg_arena_zero (core->anal->reg);
 	r_core_cmd0 (core, "aei;aeim");
 	ut8 *saved_arena = r_reg_arena_peek (core->anal->reg);
+	int cached = 0, total = 0;
 	// Iterating Reverse so that we get function in top-bottom call order
 	r_list_foreach_prev (core->anal->fcns, it, fcn) {
+		total++;
+		// nothing the pass depends on changed since it last ran on this function
+		if (fcn->tp_key && fcn->tp_key == r_core_anal_type_match_key (core, fcn)) {
+			cached++;
+			continue;
+		}
 		int ret = r_core_seek (core, fcn->addr, true);
 		if (!ret) {
 			continue;
@@ -899,6 +917,10 @@ static bool cmd_anal_aaft(RCore *core) {
 			break;
 		}
 		__add_vars_sdb (core, fcn);
+		fcn->tp_key = r_core_anal_type_match_key (core, fcn);
+	}
+	if (core->anal->verbose) {
+		eprintf ("aaft: %d functions, %d unchanged since the last pass\n", total, cached);
 	}
 	r_core_seek (core, seek, true);
 	r_reg_arena_pop (core->anal->reg);
@@ -1326,8 +1348,9 @@ static int var_cmd(RCore *core, const char *str) {
 				free (ostr);
 				return false;
 			}
-			char *old_name = strchr (new_name, ' ');
-			if (!old_name) {
+			const char *old_name;
+			char *space = strchr (new_name, ' ');
+			if (!space) {
 				RAnalVar *var = op ? r_anal_get_used_function_var (core->anal, op->addr) : NULL;
 				if (var) {
 					old_name = var->name;
@@ -1338,8 +1361,9 @@ static int var_cmd(RCore *core, const char *str) {
 					return false;
 				}
 			} else {
-				*old_name++ = 0;
-				r_str_trim (old_name);
+				*space++ = 0;
+				r_str_trim (space);
+				old_name = space;
 			}
 			if (fcn) {
 				v1 = r_anal_function_get_var_byname (fcn, old_name);
@@ -6486,6 +6510,25 @@ static void cmd_anal_opcode(RCore *core, const char *input) {
 		r_config_set_i (core->config, "asm.xrefs", xr);
 	}
 	break;
+	case 'C': // "aoC"
+	{
+		RAnalOpCache *c = core->anal->opcache;
+		if (!c) {
+			eprintf ("The decoded op cache is disabled, see anal.opcache\n");
+		} else if (input[1] == '-') {
+			r_anal_opcache_clear (c);
+		} else {
+			ut64 n = c->hits + c->misses;
+			ut64 tn = c->text_hits + c->text_misses;
+			r_cons_printf ("addrs %"PFMT64u" (max %"PFMT64u" entries)\n", (ut64)c->ht->count, (ut64)c->size);
+			r_cons_printf ("epoch %"PFMT64u"\n", c->epoch);
+			r_cons_printf ("ops   %"PFMT64u" hits %"PFMT64u" misses (%.1f%%)\n",
+				c->hits, c->misses, n? c->hits * 100.0 / n: 0.0);
+			r_cons_printf ("text  %"PFMT64u" hits %"PFMT64u" misses (%.1f%%)\n",
+				c->text_hits, c->text_misses, tn? c->text_hits * 100.0 / tn: 0.0);
+		}
+	}
+		break;
 	case 'd': // "aod"
 		if (input[1] == 'a') { // "aoda"
 			// list sdb database
@@ -7868,7 +7911,7 @@ static void cmd_anal_hint(RCore *core, const char *input) {
 			r_str_trim (off);
 			int toff = r_num_math (NULL, off);
 			if (toff) {
-				RList *typeoffs = r_type_get_by_offset (core->anal->sdb_types, toff);
+				RList *typeoffs = r_anal_type_get_by_offset (core->anal, toff);
 				RListIter *iter;
 				char *ty;
 				r_list_foreach (typeoffs, iter, ty) {
@@ -7937,7 +7980,7 @@ static void cmd_anal_hint(RCore *core, const char *input) {
 						offimm += r_num_math (NULL, off);
 					}
 					// TODO: Allow to select from multiple choices
-					RList *otypes = r_type_get_by_offset (core->anal->sdb_types, offimm);
+					RList *otypes = r_anal_type_get_by_offset (core->anal, offimm);
 					RListIter *iter;
 					char *otype = NULL;
 					r_list_foreach (otypes, iter, otype) {
@@ -8789,7 +8832,148 @@ static int compute_calls(RCore *core) {
 	return cov;
 }
 
+static void anal_pool_info(RCore *core, PJ *pj, const char *name, RMemoryPool *pool) {
+	ut64 chunk = (ut64)pool->nodesize * pool->poolsize;
+	if (pj) {
+		pj_ko (pj, name);
+		pj_kn (pj, "allocs", pool->allocs);
+		pj_kn (pj, "live", pool->live);
+		pj_kn (pj, "peak", pool->peak);
+		pj_kn (pj, "memory", chunk * pool->npool);
+		pj_end (pj);
+	} else {
+		r_cons_printf ("%-6s allocs %"PFMT64u" live %"PFMT64u" peak %"PFMT64u" memory %"PFMT64u"\n",
+			name, pool->allocs, pool->live, pool->peak, chunk * pool->npool);
+	}
+}
+
+typedef struct {
+	RList *fcns;
+	PJ *pj;
+} DirtyListCtx;
+
+static bool dirty_list_cb(RAnalBlock *bb, void *user) {
+	DirtyListCtx *ctx = user;
+	RListIter *iter;
+	RAnalFunction *fcn;
+	if (!bb->dirty) {
+		return true;
+	}
+	r_list_foreach (bb->fcns, iter, fcn) {
+		if (r_list_contains (ctx->fcns, fcn)) {
+			continue;
+		}
+		r_list_append (ctx->fcns, fcn);
+		if (ctx->pj) {
+			pj_s (ctx->pj, fcn->name);
+		} else {
+			r_cons_printf (" %s", fcn->name);
+		}
+	}
+	return true;
+}
+
+// "aaUl"
+static void cmd_anal_update_list(RCore *core, const char *input) {
+	DirtyListCtx ctx = { r_list_new (), NULL };
+	if (*input == 'j') {
+		ctx.pj = pj_new ();
+		if (!ctx.pj) {
+			r_list_free (ctx.fcns);
+			return;
+		}
+		pj_a (ctx.pj);
+	}
+	RAnalDirty *d;
+	r_vector_foreach (&core->anal->dirty, d) {
+		const char *reason = r_anal_dirty_reason_tostring (d->reason);
+		if (ctx.pj) {
+			pj_o (ctx.pj);
+			pj_kn (ctx.pj, "addr", d->addr);
+			pj_kn (ctx.pj, "size", d->size);
+			pj_ks (ctx.pj, "reason", reason);
+			pj_k (ctx.pj, "fcns");
+			pj_a (ctx.pj);
+		} else {
+			r_cons_printf ("0x%08"PFMT64x" %"PFMT64u" %s", d->addr, d->size, reason);
+		}
+		r_list_purge (ctx.fcns);
+		r_anal_blocks_foreach_intersect (core->anal, d->addr, d->size, dirty_list_cb, &ctx);
+		if (ctx.pj) {
+			pj_end (ctx.pj);
+			pj_end (ctx.pj);
+		} else {
+			r_cons_newline ();
+		}
+	}
+	if (ctx.pj) {
+		pj_end (ctx.pj);
+		r_cons_println (pj_string (ctx.pj));
+		pj_free (ctx.pj);
+	}
+	r_list_free (ctx.fcns);
+}
+
+// "aaU" incremental analysis
+static void cmd_anal_update(RCore *core, const char *input) {
+	switch (*input) {
+	case 'l': // "aaUl"
+		cmd_anal_update_list (core, input + 1);
+		break;
+	case '-': // "aaU-"
+		r_anal_dirty_clear (core->anal);
+		break;
+	case '\0':
+		r_core_anal_update (core);
+		break;
+	default:
+		r_core_cmd_help (core, help_msg_aaU);
+		break;
+	}
+}
+
+static void anal_strpool_info(RCore *core, PJ *pj) {
+	RStrConstPoolStats st;
+	r_str_constpool_stats (&core->anal->constpool, &st);
+	if (pj) {
+		pj_ko (pj, "strs");
+		pj_kn (pj, "strings", st.strings);
+		pj_kn (pj, "refs", st.refs);
+		pj_kn (pj, "memory", st.bytes);
+		pj_kn (pj, "saved", st.saved);
+		pj_end (pj);
+	} else {
+		r_cons_printf ("%-6s strings %"PFMT64u" refs %"PFMT64u" memory %"PFMT64u" saved %"PFMT64u"\n", "strs",
+			(ut64)st.strings, (ut64)st.refs, (ut64)st.bytes, (ut64)st.saved);
+	}
+}
+
+// "aaim" show memory stats of the analysis object pools and interned strings
+static void r_core_anal_info_pools(RCore *core, const char *input) {
+	PJ *pj = NULL;
+	if (*input == 'j') {
+		pj = pj_new ();
+		if (!pj) {
+			return;
+		}
+		pj_o (pj);
+	}
+	anal_pool_info (core, pj, "blocks", core->anal->block_pool);
+	anal_pool_info (core, pj, "fcns", core->anal->fcn_pool);
+	anal_pool_info (core, pj, "refs", core->anal->ref_pool);
+	anal_strpool_info (core, pj);
+	if (pj) {
+		pj_end (pj);
+		r_cons_println (pj_string (pj));
+		pj_free (pj);
+	}
+}
+
 static void r_core_anal_info (RCore *core, const char *input) {
+	if (*input == 'm') {
+		r_core_anal_info_pools (core, input + 1);
+		return;
+	}
 	int fcns = r_list_length (core->anal->fcns);
 	int strs = r_flag_count (core->flags, "str.*");
 	int syms = r_flag_count (core->flags, "sym.*");
@@ -9159,6 +9343,9 @@ static int cmd_anal_all(RCore *core, const char *input) {
 	case 'u': // "aau" - print areas not covered by functions
 		r_core_anal_nofunclist (core, input + 1);
 		break;
+	case 'U': // "aaU"
+		cmd_anal_update (core, input + 1);
+		break;
 	case 'i': // "aai"
 		r_core_anal_info (core, input + 1);
 		break;
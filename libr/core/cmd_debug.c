@@ -90,6 +90,10 @@ static const char *help_msg_db[] = {
 	"dbt", "[?]", "Show backtrace. See dbt? for more details",
 	"dbx", " [expr]", "Set expression for bp in current offset",
 	"dbw", " <addr> <r/w/rw>", "Add watchpoint",
+	"dbv", "[j]", "List coverage breakpoints hit so far (dbvs for a summary)",
+	"dbv", " <addr> [addr ...]", "Add one-shot coverage breakpoints (record the hit and continue)",
+	"dbvb", "", "Add coverage breakpoints at the start of every basic block",
+	"dbv-", "", "Remove all coverage breakpoints and forget the hits",
 #if __WINDOWS__
 	"dbW", " <WM_DEFINE> [?|handle|name]", "Set cond. breakpoint on a window message handler",
 #endif
@@ -453,6 +457,7 @@ static const char *help_msg_dt[] = {
 	"dtg", "", "Graph call/ret trace",
 	"dtg*", "", "Graph in agn/age commands. use .dtg*;aggi for visual",
 	"dtgi", "", "Interactive debug trace",
+	"dtr", "[?]", "Record stepped instructions into a binary trace file",
 	"dts", "[?]", "Trace sessions",
 	"dtt", " [tag]", "Select trace tag (no arg unsets)",
 	NULL
@@ -478,6 +483,19 @@ static const char *help_msg_dts[] = {
 	NULL
 };
 
+static const char *help_msg_dtr[] = {
+	"Usage:", "dtr[+-ilpws]", " Binary instruction trace",
+	"dtr", "", "Show recording status",
+	"dtr+", " [file]", "Record pc, written registers and memory of every step",
+	"dtr-", "", "Stop recording and close the trace file",
+	"dtri", " [file]", "Summary of a trace file",
+	"dtrl", " [file]", "List all the events of a trace file",
+	"dtrp", " [file] [addr]", "List the steps that executed addr",
+	"dtrw", " [file] [addr]", "List the steps that wrote to addr",
+	"dtrs", " [file] [step]", "Replay registers (ar) and memory (io cache, see io.cache.read) up to that step, the target is not written",
+	NULL
+};
+
 static const char *help_msg_dx[] = {
 	"Usage: dx", "", " # Code injection commands",
 	"dx", " <opcode>...", "Inject opcodes",
@@ -537,10 +555,158 @@ static void cmd_debug_init(RCore *core, RCmdDesc *parent) {
 	DEFINE_CMD_DESCRIPTOR (core, ds);
 	DEFINE_CMD_DESCRIPTOR (core, dt);
 	DEFINE_CMD_DESCRIPTOR (core, dte);
+	DEFINE_CMD_DESCRIPTOR (core, dtr);
 	DEFINE_CMD_DESCRIPTOR (core, dts);
 	DEFINE_CMD_DESCRIPTOR (core, dx);
 }
 
+typedef struct {
+	RCore *core;
+	int mode;
+	ut64 addr;
+	ut64 steps;
+	ut64 regs;
+	ut64 mems;
+	ut64 bytes;
+	SetU *pcs;
+} TraceRecQuery;
+
+static bool trace_rec_query_cb(void *user, const RDebugTraceEvent *ev) {
+	TraceRecQuery *q = user;
+	switch (ev->type) {
+	case R_DEBUG_TRACE_REC_STEP:
+		q->steps++;
+		if (q->pcs) {
+			set_u_add (q->pcs, ev->pc);
+		}
+		if (q->mode == 'l' || (q->mode == 'p' && ev->pc == q->addr)) {
+			r_cons_printf ("%"PFMT64u" 0x%08"PFMT64x"\n", ev->step, ev->pc);
+		}
+		break;
+	case R_DEBUG_TRACE_REC_REG:
+		q->regs++;
+		if (q->mode == 'l') {
+			RRegItem *ri = NULL;
+			if (ev->arena < R_REG_TYPE_LAST) {
+				RListIter *iter;
+				RRegItem *r;
+				r_list_foreach (q->core->dbg->reg->regset[ev->arena].regs, iter, r) {
+					if (r->offset == ev->offset) {
+						ri = r;
+						break;
+					}
+				}
+			}
+			if (ri) {
+				r_cons_printf ("  %s = 0x%"PFMT64x"\n", ri->name, ev->value);
+			} else {
+				r_cons_printf ("  reg.%d.%d = 0x%"PFMT64x"\n", ev->arena, ev->offset, ev->value);
+			}
+		}
+		break;
+	case R_DEBUG_TRACE_REC_MEM:
+		q->mems++;
+		q->bytes += ev->len;
+		if (q->mode == 'l') {
+			char *hex = r_hex_bin2strdup (ev->data, ev->len);
+			r_cons_printf ("  [0x%08"PFMT64x"] = %s\n", ev->addr, hex);
+			free (hex);
+		} else if (q->mode == 'w' && R_BETWEEN (ev->addr, q->addr, ev->addr + ev->len - 1)) {
+			r_cons_printf ("%"PFMT64u" 0x%08"PFMT64x" 0x%02x\n", ev->step, ev->pc, ev->data[q->addr - ev->addr]);
+		}
+		break;
+	default:
+		break;
+	}
+	return !r_cons_is_breaked ();
+}
+
+// "dtr" binary trace recorder
+static void cmd_debug_trace_rec(RCore *core, const char *input) {
+	RDebugTrace *t = core->dbg->trace;
+	TraceRecQuery q = { core, *input };
+	char *args = NULL;
+	const char *file = NULL;
+	if (*input && input[1] == ' ') {
+		args = r_str_trim_dup (input + 2);
+		char *arg = strchr (args, ' ');
+		if (arg) {
+			*arg++ = 0;
+			q.addr = r_num_math (core->num, arg);
+		}
+		file = args;
+	}
+	if (t->rec && *input != '-') {
+		// the file may be the one being recorded
+		r_debug_trace_rec_flush (t->rec);
+	}
+	switch (*input) {
+	case '\0': // "dtr"
+		if (t->rec) {
+			r_debug_trace_rec_info (t->rec, (PrintfCallback)r_cons_printf);
+		} else {
+			eprintf ("Not recording. Use dtr+ [file]\n");
+		}
+		break;
+	case '+': // "dtr+"
+		if (t->rec) {
+			eprintf ("Already recording, stop it with dtr-\n");
+			break;
+		}
+		if (!file) {
+			eprintf ("Usage: dtr+ [file]\n");
+			break;
+		}
+		t->rec = r_debug_trace_rec_new (file);
+		if (t->rec) {
+			r_debug_reg_sync (core->dbg, R_REG_TYPE_ALL, false);
+			r_debug_trace_rec_regs (t->rec, core->dbg->reg);
+		}
+		break;
+	case '-': // "dtr-"
+		r_debug_trace_rec_free (t->rec);
+		t->rec = NULL;
+		break;
+	case 'i': // "dtri"
+	case 'l': // "dtrl"
+	case 'p': // "dtrp"
+	case 'w': // "dtrw"
+	case 's': // "dtrs"
+		if (!file) {
+			eprintf ("Missing trace file\n");
+			break;
+		}
+		if (*input == 's') {
+			// the target is not written, see the result with ar and io.cache reads
+			ut64 n = r_debug_trace_rec_replay (core->dbg, file, q.addr);
+			if (!r_config_get_i (core->config, "io.cache.read")) {
+				eprintf ("Memory was replayed into the io cache, e io.cache.read=true to see it\n");
+			}
+			r_cons_printf ("%"PFMT64u"\n", n);
+			break;
+		}
+		q.pcs = (*input == 'i')? set_u_new (): NULL;
+		r_cons_break_push (NULL, NULL);
+		if (!r_debug_trace_rec_foreach (file, trace_rec_query_cb, &q)) {
+			eprintf ("Cannot read trace from %s\n", file);
+		}
+		r_cons_break_pop ();
+		if (q.pcs) {
+			r_cons_printf ("steps %"PFMT64u"\n", q.steps);
+			r_cons_printf ("pcs %"PFMT64u"\n", (ut64)q.pcs->count);
+			r_cons_printf ("regs %"PFMT64u"\n", q.regs);
+			r_cons_printf ("writes %"PFMT64u"\n", q.mems);
+			r_cons_printf ("written %"PFMT64u"\n", q.bytes);
+			set_u_free (q.pcs);
+		}
+		break;
+	default:
+		r_core_cmd_help (core, help_msg_dtr);
+		break;
+	}
+	free (args);
+}
+
 // XXX those tmp files are never removed and we shuoldnt use files for this
 static void setRarunProfileString(RCore *core, const char *str) {
 	char *file = r_file_temp ("rarun2");
@@ -3335,6 +3501,51 @@ static void add_breakpoint(RCore *core, const char *input, bool hwbp, bool watch
 	free (str);
 }
 
+static void cmd_debug_bp_coverage(RCore *core, const char *input) {
+	RBreakpoint *bp = core->dbg->bp;
+	RVector addrs;
+	switch (*input) {
+	case ' ': // "dbv "
+	case 'b': // "dbvb"
+		r_vector_init (&addrs, sizeof (ut64), NULL, NULL);
+		if (*input == 'b') {
+			RAnalFunction *fcn;
+			RAnalBlock *bb;
+			RListIter *iter, *iter2;
+			r_list_foreach (core->anal->fcns, iter, fcn) {
+				r_list_foreach (fcn->bbs, iter2, bb) {
+					r_vector_push (&addrs, &bb->addr);
+				}
+			}
+		} else {
+			char *args = strdup (input + 1);
+			int i, n = r_str_word_set0 (args);
+			for (i = 0; i < n; i++) {
+				ut64 addr = r_num_math (core->num, r_str_word_get0 (args, i));
+				r_vector_push (&addrs, &addr);
+			}
+			free (args);
+		}
+		if (!r_vector_empty (&addrs)) {
+			int n = r_bp_add_coverage (bp, addrs.a, addrs.len);
+			eprintf ("%d coverage breakpoints added\n", n);
+		}
+		r_vector_fini (&addrs);
+		break;
+	case '-': // "dbv-"
+		r_bp_del_coverage (bp);
+		break;
+	case 0: // "dbv"
+	case 'j': // "dbvj"
+	case 's': // "dbvs"
+		r_bp_coverage_list (bp, *input);
+		break;
+	default:
+		r_core_cmd_help (core, help_msg_db);
+		break;
+	}
+}
+
 static void r_core_cmd_bp(RCore *core, const char *input) {
 	RBreakpointItem *bpi;
 	int i, hwbp = r_config_get_i (core->config, "dbg.hwbp");
@@ -3737,6 +3948,9 @@ static void r_core_cmd_bp(RCore *core, const char *input) {
 	case 'w': // "dbw"
 		add_breakpoint (core, input + 1, hwbp, true);
 		break;
+	case 'v': // "dbv"
+		cmd_debug_bp_coverage (core, input + 2);
+		break;
 	case 'H': // "dbH"
 		add_breakpoint (core, input + 1, true, watch);
 		break;
@@ -4851,8 +5065,8 @@ static int cmd_debug(void *data, const char *input) {
 			case '-': // "dte-"
 				if (!strcmp (input + 3, "*")) {
 					if (core->anal->esil) {
-						sdb_free (core->anal->esil->db_trace);
-						core->anal->esil->db_trace = sdb_new0 ();
+						r_anal_esil_trace_free (core->anal->esil->trace);
+						core->anal->esil->trace = NULL;
 					}
 				} else {
 					eprintf ("TODO: dte- cannot delete specific logs. Use dte-*\n");
@@ -4865,10 +5079,13 @@ static int cmd_debug(void *data, const char *input) {
 			} break;
 			case 'k': // "dtek"
 				if (input[3] == ' ') {
-					char *s = sdb_querys (core->anal->esil->db_trace,
-							NULL, 0, input + 4);
+					RAnalEsil *esil = core->anal->esil;
+					Sdb *db = (esil && esil->trace)
+						? r_anal_esil_trace_sdb (esil->trace): sdb_new0 ();
+					char *s = sdb_querys (db, NULL, 0, input + 4);
 					r_cons_println (s);
 					free (s);
+					sdb_free (db);
 				} else {
 					eprintf ("Usage: dtek [query]\n");
 				}
@@ -4877,6 +5094,9 @@ static int cmd_debug(void *data, const char *input) {
 				r_core_cmd_help (core, help_msg_dte);
 			}
 			break;
+		case 'r': // "dtr"
+			cmd_debug_trace_rec (core, input + 2);
+			break;
 		case 's': // "dts"
 			switch (input[2]) {
 			case '+': // "dts+"
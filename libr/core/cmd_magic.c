@@ -12,6 +12,21 @@ static void r_core_magic_reset(RCore *core) {
 	kw_count = 0;
 }
 
+/* prefilter for scanning with /m, the caller frees it after the search */
+static RMagicIndex *r_core_magic_index(RCore *core, const char *file) {
+	RMagicIndex *idx = NULL;
+	if (file && *file == ' ') {
+		file++;
+	}
+	const char *path = R_STR_ISNOTEMPTY (file)? file: r_config_get (core->config, "dir.magic");
+	RMagic *ms = r_magic_new (0);
+	if (ms && r_magic_load (ms, path)) {
+		idx = r_magic_index_new (ms);
+	}
+	r_magic_free (ms);
+	return idx;
+}
+
 static int r_core_magic_at(RCore *core, const char *file, ut64 addr, int depth, int v, bool json, int *hits) {
 	const char *fmt;
 	char *q, *p;
@@ -928,7 +928,6 @@ struct __rebase_struct {
 	RList *old_sections;
 	ut64 old_base;
 	ut64 diff;
-	int type;
 };
 
 #define __is_inside_section(item_addr, section)\
@@ -949,25 +948,6 @@ static bool __rebase_flags(RFlagItem *flag, void *user) {
 	return true;
 }
 
-static bool __rebase_refs_i(void *user, const ut64 k, const void *v) {
-	struct __rebase_struct *reb = (void *)user;
-	RAnalRef *ref = (RAnalRef *)v;
-	ref->addr += reb->diff;
-	ref->at += reb->diff;
-	if (reb->type) {
-		r_anal_xrefs_set (reb->core->anal, ref->addr, ref->at, ref->type);
-	} else {
-		r_anal_xrefs_set (reb->core->anal, ref->at, ref->addr, ref->type);
-	}
-	return true;
-}
-
-static bool __rebase_refs(void *user, const ut64 k, const void *v) {
-	HtUP *ht = (HtUP *)v;
-	ht_up_foreach (ht, __rebase_refs_i, user);
-	return true;
-}
-
 static void __rebase_everything(RCore *core, RList *old_sections, ut64 old_base) {
 	RListIter *it, *itit, *ititit;
 	RAnalFunction *fcn;
@@ -1017,17 +997,17 @@ static void __rebase_everything(RCore *core, RList *old_sections, ut64 old_base)
 	r_meta_rebase (core->anal, diff);
 
 	// REFS
-	HtUP *old_refs = core->anal->dict_refs;
-	HtUP *old_xrefs = core->anal->dict_xrefs;
-	core->anal->dict_refs = NULL;
-	core->anal->dict_xrefs = NULL;
-	r_anal_xrefs_init (core->anal);
-	reb.type = 0;
-	ht_up_foreach (old_refs, __rebase_refs, &reb);
-	reb.type = 1;
-	ht_up_foreach (old_xrefs, __rebase_refs, &reb);
-	ht_up_free (old_refs);
-	ht_up_free (old_xrefs);
+	// every xref is the mirror of a ref, so re-adding the refs restores both
+	RList *refs = r_anal_ref_list_new ();
+	if (refs) {
+		RAnalRef *ref;
+		r_anal_xrefs_from (core->anal, refs, "ref", R_ANAL_REF_TYPE_NULL, UT64_MAX);
+		r_anal_xrefs_init (core->anal);
+		r_list_foreach (refs, it, ref) {
+			r_anal_xrefs_set (core->anal, ref->at + diff, ref->addr + diff, ref->type);
+		}
+		r_list_free (refs);
+	}
 
 	// BREAKPOINTS
 	r_debug_bp_rebase (core->dbg, old_base, new_base);
@@ -109,6 +109,7 @@ static const char *help_msg_amper[] = {
 	"Usage:", "&[-|<cmd>]", "Manage tasks (WARNING: Experimental. Use with caution!)",
 	"&", " <cmd>", "run <cmd> in a new background task",
 	"&t", " <cmd>", "run <cmd> in a new transient background task (auto-delete when it is finished)",
+	"&p", " <n> <cmd>", "run <cmd> in a new background task with priority <n> (0-10, the prompt has 10)",
 	"&", "", "list all tasks",
 	"&j", "", "list all tasks (in JSON)",
 	"&=", " 3", "show output of task 3",
@@ -13,6 +13,7 @@ static int cmd_search(void *data, const char *input);
 
 #define AES_SEARCH_LENGTH 40
 #define PRIVATE_KEY_SEARCH_LENGTH 11
+#define MAGIC_CHUNK 0x100000
 
 static const char *help_msg_search_esil[] = {
 	"/E", " [esil-expr]", "search offsets matching a specific esil expression",
@@ -3419,28 +3420,57 @@ reread:
 			r_core_magic_reset (core);
 			int maxHits = r_config_get_i (core->config, "search.maxhits");
 			int hits = 0;
+			// only run libmagic where the index says some test can match
+			RMagicIndex *idx = r_core_magic_index (core, file);
+			const int window = core->blocksize;
+			ut8 *buf = malloc (MAGIC_CHUNK + window);
+			ut8 *cand = malloc (MAGIC_CHUNK + window);
+			if (!buf || !cand) {
+				free (buf);
+				free (cand);
+				r_magic_index_free (idx);
+				goto beach;
+			}
 			r_list_foreach (param.boundaries, iter, map) {
 				if (param.outmode != R_MODE_JSON) {
 					eprintf ("-- %llx %llx\n", map->itv.addr, r_itv_end (map->itv));
 				}
 				r_cons_break_push (NULL, NULL);
-				for (addr = map->itv.addr; addr < r_itv_end (map->itv); addr++) {
-					if (r_cons_is_breaked ()) {
-						break;
-					}
-					ret = r_core_magic_at (core, file, addr, 99, false, param.outmode == R_MODE_JSON, &hits);
-					if (ret == -1) {
-						// something went terribly wrong.
-						break;
+				ut64 from = map->itv.addr, to = r_itv_end (map->itv);
+				ret = 0;
+				for (addr = from; addr < to && ret != -1 && !r_cons_is_breaked ();) {
+					ut64 at = addr, n = R_MIN (MAGIC_CHUNK, to - at);
+					(void)r_io_read_at (core->io, at, buf, n + window);
+					r_magic_index_scan (idx, buf, n + window, window, cand);
+					if (param.outmode != R_MODE_JSON) {
+						eprintf ("0x%08" PFMT64x " [%d matches found]\r", at, hits);
 					}
-					if (maxHits && hits >= maxHits) {
-						break;
+					for (; addr < at + n; addr++) {
+						if (!cand[addr - at]) {
+							continue;
+						}
+						if (r_cons_is_breaked ()) {
+							ret = -1;
+							break;
+						}
+						ret = r_core_magic_at (core, file, addr, 99, false, param.outmode == R_MODE_JSON, &hits);
+						if (ret == -1) {
+							// something went terribly wrong.
+							break;
+						}
+						if (maxHits && hits >= maxHits) {
+							ret = -1;
+							break;
+						}
+						addr += ret - 1;
 					}
-					addr += ret - 1;
 				}
 				r_cons_clear_line (1);
 				r_cons_break_pop ();
 			}
+			free (buf);
+			free (cand);
+			r_magic_index_free (idx);
 			if (param.outmode == R_MODE_JSON) {
 				r_cons_printf ("]");
 			}
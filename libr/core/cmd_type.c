@@ -775,7 +775,7 @@ static void typesList(RCore *core, int mode) {
 }
 
 static void set_offset_hint(RCore *core, RAnalOp *op, const char *type, ut64 laddr, ut64 at, int offimm) {
-	char *res = r_type_get_struct_memb (core->anal->sdb_types, type, offimm);
+	char *res = r_anal_type_get_struct_memb (core->anal, type, offimm);
 	const char *cmt = ((offimm == 0) && res)? res: type;
 	if (offimm > 0) {
 		// set hint only if link is present
@@ -1120,7 +1120,7 @@ static int cmd_type(void *data, const char *input) {
 			break;
 		case 's':
 			if (input[2] == ' ') {
-				r_cons_printf ("%d\n", (r_type_get_bitsize (TDB, input + 3) / 8));
+				r_cons_printf ("%d\n", (r_anal_type_get_bitsize (core->anal, input + 3) / 8));
 			} else {
 				r_core_cmd_help (core, help_msg_ts);
 			}
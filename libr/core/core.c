@@ -2310,6 +2310,7 @@ static bool r_core_anal_read_at(struct r_anal_t *anal, ut64 addr, ut8 *buf, int
 }
 
 static void r_core_break (RCore *core) {
+	r_core_task_preempt (&core->tasks);
 }
 
 static void *r_core_sleep_begin (RCore *core) {
@@ -2432,7 +2433,7 @@ static char *get_comments_cb(void *user, ut64 addr) {
 
 static void cb_event_handler(REvent *ev, int event_type, void *user, void *data) {
 	RCore *core = (RCore *)ev->user;
-	if (!core->log_events) {
+	if (!core->log_events || event_type > R_EVENT_META_CLEAR) {
 		return;
 	}
 	REventMeta *rems = data;
@@ -2474,6 +2475,19 @@ static void cb_event_handler(REvent *ev, int event_type, void *user, void *data)
 	free (str);
 }
 
+// mark the analysis of patched code as stale, see r_core_anal_update
+static void cb_io_write(REvent *ev, int event_type, void *user, void *data) {
+	RCore *core = (RCore *)ev->user;
+	REventIOWrite *w = data;
+	r_anal_invalidate (core->anal, w->addr, w->len, R_ANAL_DIRTY_WRITE);
+}
+
+static void cb_anal_hint(REvent *ev, int event_type, void *user, void *data) {
+	RCore *core = (RCore *)ev->user;
+	REventHint *h = data;
+	r_anal_invalidate (core->anal, h->addr, h->size, R_ANAL_DIRTY_HINT);
+}
+
 static RFlagItem *core_flg_class_set(RFlag *f, const char *name, ut64 addr, ut32 size) {
 	r_flag_space_push (f, R_FLAGS_FS_CLASSES);
 	RFlagItem *res = r_flag_set (f, name, addr, size);
@@ -2539,6 +2553,8 @@ R_API bool r_core_init(RCore *core) {
 	r_core_setenv (core);
 	core->ev = r_event_new (core);
 	r_event_hook (core->ev, R_EVENT_ALL, cb_event_handler, NULL);
+	r_event_hook (core->ev, R_EVENT_IO_WRITE, cb_io_write, NULL);
+	r_event_hook (core->ev, R_EVENT_ANAL_HINT, cb_anal_hint, NULL);
 	core->max_cmd_depth = R_CONS_CMD_DEPTH + 1;
 	core->sdb = sdb_new (NULL, "r2kv.sdb", 0); // XXX: path must be in home?
 	core->lastsearch = NULL;
@@ -2652,6 +2668,7 @@ R_API bool r_core_init(RCore *core) {
 	r_bin_set_user_ptr (core->bin, core);
 	core->io = r_io_new ();
 	core->io->ff = 1;
+	core->io->ev = core->ev;
 	core->search = r_search_new (R_SEARCH_KEYWORD);
 	r_io_undo_enable (core->io, 1, 0); // TODO: configurable via eval
 	core->fs = r_fs_new ();
@@ -2771,11 +2788,22 @@ R_API void r_core_fini(RCore *c) {
 	r_core_task_break_all (&c->tasks);
 	r_core_task_join (&c->tasks, NULL, -1);
 	r_core_wait (c);
+	// the cons singleton outlives this core
+	if (c->cons && c->cons->user == c) {
+		c->cons->cb_break = NULL;
+		c->cons->cb_sleep_begin = NULL;
+		c->cons->cb_sleep_end = NULL;
+		c->cons->cb_task_oneshot = NULL;
+		c->cons->user = NULL;
+	}
 	/* TODO: it leaks as shit */
 	//update_sdb (c);
 	// avoid double free
 	r_list_free (c->ropchain);
 	r_event_free (c->ev);
+	// io and anal outlive the event, debug may still write breakpoints back
+	c->io->ev = NULL;
+	c->anal->ev = NULL;
 	free (c->cmdlog);
 	free (c->lastsearch);
 	R_FREE (c->cons->pager);
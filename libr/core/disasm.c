@@ -2446,7 +2446,7 @@ static int ds_disassemble(RDisasmState *ds, ut8 *buf, int len) {
 		ds->opstr = strdup (ds->hint->opcode);
 	}
 	r_asm_op_fini (&ds->asmop);
-	ret = r_asm_disassemble (core->rasm, &ds->asmop, buf, len);
+	ret = r_core_asm_disassemble (core, &ds->asmop, buf, len);
 	if (ds->asmop.size < 1) {
 		ds->asmop.size = 1;
 	}
@@ -5235,6 +5235,9 @@ toro:
 		ds->l = core->blocksize;
 	}
 	r_cons_break_push (NULL, NULL);
+	if (addrbytes == 1) {
+		r_core_asm_prefetch (core, ds->addr, buf, len, ds->l - ds->lines);
+	}
 	for (i = idx = ret = 0; addrbytes * idx < len && ds->lines < ds->l; idx += inc, i++, ds->index += inc, ds->lines++) {
 		ds->at = ds->addr + idx;
 		ds->vat = r_core_pava (core, ds->at);
@@ -5346,7 +5349,7 @@ toro:
 			if (fmt) {
 				r_cons_printf ("(%s)\n", link_type);
 				r_core_cmdf (core, "pf %s @ 0x%08"PFMT64x"\n", fmt, ds->addr + idx);
-				const ut32 type_bitsize = r_type_get_bitsize (core->anal->sdb_types, link_type);
+				const ut32 type_bitsize = r_anal_type_get_bitsize (core->anal, link_type);
 				// always round up when calculating byte_size from bit_size of types
 				// could be struct with a bitfield entry
 				inc = (type_bitsize >> 3) + (!!(type_bitsize & 0x7));
@@ -5735,7 +5738,7 @@ toro:
 		r_asm_set_pc (core->rasm, ds->at);
 		// XXX copypasta from main disassembler function
 		// r_anal_get_fcn_in (core->anal, ds->at, R_ANAL_FCN_TYPE_NULL);
-		ret = r_asm_disassemble (core->rasm, &ds->asmop,
+		ret = r_core_asm_disassemble (core, &ds->asmop,
 			buf + addrbytes * i, nb_bytes - addrbytes * i);
 		ds->oplen = ret;
 		if (ds->midflags) {
@@ -6034,7 +6037,7 @@ R_API int r_core_print_disasm_json(RCore *core, ut64 addr, ut8 *buf, int nb_byte
 			break;
 		}
 		memset (&asmop, 0, sizeof (RAsmOp));
-		ret = r_asm_disassemble (core->rasm, &asmop, buf + i, nb_bytes - i);
+		ret = r_core_asm_disassemble (core, &asmop, buf + i, nb_bytes - i);
 		if (ret < 1) {
 			pj_o (pj);
 			pj_kn (pj, "offset", at);
@@ -6272,7 +6275,7 @@ R_API int r_core_print_disasm_all(RCore *core, ut64 addr, int l, int len, int mo
 		if (r_cons_is_breaked ()) {
 			break;
 		}
-		ret = r_asm_disassemble (core->rasm, &asmop, buf + i, l - i);
+		ret = r_core_asm_disassemble (core, &asmop, buf + i, l - i);
 		if (ret < 1) {
 			switch (mode) {
 			case 'j':
@@ -6475,7 +6478,7 @@ toro:
 			}
 		}
 		r_asm_set_pc (core->rasm, core->offset + i);
-		ret = r_asm_disassemble (core->rasm, &asmop, buf + addrbytes * i,
+		ret = r_core_asm_disassemble (core, &asmop, buf + addrbytes * i,
 			nb_bytes - addrbytes * i);
 		if (midflags || midbb) {
 			RDisasmState ds = {
@@ -1,22 +1,524 @@
 // included from rtr.c
 
+/* request handed by a connection thread to the core thread */
+typedef struct {
+	RSocketHTTPRequest *rs;
+	int ret;
+	char *out; // command output sent by the connection thread
+	char *headers;
+	bool done;
+	bool task; // answered by a task, not by the core thread
+	struct http_server_t *hs;
+} HttpJob;
+
+typedef struct http_server_t {
+	RCore *core;
+	RSocket *s;
+	RSocketHTTPOptions so;
+	const char *port;
+	const char *index;
+	int workers;
+	volatile bool stop;
+	RThreadLock *lock; // guards jobs and the done flags
+	RThreadLock *accept_lock;
+	RThreadCond *queued;
+	RThreadCond *done;
+	RList *jobs;
+	RThread **threads;
+	RList *tasks; // ids of the tasks running read-only commands
+	int pending; // tasks not done yet, guarded by lock
+} HttpServer;
+
+static void rtr_http_break(void *u) {
+	HttpServer *hs = (HttpServer *)u;
+	hs->stop = true;
+	r_core_rtr_http_stop (hs->core);
+}
+
+/* called by the task when its command is done, with the tasks lock held */
+static void rtr_http_task_done(void *user, char *out) {
+	HttpJob *job = user;
+	HttpServer *hs = job->hs;
+	r_th_lock_enter (hs->lock);
+	job->out = strdup (out? out: "");
+	job->ret = 1;
+	job->done = true;
+	hs->pending--;
+	r_th_cond_signal_all (hs->done);
+	r_th_lock_leave (hs->lock);
+}
+
+/* read-only commands run as tasks, so the core thread can take the next
+ * request meanwhile and a slow command only takes its time slices */
+static bool rtr_http_task(RCore *core, const char *cmd, const char *headers, HttpJob *job) {
+	if (!job || !r_core_cmd_is_readonly (cmd)) {
+		return false;
+	}
+	RCoreTask *task = r_core_task_new (core, true, cmd, rtr_http_task_done, job);
+	if (!task) {
+		return false;
+	}
+	job->headers = r_str_newf ("Content-Type: text/plain\n%s", headers);
+	job->task = true;
+	r_th_lock_enter (job->hs->lock);
+	job->hs->pending++;
+	r_th_lock_leave (job->hs->lock);
+	r_list_append (job->hs->tasks, (void *)(size_t)task->id);
+	r_core_task_enqueue (&core->tasks, task);
+	return true;
+}
+
+static bool rtr_http_pending(HttpServer *hs) {
+	if (!hs->lock) {
+		return false;
+	}
+	r_th_lock_enter (hs->lock);
+	bool pending = hs->pending > 0;
+	r_th_lock_leave (hs->lock);
+	return pending;
+}
+
+/* wait for the tasks started for requests, breaking them if the server stops */
+static void rtr_http_tasks_join(HttpServer *hs, bool stop) {
+	RCoreTaskScheduler *tasks = &hs->core->tasks;
+	RListIter *iter;
+	void *id;
+	r_list_foreach (hs->tasks, iter, id) {
+		if (stop) {
+			r_core_task_break (tasks, (int)(size_t)id);
+		}
+		r_core_task_join (tasks, r_core_task_self (tasks), (int)(size_t)id);
+		r_core_task_del (tasks, (int)(size_t)id);
+	}
+	r_list_purge (hs->tasks);
+}
+
+static void rtr_http_cmd(RCore *core, RSocketHTTPRequest *rs, const char *cmd, const char *headers, HttpJob *job) {
+	if (rtr_http_task (core, cmd, headers, job)) {
+		return;
+	}
+	char *out = r_core_cmd_str_pipe (core, cmd);
+	char *newheaders = out
+		? r_str_newf ("Content-Type: text/plain\n%s", headers)
+		: strdup (headers);
+	if (job) {
+		/* the connection thread writes it while the core thread moves on */
+		job->out = out;
+		job->headers = newheaders;
+		return;
+	}
+	r_socket_http_response (rs, 200, out? out: "", 0, newheaders);
+	free (newheaders);
+	free (out);
+}
+
+/* serve a single request, the connection is left open for the caller.
+ * returns 1 to keep serving, 0 to stop and -2 to restart the server.
+ * when job is given, command outputs are left there for the connection
+ * thread to send, so slow clients don't hold the core thread */
+static int rtr_http_handle(RCore *core, RSocketHTTPRequest *rs, HttpServer *hs, HttpJob *job) {
+	char headers[128] = R_EMPTY;
+	const char *allow = r_config_get (core->config, "http.allow");
+	const char *index = hs->index;
+	int ret = 1;
+	char *dir;
+
+	if (allow && *allow) {
+		bool accepted = false;
+		const char *allows_host;
+		char *p, *peer = r_socket_to_string (rs->s);
+		char *allows = strdup (allow);
+		//eprintf ("Firewall (%s)\n", allows);
+		int i, count = r_str_split (allows, ',');
+		p = strchr (peer, ':');
+		if (p) {
+			*p = 0;
+		}
+		for (i = 0; i < count; i++) {
+			allows_host = r_str_word_get0 (allows, i);
+			//eprintf ("--- (%s) (%s)\n", host, peer);
+			if (!strcmp (allows_host, peer)) {
+				accepted = true;
+				break;
+			}
+		}
+		free (peer);
+		free (allows);
+		if (!accepted) {
+			rs->keepalive = false;
+			return 1;
+		}
+	}
+	if (!rs->method || !rs->path) {
+		http_logf (core, "Invalid http headers received from client\n");
+		rs->keepalive = false;
+		return 1;
+	}
+	dir = NULL;
+
+	if (!rs->auth) {
+		r_socket_http_response (rs, 401, "", 0, NULL);
+		return 1;
+	}
+
+	if (r_config_get_i (core->config, "http.verbose")) {
+		char *peer = r_socket_to_string (rs->s);
+		http_logf (core, "[HTTP] %s %s\n", peer, rs->path);
+		free (peer);
+	}
+	if (r_config_get_i (core->config, "http.dirlist")) {
+		if (r_file_is_directory (rs->path)) {
+			dir = strdup (rs->path);
+		}
+	}
+	if (r_config_get_i (core->config, "http.cors")) {
+		strcpy (headers, "Access-Control-Allow-Origin: *\n"
+			"Access-Control-Allow-Headers: Origin, "
+			"X-Requested-With, Content-Type, Accept\n");
+	}
+	if (!strcmp (rs->method, "OPTIONS")) {
+		r_socket_http_response (rs, 200, "", 0, headers);
+	} else if (!strcmp (rs->method, "GET")) {
+		if (!strncmp (rs->path, "/up/", 4)) {
+			if (r_config_get_i (core->config, "http.upget")) {
+				const char *uproot = r_config_get (core->config, "http.uproot");
+				if (!rs->path[3] || (rs->path[3]=='/' && !rs->path[4])) {
+					char *ptr = rtr_dir_files (uproot);
+					r_socket_http_response (rs, 200, ptr, 0, headers);
+					free (ptr);
+				} else {
+					char *path = r_file_root (uproot, rs->path + 4);
+					if (r_file_exists (path)) {
+						size_t sz = 0;
+						char *f = r_file_slurp (path, &sz);
+						if (f) {
+							r_socket_http_response (rs, 200, f, (int)sz, headers);
+							free (f);
+						} else {
+							r_socket_http_response (rs, 403, "Permission denied", 0, headers);
+							http_logf (core, "http: Cannot open '%s'\n", path);
+						}
+					} else {
+						if (dir) {
+							char *resp = rtr_dir_files (dir);
+							r_socket_http_response (rs, 404, resp, 0, headers);
+							free (resp);
+						} else {
+							http_logf (core, "File '%s' not found\n", path);
+							r_socket_http_response (rs, 404, "File not found\n", 0, headers);
+						}
+					}
+					free (path);
+				}
+			} else {
+				r_socket_http_response (rs, 403, "", 0, NULL);
+			}
+		} else if (!strncmp (rs->path, "/cmd/", 5)) {
+			const bool colon = r_config_get_i (core->config, "http.colon");
+			if (colon && rs->path[5] != ':') {
+				r_socket_http_response (rs, 403, "Permission denied", 0, headers);
+			} else {
+				char *cmd = rs->path + 5;
+				const char *httpcmd = r_config_get (core->config, "http.uri");
+				const char *httpref = r_config_get (core->config, "http.referer");
+				const bool httpref_enabled = (httpref && *httpref);
+				char *refstr = NULL;
+				if (httpref_enabled) {
+					if (strstr (httpref, "http")) {
+						refstr = strdup (httpref);
+					} else {
+						refstr = r_str_newf ("http://localhost:%d/", atoi (hs->port));
+					}
+				}
+
+				while (*cmd == '/') {
+					cmd++;
+				}
+				if (httpref_enabled && (!rs->referer || (refstr && !strstr (rs->referer, refstr)))) {
+					r_socket_http_response (rs, 503, "", 0, headers);
+				} else {
+					if (httpcmd && *httpcmd) {
+						int len; // do remote http query and proxy response
+						char *res, *bar = r_str_newf ("%s/%s", httpcmd, cmd);
+						void *bed = r_cons_sleep_begin ();
+						res = r_socket_http_get (bar, NULL, &len);
+						r_cons_sleep_end (bed);
+						if (res) {
+							res[len] = 0;
+							r_cons_println (res);
+						}
+						free (bar);
+					} else {
+						char *cmd = rs->path + 5;
+						r_str_uri_decode (cmd);
+						r_config_set (core->config, "scr.interactive", "false");
+
+						if (!r_sandbox_enable (0) &&
+								(!strcmp (cmd, "=h*") ||
+								 !strcmp (cmd, "=h--"))) {
+							r_socket_http_response (rs, 200, "", 0, headers);
+							ret = strcmp (cmd, "=h*")? 0: -2;
+						} else if (*cmd == ':') {
+							/* commands in /cmd/: starting with : do not show any output */
+							r_core_cmd0 (core, cmd + 1);
+							r_socket_http_response (rs, 200, "", 0, headers);
+						} else {
+							rtr_http_cmd (core, rs, cmd, headers, job);
+						}
+					}
+				}
+				free (refstr);
+			}
+		} else {
+			const char *root = r_config_get (core->config, "http.root");
+			const char *homeroot = r_config_get (core->config, "http.homeroot");
+			char *path = NULL;
+			if (!strcmp (rs->path, "/")) {
+				free (rs->path);
+				if (*index == '/') {
+					rs->path = strdup (index);
+					path = strdup (index);
+				} else {
+					rs->path = r_str_newf ("/%s", index);
+					path = r_file_root (root, rs->path);
+				}
+			} else if (homeroot && *homeroot) {
+				char *homepath = r_file_abspath (homeroot);
+				path = r_file_root (homepath, rs->path);
+				free (homepath);
+				if (!r_file_exists (path) && !r_file_is_directory (path)) {
+					free (path);
+					path = r_file_root (root, rs->path);
+				}
+			} else {
+				if (*index == '/') {
+					path = strdup (index);
+				} else {
+				}
+			}
+			// FD IS OK HERE
+			if (rs->path [strlen (rs->path) - 1] == '/') {
+				path = (*index == '/')? strdup (index): r_str_append (path, index);
+			} else {
+				//snprintf (path, sizeof (path), "%s/%s", root, rs->path);
+				if (r_file_is_directory (path)) {
+					char *res = r_str_newf ("Location: %s/\n%s", rs->path, headers);
+					r_socket_http_response (rs, 302, NULL, 0, res);
+					free (path);
+					free (res);
+					free (dir);
+					return 1;
+				}
+			}
+			if (r_file_exists (path)) {
+				size_t sz = 0;
+				char *f = r_file_slurp (path, &sz);
+				if (f) {
+					const char *ct = NULL;
+					if (strstr (path, ".js")) {
+						ct = "Content-Type: application/javascript\n";
+					}
+					if (strstr (path, ".css")) {
+						ct = "Content-Type: text/css\n";
+					}
+					if (strstr (path, ".html")) {
+						ct = "Content-Type: text/html\n";
+					}
+					char *hdr = r_str_newf ("%s%s", ct, headers);
+					r_socket_http_response (rs, 200, f, (int)sz, hdr);
+					free (hdr);
+					free (f);
+				} else {
+					r_socket_http_response (rs, 403, "Permission denied", 0, headers);
+					http_logf (core, "http: Cannot open '%s'\n", path);
+				}
+			} else {
+				if (dir) {
+					char *resp = rtr_dir_files (dir);
+					http_logf (core, "Dirlisting %s\n", dir);
+					r_socket_http_response (rs, 404, resp, 0, headers);
+					free (resp);
+				} else {
+					http_logf (core, "File '%s' not found\n", path);
+					r_socket_http_response (rs, 404, "File not found\n", 0, headers);
+				}
+			}
+			free (path);
+		}
+	} else if (!strcmp (rs->method, "POST")) {
+		ut8 *ret;
+		int retlen;
+		char buf[128];
+		if (r_config_get_i (core->config, "http.upload")) {
+			ret = r_socket_http_handle_upload (rs->data, rs->data_length, &retlen);
+			if (ret) {
+				ut64 size = r_config_get_i (core->config, "http.maxsize");
+				if (size && retlen > size) {
+					r_socket_http_response (rs, 403, "403 File too big\n", 0, headers);
+				} else {
+					char *filename = r_file_root (
+						r_config_get (core->config, "http.uproot"),
+						rs->path + 4);
+					http_logf (core, "UPLOADED '%s'\n", filename);
+					r_file_dump (filename, ret, retlen, 0);
+					free (filename);
+					snprintf (buf, sizeof (buf),
+						"<html><body><h2>uploaded %d byte(s). Thanks</h2>\n", retlen);
+						r_socket_http_response (rs, 200, buf, 0, headers);
+				}
+				free (ret);
+			}
+		} else {
+			r_socket_http_response (rs, 403, "403 Forbidden\n", 0, headers);
+		}
+	} else {
+		r_socket_http_response (rs, 404, "Invalid protocol", 0, headers);
+	}
+	free (dir);
+	return ret;
+}
+
+/* wait for the client to send another request on a keep-alive connection */
+static RSocketHTTPRequest *rtr_http_keepalive(HttpServer *hs, RSocketHTTPRequest *rs) {
+	int idle = 0;
+	// pipelined requests may be read ahead already
+	bool buffered = rs->rbuf_pos < rs->rbuf_len;
+	while (!buffered && rs->keepalive && !hs->stop && r_socket_ready (rs->s, 1, 0) < 1) {
+		if (hs->so.timeout > 0 && ++idle >= hs->so.timeout) {
+			rs->keepalive = false;
+		}
+	}
+	if (hs->stop) {
+		rs->keepalive = false;
+	}
+	return r_socket_http_next (rs, &hs->so);
+}
+
+/* connection thread: accepts clients and feeds their requests to the core
+ * thread one at a time, keeping the connection open between requests */
+static RThreadFunctionRet rtr_http_worker(RThread *th) {
+	HttpServer *hs = th->user;
+	while (!hs->stop) {
+		r_th_lock_enter (hs->accept_lock);
+		RSocketHTTPRequest *rs = hs->stop? NULL: r_socket_http_accept (hs->s, &hs->so);
+		r_th_lock_leave (hs->accept_lock);
+		while (rs) {
+			HttpJob job = { rs, 1, NULL, NULL, false, false, hs };
+			r_th_lock_enter (hs->lock);
+			if (hs->stop) {
+				r_th_lock_leave (hs->lock);
+				r_socket_http_close (rs);
+				break;
+			}
+			r_list_append (hs->jobs, &job);
+			r_th_cond_signal (hs->queued);
+			while (!job.done) {
+				r_th_cond_wait (hs->done, hs->lock);
+			}
+			r_th_lock_leave (hs->lock);
+			if (job.headers) {
+				r_socket_http_response (rs, 200, job.out? job.out: "", 0, job.headers);
+				free (job.headers);
+				free (job.out);
+			}
+			rs = rtr_http_keepalive (hs, rs);
+		}
+	}
+	/* wake up the core thread so it can notice the stop */
+	r_th_lock_enter (hs->lock);
+	r_th_cond_signal_all (hs->queued);
+	r_th_lock_leave (hs->lock);
+	return R_TH_STOP;
+}
+
+static HttpJob *rtr_http_job(HttpServer *hs) {
+	HttpJob *job = NULL;
+	r_th_lock_enter (hs->lock);
+	while (!hs->stop && !(job = r_list_pop_head (hs->jobs))) {
+		r_th_cond_wait (hs->queued, hs->lock);
+	}
+	r_th_lock_leave (hs->lock);
+	return job;
+}
+
+static void rtr_http_job_done(HttpServer *hs, HttpJob *job, int ret) {
+	r_th_lock_enter (hs->lock);
+	job->ret = ret;
+	job->done = true;
+	r_th_cond_signal_all (hs->done);
+	r_th_lock_leave (hs->lock);
+}
+
+static bool rtr_http_workers_start(HttpServer *hs) {
+	int i;
+	hs->lock = r_th_lock_new (false);
+	hs->accept_lock = r_th_lock_new (false);
+	hs->queued = r_th_cond_new ();
+	hs->done = r_th_cond_new ();
+	hs->jobs = r_list_new ();
+	hs->tasks = r_list_new ();
+	hs->threads = R_NEWS0 (RThread *, hs->workers);
+	if (!hs->lock || !hs->accept_lock || !hs->queued || !hs->done || !hs->jobs || !hs->tasks || !hs->threads) {
+		return false;
+	}
+	for (i = 0; i < hs->workers; i++) {
+		hs->threads[i] = r_th_new (rtr_http_worker, hs, 0);
+		if (hs->threads[i]) {
+			r_th_setname (hs->threads[i], "httpworker");
+		}
+	}
+	return true;
+}
+
+static void rtr_http_workers_stop(HttpServer *hs) {
+	HttpJob *job;
+	int i;
+	if (hs->tasks) {
+		// their connection threads wait for them
+		rtr_http_tasks_join (hs, true);
+	}
+	if (hs->lock) {
+		r_th_lock_enter (hs->lock);
+		hs->stop = true;
+		while ((job = r_list_pop_head (hs->jobs))) {
+			job->ret = 0;
+			job->done = true;
+		}
+		r_th_cond_signal_all (hs->done);
+		r_th_lock_leave (hs->lock);
+	}
+	if (hs->threads) {
+		for (i = 0; i < hs->workers; i++) {
+			if (hs->threads[i]) {
+				r_th_wait (hs->threads[i]);
+				r_th_free (hs->threads[i]);
+			}
+		}
+		free (hs->threads);
+	}
+	r_list_free (hs->jobs);
+	r_list_free (hs->tasks);
+	r_th_cond_free (hs->queued);
+	r_th_cond_free (hs->done);
+	r_th_lock_free (hs->accept_lock);
+	r_th_lock_free (hs->lock);
+}
+
 // return 1 on error
 static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *path) {
 	RConfig *newcfg = NULL, *origcfg = NULL;
-	char headers[128] = R_EMPTY;
 	RSocketHTTPRequest *rs;
+	HttpServer hs = {0};
+	HttpJob *job = NULL;
 	char buf[32];
 	int ret = 0;
 	RSocket *s;
-	RSocketHTTPOptions so;
-	char *dir;
 	int iport;
 	const char *host = r_config_get (core->config, "http.bind");
 	const char *index = r_config_get (core->config, "http.index");
 	const char *root = r_config_get (core->config, "http.root");
 	const char *homeroot = r_config_get (core->config, "http.homeroot");
 	const char *port = r_config_get (core->config, "http.port");
-	const char *allow = r_config_get (core->config, "http.allow");
 	const char *httpui = r_config_get (core->config, "http.ui");
 	const char *httpauthfile = r_config_get (core->config, "http.authfile");
 	char *pfile = NULL;
@@ -79,7 +581,6 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 		} else {
 			s->local = true;
 		}
-		memset (&so, 0, sizeof (so));
 	}
 	if (!r_socket_listen (s, port, NULL)) {
 		r_socket_free (s);
@@ -93,9 +594,14 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 			browser, host, atoi (port), path? path:"");
 	}
 
-	so.httpauth = r_config_get_i (core->config, "http.auth");
+	hs.core = core;
+	hs.s = s;
+	hs.port = port;
+	hs.index = index;
+	hs.workers = r_config_get_i (core->config, "http.workers");
+	hs.so.httpauth = r_config_get_i (core->config, "http.auth");
 
-	if (so.httpauth) {
+	if (hs.so.httpauth) {
 		if (!httpauthfile) {
 			r_socket_free (s);
 			eprintf ("No user list set for HTTP Authentication\n");
@@ -105,15 +611,21 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 		pfile = r_file_slurp (httpauthfile, NULL);
 
 		if (pfile) {
-			so.authtokens = r_str_split_list (pfile, "\n", 0);
+			hs.so.authtokens = r_str_split_list (pfile, "\n", 0);
 		} else {
 			r_socket_free (s);
 			eprintf ("Empty list of HTTP users\n");
 			return 1;
 		}
 
-		so.timeout = r_config_get_i (core->config, "http.timeout");
-		so.accept_timeout = 1;
+		hs.so.timeout = r_config_get_i (core->config, "http.timeout");
+		hs.so.accept_timeout = 1;
+	}
+	if (hs.workers > 0) {
+		/* connection threads must wake up regularly to notice the stop */
+		hs.so.timeout = r_config_get_i (core->config, "http.timeout");
+		hs.so.accept_timeout = 1;
+		hs.so.keepalive = true;
 	}
 
 	origcfg = core->config;
@@ -146,30 +658,41 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 	newblk = malloc (core->blocksize);
 	if (!newblk) {
 		r_socket_free (s);
-		r_list_free (so.authtokens);
+		r_list_free (hs.so.authtokens);
 		free (pfile);
 		return 1;
 	}
 	memcpy (newblk, core->block, core->blocksize);
 
 	core->block = newblk;
-// TODO: handle mutex lock/unlock here
-	r_cons_break_push ((RConsBreak)r_core_rtr_http_stop, core);
-	while (!r_cons_is_breaked ()) {
-		/* restore environment */
-		core->config = origcfg;
-		r_config_set (origcfg, "scr.html", r_config_get (origcfg, "scr.html"));
-		r_config_set_i (origcfg, "scr.color", r_config_get_i (origcfg, "scr.color"));
-		r_config_set (origcfg, "scr.interactive", r_config_get (origcfg, "scr.interactive"));
-		core->http_up = 0; // DAT IS NOT TRUE AT ALL.. but its the way to enable visual
+	if (hs.workers > 0 && !rtr_http_workers_start (&hs)) {
+		eprintf ("Cannot start the http workers\n");
+		hs.stop = true;
+	}
+	r_cons_break_push (rtr_http_break, &hs);
+	while (!r_cons_is_breaked () && !hs.stop) {
+		/* the tasks answering requests run while this thread waits, they
+		 * need the environment of the server */
+		bool swap = !rtr_http_pending (&hs);
+		if (swap && hs.tasks && r_list_length (hs.tasks) > 64) {
+			rtr_http_tasks_join (&hs, false);
+		}
+		if (swap) {
+			/* restore environment */
+			core->config = origcfg;
+			r_config_set (origcfg, "scr.html", r_config_get (origcfg, "scr.html"));
+			r_config_set_i (origcfg, "scr.color", r_config_get_i (origcfg, "scr.color"));
+			r_config_set (origcfg, "scr.interactive", r_config_get (origcfg, "scr.interactive"));
+			core->http_up = 0; // DAT IS NOT TRUE AT ALL.. but its the way to enable visual
 
-		newoff = core->offset;
-		newblk = core->block;
-		newblksz = core->blocksize;
+			newoff = core->offset;
+			newblk = core->block;
+			newblksz = core->blocksize;
 
-		core->offset = origoff;
-		core->block = origblk;
-		core->blocksize = origblksz;
+			core->offset = origoff;
+			core->block = origblk;
+			core->blocksize = origblksz;
+		}
 
 // backup and restore offset and blocksize
 
@@ -177,312 +700,53 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 		activateDieTime (core);
 
 		void *bed = r_cons_sleep_begin ();
-		rs = r_socket_http_accept (s, &so);
+		if (hs.workers > 0) {
+			job = rtr_http_job (&hs);
+			rs = job? job->rs: NULL;
+		} else {
+			rs = r_socket_http_accept (s, &hs.so);
+		}
 		r_cons_sleep_end (bed);
 
-		origoff = core->offset;
-		origblk = core->block;
-		origblksz = core->blocksize;
-		core->offset = newoff;
-		core->block = newblk;
-		core->blocksize = newblksz;
-		/* set environment */
+		if (swap) {
+			origoff = core->offset;
+			origblk = core->block;
+			origblksz = core->blocksize;
+			core->offset = newoff;
+			core->block = newblk;
+			core->blocksize = newblksz;
+			/* set environment */
 // backup and restore offset and blocksize
-		core->http_up = 1;
-		core->config = newcfg;
-		r_config_set (newcfg, "scr.html", r_config_get (newcfg, "scr.html"));
-		r_config_set_i (newcfg, "scr.color", r_config_get_i (newcfg, "scr.color"));
-		r_config_set (newcfg, "scr.interactive", r_config_get (newcfg, "scr.interactive"));
-
+			core->http_up = 1;
+			core->config = newcfg;
+			r_config_set (newcfg, "scr.html", r_config_get (newcfg, "scr.html"));
+			r_config_set_i (newcfg, "scr.color", r_config_get_i (newcfg, "scr.color"));
+			r_config_set (newcfg, "scr.interactive", r_config_get (newcfg, "scr.interactive"));
+		}
 		if (!rs) {
 			bed = r_cons_sleep_begin ();
 			r_sys_usleep (100);
 			r_cons_sleep_end (bed);
 			continue;
 		}
-		if (allow && *allow) {
-			bool accepted = false;
-			const char *allows_host;
-			char *p, *peer = r_socket_to_string (rs->s);
-			char *allows = strdup (allow);
-			//eprintf ("Firewall (%s)\n", allows);
-			int i, count = r_str_split (allows, ',');
-			p = strchr (peer, ':');
-			if (p) {
-				*p = 0;
+		if (job) {
+			ret = rtr_http_handle (core, rs, &hs, job);
+			if (!job->task) {
+				rtr_http_job_done (&hs, job, ret);
 			}
-			for (i = 0; i < count; i++) {
-				allows_host = r_str_word_get0 (allows, i);
-				//eprintf ("--- (%s) (%s)\n", host, peer);
-				if (!strcmp (allows_host, peer)) {
-					accepted = true;
-					break;
-				}
-			}
-			free (peer);
-			free (allows);
-			if (!accepted) {
-				r_socket_http_close (rs);
-				continue;
-			}
-		}
-		if (!rs->method || !rs->path) {
-			http_logf (core, "Invalid http headers received from client\n");
+			job = NULL;
+		} else {
+			ret = rtr_http_handle (core, rs, &hs, NULL);
 			r_socket_http_close (rs);
-			continue;
 		}
-		dir = NULL;
-
-		if (!rs->auth) {
-			r_socket_http_response (rs, 401, "", 0, NULL);
-		}
-
-		if (r_config_get_i (core->config, "http.verbose")) {
-			char *peer = r_socket_to_string (rs->s);
-			http_logf (core, "[HTTP] %s %s\n", peer, rs->path);
-			free (peer);
-		}
-		if (r_config_get_i (core->config, "http.dirlist")) {
-			if (r_file_is_directory (rs->path)) {
-				dir = strdup (rs->path);
-			}
+		if (ret < 1) {
+			break;
 		}
-		if (r_config_get_i (core->config, "http.cors")) {
-			strcpy (headers, "Access-Control-Allow-Origin: *\n"
-				"Access-Control-Allow-Headers: Origin, "
-				"X-Requested-With, Content-Type, Accept\n");
-		}
-		if (!strcmp (rs->method, "OPTIONS")) {
-			r_socket_http_response (rs, 200, "", 0, headers);
-		} else if (!strcmp (rs->method, "GET")) {
-			if (!strncmp (rs->path, "/up/", 4)) {
-				if (r_config_get_i (core->config, "http.upget")) {
-					const char *uproot = r_config_get (core->config, "http.uproot");
-					if (!rs->path[3] || (rs->path[3]=='/' && !rs->path[4])) {
-						char *ptr = rtr_dir_files (uproot);
-						r_socket_http_response (rs, 200, ptr, 0, headers);
-						free (ptr);
-					} else {
-						char *path = r_file_root (uproot, rs->path + 4);
-						if (r_file_exists (path)) {
-							size_t sz = 0;
-							char *f = r_file_slurp (path, &sz);
-							if (f) {
-								r_socket_http_response (rs, 200, f, (int)sz, headers);
-								free (f);
-							} else {
-								r_socket_http_response (rs, 403, "Permission denied", 0, headers);
-								http_logf (core, "http: Cannot open '%s'\n", path);
-							}
-						} else {
-							if (dir) {
-								char *resp = rtr_dir_files (dir);
-								r_socket_http_response (rs, 404, resp, 0, headers);
-								free (resp);
-							} else {
-								http_logf (core, "File '%s' not found\n", path);
-								r_socket_http_response (rs, 404, "File not found\n", 0, headers);
-							}
-						}
-						free (path);
-					}
-				} else {
-					r_socket_http_response (rs, 403, "", 0, NULL);
-				}
-			} else if (!strncmp (rs->path, "/cmd/", 5)) {
-				const bool colon = r_config_get_i (core->config, "http.colon");
-				if (colon && rs->path[5] != ':') {
-					r_socket_http_response (rs, 403, "Permission denied", 0, headers);
-				} else {
-					char *cmd = rs->path + 5;
-					const char *httpcmd = r_config_get (core->config, "http.uri");
-					const char *httpref = r_config_get (core->config, "http.referer");
-					const bool httpref_enabled = (httpref && *httpref);
-					char *refstr = NULL;
-					if (httpref_enabled) {
-						if (strstr (httpref, "http")) {
-							refstr = strdup (httpref);
-						} else {
-							refstr = r_str_newf ("http://localhost:%d/", atoi (port));
-						}
-					}
-
-					while (*cmd == '/') {
-						cmd++;
-					}
-					if (httpref_enabled && (!rs->referer || (refstr && !strstr (rs->referer, refstr)))) {
-						r_socket_http_response (rs, 503, "", 0, headers);
-					} else {
-						if (httpcmd && *httpcmd) {
-							int len; // do remote http query and proxy response
-							char *res, *bar = r_str_newf ("%s/%s", httpcmd, cmd);
-							bed = r_cons_sleep_begin ();
-							res = r_socket_http_get (bar, NULL, &len);
-							r_cons_sleep_end (bed);
-							if (res) {
-								res[len] = 0;
-								r_cons_println (res);
-							}
-							free (bar);
-						} else {
-							char *out, *cmd = rs->path + 5;
-							r_str_uri_decode (cmd);
-							r_config_set (core->config, "scr.interactive", "false");
-
-							if (!r_sandbox_enable (0) &&
-									(!strcmp (cmd, "=h*") ||
-									 !strcmp (cmd, "=h--"))) {
-								out = NULL;
-							} else if (*cmd == ':') {
-								/* commands in /cmd/: starting with : do not show any output */
-								r_core_cmd0 (core, cmd + 1);
-								out = NULL;
-							} else {
-								out = r_core_cmd_str_pipe (core, cmd);
-							}
-
-							if (out) {
-								char *res = r_str_uri_encode (out);
-								char *newheaders = r_str_newf (
-										"Content-Type: text/plain\n%s", headers);
-								r_socket_http_response (rs, 200, out, 0, newheaders);
-								free (out);
-								free (newheaders);
-								free (res);
-							} else {
-								r_socket_http_response (rs, 200, "", 0, headers);
-							}
-
-							if (!r_sandbox_enable (0)) {
-								if (!strcmp (cmd, "=h*")) {
-									/* do stuff */
-									r_socket_http_close (rs);
-									free (dir);
-									free (refstr);
-									ret = -2;
-									goto the_end;
-								} else if (!strcmp (cmd, "=h--")) {
-									r_socket_http_close (rs);
-									free (dir);
-									free (refstr);
-									ret = 0;
-									goto the_end;
-								}
-							}
-						}
-					}
-					free (refstr);
-				}
-			} else {
-				const char *root = r_config_get (core->config, "http.root");
-				const char *homeroot = r_config_get (core->config, "http.homeroot");
-				char *path;
-				if (!strcmp (rs->path, "/")) {
-					free (rs->path);
-					if (*index == '/') {
-						rs->path = strdup (index);
-						path = strdup (index);
-					} else {
-						rs->path = r_str_newf ("/%s", index);
-						path = r_file_root (root, rs->path);
-					}
-				} else if (homeroot && *homeroot) {
-					char *homepath = r_file_abspath (homeroot);
-					path = r_file_root (homepath, rs->path);
-					free (homepath);
-					if (!r_file_exists (path) && !r_file_is_directory (path)) {
-						free (path);
-						path = r_file_root (root, rs->path);
-					}
-				} else {
-					if (*index == '/') {
-						path = strdup (index);
-					} else {
-					}
-				}
-				// FD IS OK HERE
-				if (rs->path [strlen (rs->path) - 1] == '/') {
-					path = (*index == '/')? strdup (index): r_str_append (path, index);
-				} else {
-					//snprintf (path, sizeof (path), "%s/%s", root, rs->path);
-					if (r_file_is_directory (path)) {
-						char *res = r_str_newf ("Location: %s/\n%s", rs->path, headers);
-						r_socket_http_response (rs, 302, NULL, 0, res);
-						r_socket_http_close (rs);
-						free (path);
-						free (res);
-						R_FREE (dir);
-						continue;
-					}
-				}
-				if (r_file_exists (path)) {
-					size_t sz = 0;
-					char *f = r_file_slurp (path, &sz);
-					if (f) {
-						const char *ct = NULL;
-						if (strstr (path, ".js")) {
-							ct = "Content-Type: application/javascript\n";
-						}
-						if (strstr (path, ".css")) {
-							ct = "Content-Type: text/css\n";
-						}
-						if (strstr (path, ".html")) {
-							ct = "Content-Type: text/html\n";
-						}
-						char *hdr = r_str_newf ("%s%s", ct, headers);
-						r_socket_http_response (rs, 200, f, (int)sz, hdr);
-						free (hdr);
-						free (f);
-					} else {
-						r_socket_http_response (rs, 403, "Permission denied", 0, headers);
-						http_logf (core, "http: Cannot open '%s'\n", path);
-					}
-				} else {
-					if (dir) {
-						char *resp = rtr_dir_files (dir);
-						http_logf (core, "Dirlisting %s\n", dir);
-						r_socket_http_response (rs, 404, resp, 0, headers);
-						free (resp);
-					} else {
-						http_logf (core, "File '%s' not found\n", path);
-						r_socket_http_response (rs, 404, "File not found\n", 0, headers);
-					}
-				}
-				free (path);
-			}
-		} else if (!strcmp (rs->method, "POST")) {
-			ut8 *ret;
-			int retlen;
-			char buf[128];
-			if (r_config_get_i (core->config, "http.upload")) {
-				ret = r_socket_http_handle_upload (rs->data, rs->data_length, &retlen);
-				if (ret) {
-					ut64 size = r_config_get_i (core->config, "http.maxsize");
-					if (size && retlen > size) {
-						r_socket_http_response (rs, 403, "403 File too big\n", 0, headers);
-					} else {
-						char *filename = r_file_root (
-							r_config_get (core->config, "http.uproot"),
-							rs->path + 4);
-						http_logf (core, "UPLOADED '%s'\n", filename);
-						r_file_dump (filename, ret, retlen, 0);
-						free (filename);
-						snprintf (buf, sizeof (buf),
-							"<html><body><h2>uploaded %d byte(s). Thanks</h2>\n", retlen);
-							r_socket_http_response (rs, 200, buf, 0, headers);
-					}
-					free (ret);
-				}
-			} else {
-				r_socket_http_response (rs, 403, "403 Forbidden\n", 0, headers);
-			}
-		} else {
-			r_socket_http_response (rs, 404, "Invalid protocol", 0, headers);
-		}
-		r_socket_http_close (rs);
-		free (dir);
+		ret = 0;
+	}
+	if (hs.workers > 0) {
+		rtr_http_workers_stop (&hs);
 	}
-the_end:
 	{
 		int timeout = r_config_get_i (core->config, "http.timeout");
 		const char *host = r_config_get (core->config, "http.bind");
@@ -513,6 +777,169 @@ the_end:
 	return ret;
 }
 
+typedef struct {
+	const char *host;
+	const char *port;
+	const char *path;
+	int requests;
+	int count;
+	int errors;
+	ut64 *lat;
+} HttpBenchClient;
+
+static int rtr_http_bench_gets(RSocket *s, char *buf, int size) {
+	int i = 0;
+	while (i < size - 1 && r_socket_read (s, (ut8 *)buf + i, 1) == 1) {
+		if (buf[i] == '\n') {
+			if (i > 0 && buf[i - 1] == '\r') {
+				i--;
+			}
+			buf[i] = 0;
+			return i;
+		}
+		i++;
+	}
+	return -1;
+}
+
+/* send one request and consume its response, false if the connection broke */
+static bool rtr_http_bench_request(RSocket *s, HttpBenchClient *c, bool *keep) {
+	char line[1024];
+	int len = -1;
+	r_socket_printf (s, "GET %s HTTP/1.1\r\nHost: %s\r\n\r\n", c->path, c->host);
+	if (rtr_http_bench_gets (s, line, sizeof (line)) < 12 || strncmp (line + 8, " 200", 4)) {
+		return false;
+	}
+	*keep = !strncmp (line, "HTTP/1.1", 8);
+	while (rtr_http_bench_gets (s, line, sizeof (line)) > 0) {
+		if (!r_str_ncasecmp (line, "Content-Length: ", 16)) {
+			len = atoi (line + 16);
+		} else if (!r_str_ncasecmp (line, "Connection: close", 17)) {
+			*keep = false;
+		}
+	}
+	if (len > 0) {
+		ut8 *body = malloc (len);
+		if (!body || r_socket_read_block (s, body, len) != len) {
+			free (body);
+			return false;
+		}
+		free (body);
+	}
+	return len >= 0;
+}
+
+static RThreadFunctionRet rtr_http_bench_th(RThread *th) {
+	HttpBenchClient *c = th->user;
+	RSocket *s = NULL;
+	int i;
+	for (i = 0; i < c->requests; i++) {
+		bool keep = false;
+		ut64 t = r_time_now_mono ();
+		if (!s) {
+			s = r_socket_new (false);
+			if (!s || !r_socket_connect_tcp (s, c->host, c->port, 3)) {
+				r_socket_free (s);
+				s = NULL;
+				c->errors++;
+				continue;
+			}
+			r_socket_block_time (s, true, 0, 0);
+		}
+		if (!rtr_http_bench_request (s, c, &keep)) {
+			c->errors++;
+			keep = false;
+		} else {
+			c->lat[c->count++] = r_time_now_mono () - t;
+		}
+		if (!keep) {
+			r_socket_free (s);
+			s = NULL;
+		}
+	}
+	r_socket_free (s);
+	return R_TH_STOP;
+}
+
+static int cmp_lat(const void *a, const void *b) {
+	ut64 x = *(const ut64 *)a;
+	ut64 y = *(const ut64 *)b;
+	return (x > y) - (x < y);
+}
+
+/* load test an http server: "=hb [requests] [clients] [cmd]" runs cmd
+ * requests times over the given number of concurrent keep-alive clients */
+R_API int r_core_rtr_http_bench(RCore *core, const char *input) {
+	r_return_val_if_fail (core && input, 1);
+	const char *host = r_config_get (core->config, "http.bind");
+	const char *port = r_config_get (core->config, "http.port");
+	const char *p = r_str_trim_head_ro (input);
+	char *cmd;
+	int requests = 1000, clients = 4;
+	int i, count = 0, errors = 0;
+	if (*p && IS_DIGIT (*p)) {
+		requests = atoi (p);
+		p = r_str_trim_head_ro (r_str_trim_head_wp (p));
+		if (*p && IS_DIGIT (*p)) {
+			clients = atoi (p);
+			p = r_str_trim_head_ro (r_str_trim_head_wp (p));
+		}
+	}
+	cmd = r_str_uri_encode (*p? p: "pi 1");
+	char *path = r_str_newf ("/cmd/%s", cmd);
+	free (cmd);
+	if (!strcmp (host, "0.0.0.0") || !strcmp (host, "public")) {
+		host = "127.0.0.1";
+	}
+	requests = R_MAX (requests, 1);
+	clients = R_MAX (R_MIN (clients, requests), 1);
+	HttpBenchClient *c = R_NEWS0 (HttpBenchClient, clients);
+	RThread **th = R_NEWS0 (RThread *, clients);
+	ut64 *lat = R_NEWS (ut64, requests);
+	if (!c || !th || !lat) {
+		goto beach;
+	}
+	ut64 t = r_time_now_mono ();
+	for (i = 0; i < clients; i++) {
+		c[i].host = host;
+		c[i].port = port;
+		c[i].path = path;
+		c[i].requests = requests / clients + (i < requests % clients);
+		c[i].lat = lat + count;
+		count += c[i].requests;
+		th[i] = r_th_new (rtr_http_bench_th, &c[i], 0);
+	}
+	void *bed = r_cons_sleep_begin ();
+	for (i = 0; i < clients; i++) {
+		if (th[i]) {
+			r_th_wait (th[i]);
+			r_th_free (th[i]);
+		}
+	}
+	r_cons_sleep_end (bed);
+	t = r_time_now_mono () - t;
+	/* compact the per client latencies */
+	for (count = 0, i = 0; i < clients; i++) {
+		memmove (lat + count, c[i].lat, c[i].count * sizeof (ut64));
+		count += c[i].count;
+		errors += c[i].errors;
+	}
+	qsort (lat, count, sizeof (ut64), cmp_lat);
+	r_cons_printf ("requests %d clients %d errors %d\n", count, clients, errors);
+	r_cons_printf ("time %.3fs %.1f req/s\n", (double)t / R_USEC_PER_SEC,
+		t? (double)count * R_USEC_PER_SEC / t: 0.0);
+	if (count > 0) {
+		r_cons_printf ("latency p50 %"PFMT64u"us p99 %"PFMT64u"us max %"PFMT64u"us\n",
+			lat[count / 2], lat[(count * 99) / 100], lat[count - 1]);
+	}
+beach:
+	free (c);
+	free (th);
+	free (lat);
+	free (path);
+	return errors > 0;
+}
+
 #if 0
 static RThreadFunctionRet r_core_rtr_http_thread (RThread *th) {
 	if (!th) {
@@ -11,12 +11,29 @@ R_API void r_core_task_scheduler_init (RCoreTaskScheduler *tasks, RCore *core) {
 	tasks->lock = r_th_lock_new (true);
 	tasks->tasks_running = 0;
 	tasks->oneshot_running = false;
+	tasks->waiting_prio = -1;
+	tasks->slice = 0;
+	tasks->slice_start = 0;
+	tasks->unsafe = 0;
+	tasks->block_parked = false;
+	tasks->writer_waiting = 0;
 	tasks->main_task = r_core_task_new (core, false, NULL, NULL, NULL);
+	if (tasks->main_task) {
+		tasks->main_task->priority = R_CORE_TASK_PRIORITY_INTERACTIVE;
+	}
 	r_list_append (tasks->tasks, tasks->main_task);
 	tasks->current_task = NULL;
 }
 
 R_API void r_core_task_scheduler_fini (RCoreTaskScheduler *tasks) {
+	RListIter *iter;
+	RCoreTask *task;
+	r_list_foreach (tasks->tasks, iter, task) {
+		// finished tasks may still be unwinding in their own thread
+		if (task->thread && task->state == R_CORE_TASK_STATE_DONE) {
+			r_th_wait (task->thread);
+		}
+	}
 	r_list_free (tasks->tasks);
 	r_list_free (tasks->tasks_queue);
 	r_list_free (tasks->oneshot_queue);
@@ -56,6 +73,89 @@ typedef struct oneshot_t {
 	void *user;
 } OneShot;
 
+static void tasks_queue_update(RCoreTaskScheduler *scheduler) {
+	RCoreTask *head = r_list_first (scheduler->tasks_queue);
+	scheduler->waiting_prio = head ? head->priority : -1;
+}
+
+/* tasks_queue is kept sorted by priority, FIFO among tasks of the same one */
+static void tasks_queue_push(RCoreTaskScheduler *scheduler, RCoreTask *task) {
+	RListIter *iter;
+	RCoreTask *t;
+	int n = 0;
+	r_list_foreach (scheduler->tasks_queue, iter, t) {
+		if (t->priority < task->priority) {
+			break;
+		}
+		n++;
+	}
+	r_list_insert (scheduler->tasks_queue, n, task);
+	tasks_queue_update (scheduler);
+}
+
+static RCoreTask *tasks_queue_pop(RCoreTaskScheduler *scheduler) {
+	RCoreTask *task = r_list_pop_head (scheduler->tasks_queue);
+	tasks_queue_update (scheduler);
+	return task;
+}
+
+/* true if the caller runs on the thread of the current task and not in some
+ * helper thread that happens to check for breaks */
+static bool task_is_self(RCoreTaskScheduler *scheduler) {
+#if HAVE_PTHREAD
+	return scheduler->current_task && pthread_equal (scheduler->current_tid, pthread_self ());
+#else
+	return false;
+#endif
+}
+
+/* every task has its own seek and block, other tasks may move around or
+ * resize the block while it is not running, maybe in the middle of a command
+ * that still holds a pointer to it */
+static void task_switch_out(RCoreTask *task) {
+	RCore *core = task->core;
+	task->offset = core->offset;
+	task->offset_saved = true;
+	task->block = core->block;
+	task->blocksize = core->blocksize;
+	core->tasks.block_parked = true;
+}
+
+static void task_switch_in(RCoreTask *task) {
+	RCore *core = task->core;
+	RCoreTaskScheduler *scheduler = &core->tasks;
+	scheduler->current_task = task;
+	scheduler->current_tid = r_th_self ();
+	scheduler->slice_start = r_time_now_mono ();
+	if (task->cons_context) {
+		r_cons_context_load (task->cons_context);
+	} else {
+		r_cons_context_reset ();
+	}
+	if (task->block) {
+		if (!scheduler->block_parked && core->block != task->block) {
+			/* left behind by a task that is done */
+			free (core->block);
+		}
+		core->block = task->block;
+		core->blocksize = task->blocksize;
+		task->block = NULL;
+	} else if (scheduler->block_parked) {
+		/* first run of this task, the block belongs to the one switched out */
+		ut8 *block = r_mem_dup (core->block, core->blocksize);
+		if (block) {
+			core->block = block;
+		}
+	}
+	scheduler->block_parked = false;
+	if (task->offset_saved) {
+		task->offset_saved = false;
+		if (core->offset != task->offset) {
+			r_core_seek (core, task->offset, true);
+		}
+	}
+}
+
 R_API void r_core_task_print (RCore *core, RCoreTask *task, int mode) {
 	switch (mode) {
 	case 'j':
@@ -75,7 +175,8 @@ R_API void r_core_task_print (RCore *core, RCoreTask *task, int mode) {
 			r_cons_print ("done");
 			break;
 		}
-		r_cons_printf ("\",\"transient\":%s,\"cmd\":", task->transient ? "true" : "false");
+		r_cons_printf ("\",\"transient\":%s,\"priority\":%d,\"cmd\":",
+			task->transient ? "true" : "false", task->priority);
 		if (task->cmd) {
 			r_cons_printf ("\"%s\"}", task->cmd);
 		} else {
@@ -204,6 +305,9 @@ static void task_free (RCoreTask *task) {
 	r_th_cond_free (task->dispatch_cond);
 	r_th_lock_free (task->dispatch_lock);
 	r_cons_context_free (task->cons_context);
+	if (task->block != task->core->block) {
+		free (task->block);
+	}
 	free (task);
 }
 
@@ -240,6 +344,7 @@ R_API RCoreTask *r_core_task_new(RCore *core, bool create_cons, const char *cmd,
 	task->core = core;
 	task->user = user;
 	task->cb = cb;
+	task->priority = R_CORE_TASK_PRIORITY_DEFAULT;
 
 	return task;
 
@@ -291,6 +396,9 @@ R_API void r_core_task_schedule(RCoreTask *current, RTaskState next_state) {
 	if (stop) {
 		scheduler->tasks_running--;
 	}
+	if (next_state != R_CORE_TASK_STATE_DONE) {
+		task_switch_out (current);
+	}
 
 	// oneshots always have priority.
 	// if there are any queued, run them immediately.
@@ -303,10 +411,10 @@ R_API void r_core_task_schedule(RCoreTask *current, RTaskState next_state) {
 		free (oneshot);
 	}
 
-	RCoreTask *next = r_list_pop_head (scheduler->tasks_queue);
+	RCoreTask *next = tasks_queue_pop (scheduler);
 
 	if (next && !stop) {
-		r_list_append (scheduler->tasks_queue, current);
+		tasks_queue_push (scheduler, current);
 		r_th_lock_enter (current->dispatch_lock);
 	}
 
@@ -328,12 +436,7 @@ R_API void r_core_task_schedule(RCoreTask *current, RTaskState next_state) {
 	}
 
 	if (!stop) {
-		scheduler->current_task = current;
-		if (current->cons_context) {
-			r_cons_context_load (current->cons_context);
-		} else {
-			r_cons_context_reset ();
-		}
+		task_switch_in (current);
 	}
 }
 
@@ -355,7 +458,7 @@ static void task_wakeup(RCoreTask *current) {
 	// if we are not the only task, we must wait until another task signals us.
 
 	if (!single) {
-		r_list_append (scheduler->tasks_queue, current);
+		tasks_queue_push (scheduler, current);
 	}
 
 	tasks_lock_leave (scheduler, &old_sigset);
@@ -369,23 +472,58 @@ static void task_wakeup(RCoreTask *current) {
 
 	r_th_lock_leave (current->dispatch_lock);
 
-	scheduler->current_task = current;
-
-	if (current->cons_context) {
-		r_cons_context_load (current->cons_context);
-	} else {
-		r_cons_context_reset ();
-	}
+	task_switch_in (current);
 }
 
 R_API void r_core_task_yield(RCoreTaskScheduler *scheduler) {
 	RCoreTask *task = r_core_task_self (scheduler);
-	if (!task) {
+	if (!task || scheduler->waiting_prio < task->priority) {
+		// lower priority tasks only run when this one sleeps or is done
 		return;
 	}
 	r_core_task_schedule (task, R_CORE_TASK_STATE_RUNNING);
 }
 
+/* Called on every break check. Hands the core over to a waiting task of the
+ * same or higher priority once the current one used up its time slice, tasks
+ * of the same priority take turns. The preempted task
+ * stays in the middle of its command, so until it resumes only read-only
+ * commands are allowed to run (see r_core_task_wait_safe). r_core_cmd, at
+ * any depth, and r_core_write_at check this; code changing the core
+ * through other APIs (r_io_write_at, r_config_set, ...) must call
+ * r_core_task_wait_safe itself. */
+R_API void r_core_task_preempt(RCoreTaskScheduler *scheduler) {
+	RCoreTask *task = scheduler->current_task;
+	if (!task || scheduler->slice <= 0 || scheduler->waiting_prio < task->priority) {
+		return;
+	}
+	if (scheduler->writer_waiting || scheduler->oneshot_running || !task_is_self (scheduler)) {
+		return;
+	}
+	if (r_time_now_mono () - scheduler->slice_start < (ut64)scheduler->slice * 1000) {
+		return;
+	}
+	task->preempted = true;
+	scheduler->unsafe++;
+	r_core_task_schedule (task, R_CORE_TASK_STATE_RUNNING);
+	scheduler->unsafe--;
+	task->preempted = false;
+}
+
+/* To be called before modifying the core: lets preempted tasks run until they
+ * reach the end of their commands. */
+R_API void r_core_task_wait_safe(RCoreTaskScheduler *scheduler) {
+	RCoreTask *task = scheduler->current_task;
+	if (!task || !task_is_self (scheduler)) {
+		return;
+	}
+	scheduler->writer_waiting++;
+	while (scheduler->unsafe > 0 && scheduler->tasks_running > 1 && !scheduler->oneshot_running) {
+		r_core_task_schedule (task, R_CORE_TASK_STATE_RUNNING);
+	}
+	scheduler->writer_waiting--;
+}
+
 static void task_end(RCoreTask *t) {
 	r_core_task_schedule (t, R_CORE_TASK_STATE_DONE);
 }
@@ -536,7 +674,7 @@ R_API void r_core_task_sleep_end(RCoreTask *task) {
 R_API const char *r_core_task_status (RCoreTask *task) {
 	switch (task->state) {
 	case R_CORE_TASK_STATE_RUNNING:
-		return "running";
+		return task->preempted ? "preempted" : "running";
 	case R_CORE_TASK_STATE_SLEEPING:
 		return "sleeping";
 	case R_CORE_TASK_STATE_DONE:
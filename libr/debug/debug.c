@@ -37,7 +37,7 @@ R_API void r_debug_bp_update(RDebug *dbg) {
 	RListIter *iter;
 	r_list_foreach (dbg->bp->bps, iter, bp) {
 		if (bp->expr) {
-			bp->addr = dbg->corebind.numGet (dbg->corebind.core, bp->expr);
+			r_bp_item_relocate (dbg->bp, bp, dbg->corebind.numGet (dbg->corebind.core, bp->expr));
 		}
 	}
 }
@@ -58,6 +58,45 @@ static int r_debug_drx_at(RDebug *dbg, ut64 addr) {
  * r_debug_bp_hit handles stage 1.
  * r_debug_recoil handles stage 2.
  */
+/*
+ * Coverage breakpoints are hit once while continuing. Instead of clearing
+ * and writing back all the breakpoints like r_debug_bp_hit and the recoil
+ * do, only the bytes of the hit one are restored and the rest stay in place.
+ *
+ * Returns false when pc is not on a coverage breakpoint.
+ */
+static bool r_debug_bp_coverage_hit(RDebug *dbg, RRegItem *pc_ri, ut64 pc, RBreakpointItem **pb) {
+	ut64 at = pc;
+	RBreakpointItem *b = NULL;
+#if !__mips__
+	if (!dbg->pc_at_bp_set || !dbg->pc_at_bp) {
+		at = pc - dbg->bpsize;
+		b = r_bp_get_at (dbg->bp, at);
+	}
+#endif
+	if (!b) {
+		at = pc;
+		b = r_bp_get_at (dbg->bp, at);
+	}
+	if (!b || !b->coverage || b->hw) {
+		return false;
+	}
+	if (at != pc) {
+		if (!r_reg_set_value (dbg->reg, pc_ri, at) || !r_debug_reg_sync (dbg, R_REG_TYPE_GPR, true)) {
+			return false;
+		}
+	}
+	if (dbg->trace->enabled) {
+		r_debug_trace_pc (dbg, at);
+	}
+	r_bp_restore_one (dbg->bp, b, false);
+	r_bp_coverage_hit (dbg->bp, b);
+	dbg->reason.bp_addr = 0;
+	dbg->bps_in_place = true;
+	*pb = b;
+	return true;
+}
+
 static int r_debug_bp_hit(RDebug *dbg, RRegItem *pc_ri, ut64 pc, RBreakpointItem **pb) {
 	RBreakpointItem *b;
 
@@ -172,6 +211,12 @@ static int r_debug_bp_hit(RDebug *dbg, RRegItem *pc_ri, ut64 pc, RBreakpointItem
 		return true;
 	}
 
+	/* coverage breakpoints just record the hit and are gone, no need to recoil */
+	if (r_bp_coverage_hit (dbg->bp, b)) {
+		dbg->reason.bp_addr = 0;
+		return true;
+	}
+
 	/* setup our stage 2 */
 	dbg->reason.bp_addr = b->addr;
 
@@ -426,7 +471,7 @@ R_API RDebug *r_debug_free(RDebug *dbg) {
 		free (dbg->btalgo);
 		r_debug_trace_free (dbg->trace);
 		r_debug_session_free (dbg->session);
-		r_anal_op_free (dbg->cur_op);
+		dbg->cur_op = NULL;
 		dbg->trace = NULL;
 		r_egg_free (dbg->egg);
 		free (dbg->arch);
@@ -488,6 +533,7 @@ R_API bool r_debug_set_arch(RDebug *dbg, const char *arch, int bits) {
 			}
 			free (dbg->arch);
 			dbg->arch = strdup (arch);
+			r_debug_trace_ops_clear (dbg);
 			return true;
 		}
 	}
@@ -530,7 +576,8 @@ R_API ut64 r_debug_execute(RDebug *dbg, const ut8 *buf, int len, int restore) {
 
 		r_bp_add_sw (dbg->bp, rpc+len, dbg->bpsize, R_BP_PROT_EXEC);
 
-		/* execute code here */
+		/* execute code here, the original bytes are back before returning */
+		dbg->iob.io->ev_lock++;
 		dbg->iob.write_at (dbg->iob.io, rpc, buf, len);
 		//r_bp_add_sw (dbg->bp, rpc+len, 4, R_BP_PROT_EXEC);
 		r_debug_continue (dbg);
@@ -542,6 +589,7 @@ R_API ut64 r_debug_execute(RDebug *dbg, const ut8 *buf, int len, int restore) {
 		if (restore) {
 			dbg->iob.write_at (dbg->iob.io, rsp, stackbackup, len);
 		}
+		dbg->iob.io->ev_lock--;
 
 		r_debug_reg_sync (dbg, R_REG_TYPE_GPR, false);
 		ri = r_reg_get (dbg->reg, dbg->reg->name[R_REG_NAME_A0], R_REG_TYPE_GPR);
@@ -749,7 +797,9 @@ R_API RDebugReasonType r_debug_wait(RDebug *dbg, RBreakpointItem **bp) {
 			/* get the value */
 			pc = r_reg_get_value (dbg->reg, pc_ri);
 
-			if (!r_debug_bp_hit (dbg, pc_ri, pc, &b)) {
+			if (reason == R_DEBUG_REASON_BREAKPOINT && r_debug_bp_coverage_hit (dbg, pc_ri, pc, &b)) {
+				// the other breakpoints are still set
+			} else if (!r_debug_bp_hit (dbg, pc_ri, pc, &b)) {
 				return R_DEBUG_REASON_ERROR;
 			}
 
@@ -970,11 +1020,14 @@ R_API int r_debug_step(RDebug *dbg, int steps) {
 		}
 	}
 
+	bool record = (dbg->session || dbg->trace->rec) && dbg->recoil_mode == R_DBG_RECOIL_NONE;
 	for (; steps_taken < steps; steps_taken++) {
-		if (dbg->session && dbg->recoil_mode == R_DBG_RECOIL_NONE) {
-			dbg->session->cnum++;
-			dbg->session->maxcnum++;
-			dbg->session->bp = 0;
+		if (record) {
+			if (dbg->session) {
+				dbg->session->cnum++;
+				dbg->session->maxcnum++;
+				dbg->session->bp = 0;
+			}
 			if (!r_debug_trace_ins_before (dbg)) {
 				eprintf ("trace_ins_before: failed");
 			}
@@ -990,12 +1043,14 @@ R_API int r_debug_step(RDebug *dbg, int steps) {
 			return steps_taken;
 		}
 
-		if (dbg->session && dbg->recoil_mode == R_DBG_RECOIL_NONE) {
+		if (record) {
 			if (!r_debug_trace_ins_after (dbg)) {
 				eprintf ("trace_ins_after: failed");
 			}
-			dbg->session->reasontype = dbg->reason.type;
-			dbg->session->bp = bp;
+			if (dbg->session) {
+				dbg->session->reasontype = dbg->reason.type;
+				dbg->session->bp = bp;
+			}
 		}
 
 		dbg->steps++;
@@ -1031,16 +1086,19 @@ R_API int r_debug_step_over(RDebug *dbg, int steps) {
 	}
 
 	if (dbg->h && dbg->h->step_over) {
+		bool record = (dbg->session || dbg->trace->rec) && dbg->recoil_mode == R_DBG_RECOIL_NONE;
 		for (; steps_taken < steps; steps_taken++) {
-			if (dbg->session && dbg->recoil_mode == R_DBG_RECOIL_NONE) {
-				dbg->session->cnum++;
-				dbg->session->maxcnum++;
+			if (record) {
+				if (dbg->session) {
+					dbg->session->cnum++;
+					dbg->session->maxcnum++;
+				}
 				r_debug_trace_ins_before (dbg);
 			}
 			if (!dbg->h->step_over (dbg)) {
 				return steps_taken;
 			}
-			if (dbg->session && dbg->recoil_mode == R_DBG_RECOIL_NONE) {
+			if (record) {
 				r_debug_trace_ins_after (dbg);
 			}
 		}
@@ -1158,6 +1216,7 @@ R_API int r_debug_continue_kill(RDebug *dbg, int sig) {
 
 repeat:
 	if (r_debug_is_dead (dbg)) {
+		dbg->bps_in_place = false;
 		return 0;
 	}
 	if (dbg->session && dbg->trace_continue) {
@@ -1172,8 +1231,10 @@ repeat:
 		reason = dbg->session->reasontype;
 		bp = dbg->session->bp;
 	} else if (dbg->h && dbg->h->cont) {
-		/* handle the stage-2 of breakpoints */
-		if (!r_debug_recoil (dbg, R_DBG_RECOIL_CONTINUE)) {
+		/* handle the stage-2 of breakpoints, unless a coverage hit left them set */
+		if (dbg->bps_in_place) {
+			dbg->bps_in_place = false;
+		} else if (!r_debug_recoil (dbg, R_DBG_RECOIL_CONTINUE)) {
 			return 0;
 		}
 		/* tell the inferior to go! */
@@ -1196,6 +1257,16 @@ repeat:
 			}
 		}
 	}
+	if (reason == R_DEBUG_REASON_BREAKPOINT && bp && bp->coverage) {
+		// one-shot, drop it and keep going without bothering the user
+		r_bp_del (dbg->bp, bp->addr);
+		goto repeat;
+	}
+	if (dbg->bps_in_place) {
+		// stopping here, so take the breakpoints out like r_debug_bp_hit does
+		dbg->bps_in_place = false;
+		r_bp_restore (dbg->bp, false);
+	}
 	if (reason == R_DEBUG_REASON_BREAKPOINT &&
 	   ((bp && !bp->enabled) || (!bp && !r_cons_is_breaked () && dbg->corebind.core &&
 					dbg->corebind.cfggeti (dbg->corebind.core, "dbg.bpsysign")))) {
@@ -1727,7 +1798,7 @@ R_API void r_debug_bp_rebase(RDebug *dbg, ut64 old_base, ut64 new_base) {
 
 	// update bp's address
 	r_list_foreach (dbg->bp->bps, iter, bp) {
-		bp->addr += diff;
+		r_bp_item_relocate (dbg->bp, bp, bp->addr + diff);
 		bp->delta = bp->addr - dbg->bp->baddr;
 	}
 }
@@ -0,0 +1,388 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_debug.h>
+#include <r_th.h>
+
+/*
+ * Binary instruction trace recorder.
+ *
+ * The stepping thread appends compact records to fixed size blocks of a
+ * ring and publishes every filled block with a single release store, a
+ * writer thread drains the published blocks to the file. Only one side
+ * ever writes each index, so recording a step never takes a lock. The
+ * stepping thread only sleeps on the drained condition when the ring is
+ * full or when flushing.
+ *
+ * File layout: "R2TRACE" + version byte, followed by records:
+ *   'A' arena:u8 size:u32 bytes[size]   register arena snapshot
+ *   'S' pc:u64                          start of a new step
+ *   'R' arena:u8 offset:u16 value:u64   register written by the step
+ *   'M' addr:u64 len:u8 bytes[len]      memory written by the step
+ * All integers are little endian.
+ */
+
+#define TREC_MAGIC "R2TRACE"
+#define TREC_VERSION 1
+#define TREC_BLOCKS 8
+#define TREC_BLOCK_SIZE (64 * 1024)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TREC_LOAD(x) __atomic_load_n (&(x), __ATOMIC_ACQUIRE)
+#define TREC_STORE(x, v) __atomic_store_n (&(x), (v), __ATOMIC_RELEASE)
+#else
+#define TREC_LOAD(x) (*(volatile ut32 *)&(x))
+#define TREC_STORE(x, v) (*(volatile ut32 *)&(x) = (v))
+#endif
+
+struct r_debug_trace_rec_t {
+	char *file;
+	int fd;
+	ut8 *blocks[TREC_BLOCKS];
+	int lens[TREC_BLOCKS];
+	int pos; // bytes used in the block being filled
+	ut32 head; // blocks published, only written by the producer
+	ut32 tail; // blocks flushed, only written by the writer thread
+	ut32 stop;
+	ut32 failed;
+	RThread *th;
+	RThreadSemaphore *ready;
+	RThreadLock *lock;
+	RThreadCond *drained; // signaled by the writer for every flushed block
+	ut64 steps;
+	ut64 records;
+	ut64 bytes;
+};
+
+static RThreadFunctionRet trec_writer_th(RThread *th) {
+	RDebugTraceRec *rec = th->user;
+	ut32 tail = rec->tail;
+	for (;;) {
+		r_th_sem_wait (rec->ready);
+		ut32 head = TREC_LOAD (rec->head);
+		while (tail != head) {
+			int i = tail % TREC_BLOCKS;
+			if (write (rec->fd, rec->blocks[i], rec->lens[i]) != rec->lens[i]) {
+				TREC_STORE (rec->failed, 1);
+			}
+			r_th_lock_enter (rec->lock);
+			TREC_STORE (rec->tail, ++tail);
+			r_th_cond_signal (rec->drained);
+			r_th_lock_leave (rec->lock);
+		}
+		if (TREC_LOAD (rec->stop)) {
+			break;
+		}
+	}
+	return R_TH_STOP;
+}
+
+// sleep until the writer is less than the given number of blocks behind
+static void trec_wait(RDebugTraceRec *rec, ut32 behind) {
+	if (rec->head - TREC_LOAD (rec->tail) < behind) {
+		return;
+	}
+	r_th_lock_enter (rec->lock);
+	while (rec->head - TREC_LOAD (rec->tail) >= behind) {
+		r_th_cond_wait (rec->drained, rec->lock);
+	}
+	r_th_lock_leave (rec->lock);
+}
+
+static void trec_publish(RDebugTraceRec *rec) {
+	if (!rec->pos) {
+		return;
+	}
+	rec->lens[rec->head % TREC_BLOCKS] = rec->pos;
+	TREC_STORE (rec->head, rec->head + 1);
+	r_th_sem_post (rec->ready);
+	rec->pos = 0;
+	// only block when the writer is a whole ring behind
+	trec_wait (rec, TREC_BLOCKS);
+}
+
+static ut8 *trec_reserve(RDebugTraceRec *rec, int len) {
+	if (rec->pos + len > TREC_BLOCK_SIZE) {
+		trec_publish (rec);
+	}
+	ut8 *p = rec->blocks[rec->head % TREC_BLOCKS] + rec->pos;
+	rec->pos += len;
+	rec->bytes += len;
+	rec->records++;
+	return p;
+}
+
+R_API RDebugTraceRec *r_debug_trace_rec_new(const char *file) {
+	r_return_val_if_fail (file, NULL);
+	int i;
+	RDebugTraceRec *rec = R_NEW0 (RDebugTraceRec);
+	if (!rec) {
+		return NULL;
+	}
+	rec->fd = r_sandbox_open (file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (rec->fd == -1) {
+		eprintf ("Cannot open %s for writing\n", file);
+		free (rec);
+		return NULL;
+	}
+	rec->file = strdup (file);
+	for (i = 0; i < TREC_BLOCKS; i++) {
+		rec->blocks[i] = malloc (TREC_BLOCK_SIZE);
+		if (!rec->blocks[i]) {
+			goto beach;
+		}
+	}
+	ut8 *hdr = trec_reserve (rec, 8);
+	memcpy (hdr, TREC_MAGIC, 7);
+	hdr[7] = TREC_VERSION;
+	rec->records = 0;
+	rec->ready = r_th_sem_new (0);
+	rec->lock = r_th_lock_new (false);
+	rec->drained = r_th_cond_new ();
+	if (!rec->ready || !rec->lock || !rec->drained) {
+		goto beach;
+	}
+	rec->th = r_th_new (trec_writer_th, rec, 0);
+	if (!rec->th) {
+		goto beach;
+	}
+	r_th_setname (rec->th, "r2_trace_rec");
+	return rec;
+beach:
+	r_debug_trace_rec_free (rec);
+	return NULL;
+}
+
+R_API void r_debug_trace_rec_free(RDebugTraceRec *rec) {
+	int i;
+	if (!rec) {
+		return;
+	}
+	if (rec->th) {
+		trec_publish (rec);
+		TREC_STORE (rec->stop, 1);
+		r_th_sem_post (rec->ready);
+		r_th_wait (rec->th);
+		r_th_free (rec->th);
+	}
+	r_th_sem_free (rec->ready);
+	r_th_cond_free (rec->drained);
+	r_th_lock_free (rec->lock);
+	if (rec->fd != -1) {
+		close (rec->fd);
+	}
+	for (i = 0; i < TREC_BLOCKS; i++) {
+		free (rec->blocks[i]);
+	}
+	free (rec->file);
+	free (rec);
+}
+
+// make everything recorded so far visible in the file
+R_API bool r_debug_trace_rec_flush(RDebugTraceRec *rec) {
+	r_return_val_if_fail (rec, false);
+	trec_publish (rec);
+	trec_wait (rec, 1);
+	return !TREC_LOAD (rec->failed);
+}
+
+R_API void r_debug_trace_rec_regs(RDebugTraceRec *rec, RReg *reg) {
+	r_return_if_fail (rec && reg);
+	int i;
+	for (i = 0; i < R_REG_TYPE_LAST; i++) {
+		RRegArena *a = reg->regset[i].arena;
+		if (!a || !a->bytes || a->size < 1 || a->size > TREC_BLOCK_SIZE - 6 || r_list_empty (reg->regset[i].regs)) {
+			continue;
+		}
+		ut8 *p = trec_reserve (rec, 6 + a->size);
+		p[0] = R_DEBUG_TRACE_REC_REGS;
+		p[1] = i;
+		r_write_le32 (p + 2, a->size);
+		memcpy (p + 6, a->bytes, a->size);
+	}
+}
+
+R_API void r_debug_trace_rec_step(RDebugTraceRec *rec, ut64 pc) {
+	ut8 *p = trec_reserve (rec, 9);
+	p[0] = R_DEBUG_TRACE_REC_STEP;
+	r_write_le64 (p + 1, pc);
+	rec->steps++;
+}
+
+R_API void r_debug_trace_rec_reg(RDebugTraceRec *rec, int arena, int offset, ut64 value) {
+	ut8 *p = trec_reserve (rec, 12);
+	p[0] = R_DEBUG_TRACE_REC_REG;
+	p[1] = arena;
+	r_write_le16 (p + 2, offset);
+	r_write_le64 (p + 4, value);
+}
+
+R_API void r_debug_trace_rec_mem(RDebugTraceRec *rec, ut64 addr, const ut8 *buf, int len) {
+	while (len > 0) {
+		int n = R_MIN (len, 255);
+		ut8 *p = trec_reserve (rec, 10 + n);
+		p[0] = R_DEBUG_TRACE_REC_MEM;
+		r_write_le64 (p + 1, addr);
+		p[9] = n;
+		memcpy (p + 10, buf, n);
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
+R_API void r_debug_trace_rec_info(RDebugTraceRec *rec, PrintfCallback cb_printf) {
+	r_return_if_fail (rec && cb_printf);
+	cb_printf ("file %s\n", rec->file);
+	cb_printf ("steps %"PFMT64u"\n", rec->steps);
+	cb_printf ("records %"PFMT64u"\n", rec->records);
+	cb_printf ("bytes %"PFMT64u"\n", rec->bytes);
+	cb_printf ("pending %d\n", (int)(rec->head - TREC_LOAD (rec->tail)));
+}
+
+R_API bool r_debug_trace_rec_foreach(const char *file, RDebugTraceEventCallback cb, void *user) {
+	r_return_val_if_fail (file && cb, false);
+	ut8 hdr[8], tmp[16];
+	ut8 *data = NULL;
+	bool ret = false;
+	FILE *fd = r_sandbox_fopen (file, "rb");
+	if (!fd) {
+		return false;
+	}
+	if (fread (hdr, 1, sizeof (hdr), fd) != sizeof (hdr) || memcmp (hdr, TREC_MAGIC, 7) || hdr[7] != TREC_VERSION) {
+		eprintf ("%s is not a binary trace\n", file);
+		goto beach;
+	}
+	RDebugTraceEvent ev = {0};
+	int c;
+	while ((c = fgetc (fd)) != EOF) {
+		ev.type = c;
+		ev.data = NULL;
+		ev.len = 0;
+		switch (c) {
+		case R_DEBUG_TRACE_REC_STEP:
+			if (fread (tmp, 1, 8, fd) != 8) {
+				goto beach;
+			}
+			ev.step++;
+			ev.pc = r_read_le64 (tmp);
+			break;
+		case R_DEBUG_TRACE_REC_REG:
+			if (fread (tmp, 1, 11, fd) != 11) {
+				goto beach;
+			}
+			ev.arena = tmp[0];
+			ev.offset = r_read_le16 (tmp + 1);
+			ev.value = r_read_le64 (tmp + 3);
+			break;
+		case R_DEBUG_TRACE_REC_MEM:
+			if (fread (tmp, 1, 9, fd) != 9) {
+				goto beach;
+			}
+			ev.addr = r_read_le64 (tmp);
+			ev.len = tmp[8];
+			break;
+		case R_DEBUG_TRACE_REC_REGS:
+			if (fread (tmp, 1, 5, fd) != 5) {
+				goto beach;
+			}
+			ev.arena = tmp[0];
+			ev.len = r_read_le32 (tmp + 1);
+			if (ev.len > TREC_BLOCK_SIZE) {
+				goto beach;
+			}
+			break;
+		default:
+			eprintf ("Invalid trace record 0x%02x at 0x%"PFMT64x"\n", c, (ut64)ftell (fd) - 1);
+			goto beach;
+		}
+		if (ev.len > 0) {
+			ut8 *d = realloc (data, ev.len);
+			if (!d || fread (d, 1, ev.len, fd) != (size_t)ev.len) {
+				data = d? d: data;
+				goto beach;
+			}
+			data = d;
+			ev.data = data;
+		}
+		if (!cb (user, &ev)) {
+			break;
+		}
+	}
+	ret = true;
+beach:
+	free (data);
+	fclose (fd);
+	return ret;
+}
+
+typedef struct {
+	RDebug *dbg;
+	ut64 step;
+	ut64 done;
+	ut64 pc;
+} TraceReplay;
+
+static RRegItem *reg_at(RReg *reg, int arena, int offset) {
+	RListIter *iter;
+	RRegItem *ri;
+	if (arena < 0 || arena >= R_REG_TYPE_LAST) {
+		return NULL;
+	}
+	r_list_foreach (reg->regset[arena].regs, iter, ri) {
+		if (ri->offset == offset) {
+			return ri;
+		}
+	}
+	return NULL;
+}
+
+static bool replay_cb(void *user, const RDebugTraceEvent *ev) {
+	TraceReplay *tr = user;
+	RDebug *dbg = tr->dbg;
+	if (ev->step > tr->step) {
+		// pc of the first instruction not replayed
+		tr->pc = ev->pc;
+		return false;
+	}
+	switch (ev->type) {
+	case R_DEBUG_TRACE_REC_REGS: {
+		RRegArena *a = (ev->arena < R_REG_TYPE_LAST)? dbg->reg->regset[ev->arena].arena: NULL;
+		if (a && a->bytes) {
+			memcpy (a->bytes, ev->data, R_MIN (a->size, ev->len));
+		}
+		break;
+	}
+	case R_DEBUG_TRACE_REC_STEP:
+		tr->done = ev->step;
+		tr->pc = ev->pc;
+		break;
+	case R_DEBUG_TRACE_REC_REG: {
+		RRegItem *ri = reg_at (dbg->reg, ev->arena, ev->offset);
+		if (ri) {
+			r_reg_set_value (dbg->reg, ri, ev->value);
+		}
+		break;
+	}
+	case R_DEBUG_TRACE_REC_MEM:
+		// only the io cache sees it, the target memory is left alone
+		r_io_cache_write (dbg->iob.io, ev->addr, ev->data, ev->len);
+		break;
+	}
+	return true;
+}
+
+/* rebuild registers and written memory as they were after the given
+ * number of steps without touching the target: the registers are set in
+ * dbg->reg only and the memory goes to the io cache, which is only read
+ * back with io.cache.read. Returns the steps replayed */
+R_API ut64 r_debug_trace_rec_replay(RDebug *dbg, const char *file, ut64 step) {
+	r_return_val_if_fail (dbg && dbg->reg && dbg->iob.io && file, 0);
+	TraceReplay tr = { dbg, step, 0, UT64_MAX };
+	if (!r_debug_trace_rec_foreach (file, replay_cb, &tr)) {
+		return 0;
+	}
+	if (tr.pc != UT64_MAX) {
+		r_reg_setv (dbg->reg, dbg->reg->name[R_REG_NAME_PC], tr.pc);
+	}
+	return tr.done;
+}
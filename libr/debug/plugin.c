@@ -33,6 +33,7 @@ R_API bool r_debug_use(RDebug *dbg, const char *str) {
 	if (dbg && dbg->h && dbg->h->reg_profile) {
 		char *p = dbg->h->reg_profile (dbg);
 		if (p) {
+			r_debug_trace_ops_clear (dbg);
 			r_reg_set_profile_string (dbg->reg, p);
 			if (dbg->anal && dbg->reg != dbg->anal->reg) {
 				r_reg_free (dbg->anal->reg);
@@ -101,6 +102,7 @@ R_API bool r_debug_plugin_set_reg_profile(RDebug *dbg, const char *profile) {
 		return false;
 	}
 	if (dbg && dbg->h && dbg->h->set_reg_profile) {
+		r_debug_trace_ops_clear (dbg);
 		return dbg->h->set_reg_profile (str);
 	}
 	free (str);
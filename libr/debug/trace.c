@@ -4,6 +4,19 @@
 
 // DO IT WITH SDB
 
+#define TRACE_OP_BYTES 32
+
+typedef struct {
+	RAnalOp *op; // only keeps the accesses that write
+	ut8 bytes[TRACE_OP_BYTES]; // what op was decoded from
+} RDebugTraceOp;
+
+static void trace_op_free(HtUPKv *kv) {
+	RDebugTraceOp *top = kv->value;
+	r_anal_op_free (top->op);
+	free (top);
+}
+
 R_API RDebugTrace *r_debug_trace_new (void) {
 	RDebugTrace *t = R_NEW0 (RDebugTrace);
 	if (!t) {
@@ -19,7 +32,8 @@ R_API RDebugTrace *r_debug_trace_new (void) {
 	}
 	t->traces->free = free;
 	t->ht = ht_pp_new0 ();
-	if (!t->ht) {
+	t->ops = ht_up_new (NULL, trace_op_free, NULL);
+	if (!t->ht || !t->ops) {
 		r_debug_trace_free (t);
 		return NULL;
 	}
@@ -33,6 +47,8 @@ R_API void r_debug_trace_free (RDebugTrace *trace) {
 	r_list_purge (trace->traces);
 	free (trace->traces);
 	ht_pp_free (trace->ht);
+	ht_up_free (trace->ops);
+	r_debug_trace_rec_free (trace->rec);
 	R_FREE (trace);
 }
 
@@ -43,10 +59,83 @@ R_API int r_debug_trace_tag (RDebug *dbg, int tag) {
 	return (dbg->trace->tag = (tag>0)? tag: UT32_MAX);
 }
 
-R_API bool r_debug_trace_ins_before(RDebug *dbg) {
+// drop the decoded ops, they point into the register profile they were decoded with
+R_API void r_debug_trace_ops_clear(RDebug *dbg) {
+	r_return_if_fail (dbg);
+	RDebugTrace *t = dbg->trace;
+	if (!t) {
+		return;
+	}
+	if (t->ops && t->ops->count) {
+		ht_up_free (t->ops);
+		t->ops = ht_up_new (NULL, trace_op_free, NULL);
+	}
+	t->ops_plugin = NULL;
+	dbg->cur_op = NULL;
+}
+
+static void trace_ops_sync(RDebug *dbg) {
+	RDebugTrace *t = dbg->trace;
+	RAnal *anal = dbg->anal;
+	if (!anal) {
+		return;
+	}
+	ut64 reg_epoch = anal->reg? anal->reg->epoch: 0;
+	if (t->ops_plugin != anal->cur || t->ops_bits != anal->bits || t->ops_reg_epoch != reg_epoch) {
+		r_debug_trace_ops_clear (dbg);
+		t->ops_plugin = anal->cur;
+		t->ops_bits = anal->bits;
+		t->ops_reg_epoch = reg_epoch;
+	}
+}
+
+// decode the instruction at pc once, later steps over the same bytes reuse it
+static RAnalOp *trace_op_at(RDebug *dbg, ut64 pc, const ut8 *buf) {
 	RListIter *it, *it_tmp;
 	RAnalValue *val;
-	ut8 buf_pc[32];
+	trace_ops_sync (dbg);
+	if (!dbg->trace->ops) {
+		return NULL;
+	}
+	RDebugTraceOp *top = ht_up_find (dbg->trace->ops, pc, NULL);
+	if (top) {
+		if (!memcmp (top->bytes, buf, R_MIN (top->op->size, TRACE_OP_BYTES))) {
+			return top->op;
+		}
+		// code was modified, decode it again
+		ht_up_delete (dbg->trace->ops, pc);
+	}
+	RAnalOp *op = R_NEW0 (RAnalOp);
+	if (!op) {
+		return NULL;
+	}
+	if (!r_anal_op (dbg->anal, op, pc, buf, TRACE_OP_BYTES, R_ANAL_OP_MASK_VAL)) {
+		r_anal_op_free (op);
+		return NULL;
+	}
+	r_list_foreach_safe (op->access, it, it_tmp, val) {
+		if (!(val->access & R_ANAL_ACC_W)) {
+			r_list_delete (op->access, it);
+		} else if (val->type == R_ANAL_VAL_MEM && val->memref > 32) {
+			eprintf ("Error: adding changes to %d bytes in memory.\n", val->memref);
+			r_list_delete (op->access, it);
+		}
+	}
+	top = R_NEW0 (RDebugTraceOp);
+	if (!top) {
+		r_anal_op_free (op);
+		return NULL;
+	}
+	top->op = op;
+	memcpy (top->bytes, buf, TRACE_OP_BYTES);
+	ht_up_insert (dbg->trace->ops, pc, top);
+	return op;
+}
+
+R_API bool r_debug_trace_ins_before(RDebug *dbg) {
+	RListIter *it;
+	RAnalValue *val;
+	ut8 buf_pc[TRACE_OP_BYTES];
 
 	// Analyze current instruction
 	ut64 pc = r_debug_reg_get (dbg, dbg->reg->name[R_REG_NAME_PC]);
@@ -56,52 +145,30 @@ R_API bool r_debug_trace_ins_before(RDebug *dbg) {
 	if (!dbg->iob.read_at (dbg->iob.io, pc, buf_pc, sizeof (buf_pc))) {
 		return false;
 	}
-	dbg->cur_op = R_NEW0 (RAnalOp);
-	if (!dbg->cur_op) {
-		return false;
+	if (dbg->trace->rec) {
+		r_debug_trace_rec_step (dbg->trace->rec, pc);
 	}
-	if (!r_anal_op (dbg->anal, dbg->cur_op, pc, buf_pc, sizeof (buf_pc), R_ANAL_OP_MASK_VAL)) {
-		r_anal_op_free (dbg->cur_op);
-		dbg->cur_op = NULL;
+	dbg->cur_op = trace_op_at (dbg, pc, buf_pc);
+	if (!dbg->cur_op) {
 		return false;
 	}
 
-	// resolve mem write address
-	r_list_foreach_safe (dbg->cur_op->access, it, it_tmp, val) {
-		switch (val->type) {
-		case R_ANAL_VAL_REG:
-			if (!(val->access & R_ANAL_ACC_W)) {
-				r_list_delete (dbg->cur_op->access, it);
+	// resolve mem write addresses for ins_after
+	r_list_foreach (dbg->cur_op->access, it, val) {
+		if (val->type == R_ANAL_VAL_MEM) {
+			ut64 addr = 0;
+			addr += val->delta;
+			if (val->seg) {
+				addr += r_reg_get_value (dbg->reg, val->seg);
 			}
-			break;
-		case R_ANAL_VAL_MEM:
-			if (val->memref > 32) {
-				eprintf ("Error: adding changes to %d bytes in memory.\n", val->memref);
-				r_list_delete (dbg->cur_op->access, it);
-				break;
+			if (val->reg) {
+				addr += r_reg_get_value (dbg->reg, val->reg);
 			}
-
-			if (val->access & R_ANAL_ACC_W) {
-				// resolve memory address
-				ut64 addr = 0;
-				addr += val->delta;
-				if (val->seg) {
-					addr += r_reg_get_value (dbg->reg, val->seg);
-				}
-				if (val->reg) {
-					addr += r_reg_get_value (dbg->reg, val->reg);
-				}
-				if (val->regdelta) {
-					int mul = val->mul ? val->mul : 1;
-					addr += mul * r_reg_get_value (dbg->reg, val->regdelta);
-				}
-				// resolve address into base for ins_after
-				val->base = addr;
-			} else {
-				r_list_delete (dbg->cur_op->access, it);
+			if (val->regdelta) {
+				int mul = val->mul ? val->mul : 1;
+				addr += mul * r_reg_get_value (dbg->reg, val->regdelta);
 			}
-		default:
-			break;
+			val->base = addr;
 		}
 	}
 	return true;
@@ -110,21 +177,26 @@ R_API bool r_debug_trace_ins_before(RDebug *dbg) {
 R_API bool r_debug_trace_ins_after(RDebug *dbg) {
 	RListIter *it;
 	RAnalValue *val;
+	RDebugTraceRec *rec = dbg->trace->rec;
 
+	if (!dbg->cur_op) {
+		return false;
+	}
 	// Add reg/mem write change
 	r_debug_reg_sync (dbg, R_REG_TYPE_ALL, false);
 	r_list_foreach (dbg->cur_op->access, it, val) {
-		if (!(val->access & R_ANAL_ACC_W)) {
-			continue;
-		}
-
 		switch (val->type) {
 		case R_ANAL_VAL_REG:
 		{
 			ut64 data = r_reg_get_value (dbg->reg, val->reg);
 
 			// add reg write
-			r_debug_session_add_reg_change (dbg->session, val->reg->arena, val->reg->offset, data);
+			if (dbg->session) {
+				r_debug_session_add_reg_change (dbg->session, val->reg->arena, val->reg->offset, data);
+			}
+			if (rec) {
+				r_debug_trace_rec_reg (rec, val->reg->arena, val->reg->offset, data);
+			}
 			break;
 		}
 		case R_ANAL_VAL_MEM:
@@ -136,9 +208,14 @@ R_API bool r_debug_trace_ins_after(RDebug *dbg) {
 			}
 
 			// add mem write
-			size_t i;
-			for (i = 0; i < val->memref; i++) {
-				r_debug_session_add_mem_change (dbg->session, val->base + i, buf[i]);
+			if (dbg->session) {
+				size_t i;
+				for (i = 0; i < val->memref; i++) {
+					r_debug_session_add_mem_change (dbg->session, val->base + i, buf[i]);
+				}
+			}
+			if (rec) {
+				r_debug_trace_rec_mem (rec, val->base, buf, val->memref);
 			}
 			break;
 		}
@@ -146,7 +223,7 @@ R_API bool r_debug_trace_ins_after(RDebug *dbg) {
 			break;
 		}
 	}
-	r_anal_op_free (dbg->cur_op);
+	// owned by dbg->trace->ops
 	dbg->cur_op = NULL;
 	return true;
 }
@@ -29,20 +29,167 @@ static const char *str_callback(RNum *user, ut64 off, int *ok) {
 	return NULL;
 }
 
-static void flag_skiplist_free(void *data) {
-	RFlagsAtOffset *item = (RFlagsAtOffset *)data;
-	r_list_free (item->flags);
-	free (data);
-}
-
-static int flag_skiplist_cmp(const void *va, const void *vb) {
-	const RFlagsAtOffset *a = (RFlagsAtOffset *)va, *b = (RFlagsAtOffset *)vb;
+/*
+ * Flags are indexed by offset in by_off, a vector of RFlagsAtOffset sorted
+ * by offset. Flags at offsets that are not there yet go to by_off_log,
+ * whose first by_off_log_sorted entries are kept sorted too. Once the log
+ * outgrows the square root of by_off, flags_sync () merges it in, so a
+ * new offset costs a short insertion instead of moving the whole index.
+ * Between r_flag_bulk_begin and r_flag_bulk_end, and from foreach
+ * callbacks, new offsets are appended to the log unsorted, indexed by
+ * by_off_pending, and merged with a single sort when the bulk or the
+ * iteration ends. Lookups never reorganize the index, they check both
+ * vectors. Offsets losing all their flags stay until the next merge.
+ */
+
+#define FLAGS_AT_CMP(x, y) ((x) < ((RFlagsAtOffset *)(y))->off? -1: (x) > ((RFlagsAtOffset *)(y))->off)
+#define FLAGS_LOG_MIN 32
+
+static void flags_at_fini(void *e, void *user) {
+	r_list_free (((RFlagsAtOffset *)e)->flags);
+}
+
+static int flags_at_cmp(const void *va, const void *vb) {
+	const RFlagsAtOffset *a = va, *b = vb;
 	if (a->off == b->off) {
 		return 0;
 	}
 	return a->off < b->off? -1: 1;
 }
 
+static void flags_init(RFlag *f) {
+	r_vector_init (&f->by_off, sizeof (RFlagsAtOffset), flags_at_fini, NULL);
+	r_vector_init (&f->by_off_log, sizeof (RFlagsAtOffset), flags_at_fini, NULL);
+	f->by_off_log_sorted = 0;
+	f->by_off_pending = ht_up_new0 ();
+	f->by_off_holes = 0;
+}
+
+static void flags_fini(RFlag *f) {
+	r_vector_fini (&f->by_off);
+	r_vector_fini (&f->by_off_log);
+	ht_up_free (f->by_off_pending);
+	f->by_off_pending = NULL;
+}
+
+static void flags_at_move(RVector *dst, RFlagsAtOffset *fa) {
+	RFlagsAtOffset *last = dst->len? r_vector_index_ptr (dst, dst->len - 1): NULL;
+	if (r_list_empty (fa->flags)) {
+		r_list_free (fa->flags);
+	} else if (last && last->off == fa->off) {
+		// flags set in bulk at an offset which already had some
+		r_list_join (last->flags, fa->flags);
+		r_list_free (fa->flags);
+	} else {
+		r_vector_push (dst, fa);
+	}
+}
+
+/* merge the log into by_off and drop the offsets without flags */
+static void flags_sync(RFlag *f) {
+	if (f->iterating || (!f->by_off_log.len && f->by_off_holes * 4 <= f->by_off.len)) {
+		return;
+	}
+	RVector merged;
+	r_vector_init (&merged, sizeof (RFlagsAtOffset), flags_at_fini, NULL);
+	size_t n = f->by_off.len - f->by_off_holes + f->by_off_log.len;
+	if (n && !r_vector_reserve (&merged, n)) {
+		return;
+	}
+	if (f->by_off_log_sorted < f->by_off_log.len) {
+		qsort (f->by_off_log.a, f->by_off_log.len, f->by_off_log.elem_size, flags_at_cmp);
+	}
+	size_t i = 0, j = 0;
+	while (i < f->by_off.len || j < f->by_off_log.len) {
+		RFlagsAtOffset *a = i < f->by_off.len? r_vector_index_ptr (&f->by_off, i): NULL;
+		RFlagsAtOffset *b = j < f->by_off_log.len? r_vector_index_ptr (&f->by_off_log, j): NULL;
+		if (a && (!b || a->off <= b->off)) {
+			flags_at_move (&merged, a);
+			i++;
+		} else {
+			flags_at_move (&merged, b);
+			j++;
+		}
+	}
+	// the lists are owned by merged now
+	f->by_off.len = 0;
+	r_vector_fini (&f->by_off);
+	f->by_off = merged;
+	f->by_off_log.len = 0;
+	r_vector_clear (&f->by_off_log);
+	f->by_off_log_sorted = 0;
+	ht_up_free (f->by_off_pending);
+	f->by_off_pending = ht_up_new0 ();
+	f->by_off_holes = 0;
+}
+
+// index of the first of the len first entries of v at or after off
+static size_t flags_at_lower(RVector *v, size_t len, ut64 off) {
+	RVector head = *v;
+	size_t i;
+	head.len = len;
+	r_vector_lower_bound (&head, off, i, FLAGS_AT_CMP);
+	return i;
+}
+
+static RFlagsAtOffset *flags_at_find(RVector *v, size_t len, ut64 off) {
+	size_t i = flags_at_lower (v, len, off);
+	if (i < len) {
+		RFlagsAtOffset *fa = r_vector_index_ptr (v, i);
+		if (fa->off == off) {
+			return fa;
+		}
+	}
+	return NULL;
+}
+
+// nearest entry with flags among the len first ones of v, see r_flag_get_nearest_list
+static RFlagsAtOffset *flags_at_nearest(RVector *v, size_t len, ut64 off, int dir) {
+	RFlagsAtOffset *fa;
+	size_t i = flags_at_lower (v, len, off);
+	if (dir >= 0) {
+		for (; i < len; i++) {
+			fa = r_vector_index_ptr (v, i);
+			if (!r_list_empty (fa->flags)) {
+				return fa;
+			}
+		}
+		return NULL;
+	}
+	if (i < len && ((RFlagsAtOffset *)r_vector_index_ptr (v, i))->off == off) {
+		i++;
+	}
+	while (i-- > 0) {
+		fa = r_vector_index_ptr (v, i);
+		if (!r_list_empty (fa->flags)) {
+			return fa;
+		}
+	}
+	return NULL;
+}
+
+// whichever of res and fa is nearer to off, fa is skipped when it has no flags or is on the wrong side
+static RFlagsAtOffset *flags_at_nearer(RFlagsAtOffset *res, RFlagsAtOffset *fa, ut64 off, int dir) {
+	if (!fa || r_list_empty (fa->flags) || (dir >= 0? fa->off < off: fa->off > off)) {
+		return res;
+	}
+	return (!res || (dir >= 0? fa->off < res->off: fa->off > res->off))? fa: res;
+}
+
+static RFlagsAtOffset *flags_at_sorted(RFlag *f, ut64 off) {
+	return flags_at_find (&f->by_off, f->by_off.len, off);
+}
+
+static RFlagsAtOffset *flags_at_log(RFlag *f, ut64 off) {
+	RFlagsAtOffset *fa = flags_at_find (&f->by_off_log, f->by_off_log_sorted, off);
+	if (!fa && f->by_off_log_sorted < f->by_off_log.len) {
+		bool found = false;
+		size_t i = (size_t)ht_up_find (f->by_off_pending, off, &found);
+		fa = found? r_vector_index_ptr (&f->by_off_log, i - 1): NULL;
+	}
+	return fa;
+}
+
 static ut64 num_callback(RNum *user, const char *name, int *ok) {
 	RFlag *f = (RFlag *)user;
 	if (ok) {
@@ -79,44 +226,69 @@ static void free_item_name(RFlagItem *item) {
    dir == 0 ->  result == off
    dir == 1 ->  result >= off*/
 static RFlagsAtOffset *r_flag_get_nearest_list(RFlag *f, ut64 off, int dir) {
-	RFlagsAtOffset key = { .off = off };
-	RFlagsAtOffset *flags = (dir >= 0)
-		? r_skiplist_get_geq (f->by_off, &key)
-		: r_skiplist_get_leq (f->by_off, &key);
-	return (dir == 0 && flags && flags->off != off)? NULL: flags;
+	RFlagsAtOffset *res = flags_at_nearest (&f->by_off, f->by_off.len, off, dir);
+	res = flags_at_nearer (res, flags_at_nearest (&f->by_off_log, f->by_off_log_sorted, off, dir), off, dir);
+	size_t i;
+	// set in bulk or while iterating, not sorted yet
+	for (i = f->by_off_log_sorted; i < f->by_off_log.len; i++) {
+		res = flags_at_nearer (res, r_vector_index_ptr (&f->by_off_log, i), off, dir);
+	}
+	return (dir == 0 && res && res->off != off)? NULL: res;
 }
 
 static void remove_offsetmap(RFlag *f, RFlagItem *item) {
 	r_return_if_fail (f && item);
-	RFlagsAtOffset *flags = r_flag_get_nearest_list (f, item->offset, 0);
-	if (flags) {
-		r_list_delete_data (flags->flags, item);
-		if (r_list_empty (flags->flags)) {
-			r_skiplist_delete (f->by_off, flags);
+	RFlagsAtOffset *fa = flags_at_sorted (f, item->offset);
+	if (fa && r_list_delete_data (fa->flags, item)) {
+		if (r_list_empty (fa->flags)) {
+			f->by_off_holes++;
 		}
+		return;
+	}
+	fa = flags_at_log (f, item->offset);
+	if (fa) {
+		r_list_delete_data (fa->flags, item);
 	}
 }
 
-static RFlagsAtOffset *flags_at_offset(RFlag *f, ut64 off) {
-	RFlagsAtOffset *res = r_flag_get_nearest_list (f, off, 0);
-	if (res) {
-		return res;
+static bool add_offsetmap(RFlag *f, RFlagItem *item) {
+	// in bulk everything goes to the log, merging it sorts it all at once
+	RFlagsAtOffset *fa = f->bulk? NULL: flags_at_sorted (f, item->offset);
+	if (fa) {
+		if (r_list_empty (fa->flags)) {
+			f->by_off_holes--;
+		}
+		return r_list_append (fa->flags, item);
 	}
-
-	// there is no existing flagsAtOffset, we create one now
-	res = R_NEW (RFlagsAtOffset);
-	if (!res) {
-		return NULL;
+	fa = flags_at_log (f, item->offset);
+	if (fa) {
+		return r_list_append (fa->flags, item);
 	}
-
-	res->flags = r_list_new ();
-	if (!res->flags) {
-		free (res);
-		return NULL;
+	RFlagsAtOffset add = { .off = item->offset, .flags = r_list_new () };
+	if (!add.flags) {
+		return false;
+	}
+	const bool sorted = !f->bulk && !f->iterating;
+	if (sorted && f->by_off_log_sorted < f->by_off_log.len) {
+		flags_sync (f);
+	}
+	if (sorted) {
+		size_t i = flags_at_lower (&f->by_off_log, f->by_off_log.len, add.off);
+		if ((fa = r_vector_insert (&f->by_off_log, i, &add))) {
+			f->by_off_log_sorted++;
+		}
+	} else if ((fa = r_vector_push (&f->by_off_log, &add))) {
+		ht_up_insert (f->by_off_pending, add.off, (void *)(size_t)f->by_off_log.len);
+	}
+	if (!fa) {
+		r_list_free (add.flags);
+		return false;
+	}
+	bool res = r_list_append (fa->flags, item);
+	const size_t n = f->by_off_log.len;
+	if (sorted && n >= FLAGS_LOG_MIN && n * n > f->by_off.len) {
+		flags_sync (f);
 	}
-
-	res->off = off;
-	r_skiplist_insert (f->by_off, res);
 	return res;
 }
 
@@ -144,14 +316,7 @@ static bool update_flag_item_offset(RFlag *f, RFlagItem *item, ut64 newoff, bool
 			remove_offsetmap (f, item);
 		}
 		item->offset = newoff;
-
-		RFlagsAtOffset *flagsAtOffset = flags_at_offset (f, newoff);
-		if (!flagsAtOffset) {
-			return false;
-		}
-
-		r_list_append (flagsAtOffset->flags, item);
-		return true;
+		return add_offsetmap (f, item);
 	}
 
 	return false;
@@ -180,10 +345,26 @@ static bool update_flag_item_name(RFlag *f, RFlagItem *item, const char *newname
 }
 
 static void ht_free_flag(HtPPKv *kv) {
-	free (kv->key);
 	r_flag_item_free (kv->value);
 }
 
+// the keys are the names of the items, stored only once
+static HtPP *ht_name_new(RFlag *f) {
+	HtPPOptions opt = {
+		.cmp = (HtPPListComparator)strcmp,
+		.hashfn = (HtPPHashFunction)sdb_hash,
+		.dupkey = NULL,
+		.calcsizeK = (HtPPCalcSizeK)strlen,
+		.freefn = ht_free_flag,
+		.elem_size = sizeof (HtPPKv),
+	};
+	HtPP *ht = ht_pp_new_opt (&opt);
+	if (ht && f->concurrent) {
+		ht_pp_set_concurrent (ht, true);
+	}
+	return ht;
+}
+
 static bool count_flags(RFlagItem *fi, void *user) {
 	int *count = (int *)user;
 	(*count)++;
@@ -233,8 +414,8 @@ R_API RFlag *r_flag_new(void) {
 	f->zones = NULL;
 #endif
 	f->tags = sdb_new0 ();
-	f->ht_name = ht_pp_new (NULL, ht_free_flag, NULL);
-	f->by_off = r_skiplist_new (flag_skiplist_free, flag_skiplist_cmp);
+	f->ht_name = ht_name_new (f);
+	flags_init (f);
 #if R_FLAG_ZONE_USE_SDB
 	sdb_free (f->zones);
 #else
@@ -277,7 +458,7 @@ R_API void r_flag_item_free(RFlagItem *item) {
 
 R_API RFlag *r_flag_free(RFlag *f) {
 	r_return_val_if_fail (f, NULL);
-	r_skiplist_free (f->by_off);
+	flags_fini (f);
 	ht_pp_free (f->ht_name);
 	sdb_free (f->tags);
 	r_spaces_fini (&f->spaces);
@@ -287,6 +468,16 @@ R_API RFlag *r_flag_free(RFlag *f) {
 	return NULL;
 }
 
+// lets other threads look flags up by name while one of them adds or
+// removes flags, the offset index still needs the caller to serialize.
+// r_flag_unset and r_flag_unset_all free the items right away, so no other
+// thread may still be using an item that is being removed.
+R_API bool r_flag_set_concurrent(RFlag *f, bool enable) {
+	r_return_val_if_fail (f, false);
+	f->concurrent = enable;
+	return ht_pp_set_concurrent (f->ht_name, enable);
+}
+
 static bool print_flag_name(RFlagItem *fi, void *user) {
 	RFlag *flag = (RFlag *)user;
 	flag->cb_printf ("%s\n", fi->name);
@@ -717,38 +908,51 @@ R_API RFlagItem *r_flag_set_next(RFlag *f, const char *name, ut64 off, ut32 size
 R_API RFlagItem *r_flag_set(RFlag *f, const char *name, ut64 off, ut32 size) {
 	r_return_val_if_fail (f && name && *name, NULL);
 
-	bool is_new = false;
 	char *itemname = filter_item_name (name);
 	if (!itemname) {
 		return NULL;
 	}
 
 	RFlagItem *item = r_flag_get (f, itemname);
-	free (itemname);
-	if (item && item->offset == off) {
+	if (item) {
+		free (itemname);
+		if (item->offset != off) {
+			item->space = r_flag_space_cur (f);
+			update_flag_item_offset (f, item, off + f->base, false, true);
+		}
 		item->size = size;
 		return item;
 	}
 
-	if (!item) {
-		item = R_NEW0 (RFlagItem);
-		if (!item) {
-			goto err;
-		}
-		is_new = true;
+	item = R_NEW0 (RFlagItem);
+	if (!item || !ht_pp_insert (f->ht_name, itemname, item)) {
+		goto err;
 	}
-
+	set_name (item, itemname);
 	item->space = r_flag_space_cur (f);
 	item->size = size;
-
-	update_flag_item_offset (f, item, off + f->base, is_new, true);
-	update_flag_item_name (f, item, name, true);
+	update_flag_item_offset (f, item, off + f->base, true, true);
 	return item;
 err:
-	r_flag_item_free (item);
+	free (itemname);
+	free (item);
 	return NULL;
 }
 
+/* flags set between r_flag_bulk_begin and r_flag_bulk_end are indexed by
+ * offset all at once, the calls can be nested */
+R_API void r_flag_bulk_begin(RFlag *f) {
+	r_return_if_fail (f);
+	f->bulk++;
+}
+
+R_API void r_flag_bulk_end(RFlag *f) {
+	r_return_if_fail (f && f->bulk > 0);
+	if (!--f->bulk && !f->iterating) {
+		flags_sync (f);
+	}
+}
+
 /* add/replace/remove the alias of a flag item */
 R_API void r_flag_item_set_alias(RFlagItem *item, const char *alias) {
 	r_return_if_fail (item);
@@ -788,7 +992,8 @@ R_API int r_flag_rename(RFlag *f, RFlagItem *item, const char *name) {
 /* unset the given flag item.
  * returns true if the item is successfully unset, false otherwise.
  *
- * NOTE: the item is freed. */
+ * NOTE: the item is freed, even if other threads got it from a
+ * concurrent r_flag_get. */
 R_API bool r_flag_unset(RFlag *f, RFlagItem *item) {
 	r_return_val_if_fail (f && item, false);
 	remove_offsetmap (f, item);
@@ -844,9 +1049,10 @@ R_API bool r_flag_unset_name(RFlag *f, const char *name) {
 /* unset all flag items in the RFlag f */
 R_API void r_flag_unset_all(RFlag *f) {
 	r_return_if_fail (f);
+	flags_fini (f);
 	ht_pp_free (f->ht_name);
-	f->ht_name = ht_pp_new (NULL, ht_free_flag, NULL);
-	r_skiplist_purge (f->by_off);
+	f->ht_name = ht_name_new (f);
+	flags_init (f);
 	r_spaces_fini (&f->spaces);
 	new_spaces (f);
 }
@@ -928,23 +1134,56 @@ R_API int r_flag_count(RFlag *f, const char *glob) {
 	return count;
 }
 
-#define FOREACH_BODY(condition) \
-	RSkipListNode *it, *tmp; \
-	RFlagsAtOffset *flags_at; \
-	RListIter *it2, *tmp2;	  \
+// iterates the flags at offsets from..last, both included, merging by_off
+// with the sorted part of the log. The unsorted part comes last, new offsets
+// the callbacks set go there and are not visited
+#define FOREACH_RANGE(from, last, condition) \
+	RListIter *it, *tmp; \
 	RFlagItem *fi; \
-	r_skiplist_foreach_safe (f->by_off, it, tmp, flags_at) { \
-		if (flags_at) { \
-			r_list_foreach_safe (flags_at->flags, it2, tmp2, fi) {	\
-				if (condition) { \
-					if (!cb (fi, user)) { \
-						return; \
-					} \
-				} \
+	RFlagsAtOffset *flags_at, *a, *b; \
+	const size_t nsorted = f->by_off_log_sorted, nlog = f->by_off_log.len; \
+	size_t i = flags_at_lower (&f->by_off, f->by_off.len, (ut64)(from)); \
+	size_t j = flags_at_lower (&f->by_off_log, nsorted, (ut64)(from)); \
+	f->iterating++; \
+	for (;;) { \
+		a = i < f->by_off.len? r_vector_index_ptr (&f->by_off, i): NULL; \
+		b = j < nsorted? r_vector_index_ptr (&f->by_off_log, j): NULL; \
+		if (a && (!b || a->off <= b->off)) { \
+			flags_at = a; \
+			i++; \
+		} else if (b) { \
+			flags_at = b; \
+			j++; \
+		} else { \
+			break; \
+		} \
+		if (flags_at->off > (last)) { \
+			break; \
+		} \
+		r_list_foreach_safe (flags_at->flags, it, tmp, fi) { \
+			if ((condition) && !cb (fi, user)) { \
+				goto beach; \
 			} \
 		} \
+	} \
+	for (j = nsorted; j < nlog; j++) { \
+		flags_at = r_vector_index_ptr (&f->by_off_log, j); \
+		if (flags_at->off < (ut64)(from) || flags_at->off > (last)) { \
+			continue; \
+		} \
+		r_list_foreach_safe (flags_at->flags, it, tmp, fi) { \
+			if ((condition) && !cb (fi, user)) { \
+				goto beach; \
+			} \
+		} \
+	} \
+beach: \
+	if (!--f->iterating && !f->bulk && f->by_off_log_sorted < f->by_off_log.len) { \
+		flags_sync (f); \
 	}
 
+#define FOREACH_BODY(condition) FOREACH_RANGE (0, UT64_MAX, condition)
+
 R_API void r_flag_foreach(RFlag *f, RFlagItemCb cb, void *user) {
 	FOREACH_BODY (true);
 }
@@ -955,7 +1194,9 @@ R_API void r_flag_foreach_prefix(RFlag *f, const char *pfx, int pfx_len, RFlagIt
 }
 
 R_API void r_flag_foreach_range(RFlag *f, ut64 from, ut64 to, RFlagItemCb cb, void *user) {
-	FOREACH_BODY (fi->offset >= from && fi->offset < to);
+	if (to > from) {
+		FOREACH_RANGE (from, to - 1, fi->offset >= from && fi->offset < to);
+	}
 }
 
 R_API void r_flag_foreach_glob(RFlag *f, const char *glob, RFlagItemCb cb, void *user) {
@@ -963,7 +1204,7 @@ R_API void r_flag_foreach_glob(RFlag *f, const char *glob, RFlagItemCb cb, void
 }
 
 R_API void r_flag_foreach_space_glob(RFlag *f, const char *glob, const RSpace *space, RFlagItemCb cb, void *user) {
-        FOREACH_BODY (IS_FI_IN_SPACE (fi, space) && (!glob || r_str_glob (fi->name, glob)));
+	FOREACH_BODY (IS_FI_IN_SPACE (fi, space) && (!glob || r_str_glob (fi->name, glob)));
 }
 
 R_API void r_flag_foreach_space(RFlag *f, const RSpace *space, RFlagItemCb cb, void *user) {
@@ -4,6 +4,7 @@
 #include <r_types.h>
 #include <r_cons.h>
 #include <r_util/r_graph.h>
+#include <ht_uu.h>
 
 typedef struct r_ascii_node_t {
 	RGraphNode *gnode;
@@ -86,9 +87,14 @@ typedef struct r_ascii_graph_t {
 	RList *long_edges;
 	struct layer_t *layers;
 	int n_layers;
-	RList *dists; /* RList<struct dist_t> */
+	HtUU *dists; /* (from->idx << 32 | to->idx) => distance */
 	RList *edges; /* RList<AEdge> */
 	RAGraphHits ghits;
+
+	/* last computed layout, reused while the graph does not change */
+	ut64 layout_sig;
+	int *layout_cache; /* pos_in_layer and x of each node */
+	int layout_cache_len;
 } RAGraph;
 
 #ifdef R_API
@@ -106,6 +112,7 @@ R_API void r_agraph_add_edge_at(const RAGraph *g, RANode *a, RANode *b, int nth)
 R_API void r_agraph_del_edge(const RAGraph *g, RANode *a, RANode *b);
 R_API void r_agraph_print(RAGraph *g);
 R_API void r_agraph_print_json(RAGraph *g, PJ *pj);
+R_API void r_agraph_layout(RAGraph *g);
 R_API Sdb *r_agraph_get_sdb(RAGraph *g);
 R_API void r_agraph_foreach(RAGraph *g, RANodeCallback cb, void *user);
 R_API void r_agraph_foreach_edge(RAGraph *g, RAEdgeCallback cb, void *user);
@@ -308,6 +308,7 @@ typedef struct r_anal_function_t {
 	bool has_changed; // true if function may have changed since last anaysis TODO: set this attribute where necessary
 	bool bp_frame;
 	bool is_noreturn; // true if function does not return
+	ut64 tp_key; // inputs of the last type propagation (aaft), 0 if it never ran
 	ut8 *fingerprint; // TODO: make is fuzzy and smarter
 	size_t fingerprint_size;
 	RAnalDiff *diff;
@@ -352,7 +353,7 @@ typedef enum {
 typedef struct r_anal_meta_item_t {
 	RAnalMetaType type;
 	int subtype;
-	char *str;
+	char *str; // comments are interned in anal->constpool
 	const RSpace *space;
 } RAnalMetaItem;
 
@@ -613,6 +614,66 @@ typedef struct r_anal_hint_cb_t {
 	void (*on_bits) (struct r_anal_t *a, ut64 addr, int bits, bool set);
 } RHintCb;
 
+typedef struct r_anal_block_index_entry_t {
+	ut64 addr;
+	ut64 end;
+	ut64 max_end; // max end of all entries up to this one, monotonic
+	struct r_anal_bb_t *block;
+} RAnalBlockIndexEntry;
+
+// flat copy of bb_tree sorted by address, rebuilt lazily for read-heavy phases
+typedef struct r_anal_block_index_t {
+	RAnalBlockIndexEntry *entries;
+	size_t count;
+	size_t capacity;
+	ut64 epoch; // value of RAnal.bb_epoch when built
+	ut64 stale_queries; // lookups served by bb_tree since the last mutation
+} RAnalBlockIndex;
+
+typedef enum {
+	R_ANAL_DIRTY_WRITE, // bytes written to io
+	R_ANAL_DIRTY_HINT, // hints changed
+	R_ANAL_DIRTY_CALLEE, // a called function changed its noreturn attribute
+} RAnalDirtyReason;
+
+// a change that invalidated analyzed basic blocks, see dirty.c
+typedef struct r_anal_dirty_t {
+	ut64 addr;
+	ut64 size;
+	RAnalDirtyReason reason;
+} RAnalDirty;
+
+// lookups in sdb_types, see type.c
+typedef struct r_anal_type_cache_t {
+	HtPP *types; // compiled base types by name
+	HtPP *bitsizes; // r_type_get_bitsize () by type
+	HtPP *membs; // r_type_get_struct_memb () by "offset:type"
+	ut32 count; // keys in sdb_types when bitsizes and membs were filled
+} RAnalTypeCache;
+
+// bounded cache of decoded instructions, see opcache.c
+typedef struct r_anal_op_cache_t {
+	HtUP *ht; // addr => entries decoded at that address
+	void **ring; // entries in insertion order, the oldest one is evicted
+	size_t size;
+	size_t pos;
+	ut64 epoch; // bumped when the decoder state changes
+	// decoder state of the current epoch
+	const void *cur;
+	int bits;
+	int big_endian;
+	int pcalign;
+	char *cpu;
+	ut64 reg_epoch;
+	bool reads; // an op of this epoch was decoded reading memory
+	bool read; // set by read_at while decoding
+	bool (*read_at)(struct r_anal_t *anal, ut64 addr, ut8 *buf, int len); // of the anal while decoding
+	ut64 hits;
+	ut64 misses;
+	ut64 text_hits;
+	ut64 text_misses;
+} RAnalOpCache;
+
 typedef struct r_anal_t {
 	char *cpu;      // anal.cpu
 	char *os;       // asm.os
@@ -624,9 +685,20 @@ typedef struct r_anal_t {
 	void *user;
 	ut64 gp;        // anal.gp, global pointer. used for mips. but can be used by other arches too in the future
 	RBTree bb_tree; // all basic blocks by address. They can overlap each other, but must never start at the same address.
+	ut64 bb_epoch; // bumped on every change to bb_tree
+	ut64 hint_epoch; // bumped on every change to the hints
+	RAnalOpCache *opcache; // anal.opcache
+	RVector dirty; // RAnalDirty, changes that invalidated blocks since the last update
+	int dirty_lock; // changes made by the analysis itself do not invalidate anything
+	RAnalBlockIndex bb_index;
+	RMemoryPool *block_pool; // RAnalBlock
+	RMemoryPool *fcn_pool; // RAnalFunction
+	RMemoryPool *ref_pool; // RAnalRef stored in dict_refs/dict_xrefs
+	RThreadLock *ref_lock; // guards ref_pool while concurrent
 	RList *fcns;
 	HtUP *ht_addr_fun; // address => function
 	HtPP *ht_name_fun; // name => function
+	bool concurrent; // the hashtables of RAnal can be used from several threads, see r_anal_set_concurrent
 	RReg *reg;
 	ut8 *last_disasm_reg;
 	RSyscall *syscall;
@@ -648,6 +720,7 @@ typedef struct r_anal_t {
 	RAnalRange *limit; // anal.from, anal.to
 	RList *plugins;
 	Sdb *sdb_types;
+	RAnalTypeCache type_cache; // see type.c
 	Sdb *sdb_fmts;
 	Sdb *sdb_zigns;
 	HtUP *dict_refs;
@@ -665,6 +738,8 @@ typedef struct r_anal_t {
 	RBTree/*<RAnalArchBitsRecord>*/ bits_hints;
 	RHintCb hint_cbs;
 	RIntervalTree meta;
+	RVector meta_bulk; // items set since r_meta_bulk_begin, not in meta yet
+	int meta_bulk_depth;
 	RSpaces meta_spaces;
 	Sdb *sdb_fcnsign; // OK
 	Sdb *sdb_cc; // calling conventions
@@ -785,12 +860,12 @@ typedef struct r_anal_var_access_t {
 // generic for args and locals
 typedef struct r_anal_var_t {
 	RAnalFunction *fcn;
-	char *name; // name of the variable
-	char *type; // cparse type of the variable
+	const char *name; // name of the variable, interned in anal->constpool
+	const char *type; // cparse type of the variable, interned in anal->constpool
 	RAnalVarKind kind;
 	bool isarg;
 	int delta;   /* delta offset inside stack frame */
-	char *regname; // name of the register
+	const char *regname; // name of the register, interned in anal->constpool
 	RVector/*<RAnalVarAccess>*/ accesses; // ordered by offset, touch this only through API or expect uaf
 	char *comment;
 
@@ -908,6 +983,7 @@ typedef struct r_anal_bb_t {
 	ut64 fail;
 	bool traced;
 	bool folded;
+	bool dirty; // code or hints changed since it was analyzed, see dirty.c
 	ut32 colorize;
 	ut8 *fingerprint;
 	RAnalDiff *diff;
@@ -1131,6 +1207,32 @@ typedef struct r_anal_esil_callbacks_t {
 	int (*reg_write)(ESIL *esil, const char *name, ut64 val);
 } RAnalEsilCallbacks;
 
+typedef struct r_anal_esil_trace_reg_t {
+	int reg; // index in RAnalEsilTrace.regs
+	ut64 value;
+} RAnalEsilTraceReg;
+
+typedef struct r_anal_esil_trace_mem_t {
+	ut64 addr;
+	ut8 *data;
+	int len;
+} RAnalEsilTraceMem;
+
+typedef struct r_anal_esil_trace_step_t {
+	ut64 addr;
+	RVector reg_read; // RAnalEsilTraceReg
+	RVector reg_write; // RAnalEsilTraceReg
+	RVector mem_read; // RAnalEsilTraceMem
+	RVector mem_write; // RAnalEsilTraceMem
+} RAnalEsilTraceStep;
+
+typedef struct r_anal_esil_trace_t {
+	int idx; // trace_idx of the first step
+	RVector steps; // RAnalEsilTraceStep
+	RPVector regs; // interned register names
+	HtPP *reg_ids; // name => index in regs + 1
+} RAnalEsilTrace;
+
 typedef struct r_anal_esil_t {
 	RAnal *anal;
 	char **stack;
@@ -1168,7 +1270,7 @@ typedef struct r_anal_esil_t {
 	RAnalEsilInterrupt *intr0;
 	/* deep esil parsing fills this */
 	Sdb *stats;
-	Sdb *db_trace;
+	RAnalEsilTrace *trace;
 	int trace_idx;
 	RAnalEsilCallbacks cb;
 	RAnalReil *Reil;
@@ -1269,6 +1371,7 @@ typedef int (*RAnalCmdExt)(/* Rcore */RAnal *anal, const char* input);
 
 // TODO: rm data + len
 typedef int (*RAnalOpCallback)(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *data, int len, RAnalOpMask mask);
+typedef int (*RAnalOpBatchCallback)(RAnal *a, RAnalOp *ops, int n, ut64 addr, const ut8 *data, int len, RAnalOpMask mask);
 
 typedef bool (*RAnalRegProfCallback)(RAnal *a);
 typedef char*(*RAnalRegProfGetCallback)(RAnal *a);
@@ -1301,6 +1404,7 @@ typedef struct r_anal_plugin_t {
 
 	// legacy r_anal_functions
 	RAnalOpCallback op;
+	RAnalOpBatchCallback op_batch; // optional, see r_anal_op_batch
 
 	// command extension to directly call any analysis functions
 	RAnalCmdExt cmd_ext;
@@ -1498,6 +1602,7 @@ R_API bool r_anal_function_contains(RAnalFunction *fcn, ut64 addr);
 R_API RAnal *r_anal_new(void);
 R_API int r_anal_purge (RAnal *anal);
 R_API RAnal *r_anal_free(RAnal *r);
+R_API bool r_anal_set_concurrent(RAnal *anal, bool enable);
 R_API void r_anal_set_user_ptr(RAnal *anal, void *user);
 R_API void r_anal_plugin_free (RAnalPlugin *p);
 R_API int r_anal_add(RAnal *anal, RAnalPlugin *foo);
@@ -1539,13 +1644,39 @@ R_API int r_anal_op_reg_delta(RAnal *anal, ut64 addr, const char *name);
 R_API bool r_anal_op_is_eob(RAnalOp *op);
 R_API RList *r_anal_op_list_new(void);
 R_API int r_anal_op(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int len, RAnalOpMask mask);
+R_API int r_anal_op_batch(RAnal *anal, RAnalOp *ops, int n, ut64 addr, const ut8 *data, int len, RAnalOpMask mask);
 R_API RAnalOp *r_anal_op_hexstr(RAnal *anal, ut64 addr, const char *hexstr);
 R_API char *r_anal_op_to_string(RAnal *anal, RAnalOp *op);
 
+/* dirty.c */
+R_API bool r_anal_invalidate(RAnal *anal, ut64 addr, ut64 size, RAnalDirtyReason reason);
+R_API RList *r_anal_dirty_functions(RAnal *anal);
+R_API void r_anal_dirty_clear(RAnal *anal);
+R_API const char *r_anal_dirty_reason_tostring(RAnalDirtyReason reason);
+
+/* opcache.c */
+R_API RAnalOpCache *r_anal_opcache_new(size_t size);
+R_API void r_anal_opcache_free(RAnalOpCache *c);
+R_API void r_anal_opcache_clear(RAnalOpCache *c);
+R_API bool r_anal_opcache_get(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int len, int mask, int *ret);
+R_API void r_anal_opcache_set(RAnal *anal, const RAnalOp *op, ut64 addr, const ut8 *data, int len, int mask, int ret);
+R_API const char *r_anal_opcache_get_text(RAnal *anal, ut64 addr, ut64 state, const ut8 *data, int len, int *size, int *payload, int *ret);
+R_API void r_anal_opcache_set_text(RAnal *anal, ut64 addr, ut64 state, const ut8 *data, int size, int payload, const char *text, int ret);
+R_API void r_anal_opcache_invalidate(RAnal *anal, ut64 addr, ut64 size, RAnalDirtyReason reason);
+
 R_API RAnalEsil *r_anal_esil_new(int stacksize, int iotrap, unsigned int addrsize);
 R_API void r_anal_esil_trace(RAnalEsil *esil, RAnalOp *op);
 R_API void r_anal_esil_trace_list(RAnalEsil *esil);
 R_API void r_anal_esil_trace_show(RAnalEsil *esil, int idx);
+R_API RAnalEsilTrace *r_anal_esil_trace_new(void);
+R_API void r_anal_esil_trace_free(RAnalEsilTrace *trace);
+R_API void r_anal_esil_trace_reset(RAnalEsilTrace *trace);
+R_API int r_anal_esil_trace_last(RAnalEsilTrace *trace);
+R_API RAnalEsilTraceStep *r_anal_esil_trace_step(RAnalEsilTrace *trace, int idx);
+R_API int r_anal_esil_trace_reg_id(RAnalEsilTrace *trace, const char *name);
+R_API bool r_anal_esil_trace_reg_read(RAnalEsilTrace *trace, int idx, const char *name, ut64 *value);
+R_API bool r_anal_esil_trace_reg_write(RAnalEsilTrace *trace, int idx, const char *name, ut64 *value);
+R_API Sdb *r_anal_esil_trace_sdb(RAnalEsilTrace *trace);
 R_API bool r_anal_esil_set_pc(RAnalEsil *esil, ut64 addr);
 R_API bool r_anal_esil_setup(RAnalEsil *esil, RAnal *anal, int romem, int stats, int nonull);
 R_API void r_anal_esil_free(RAnalEsil *esil);
@@ -1646,6 +1777,7 @@ R_API const char *r_anal_xrefs_type_tostring(RAnalRefType type);
 R_API RAnalRefType r_anal_xrefs_type(char ch);
 R_API RList *r_anal_xrefs_get(RAnal *anal, ut64 to);
 R_API RList *r_anal_refs_get(RAnal *anal, ut64 to);
+R_API void r_anal_refs_del(RAnal *anal, ut64 from);
 R_API RList *r_anal_xrefs_get_from(RAnal *anal, ut64 from);
 R_API void r_anal_xrefs_list(RAnal *anal, int rad);
 R_API RList *r_anal_function_get_refs(RAnalFunction *fcn);
@@ -1823,6 +1955,12 @@ R_API bool r_meta_set(RAnal *a, RAnalMetaType type, ut64 addr, ut64 size, const
 // Same as r_meta_set() but also sets the subtype.
 R_API bool r_meta_set_with_subtype(RAnal *m, RAnalMetaType type, int subtype, ut64 addr, ut64 size, const char *str);
 
+// Items set between r_meta_bulk_begin() and r_meta_bulk_end() are queued and go into the
+// tree all at once when the outermost bulk ends, they are not visible to any query before.
+// Meant for importing lots of items, like the strings of a binary.
+R_API void r_meta_bulk_begin(RAnal *a);
+R_API void r_meta_bulk_end(RAnal *a);
+
 // Delete all meta items in the current space that intersect with the given interval.
 // If size == UT64_MAX, everything in the current space will be deleted.
 R_API void r_meta_del(RAnal *a, RAnalMetaType type, ut64 addr, ut64 size);
@@ -2092,7 +2230,13 @@ R_API RStrBuf *r_anal_esil_dfg_filter(RAnalEsilDFG *dfg, const char *reg);
 R_API RStrBuf *r_anal_esil_dfg_filter_expr(RAnal *anal, const char *expr, const char *reg);
 R_API RList *r_anal_types_from_fcn(RAnal *anal, RAnalFunction *fcn);
 
+/* cached, see type.c */
+R_API ut64 r_anal_type_get_bitsize(RAnal *anal, const char *type);
+R_API char *r_anal_type_get_struct_memb(RAnal *anal, const char *type, int offset);
+R_API RList *r_anal_type_get_by_offset(RAnal *anal, ut64 offset);
 R_API RAnalBaseType *r_anal_get_base_type(RAnal *anal, const char *name);
+R_API const RAnalBaseType *r_anal_base_type_get(RAnal *anal, const char *name);
+R_API bool r_anal_base_type_member_offset(RAnal *anal, const char *type, const char *member, ut64 *offset);
 R_API void r_parse_pdb_types(const RAnal *anal, const RPdb *pdb);
 R_API void r_anal_save_base_type(const RAnal *anal, const RAnalBaseType *type);
 R_API void r_anal_free_base_type(RAnalBaseType *type);
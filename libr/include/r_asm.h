@@ -135,6 +135,7 @@ typedef struct r_asm_plugin_t {
 	bool (*init)(void *user);
 	bool (*fini)(void *user);
 	int (*disassemble)(RAsm *a, RAsmOp *op, const ut8 *buf, int len);
+	int (*disassemble_batch)(RAsm *a, RAsmOp *ops, int n, const ut8 *buf, int len); // optional, see r_asm_disassemble_batch
 	int (*assemble)(RAsm *a, RAsmOp *op, const char *buf);
 	RAsmModifyCallback modify;
 	char *(*mnemonics)(RAsm *a, int id, bool json);
@@ -162,6 +163,7 @@ R_API bool r_asm_set_syntax(RAsm *a, int syntax);
 R_API int r_asm_syntax_from_string(const char *name);
 R_API int r_asm_set_pc(RAsm *a, ut64 pc);
 R_API int r_asm_disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len);
+R_API int r_asm_disassemble_batch(RAsm *a, RAsmOp *ops, int n, const ut8 *buf, int len);
 R_API int r_asm_assemble(RAsm *a, RAsmOp *op, const char *buf);
 R_API RAsmCode* r_asm_mdisassemble(RAsm *a, const ut8 *buf, int len);
 R_API RAsmCode* r_asm_mdisassemble_hexstr(RAsm *a, RParse *p, const char *hexstr);
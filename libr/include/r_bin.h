@@ -256,6 +256,7 @@ typedef struct r_bin_object_t {
 	RList/*<RBinClass>*/ *classes;
 	HtPP *classes_ht;
 	HtPP *methods_ht;
+	HtPP *demangled; // "type.mangled" -> demangled name cache
 	RList/*<RBinDwarfRow>*/ *lines;
 	HtUP *strings_db;
 	RList/*<??>*/ *mem;	//RBinMem maybe?
@@ -330,6 +331,9 @@ struct r_bin_t {
 	char *force;
 	int is_debugger;
 	bool want_dbginfo;
+	int dbginfo_threads; // threads used to parse .debug_info
+	ut64 dbginfo_from; // only parse the dwarf units covering this range
+	ut64 dbginfo_to;
 	int filter; // symbol filtering
 	char strfilter; // string filtering
 	char *strpurge; // purge false positive strings
@@ -338,6 +342,7 @@ struct r_bin_t {
 	char *strenc;
 	ut64 filter_rules;
 	bool demanglercmd;
+	int demangle_threads; // threads used to demangle the initial symbols
 	bool verbose;
 	bool use_xtr; // use extract plugins when loading a file?
 	bool use_ldr; // use loader plugins when loading a file?
@@ -783,6 +788,7 @@ R_API void r_bin_mem_free(void *data);
 
 // demangle functions
 R_API char *r_bin_demangle(RBinFile *binfile, const char *lang, const char *str, ut64 vaddr, bool libs);
+R_API int r_bin_demangle_batch(RBinFile *bf, const char *lang, RList *symbols, int threads);
 R_API char *r_bin_demangle_java(const char *str);
 R_API char *r_bin_demangle_cxx(RBinFile *binfile, const char *str, ut64 vaddr);
 R_API char *r_bin_demangle_msvc(const char *str);
@@ -61,6 +61,9 @@ typedef struct r_bp_item_t {
 	char *data;
 	char *cond; /* used for conditional breakpoints */
 	char *expr; /* to be used for named breakpoints (see r_debug_bp_update) */
+	bool coverage; /* one-shot: record the hit in bp->cov_hits, remove and continue */
+	int cov_idx; /* index in bp->cov_addrs */
+	int idx; /* slot in bp->bps_idx */
 } RBreakpointItem;
 
 struct r_bp_t;
@@ -85,8 +88,14 @@ typedef struct r_bp_t {
 	RList *bps; // list of breakpoints
 	RBreakpointItem **bps_idx;
 	int bps_idx_count;
+	int bps_idx_free; // no free slot in bps_idx below this one
+	HtUP *bps_at; // addr => first RBreakpointItem at that exact addr
+	RIntervalTree bps_in; // [addr, addr + size) => RBreakpointItem
 	st64 delta;
 	ut64 baddr;
+	/* coverage breakpoints */
+	RVector cov_addrs; // ut64 address of every coverage breakpoint ever added
+	RBitmap *cov_hits; // bit n is set once cov_addrs[n] was hit
 } RBreakpoint;
 
 // DEPRECATED: USE R_PERM
@@ -136,8 +145,10 @@ R_API int r_bp_del_index(RBreakpoint *bp, int idx);
 R_API RBreakpointItem *r_bp_get_index(RBreakpoint *bp, int idx);
 R_API int r_bp_get_index_at (RBreakpoint *bp, ut64 addr);
 R_API RBreakpointItem *r_bp_item_new (RBreakpoint *bp);
+R_IPI void r_bp_item_link(RBreakpoint *bp, RBreakpointItem *b);
 
 R_API RBreakpointItem *r_bp_get_at (RBreakpoint *bp, ut64 addr);
+R_API void r_bp_item_relocate(RBreakpoint *bp, RBreakpointItem *b, ut64 addr);
 R_API RBreakpointItem *r_bp_get_in (RBreakpoint *bp, ut64 addr, int perm);
 
 R_API bool r_bp_is_valid(RBreakpoint *bp, RBreakpointItem *b);
@@ -148,6 +159,12 @@ R_API int r_bp_add_fault(RBreakpoint *bp, ut64 addr, int size, int perm);
 
 R_API RBreakpointItem *r_bp_add_sw(RBreakpoint *bp, ut64 addr, int size, int perm);
 R_API RBreakpointItem *r_bp_add_hw(RBreakpoint *bp, ut64 addr, int size, int perm);
+
+/* coverage */
+R_API int r_bp_add_coverage(RBreakpoint *bp, const ut64 *addrs, int count);
+R_API bool r_bp_coverage_hit(RBreakpoint *bp, RBreakpointItem *b);
+R_API int r_bp_del_coverage(RBreakpoint *bp);
+R_API int r_bp_coverage_list(RBreakpoint *bp, int rad);
 R_API void r_bp_restore_one(RBreakpoint *bp, RBreakpointItem *b, bool set);
 R_API int r_bp_restore(RBreakpoint *bp, bool set);
 R_API bool r_bp_restore_except(RBreakpoint *bp, bool set, ut64 addr);
@@ -225,6 +225,9 @@ typedef struct {
 
 R_API void r_core_gadget_free (RCoreGadget *g);
 
+/* command parsed once by r_core_cmd_prepare, see r_core_cmd_prepared_call */
+typedef struct r_core_cmd_prepared_t RCoreCmdPrepared;
+
 typedef struct r_core_tasks_t {
 	int task_id_next;
 	RList *tasks;
@@ -236,6 +239,13 @@ typedef struct r_core_tasks_t {
 	RThreadLock *lock;
 	int tasks_running;
 	bool oneshot_running;
+	int waiting_prio; // priority of the head of tasks_queue, -1 if empty
+	int slice; // ms a task may run before yielding to a higher priority one, 0 disables preemption
+	ut64 slice_start;
+	R_TH_TID current_tid;
+	int unsafe; // tasks suspended in the middle of a command
+	int writer_waiting;
+	bool block_parked; // core->block still belongs to a switched out task
 } RCoreTaskScheduler;
 
 typedef struct r_core_t {
@@ -403,6 +413,11 @@ R_API void r_core_prompt_loop(RCore *core);
 R_API ut64 r_core_pava(RCore *core, ut64 addr);
 R_API int r_core_cmd(RCore *core, const char *cmd, int log);
 R_API int r_core_cmd_task_sync(RCore *core, const char *cmd, bool log);
+R_API RCoreCmdPrepared *r_core_cmd_prepare(RCore *core, const char *cmd);
+R_API int r_core_cmd_prepared_call(RCore *core, RCoreCmdPrepared *pc);
+R_API int r_core_cmd_prepared_at(RCore *core, RCoreCmdPrepared *pc, ut64 addr);
+R_API void r_core_cmd_prepared_free(RCoreCmdPrepared *pc);
+R_API bool r_core_cmd_is_readonly(const char *cmd);
 R_API char *r_core_editor(const RCore *core, const char *file, const char *str);
 R_API int r_core_fgets(char *buf, int len);
 R_API RFlagItem *r_core_flag_get_by_spaces(RFlag *f, ut64 off);
@@ -605,6 +620,7 @@ R_API char *r_core_anal_fcn_name(RCore *core, RAnalFunction *fcn);
 R_API ut64 r_core_anal_fcn_list_size(RCore *core);
 R_API void r_core_anal_fcn_labels(RCore *core, RAnalFunction *fcn, int rad);
 R_API int r_core_anal_fcn_clean(RCore *core, ut64 addr);
+R_API int r_core_anal_update(RCore *core);
 R_API int r_core_print_bb_custom(RCore *core, RAnalFunction *fcn);
 R_API int r_core_print_bb_gml(RCore *core, RAnalFunction *fcn);
 R_API int r_core_anal_graph(RCore *core, ut64 addr, int opts);
@@ -617,6 +633,7 @@ R_API RList *r_core_anal_fcn_get_calls (RCore *core, RAnalFunction *fcn); // get
 
 /*tp.c*/
 R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn);
+R_API ut64 r_core_anal_type_match_key(RCore *core, RAnalFunction *fcn);
 R_API RStrBuf *var_get_constraint(RAnal *a, RAnalFunction *fcn, RAnalVar *var);
 
 /* asm.c */
@@ -637,6 +654,8 @@ R_API RCoreAsmHit *r_core_asm_hit_new(void);
 R_API RList *r_core_asm_hit_list_new(void);
 R_API void r_core_asm_hit_free(void *_hit);
 R_API void r_core_set_asm_configs(RCore *core, char *arch, ut32 bits, int segoff);
+R_API int r_core_asm_disassemble(RCore *core, RAsmOp *op, const ut8 *buf, int len);
+R_API int r_core_asm_prefetch(RCore *core, ut64 addr, const ut8 *buf, int len, int n);
 R_API char* r_core_asm_search(RCore *core, const char *input);
 R_API RList *r_core_asm_strsearch(RCore *core, const char *input, ut64 from, ut64 to, int maxhits, int regexp, int everyByte, int mode);
 R_API RList *r_core_asm_bwdisassemble (RCore *core, ut64 addr, int n, int len);
@@ -759,6 +778,7 @@ R_API void r_core_rtr_session(RCore *core, const char *input);
 R_API void r_core_rtr_cmd(RCore *core, const char *input);
 R_API int r_core_rtr_http(RCore *core, int launch, int browse, const char *path);
 R_API int r_core_rtr_http_stop(RCore *u);
+R_API int r_core_rtr_http_bench(RCore *core, const char *input);
 R_API int r_core_rtr_gdb(RCore *core, int launch, const char *path);
 
 R_API int r_core_visual_prevopsz(RCore *core, ut64 addr);
@@ -883,8 +903,17 @@ typedef struct r_core_task_t {
 	bool cmd_log;
 	RConsContext *cons_context;
 	RCoreTaskCallback cb;
+	int priority;
+	bool preempted;
+	bool offset_saved;
+	ut64 offset;
+	ut8 *block; // own core->block while switched out
+	ut32 blocksize;
 } RCoreTask;
 
+#define R_CORE_TASK_PRIORITY_DEFAULT 0
+#define R_CORE_TASK_PRIORITY_INTERACTIVE 10
+
 typedef void (*RCoreTaskOneShot)(void *);
 
 R_API void r_core_echo(RCore *core, const char *msg);
@@ -907,6 +936,8 @@ R_API int r_core_task_run_sync(RCoreTaskScheduler *scheduler, RCoreTask *task);
 R_API void r_core_task_sync_begin(RCoreTaskScheduler *scheduler);
 R_API void r_core_task_sync_end(RCoreTaskScheduler *scheduler);
 R_API void r_core_task_yield(RCoreTaskScheduler *scheduler);
+R_API void r_core_task_preempt(RCoreTaskScheduler *scheduler);
+R_API void r_core_task_wait_safe(RCoreTaskScheduler *scheduler);
 R_API void r_core_task_sleep_begin(RCoreTask *task);
 R_API void r_core_task_sleep_end(RCoreTask *task);
 R_API void r_core_task_break(RCoreTaskScheduler *scheduler, int id);
@@ -218,6 +218,30 @@ typedef struct r_snap_entry {
 	int perm;
 } RSnapEntry;
 
+/* binary instruction trace recorder, see drecord.c */
+typedef struct r_debug_trace_rec_t RDebugTraceRec;
+
+typedef enum {
+	R_DEBUG_TRACE_REC_REGS = 'A', // full register arena, taken when recording starts
+	R_DEBUG_TRACE_REC_STEP = 'S', // an instruction is about to execute at pc
+	R_DEBUG_TRACE_REC_REG = 'R', // register written by the last step
+	R_DEBUG_TRACE_REC_MEM = 'M', // memory written by the last step
+} RDebugTraceRecType;
+
+typedef struct r_debug_trace_event_t {
+	RDebugTraceRecType type;
+	ut64 step; // number of the instruction the event belongs to, 0 for the initial state
+	ut64 pc;
+	ut64 addr;
+	int arena;
+	int offset;
+	ut64 value;
+	const ut8 *data;
+	int len;
+} RDebugTraceEvent;
+
+typedef bool (*RDebugTraceEventCallback)(void *user, const RDebugTraceEvent *ev);
+
 typedef struct r_debug_trace_t {
 	RList *traces;
 	int count;
@@ -228,6 +252,12 @@ typedef struct r_debug_trace_t {
 	char *addresses;
 	// TODO: add range here
 	HtPP *ht;
+	HtUP *ops; // pc => instruction decoded for trace_ins_before
+	// decoder the ops come from, they hold RRegItem pointers of anal->reg
+	void *ops_plugin;
+	int ops_bits;
+	ut64 ops_reg_epoch;
+	RDebugTraceRec *rec;
 } RDebugTrace;
 
 typedef struct r_debug_tracepoint_t {
@@ -301,6 +331,7 @@ typedef struct r_debug_t {
 
 	bool pc_at_bp; /* after a breakpoint, is the pc at the bp? */
 	bool pc_at_bp_set; /* is the pc_at_bp variable set already? */
+	bool bps_in_place; /* a coverage hit left the other sw breakpoints written */
 
 	REvent *ev;
 
@@ -548,6 +579,7 @@ R_API int r_debug_thread_list(RDebug *dbg, int pid, char fmt);
 R_API void r_debug_tracenodes_reset(RDebug *dbg);
 
 R_API void r_debug_trace_reset(RDebug *dbg);
+R_API void r_debug_trace_ops_clear(RDebug *dbg);
 R_API int r_debug_trace_pc(RDebug *dbg, ut64 pc);
 R_API void r_debug_trace_op(RDebug *dbg, RAnalOp *op);
 R_API void r_debug_trace_at(RDebug *dbg, const char *str);
@@ -589,6 +621,18 @@ R_API bool r_debug_session_load(RDebug *dbg, const char *file);
 R_API bool r_debug_trace_ins_before(RDebug *dbg);
 R_API bool r_debug_trace_ins_after(RDebug *dbg);
 
+/* binary trace recorder */
+R_API RDebugTraceRec *r_debug_trace_rec_new(const char *file);
+R_API void r_debug_trace_rec_free(RDebugTraceRec *rec);
+R_API bool r_debug_trace_rec_flush(RDebugTraceRec *rec);
+R_API void r_debug_trace_rec_regs(RDebugTraceRec *rec, RReg *reg);
+R_API void r_debug_trace_rec_step(RDebugTraceRec *rec, ut64 pc);
+R_API void r_debug_trace_rec_reg(RDebugTraceRec *rec, int arena, int offset, ut64 value);
+R_API void r_debug_trace_rec_mem(RDebugTraceRec *rec, ut64 addr, const ut8 *buf, int len);
+R_API void r_debug_trace_rec_info(RDebugTraceRec *rec, PrintfCallback cb_printf);
+R_API bool r_debug_trace_rec_foreach(const char *file, RDebugTraceEventCallback cb, void *user);
+R_API ut64 r_debug_trace_rec_replay(RDebug *dbg, const char *file, ut64 step);
+
 R_API RDebugSession *r_debug_session_new(void);
 R_API void r_debug_session_free(RDebugSession *session);
 
@@ -54,8 +54,15 @@ typedef struct r_flag_t {
 	bool realnames;
 	Sdb *tags;
 	RNum *num;
-	RSkipList *by_off; /* flags sorted by offset, value=RFlagsAtOffset */
-	HtPP *ht_name; /* hashmap key=item name, value=RFlagItem * */
+	RVector by_off; /* RFlagsAtOffset sorted by offset */
+	RVector by_off_log; /* RFlagsAtOffset at offsets not merged in by_off yet */
+	size_t by_off_log_sorted; /* entries at the start of by_off_log sorted by offset */
+	HtUP *by_off_pending; /* offset -> index + 1 in by_off_log, for the unsorted entries */
+	size_t by_off_holes; /* entries of by_off left without flags */
+	int iterating; /* foreach depth, by_off can not be reorganized meanwhile */
+	int bulk; /* r_flag_bulk_begin depth */
+	HtPP *ht_name; /* hashmap key=item name, value=RFlagItem *, the key is the item name */
+	bool concurrent; /* ht_name can be used from several threads, see r_flag_set_concurrent */
 	PrintfCallback cb_printf;
 #if R_FLAG_ZONE_USE_SDB
 	Sdb *zones;
@@ -103,6 +110,7 @@ R_API void r_flag_bind(RFlag *io, RFlagBind *bnd);
 #ifdef R_API
 R_API RFlag * r_flag_new(void);
 R_API RFlag * r_flag_free(RFlag *f);
+R_API bool r_flag_set_concurrent(RFlag *f, bool enable);
 R_API void r_flag_list(RFlag *f, int rad, const char *pfx);
 R_API bool r_flag_exist_at(RFlag *f, const char *flag_prefix, ut16 fp_size, ut64 off);
 R_API RFlagItem *r_flag_get(RFlag *f, const char *name);
@@ -118,6 +126,8 @@ R_API bool r_flag_unset_off(RFlag *f, ut64 addr);
 R_API void r_flag_unset_all (RFlag *f);
 R_API RFlagItem *r_flag_set(RFlag *fo, const char *name, ut64 addr, ut32 size);
 R_API RFlagItem *r_flag_set_next(RFlag *fo, const char *name, ut64 addr, ut32 size);
+R_API void r_flag_bulk_begin(RFlag *f);
+R_API void r_flag_bulk_end(RFlag *f);
 R_API void r_flag_item_set_alias(RFlagItem *item, const char *alias);
 R_API void r_flag_item_free (RFlagItem *item);
 R_API void r_flag_item_set_comment(RFlagItem *item, const char *comment);
@@ -103,10 +103,13 @@ typedef struct r_io_t {
 #if USE_PTRACE_WRAP
 	struct ptrace_wrap_instance_t *ptrace_wrap;
 #endif
+	ut64 ptrace_epoch; // bumped by every r_io_ptrace request that is not a read
 #if __WINDOWS__
 	struct w32dbg_wrap_instance_t *w32dbg_wrap;
 #endif
 	char *args;
+	REvent *ev; // R_EVENT_IO_WRITE is sent here, set by core
+	int ev_lock; // writes send no event meanwhile, for breakpoints and other debugger patches
 	PrintfCallback cb_printf;
 	RCoreBind corebind;
 } RIO;
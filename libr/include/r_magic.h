@@ -276,6 +276,8 @@ struct r_magic_set {
 typedef struct r_magic_set RMagic;
 #endif
 
+typedef struct r_magic_index_t RMagicIndex;
+
 #ifdef R_API
 R_API RMagic* r_magic_new(int flags);
 R_API void r_magic_free(RMagic*);
@@ -292,6 +294,10 @@ R_API bool r_magic_load_buffer(RMagic*, const char *);
 R_API bool r_magic_compile(RMagic*, const char *);
 R_API bool r_magic_check(RMagic*, const char *);
 R_API int r_magic_errno(RMagic*);
+
+R_API RMagicIndex *r_magic_index_new(RMagic *ms);
+R_API void r_magic_index_free(RMagicIndex *idx);
+R_API size_t r_magic_index_scan(RMagicIndex *idx, const ut8 *buf, size_t len, size_t window, ut8 *cand);
 #endif
 
 
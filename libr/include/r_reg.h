@@ -127,6 +127,7 @@ typedef struct r_reg_t {
 	int size;
 	bool is_thumb;
 	bool big_endian;
+	ut64 epoch; // bumped every time the profile is replaced
 } RReg;
 
 typedef struct r_reg_flags_t {
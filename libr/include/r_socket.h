@@ -46,6 +46,8 @@ R_LIB_VERSION_HEADER (r_socket);
 #define R_INVALID_SOCKET -1
 #endif
 
+typedef struct r2pipe_shm_t R2PipeShm;
+
 typedef struct {
 	int child;
 #if __WINDOWS__
@@ -54,6 +56,7 @@ typedef struct {
 	int input[2];
 	int output[2];
 #endif
+	R2PipeShm *shm;
 	RCoreBind coreb;
 } R2Pipe;
 
@@ -80,6 +83,7 @@ typedef struct r_socket_http_options {
 	bool accept_timeout;
 	int timeout;
 	bool httpauth;
+	bool keepalive;
 } RSocketHTTPOptions;
 
 
@@ -150,9 +154,15 @@ typedef struct r_socket_http_request {
 	ut8 *data;
 	int data_length;
 	bool auth;
+	bool keepalive;
+	int version; // minor version of the request, echoed in the response
+	ut8 *rbuf; // bytes of the connection read ahead, passed on to the next request
+	int rbuf_len;
+	int rbuf_pos;
 } RSocketHTTPRequest;
 
 R_API RSocketHTTPRequest *r_socket_http_accept(RSocket *s, RSocketHTTPOptions *so);
+R_API RSocketHTTPRequest *r_socket_http_next(RSocketHTTPRequest *rs, RSocketHTTPOptions *so);
 R_API void r_socket_http_response(RSocketHTTPRequest *rs, int code, const char *out, int x, const char *headers);
 R_API void r_socket_http_close(RSocketHTTPRequest *rs);
 R_API ut8 *r_socket_http_handle_upload(const ut8 *str, int len, int *olen);
@@ -274,7 +284,11 @@ R_API int r2pipe_close(R2Pipe *r2pipe);
 R_API R2Pipe *r2pipe_open_corebind(RCoreBind *coreb);
 R_API R2Pipe *r2pipe_open(const char *cmd);
 R_API R2Pipe *r2pipe_open_dl(const char *file);
+R_API R2Pipe *r2pipe_open_shm(const char *cmd);
+R_API R2Pipe *r2pipe_shm_listen(void);
+R_API int r2pipe_shm_serve(R2Pipe *r2p, RCoreBind *coreb);
 R_API char *r2pipe_cmd(R2Pipe *r2pipe, const char *str);
+R_API RList *r2pipe_cmd_batch(R2Pipe *r2pipe, const char **cmds, int n);
 R_API char *r2pipe_cmdf(R2Pipe *r2pipe, const char *fmt, ...);
 #endif
 
@@ -37,6 +37,8 @@ typedef enum {
 	R_EVENT_CLASS_ATTR_DEL, // REventClassAttrSet
 	R_EVENT_CLASS_ATTR_RENAME, // REventClassAttrRename
 	R_EVENT_DEBUG_PROCESS_FINISHED, // REventDebugProcessFinished
+	R_EVENT_IO_WRITE, // REventIOWrite
+	R_EVENT_ANAL_HINT, // REventHint
 	R_EVENT_MAX,
 } REventType;
 
@@ -75,6 +77,17 @@ typedef struct r_event_debug_process_finished_t {
 	int pid;
 } REventDebugProcessFinished;
 
+typedef struct r_event_io_write_t {
+	ut64 addr;
+	const ut8 *buf;
+	int len;
+} REventIOWrite;
+
+typedef struct r_event_hint_t {
+	ut64 addr;
+	ut64 size; // number of addresses whose hints changed
+} REventHint;
+
 R_API REvent *r_event_new(void *user);
 R_API void r_event_free(REvent *ev);
 R_API REventCallbackHandle r_event_hook(REvent *ev, int type, REventCallback cb, void *user);
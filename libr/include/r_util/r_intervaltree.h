@@ -29,6 +29,12 @@ typedef struct r_interval_node_t {
 
 typedef void (*RIntervalNodeFree)(void *data);
 
+typedef struct r_interval_tree_item_t {
+	ut64 start;
+	ut64 end;
+	void *data;
+} RIntervalTreeItem;
+
 typedef struct r_interval_tree_t {
 	RIntervalNode *root;
 	RIntervalNodeFree free;
@@ -40,6 +46,13 @@ R_API void r_interval_tree_fini(RIntervalTree *tree);
 // return false if the insertion failed.
 R_API bool r_interval_tree_insert(RIntervalTree *tree, ut64 start, ut64 end, void *data);
 
+// Inserts n items at once, items is sorted by start in place.
+// The tree is rebuilt in a single pass when that is cheaper than inserting
+// them one by one, O(n + m) for m entries already in the tree.
+// return false if the insertion failed, the tree keeps the entries it had
+// then and the data of all the items is left to the caller.
+R_API bool r_interval_tree_insert_all(RIntervalTree *tree, RIntervalTreeItem *items, size_t n);
+
 // Removes a given node from the tree. The node will be freed.
 // If free is true, the data in the node is freed as well.
 // false if the removal failed
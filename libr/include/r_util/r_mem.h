@@ -18,14 +18,19 @@ typedef struct r_mmap_t {
 #endif
 } RMmap;
 
+// not thread-safe, callers sharing a pool between threads must lock it
 typedef struct r_mem_pool_t {
-	ut8 **nodes;
-	int ncount;
-	int npool;
+	ut8 **nodes;    // chunks of poolsize nodes each
+	int ncount;     // nodes handed out from the last chunk
+	int npool;      // chunks in use
 	//
 	int nodesize;
-	int poolsize;
-	int poolcount;
+	int poolsize;   // nodes per chunk
+	int poolcount;  // capacity of the chunk array
+	void *freelist; // released nodes, linked through their first word
+	ut64 allocs;    // total nodes ever allocated
+	ut64 live;      // nodes currently in use
+	ut64 peak;      // max value of live
 } RMemoryPool;
 
 R_API ut64 r_mem_get_num(const ut8 *b, int size);
@@ -35,6 +40,7 @@ R_API RMemoryPool* r_mem_pool_deinit(RMemoryPool *pool);
 R_API RMemoryPool *r_mem_pool_new(int nodesize, int poolsize, int poolcount);
 R_API RMemoryPool *r_mem_pool_free(RMemoryPool *pool);
 R_API void* r_mem_pool_alloc(RMemoryPool *pool);
+R_API void r_mem_pool_release(RMemoryPool *pool, void *p);
 R_API void *r_mem_dup(const void *s, int l);
 R_API void *r_mem_alloc(int sz);
 R_API void r_mem_free(void *);
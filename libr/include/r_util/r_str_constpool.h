@@ -13,15 +13,29 @@ extern "C" {
 /*
  * RStrConstPool is a pool of constant strings.
  * References to strings will be valid as long as the RStrConstPool is alive.
+ *
+ * Strings taken with r_str_constpool_ref () are reference counted instead
+ * and released by the last r_str_constpool_unref (), unless the same string
+ * was also taken with r_str_constpool_get ().
  */
 
 typedef struct r_str_constpool_t {
 	HtPP *ht;
 } RStrConstPool;
 
+typedef struct r_str_constpool_stats_t {
+	size_t strings; // distinct strings in the pool
+	size_t refs; // references to them, strings from r_str_constpool_get count once
+	size_t bytes; // memory taken by the strings
+	size_t saved; // memory a copy per reference would take on top of that
+} RStrConstPoolStats;
+
 R_API bool r_str_constpool_init(RStrConstPool *pool);
 R_API void r_str_constpool_fini(RStrConstPool *pool);
 R_API const char *r_str_constpool_get(RStrConstPool *pool, const char *str);
+R_API const char *r_str_constpool_ref(RStrConstPool *pool, const char *str);
+R_API void r_str_constpool_unref(RStrConstPool *pool, const char *str);
+R_API void r_str_constpool_stats(RStrConstPool *pool, RStrConstPoolStats *stats);
 
 #ifdef __cplusplus
 }
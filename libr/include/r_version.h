@@ -0,0 +1,12 @@
+#ifndef R_VERSION_H
+#define R_VERSION_H 1
+#define R2_VERSION_COMMIT 1
+#define R2_VERSION "4.6.0-git"
+#define R2_VERSION_MAJOR 4
+#define R2_VERSION_MINOR 6
+#define R2_VERSION_PATCH 0
+#define R2_VERSION_NUMBER 40600
+#define R2_GITTAP "4.6.0-git"
+#define R2_GITTIP "7f578a22f1c51341081defb920f07ecde1d3b2f0"
+#define R2_BIRTH "2026-10-19__13:11:44"
+#endif
@@ -355,6 +355,10 @@ R_API bool r_io_write_at(RIO* io, ut64 addr, const ut8* buf, int len) {
 	} else {
 		ret = r_io_pwrite_at (io, addr, mybuf, len) > 0;
 	}
+	if (ret && io->ev && !io->ev_lock) {
+		REventIOWrite ev = { addr, mybuf, len };
+		r_event_send (io->ev, R_EVENT_IO_WRITE, &ev);
+	}
 	if (buf != mybuf) {
 		free (mybuf);
 	}
@@ -614,7 +618,62 @@ static ptrace_wrap_instance *io_ptrace_wrap_instance(RIO *io) {
 }
 #endif
 
+// requests that only read from the stopped tracee, anything else may
+// resume it or change its memory (PTRACE_SYSEMU, PTRACE_LISTEN, pokes..)
+static bool ptrace_reads(r_ptrace_request_t request) {
+	switch ((int)request) {
+#ifdef PT_READ_I
+	case PT_READ_I:
+#endif
+#ifdef PT_READ_D
+	case PT_READ_D:
+#endif
+#ifdef PT_READ_U
+	case PT_READ_U:
+#endif
+#ifdef PT_GETREGS
+	case PT_GETREGS:
+#endif
+#ifdef PT_GETFPREGS
+	case PT_GETFPREGS:
+#endif
+#ifdef PT_GETFPXREGS
+	case PT_GETFPXREGS:
+#endif
+#ifdef PT_GETDBREGS
+	case PT_GETDBREGS:
+#endif
+#ifdef PT_GET_THREAD_AREA
+	case PT_GET_THREAD_AREA:
+#endif
+#ifdef PT_GETEVENTMSG
+	case PT_GETEVENTMSG:
+#endif
+#ifdef PT_GETSIGINFO
+	case PT_GETSIGINFO:
+#endif
+#ifdef PT_LWPINFO
+	case PT_LWPINFO:
+#endif
+#ifdef PTRACE_GETREGSET
+	case PTRACE_GETREGSET:
+#endif
+#ifdef PTRACE_PEEKSIGINFO
+	case PTRACE_PEEKSIGINFO:
+#endif
+#ifdef PTRACE_GETSIGMASK
+	case PTRACE_GETSIGMASK:
+#endif
+		return true;
+	}
+	return false;
+}
+
 R_API long r_io_ptrace(RIO *io, r_ptrace_request_t request, pid_t pid, void *addr, r_ptrace_data_t data) {
+	if (!ptrace_reads (request)) {
+		// anything cached from the stopped tracee may be stale after this
+		io->ptrace_epoch++;
+	}
 #if USE_PTRACE_WRAP
 	ptrace_wrap_instance *wrap = io_ptrace_wrap_instance (io);
 	if (!wrap) {
@@ -13,12 +13,38 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <errno.h>
+#if __linux__
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#endif
+
+#if __linux__ && defined(SYS_process_vm_readv) && defined(SYS_process_vm_writev)
+#define USE_PROCESS_VM 1
+#else
+#define USE_PROCESS_VM 0
+#endif
+
+#define PTRACE_PAGE_SIZE 4096
+#define PTRACE_PAGE_MASK ((ut64)PTRACE_PAGE_SIZE - 1)
+#define PTRACE_CACHE_PAGES 1024
+#define PTRACE_IOV_MAX 1024
+
+enum {
+	R_IO_PTRACE_PEEK, // PTRACE_PEEKTEXT/POKEDATA, one word per syscall
+	R_IO_PTRACE_PIDMEM, // /proc/pid/mem
+	R_IO_PTRACE_VM, // process_vm_readv/writev, one syscall per request
+};
 
 typedef struct {
 	int pid;
 	int tid;
 	int fd;
 	int opid;
+	int method;
+	bool use_cache;
+	HtUP *pages; // page address => copy of the page, NULL if unreadable
+	ut64 epoch; // io->ptrace_epoch the cached pages were taken at
+	int cache_pid;
 } RIOPtrace;
 #define RIOPTRACE_OPID(x) (((RIOPtrace*)(x)->data)->opid)
 #define RIOPTRACE_PID(x) (((RIOPtrace*)(x)->data)->pid)
@@ -79,6 +105,174 @@ static int debug_os_read_at(RIO *io, int pid, ut32 *buf, int sz, ut64 addr) {
 	return sz;
 }
 
+static int peek_read_at(RIO *io, int pid, ut8 *buf, int len, ut64 addr) {
+	ut32 *aligned_buf = (ut32*)r_malloc_aligned (len, sizeof (ut32));
+	if (aligned_buf) {
+		int res = debug_os_read_at (io, pid, aligned_buf, len, addr);
+		memcpy (buf, aligned_buf, len);
+		r_free_aligned (aligned_buf);
+		return res;
+	}
+	return -1;
+}
+
+#if USE_PROCESS_VM
+static ssize_t vm_readv(int pid, struct iovec *local, int nlocal, struct iovec *remote, int nremote) {
+	return syscall (SYS_process_vm_readv, pid, local, (unsigned long)nlocal, remote, (unsigned long)nremote, 0UL);
+}
+
+static ssize_t vm_writev(int pid, struct iovec *local, int nlocal, struct iovec *remote, int nremote) {
+	return syscall (SYS_process_vm_writev, pid, local, (unsigned long)nlocal, remote, (unsigned long)nremote, 0UL);
+}
+
+static inline bool vm_unsupported(int err) {
+	return err == ENOSYS || err == EPERM || err == ESRCH;
+}
+
+// reads as much of the range as possible, skipping unreadable pages.
+// returns -1 only if the syscall itself is unusable for this process
+static int vm_read_at(int pid, ut8 *buf, int len, ut64 addr) {
+	int done = 0;
+	while (done < len) {
+		struct iovec local = { buf + done, len - done };
+		struct iovec remote = { (void *)(size_t)(addr + done), len - done };
+		ssize_t n = vm_readv (pid, &local, 1, &remote, 1);
+		if (n > 0) {
+			done += n;
+			continue;
+		}
+		if (n < 0 && vm_unsupported (errno)) {
+			return -1;
+		}
+		// first page is not mapped, skip to the next one
+		ut64 next = ((addr + done) | PTRACE_PAGE_MASK) + 1;
+		done = (int)R_MIN ((ut64)len, next - addr);
+	}
+	return len;
+}
+
+static void page_free(HtUPKv *kv) {
+	free (kv->value);
+}
+
+static void cache_flush(RIOPtrace *iop) {
+	ht_up_free (iop->pages);
+	iop->pages = NULL;
+}
+
+static void cache_sync(RIO *io, RIOPtrace *iop) {
+	if (iop->epoch != io->ptrace_epoch || iop->pid != iop->cache_pid) {
+		cache_flush (iop);
+		iop->epoch = io->ptrace_epoch;
+		iop->cache_pid = iop->pid;
+	}
+	if (!iop->pages) {
+		iop->pages = ht_up_new (NULL, page_free, NULL);
+	} else if (iop->pages->count > PTRACE_CACHE_PAGES) {
+		cache_flush (iop);
+		iop->pages = ht_up_new (NULL, page_free, NULL);
+	}
+}
+
+static void cache_invalidate(RIOPtrace *iop, ut64 addr, int len) {
+	if (!iop->pages || len < 1) {
+		return;
+	}
+	ut64 page = addr & ~PTRACE_PAGE_MASK;
+	ut64 end = addr + len;
+	for (; page < end && page >= (addr & ~PTRACE_PAGE_MASK); page += PTRACE_PAGE_SIZE) {
+		ht_up_delete (iop->pages, page);
+	}
+}
+
+// fetch all the given pages with a single scatter/gather syscall per batch.
+// pages that cannot be read are cached as NULL so they are not retried
+// until the tracee runs again
+static bool cache_fetch(RIOPtrace *iop, ut64 *miss, int nmiss) {
+	struct iovec local[PTRACE_IOV_MAX];
+	struct iovec remote[PTRACE_IOV_MAX];
+	int i = 0;
+	while (i < nmiss) {
+		int j, n = R_MIN (nmiss - i, PTRACE_IOV_MAX);
+		for (j = 0; j < n; j++) {
+			local[j].iov_base = malloc (PTRACE_PAGE_SIZE);
+			local[j].iov_len = PTRACE_PAGE_SIZE;
+			remote[j].iov_base = (void *)(size_t)miss[i + j];
+			remote[j].iov_len = PTRACE_PAGE_SIZE;
+			if (!local[j].iov_base) {
+				n = j;
+				break;
+			}
+		}
+		if (n < 1) {
+			return false;
+		}
+		ssize_t got = vm_readv (iop->pid, local, n, remote, n);
+		if (got < 0 && vm_unsupported (errno)) {
+			for (j = 0; j < n; j++) {
+				free (local[j].iov_base);
+			}
+			return false;
+		}
+		// transfers stop at the first page that faults
+		int ok = got > 0? (int)(got / PTRACE_PAGE_SIZE): 0;
+		for (j = 0; j < ok; j++) {
+			ht_up_insert (iop->pages, miss[i + j], local[j].iov_base);
+		}
+		if (ok < n) {
+			free (local[ok].iov_base);
+			ht_up_insert (iop->pages, miss[i + ok], NULL);
+			for (j = ok + 1; j < n; j++) {
+				free (local[j].iov_base);
+			}
+			ok++;
+		}
+		i += ok;
+	}
+	return true;
+}
+
+static int vm_read_cached(RIO *io, RIOPtrace *iop, ut8 *buf, int len, ut64 addr) {
+	ut64 first = addr & ~PTRACE_PAGE_MASK;
+	ut64 last = (addr + len - 1) & ~PTRACE_PAGE_MASK;
+	ut64 page, npages = ((last - first) / PTRACE_PAGE_SIZE) + 1;
+	bool found;
+	if (last < first || npages > PTRACE_CACHE_PAGES) {
+		// too big to be worth caching
+		return vm_read_at (iop->pid, buf, len, addr);
+	}
+	cache_sync (io, iop);
+	if (!iop->pages) {
+		return vm_read_at (iop->pid, buf, len, addr);
+	}
+	ut64 *miss = R_NEWS (ut64, npages);
+	if (!miss) {
+		return vm_read_at (iop->pid, buf, len, addr);
+	}
+	int nmiss = 0;
+	for (page = first; page <= last; page += PTRACE_PAGE_SIZE) {
+		ht_up_find (iop->pages, page, &found);
+		if (!found) {
+			miss[nmiss++] = page;
+		}
+	}
+	bool ok = !nmiss || cache_fetch (iop, miss, nmiss);
+	free (miss);
+	if (!ok) {
+		return -1;
+	}
+	for (page = first; page <= last; page += PTRACE_PAGE_SIZE) {
+		const ut8 *data = ht_up_find (iop->pages, page, NULL);
+		ut64 from = R_MAX (page, addr);
+		ut64 to = R_MIN (page + PTRACE_PAGE_SIZE, addr + len);
+		if (data) {
+			memcpy (buf + (from - addr), data + (from - page), to - from);
+		}
+	}
+	return len;
+}
+#endif
+
 static int __read(RIO *io, RIODesc *desc, ut8 *buf, int len) {
 #if USE_PROC_PID_MEM
 	int ret, fd;
@@ -88,6 +282,24 @@ static int __read(RIO *io, RIODesc *desc, ut8 *buf, int len) {
 		return -1;
 	}
 	memset (buf, '\xff', len); // TODO: only memset the non-readed bytes
+	if (len < 1) {
+		return len;
+	}
+#if USE_PROCESS_VM
+	RIOPtrace *iop = desc->data;
+	if (iop->method == R_IO_PTRACE_VM) {
+		int res = iop->use_cache
+			? vm_read_cached (io, iop, buf, len, addr)
+			: vm_read_at (iop->pid, buf, len, addr);
+		if (res != -1) {
+			return res;
+		}
+		// not allowed for this process, stick to ptrace from now on
+		iop->method = R_IO_PTRACE_PEEK;
+		cache_flush (iop);
+		memset (buf, '\xff', len);
+	}
+#endif
 	/* reopen procpidmem if necessary */
 #if USE_PROC_PID_MEM
 	fd = RIOPTRACE_FD (desc);
@@ -110,14 +322,7 @@ static int __read(RIO *io, RIODesc *desc, ut8 *buf, int len) {
 		}
 	}
 #endif
-	ut32 *aligned_buf = (ut32*)r_malloc_aligned (len, sizeof (ut32));
-	if (aligned_buf) {
-		int res = debug_os_read_at (io, RIOPTRACE_PID (desc), (ut32*)aligned_buf, len, addr);
-		memcpy (buf, aligned_buf, len);
-		r_free_aligned (aligned_buf);
-		return res;
-	}
-	return -1;
+	return peek_read_at (io, RIOPTRACE_PID (desc), buf, len, addr);
 }
 
 static int ptrace_write_at(RIO *io, int pid, const ut8 *pbuf, int sz, ut64 addr) {
@@ -149,6 +354,18 @@ static int __write(RIO *io, RIODesc *fd, const ut8 *buf, int len) {
 	if (!fd || !fd->data) {
 		return -1;
 	}
+#if USE_PROCESS_VM
+	RIOPtrace *iop = fd->data;
+	cache_invalidate (iop, io->off, len);
+	if (iop->method == R_IO_PTRACE_VM && len > 0) {
+		struct iovec local = { (void *)buf, len };
+		struct iovec remote = { (void *)(size_t)io->off, len };
+		// fails on non-writable pages like .text, where poke still works
+		if (vm_writev (iop->pid, &local, 1, &remote, 1) == len) {
+			return len;
+		}
+	}
+#endif
 	return ptrace_write_at (io, RIOPTRACE_PID (fd), buf, len, io->off);
 }
 
@@ -249,7 +466,10 @@ static RIODesc *__open(RIO *io, const char *file, int rw, int mode) {
 		return NULL;
 	}
 
-	riop->pid = riop->tid = pid;
+	riop->pid = riop->tid = riop->cache_pid = pid;
+	riop->method = USE_PROCESS_VM? R_IO_PTRACE_VM: R_IO_PTRACE_PEEK;
+	riop->use_cache = USE_PROCESS_VM;
+	riop->epoch = io->ptrace_epoch;
 	open_pidmem (riop);
 	desc = r_io_desc_new (io, &r_io_plugin_ptrace, file, rw | R_PERM_X, mode, riop);
 	desc->name = r_sys_pid_to_path (pid);
@@ -282,6 +502,9 @@ static int __close(RIODesc *desc) {
 		close (fd);
 	}
 	RIOPtrace *riop = desc->data;
+#if USE_PROCESS_VM
+	cache_flush (riop);
+#endif
 	desc->data = NULL;
 	long ret = r_io_ptrace (desc->io, PTRACE_DETACH, pid, 0, 0);
 	if (errno == ESRCH) {
@@ -292,6 +515,61 @@ static int __close(RIODesc *desc) {
 	return ret;
 }
 
+static int pidmem_read_at(int fd, ut8 *buf, int len, ut64 addr) {
+	if (lseek (fd, addr, SEEK_SET) < 0) {
+		return -1;
+	}
+	return read (fd, buf, len);
+}
+
+// read the same range with every available method and report the throughput
+static void ptrace_bench(RIO *io, RIOPtrace *iop, int len) {
+	const char *names[] = { "ptrace", "pidmem", "vm" };
+	ut64 addr = io->off;
+	int method, rounds = 4;
+	ut8 *buf = malloc (len);
+	if (!buf) {
+		return;
+	}
+	char pidmem[32];
+	snprintf (pidmem, sizeof (pidmem), "/proc/%d/mem", iop->pid);
+	int memfd = open (pidmem, O_RDONLY);
+	for (method = R_IO_PTRACE_PEEK; method <= R_IO_PTRACE_VM; method++) {
+		int i, res = -1;
+		ut64 t0 = r_time_now_mono ();
+		for (i = 0; i < rounds; i++) {
+			switch (method) {
+			case R_IO_PTRACE_PEEK:
+				res = peek_read_at (io, iop->pid, buf, len, addr);
+				break;
+			case R_IO_PTRACE_PIDMEM:
+				res = memfd != -1? pidmem_read_at (memfd, buf, len, addr): -1;
+				break;
+#if USE_PROCESS_VM
+			case R_IO_PTRACE_VM:
+				res = vm_read_at (iop->pid, buf, len, addr);
+				break;
+#endif
+			}
+			if (res < 0) {
+				break;
+			}
+		}
+		ut64 dt = r_time_now_mono () - t0;
+		if (res < 0) {
+			io->cb_printf ("%-8s  unavailable\n", names[method]);
+		} else {
+			ut64 bytes = (ut64)len * rounds;
+			ut64 bps = dt? (bytes * 1000000) / dt: bytes * 1000000;
+			io->cb_printf ("%-8s  %"PFMT64u" bytes/s\n", names[method], bps);
+		}
+	}
+	if (memfd != -1) {
+		close (memfd);
+	}
+	free (buf);
+}
+
 static char *__system(RIO *io, RIODesc *fd, const char *cmd) {
 	RIOPtrace *iop = (RIOPtrace*)fd->data;
 	//printf("ptrace io command (%s)\n", cmd);
@@ -303,14 +581,38 @@ static char *__system(RIO *io, RIODesc *fd, const char *cmd) {
 		eprintf ("Usage: =!cmd args\n"
 			" =!ptrace   - use ptrace io\n"
 			" =!mem      - use /proc/pid/mem io if possible\n"
+			" =!vm       - use process_vm_readv/writev io (default)\n"
+			" =!cache    - toggle the per-stop page cache for vm io\n"
+			" =!bench [len] - measure read throughput of each method at the current offset\n"
 			" =!pid      - show targeted pid\n"
 			" =!pid <#>  - select new pid\n");
 	} else
 	if (!strcmp (cmd, "ptrace")) {
 		close_pidmem (iop);
+		iop->method = R_IO_PTRACE_PEEK;
 	} else
 	if (!strcmp (cmd, "mem")) {
 		open_pidmem (iop);
+		iop->method = R_IO_PTRACE_PIDMEM;
+	} else
+	if (!strcmp (cmd, "vm")) {
+#if USE_PROCESS_VM
+		close_pidmem (iop);
+		iop->method = R_IO_PTRACE_VM;
+#else
+		eprintf ("process_vm_readv is not supported on this platform\n");
+#endif
+	} else
+	if (!strcmp (cmd, "cache")) {
+		iop->use_cache = !iop->use_cache;
+#if USE_PROCESS_VM
+		cache_flush (iop);
+#endif
+		io->cb_printf ("%s\n", r_str_bool (iop->use_cache));
+	} else
+	if (!strncmp (cmd, "bench", 5)) {
+		int len = (cmd[5] == ' ')? (int)r_num_math (NULL, cmd + 6): 0;
+		ptrace_bench (io, iop, len > 0? len: 1024 * 1024);
 	} else
 	if (!strncmp (cmd, "pid", 3)) {
 		if (iop) {
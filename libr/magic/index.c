@@ -0,0 +1,355 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_userconf.h>
+#include <r_magic.h>
+#include <r_util.h>
+
+/*
+ * Prefilter for scanning a buffer at every offset with r_magic_buffer.
+ *
+ * Every top-level binary test of the loaded database is reduced to an
+ * anchor: a run of bytes (with a mask) that must appear at a known
+ * distance from the start of the match. Scanning the buffer for those
+ * runs gives the offsets where softmagic can possibly succeed, the rest
+ * of the offsets do not need to be interpreted at all.
+ */
+
+#if USE_LIB_MAGIC
+
+R_API RMagicIndex *r_magic_index_new(RMagic *ms) {
+	return NULL;
+}
+
+R_API void r_magic_index_free(RMagicIndex *idx) {
+}
+
+R_API size_t r_magic_index_scan(RMagicIndex *idx, const ut8 *buf, size_t len, size_t window, ut8 *cand) {
+	memset (cand, 1, len);
+	return len;
+}
+
+#else
+
+#include "file.h"
+
+/* is_tar() wants a whole 512 byte record with an octal checksum at 148 */
+#define TAR_RECORD 512
+#define TAR_CHKSUM 148
+
+typedef struct {
+	ut32 off;	/* distance from the match start to the first byte */
+	ut32 range;	/* number of match starts to try, 1 for fixed offsets */
+	ut32 minlen;	/* the match needs at least this many bytes */
+	int len;
+	bool nocase;
+	ut8 val[MAXstring];
+	ut8 mask[MAXstring];
+} RMagicAnchor;
+
+struct r_magic_index_t {
+	bool all;	/* some test has no anchor, every offset is a candidate */
+	RVector anchors;
+	RVector bucket[256];	/* anchor indexes by their first byte */
+	ut8 pairs[65536 / 8];	/* the first two bytes of every anchor */
+};
+
+static inline ut8 anchor_byte(const RMagicAnchor *a, int i, ut8 b) {
+	return a->nocase? tolower (b): b & a->mask[i];
+}
+
+static void index_pair(RMagicIndex *idx, int b0, const RMagicAnchor *a) {
+	int b1;
+	for (b1 = 0; b1 < 256; b1++) {
+		if (a->len < 2 || anchor_byte (a, 1, b1) == a->val[1]) {
+			int k = b0 | (b1 << 8);
+			idx->pairs[k >> 3] |= 1 << (k & 7);
+		}
+	}
+}
+
+static bool index_add(RMagicIndex *idx, RMagicAnchor *a) {
+	int i, b0;
+	// bytes that must be zero also match past the end of the buffer,
+	// drop them from both ends so the anchor is always found in it
+	while (a->len > 0 && !a->val[a->len - 1]) {
+		a->len--;
+	}
+	for (i = 0; i < a->len && !a->val[i]; i++) {
+	}
+	if (i == a->len) {
+		idx->all = true;
+		return false;
+	}
+	if (i > 0) {
+		memmove (a->val, a->val + i, a->len - i);
+		memmove (a->mask, a->mask + i, a->len - i);
+		a->len -= i;
+		a->off += i;
+	}
+	ut32 n = (ut32)idx->anchors.len;
+	if (!r_vector_push (&idx->anchors, a)) {
+		return false;
+	}
+	for (b0 = 0; b0 < 256; b0++) {
+		if (anchor_byte (a, 0, b0) == a->val[0]) {
+			r_vector_push (&idx->bucket[b0], &n);
+			index_pair (idx, b0, a);
+		}
+	}
+	return true;
+}
+
+static bool anchor_num(RMagicAnchor *a, struct r_magic *m) {
+	int size;
+	bool be;
+	switch (m->type) {
+	case FILE_BYTE: size = 1; be = false; break;
+	case FILE_SHORT: size = 2; be = R_SYS_ENDIAN; break;
+	case FILE_BESHORT: size = 2; be = true; break;
+	case FILE_LESHORT: size = 2; be = false; break;
+	case FILE_LONG: size = 4; be = R_SYS_ENDIAN; break;
+	case FILE_BELONG: size = 4; be = true; break;
+	case FILE_LELONG: size = 4; be = false; break;
+	case FILE_QUAD: size = 8; be = R_SYS_ENDIAN; break;
+	case FILE_BEQUAD: size = 8; be = true; break;
+	case FILE_LEQUAD: size = 8; be = false; break;
+	default:
+		return false;
+	}
+	ut64 mask = UT64_MAX;
+	if (m->mask_op & FILE_OPINVERSE) {
+		return false;
+	}
+	if (m->num_mask) {
+		if ((m->mask_op & FILE_OPS_MASK) != FILE_OPAND) {
+			return false;
+		}
+		mask = m->num_mask;
+	}
+	ut64 val = m->value.q & mask;
+	int i;
+	for (i = 0; i < size; i++) {
+		int shift = (be? size - 1 - i: i) * 8;
+		a->val[i] = (val >> shift) & 0xff;
+		a->mask[i] = (mask >> shift) & 0xff;
+	}
+	a->len = size;
+	return true;
+}
+
+static bool anchor_str(RMagicAnchor *a, struct r_magic *m) {
+	int i, len = R_MIN (m->vallen, MAXstring);
+	ut32 flags = m->str_flags;
+	if (m->type == FILE_SEARCH) {
+		// an unlimited search still has to start inside the buffer
+		a->range = m->str_range? m->str_range: UT32_MAX;
+	}
+	a->nocase = flags & STRING_IGNORE_CASE;
+	for (i = 0; i < len; i++) {
+		ut8 c = m->value.s[i];
+		if ((flags & (STRING_COMPACT_BLANK | STRING_COMPACT_OPTIONAL_BLANK)) && isspace (c)) {
+			break;
+		}
+		a->val[i] = a->nocase? tolower (c): c;
+		a->mask[i] = 0xff;
+	}
+	a->len = i;
+	return true;
+}
+
+static bool anchor_magic(RMagicAnchor *a, struct r_magic *m) {
+	memset (a, 0, sizeof (*a));
+	a->off = m->offset;
+	a->range = 1;
+	if ((m->flag & (INDIR | OFFADD)) || m->reln != '=') {
+		return false;
+	}
+	switch (m->type) {
+	case FILE_STRING:
+	case FILE_SEARCH:
+		return anchor_str (a, m);
+	}
+	return anchor_num (a, m);
+}
+
+/* A test only counts when it prints something, so every printing test
+ * needs an anchor somewhere in the chain of tests leading to it. Takes
+ * the top-level test at magic[i] and returns the index of the next one. */
+static ut32 index_magic(RMagicIndex *idx, RMagic *ms, struct r_magic *magic, ut32 nmagic, ut32 i) {
+	RMagicAnchor a;
+	RVector chain;	/* anchored test closest to each level, or -1 */
+	RVector added;
+	ut32 j;
+	r_vector_init (&chain, sizeof (int), NULL, NULL);
+	r_vector_init (&added, sizeof (int), NULL, NULL);
+	for (j = i; j < nmagic && (j == i || magic[j].cont_level); j++) {
+		struct r_magic *m = &magic[j];
+		if (m->cont_level > chain.len) {
+			// skipped levels never run
+			continue;
+		}
+		while (chain.len > m->cont_level) {
+			r_vector_pop (&chain, NULL);
+		}
+		int best = chain.len? *(int *)r_vector_index_ptr (&chain, chain.len - 1): -1;
+		if (best < 0 && anchor_magic (&a, m)) {
+			best = j;
+		}
+		r_vector_push (&chain, &best);
+		const char *desc = (ms->flags & R_MAGIC_MIME)? m->mimetype: m->desc;
+		if (!*desc) {
+			continue;
+		}
+		if (best < 0) {
+			idx->all = true;
+			break;
+		}
+		int *k;
+		bool found = false;
+		r_vector_foreach (&added, k) {
+			if (*k == best) {
+				found = true;
+				break;
+			}
+		}
+		if (!found) {
+			r_vector_push (&added, &best);
+			anchor_magic (&a, &magic[best]);
+			index_add (idx, &a);
+		}
+	}
+	r_vector_fini (&chain);
+	r_vector_fini (&added);
+	while (j < nmagic && magic[j].cont_level) {
+		j++;
+	}
+	return j;
+}
+
+static void index_tar(RMagicIndex *idx) {
+	// octal digits and the blanks from_oct skips
+	const ut8 vals[] = { '0', ' ', '\t' & 0xf8 };
+	const ut8 masks[] = { 0xf8, 0xff, 0xf8 };
+	size_t i;
+	for (i = 0; i < R_ARRAY_SIZE (vals); i++) {
+		RMagicAnchor a = { .off = TAR_CHKSUM, .range = 1, .minlen = TAR_RECORD, .len = 1 };
+		a.val[0] = vals[i];
+		a.mask[0] = masks[i];
+		index_add (idx, &a);
+	}
+}
+
+R_API RMagicIndex *r_magic_index_new(RMagic *ms) {
+	r_return_val_if_fail (ms, NULL);
+	if (!ms->mlist) {
+		return NULL;
+	}
+	RMagicIndex *idx = R_NEW0 (RMagicIndex);
+	if (!idx) {
+		return NULL;
+	}
+	int i;
+	r_vector_init (&idx->anchors, sizeof (RMagicAnchor), NULL, NULL);
+	for (i = 0; i < 256; i++) {
+		r_vector_init (&idx->bucket[i], sizeof (ut32), NULL, NULL);
+	}
+	if (!(ms->flags & R_MAGIC_NO_CHECK_TAR)) {
+		index_tar (idx);
+	}
+	if (!(ms->flags & R_MAGIC_NO_CHECK_SOFT)) {
+		struct mlist *ml;
+		for (ml = ms->mlist->next; ml != ms->mlist; ml = ml->next) {
+			ut32 j = 0;
+			while (j < ml->nmagic) {
+				struct r_magic *m = &ml->magic[j];
+				// file_buffer only runs the binary tests
+				if (!m->cont_level && (m->flag & BINTEST)) {
+					j = index_magic (idx, ms, ml->magic, ml->nmagic, j);
+				} else {
+					j++;
+				}
+			}
+		}
+	}
+	return idx;
+}
+
+R_API void r_magic_index_free(RMagicIndex *idx) {
+	if (!idx) {
+		return;
+	}
+	int i;
+	r_vector_fini (&idx->anchors);
+	for (i = 0; i < 256; i++) {
+		r_vector_fini (&idx->bucket[i]);
+	}
+	free (idx);
+}
+
+static void index_mark(const RMagicAnchor *a, size_t q, size_t len, size_t window, ut8 *cand) {
+	if (q < a->off || window < a->minlen || len < a->minlen) {
+		return;
+	}
+	size_t hi = R_MIN (q - a->off, len - a->minlen);
+	size_t span = a->range;
+	if (span > window) {
+		span = window;
+	}
+	size_t lo = (hi + 1 > span)? hi + 1 - span: 0;
+	// the anchor must end inside the bytes magic gets to see
+	size_t end = q + a->len;
+	if (end > window && lo < end - window) {
+		lo = end - window;
+	}
+	if (lo <= hi) {
+		memset (cand + lo, 1, hi - lo + 1);
+	}
+}
+
+/* Sets cand[i] for every offset of buf where
+ *   r_magic_buffer (ms, buf + i, R_MIN (window, len - i))
+ * may find something and returns how many of them there are.
+ * The others are guaranteed not to match. */
+R_API size_t r_magic_index_scan(RMagicIndex *idx, const ut8 *buf, size_t len, size_t window, ut8 *cand) {
+	r_return_val_if_fail (buf && cand, 0);
+	size_t q, n = 0;
+	if (!idx || idx->all) {
+		memset (cand, 1, len);
+		return len;
+	}
+	memset (cand, 0, len);
+	for (q = 0; q < len; q++) {
+		if (q + 1 < len) {
+			int k = buf[q] | (buf[q + 1] << 8);
+			if (!(idx->pairs[k >> 3] & (1 << (k & 7)))) {
+				continue;
+			}
+		}
+		ut32 *ai;
+		r_vector_foreach (&idx->bucket[buf[q]], ai) {
+			const RMagicAnchor *a = r_vector_index_ptr (&idx->anchors, *ai);
+			int i;
+			if (q + a->len > len) {
+				continue;
+			}
+			for (i = 1; i < a->len; i++) {
+				if (anchor_byte (a, i, buf[q + i]) != a->val[i]) {
+					break;
+				}
+			}
+			if (i == a->len) {
+				index_mark (a, q, len, window, cand);
+			}
+		}
+	}
+	// less than two bytes left is reported as an empty or short file
+	if (len > 0) {
+		cand[len - 1] = 1;
+	}
+	for (q = 0; q < len; q++) {
+		n += cand[q];
+	}
+	return n;
+}
+
+#endif
@@ -94,7 +94,7 @@ static int main_help(int line) {
 		" -            same as 'r2 malloc://512'\n"
 		" =            read file from stdin (use -i and -c to run cmds)\n"
 		" -=           perform !=! command to run all commands remotely\n"
-		" -0           print \\x00 after init and every command\n"
+		" -0           print \\x00 after init and every command (or serve R2PIPE_SHM)\n"
 		" -2           close stderr file descriptor (silent warning messages)\n"
 		" -a [arch]    set asm.arch\n"
 		" -A           run 'aaa' command to analyze all referenced code\n"
@@ -1403,6 +1403,8 @@ R_API int r_main_radare2(int argc, const char **argv) {
 		}
 	}
 	if ((patchfile && !quiet) || !patchfile) {
+		/* r2pipe_open_shm clients expect the rings to be ready before the null byte */
+		R2Pipe *shmpipe = zerosep? r2pipe_shm_listen (): NULL;
 		if (zerosep) {
 			r_cons_zero ();
 		}
@@ -1417,7 +1419,13 @@ R_API int r_main_radare2(int argc, const char **argv) {
 				r_core_cmd0 (r, "aeip");
 			}
 		}
-		for (;;) {
+		if (shmpipe) {
+			RCoreBind rcb;
+			r_core_bind (r, &rcb);
+			r2pipe_shm_serve (shmpipe, &rcb);
+			r2pipe_close (shmpipe);
+		}
+		while (!shmpipe) {
 			r_core_prompt_loop (r);
 			ret = r->num->value;
 			debug = r_config_get_i (r->config, "cfg.debug");
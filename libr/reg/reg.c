@@ -159,6 +159,8 @@ R_API void r_reg_free_internal(RReg *reg, bool init) {
 	r_return_if_fail (reg);
 	ut32 i;
 
+	reg->epoch++;
+
 	r_list_free (reg->roregs);
 	reg->roregs = NULL;
 	R_FREE (reg->reg_profile_str);
@@ -20,6 +20,17 @@ Usage Example:
 #include <r_lib.h>
 #include <r_socket.h>
 
+#if __linux__
+#define R2PIPE_SHM 1
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <limits.h>
+#include <errno.h>
+#else
+#define R2PIPE_SHM 0
+#endif
+
 #define R2P_PID(x) (((R2Pipe*)(x)->data)->pid)
 #define R2P_INPUT(x) (((R2Pipe*)(x)->data)->input[0])
 #define R2P_OUTPUT(x) (((R2Pipe*)(x)->data)->output[1])
@@ -32,6 +43,194 @@ static void env(const char *s, int f) {
 }
 #endif
 
+#if R2PIPE_SHM
+/* shared memory transport: the client creates an unlinked temporary file,
+ * maps it and passes the descriptor to the spawned r2 in R2PIPE_SHM. it
+ * holds two single producer single consumer byte rings, one for commands
+ * and one for replies, with the same framing as the pipes ('\n' after
+ * commands and '\0' after replies). the side that finds its ring empty or
+ * full spins for a while and then sleeps in a futex on the other side's
+ * counter, so a round trip costs no syscalls when both sides are busy */
+#define R2PIPE_SHM_MAGIC 0x4d485332
+#define R2PIPE_SHM_SIZE (1024 * 1024) // per ring, power of two
+#define R2PIPE_SHM_SPIN 1024
+#define SHM_LOAD(x) __atomic_load_n (&(x), __ATOMIC_ACQUIRE)
+#define SHM_STORE(x, v) __atomic_store_n (&(x), (v), __ATOMIC_RELEASE)
+
+typedef struct {
+	ut32 head; // bytes produced
+	ut32 tail; // bytes consumed
+	ut32 waiters;
+	ut32 pad;
+} R2PipeRing;
+
+typedef struct {
+	ut32 magic;
+	ut32 size;
+	ut32 ready; // set by the server once it serves on the rings
+	int client;
+	R2PipeRing ring[2]; // commands, replies
+} R2PipeShmHeader;
+
+struct r2pipe_shm_t {
+	R2PipeShmHeader *hdr;
+	size_t mapsz;
+	R2PipeRing *in;
+	R2PipeRing *out;
+	ut8 *indata;
+	ut8 *outdata;
+	int peer; // process to check when a wait times out
+	bool peer_is_child;
+};
+
+static bool shm_peer_alive(R2PipeShm *shm) {
+	if (shm->peer < 1) {
+		return true;
+	}
+	if (shm->peer_is_child) {
+		return waitpid (shm->peer, NULL, WNOHANG) == 0;
+	}
+	return kill (shm->peer, 0) == 0 || errno != ESRCH;
+}
+
+/* wait until *word is no longer val, false if the peer went away */
+static bool shm_sleep(R2PipeShm *shm, R2PipeRing *r, ut32 *word, ut32 val) {
+	bool alive = true;
+	int i;
+	for (i = 0; i < R2PIPE_SHM_SPIN; i++) {
+		if (SHM_LOAD (*word) != val) {
+			return true;
+		}
+	}
+	__atomic_add_fetch (&r->waiters, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n (word, __ATOMIC_SEQ_CST) == val) {
+		struct timespec ts = { 1, 0 };
+		if (syscall (SYS_futex, word, FUTEX_WAIT, val, &ts, NULL, 0) == -1 && errno == ETIMEDOUT) {
+			alive = shm_peer_alive (shm);
+		}
+	}
+	__atomic_sub_fetch (&r->waiters, 1, __ATOMIC_SEQ_CST);
+	return alive;
+}
+
+static void shm_wake(R2PipeRing *r, ut32 *word) {
+	/* the release store of word must not pass this load, or a waiter that
+	 * saw the old value could sleep without being woken (store-load order) */
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+	if (__atomic_load_n (&r->waiters, __ATOMIC_SEQ_CST)) {
+		syscall (SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+	}
+}
+
+static bool shm_write(R2PipeShm *shm, const ut8 *buf, size_t len) {
+	R2PipeRing *r = shm->out;
+	const ut32 size = shm->hdr->size;
+	while (len > 0) {
+		ut32 head = r->head;
+		ut32 tail = SHM_LOAD (r->tail);
+		ut32 avail = size - (head - tail);
+		if (!avail) {
+			if (!shm_sleep (shm, r, &r->tail, tail)) {
+				return false;
+			}
+			continue;
+		}
+		ut32 off = head & (size - 1);
+		ut32 n = R_MIN (R_MIN (avail, len), size - off);
+		memcpy (shm->outdata + off, buf, n);
+		SHM_STORE (r->head, head + n);
+		shm_wake (r, &r->head);
+		buf += n;
+		len -= n;
+	}
+	return true;
+}
+
+/* read up to and including term, which is replaced by a null byte */
+static char *shm_read(R2PipeShm *shm, char term) {
+	R2PipeRing *r = shm->in;
+	const ut32 size = shm->hdr->size;
+	size_t len = 0, cap = 0;
+	char *res = NULL;
+	for (;;) {
+		ut32 tail = r->tail;
+		ut32 head = SHM_LOAD (r->head);
+		if (head == tail) {
+			if (!shm_sleep (shm, r, &r->head, head)) {
+				free (res);
+				return NULL;
+			}
+			continue;
+		}
+		ut32 off = tail & (size - 1);
+		ut32 n = R_MIN (head - tail, size - off);
+		const ut8 *src = shm->indata + off;
+		const ut8 *end = memchr (src, term, n);
+		ut32 take = end? (end - src) + 1: n;
+		if (len + take + 1 > cap) {
+			size_t ncap = R_MAX (cap * 2, len + take + 1);
+			char *nres = realloc (res, ncap);
+			if (!nres) {
+				free (res);
+				return NULL;
+			}
+			res = nres;
+			cap = ncap;
+		}
+		memcpy (res + len, src, take);
+		len += take;
+		SHM_STORE (r->tail, tail + take);
+		shm_wake (r, &r->tail);
+		if (end) {
+			res[len - 1] = 0;
+			return res;
+		}
+	}
+}
+
+static R2PipeShm *shm_map(int fd, bool server) {
+	size_t mapsz = sizeof (R2PipeShmHeader) + 2 * R2PIPE_SHM_SIZE;
+	if (!server && ftruncate (fd, mapsz) == -1) {
+		return NULL;
+	}
+	R2PipeShmHeader *hdr = mmap (NULL, mapsz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (hdr == MAP_FAILED) {
+		return NULL;
+	}
+	if (server) {
+		if (hdr->magic != R2PIPE_SHM_MAGIC || hdr->size != R2PIPE_SHM_SIZE) {
+			munmap (hdr, mapsz);
+			return NULL;
+		}
+	} else {
+		hdr->magic = R2PIPE_SHM_MAGIC;
+		hdr->size = R2PIPE_SHM_SIZE;
+		hdr->client = getpid ();
+	}
+	R2PipeShm *shm = R_NEW0 (R2PipeShm);
+	if (!shm) {
+		munmap (hdr, mapsz);
+		return NULL;
+	}
+	ut8 *data = (ut8 *)(hdr + 1);
+	shm->hdr = hdr;
+	shm->mapsz = mapsz;
+	shm->in = &hdr->ring[server? 0: 1];
+	shm->out = &hdr->ring[server? 1: 0];
+	shm->indata = data + (server? 0: R2PIPE_SHM_SIZE);
+	shm->outdata = data + (server? R2PIPE_SHM_SIZE: 0);
+	shm->peer = server? hdr->client: -1;
+	return shm;
+}
+
+static void shm_free(R2PipeShm *shm) {
+	if (shm) {
+		munmap (shm->hdr, shm->mapsz);
+		free (shm);
+	}
+}
+#endif
+
 R_API int r2pipe_write(R2Pipe *r2pipe, const char *str) {
 	char *cmd;
 	int ret, len;
@@ -45,6 +244,13 @@ R_API int r2pipe_write(R2Pipe *r2pipe, const char *str) {
 	}
 	memcpy (cmd, str, len - 1);
 	strcpy (cmd + len - 2, "\n");
+#if R2PIPE_SHM
+	if (r2pipe->shm) {
+		ret = shm_write (r2pipe->shm, (const ut8 *)cmd, len - 1);
+		free (cmd);
+		return ret;
+	}
+#endif
 #if __WINDOWS__
 	DWORD dwWritten = -1;
 	WriteFile (r2pipe->pipe, cmd, len, &dwWritten, NULL);
@@ -63,6 +269,11 @@ R_API char *r2pipe_read(R2Pipe *r2pipe) {
 	if (!r2pipe) {
 		return NULL;
 	}
+#if R2PIPE_SHM
+	if (r2pipe->shm) {
+		return shm_read (r2pipe->shm, 0);
+	}
+#endif
 	bufsz = 4096;
 	buf = calloc (1, bufsz);
 	if (!buf) {
@@ -118,6 +329,13 @@ R_API int r2pipe_close(R2Pipe *r2pipe) {
 		}
 	}
 	*/
+#if R2PIPE_SHM
+	if (r2pipe->shm && r2pipe->child != -1) {
+		/* the server does not see the pipes closing, ask it to quit */
+		(void)shm_write (r2pipe->shm, (const ut8 *)"q\n", 2);
+	}
+	shm_free (r2pipe->shm);
+#endif
 #if __WINDOWS__
 	if (r2pipe->pipe) {
 		CloseHandle (r2pipe->pipe);
@@ -327,6 +545,147 @@ R_API char *r2pipe_cmd(R2Pipe *r2p, const char *str) {
 	return r2pipe_read (r2p);
 }
 
+/* send all the commands in a single write and collect one reply for each,
+ * saving a round trip per command when talking to a remote r2 */
+R_API RList *r2pipe_cmd_batch(R2Pipe *r2p, const char **cmds, int n) {
+	r_return_val_if_fail (r2p && cmds && n >= 0, NULL);
+	RStrBuf *sb = r_strbuf_new ("");
+	RList *res = r_list_newf (free);
+	int i;
+	if (!sb || !res) {
+		r_strbuf_free (sb);
+		r_list_free (res);
+		return NULL;
+	}
+	for (i = 0; i < n; i++) {
+		if (R_STR_ISEMPTY (cmds[i]) || strchr (cmds[i], '\n')) {
+			eprintf ("r2pipe_cmd_batch: invalid command at index %d\n", i);
+			goto fail;
+		}
+		r_strbuf_appendf (sb, "%s\n", cmds[i]);
+	}
+	if (n > 0) {
+		const char *buf = r_strbuf_get (sb);
+		int len = r_strbuf_length (sb);
+#if R2PIPE_SHM
+		if (r2p->shm) {
+			if (!shm_write (r2p->shm, (const ut8 *)buf, len)) {
+				goto fail;
+			}
+		} else
+#endif
+#if __WINDOWS__
+		DWORD dwWritten = 0;
+		WriteFile (r2p->pipe, buf, len, &dwWritten, NULL);
+		if (dwWritten != len) {
+#else
+		if (write (r2p->input[1], buf, len) != len) {
+#endif
+			perror ("r2pipe_cmd_batch");
+			goto fail;
+		}
+	}
+	for (i = 0; i < n; i++) {
+		char *out = r2pipe_read (r2p);
+		if (!out) {
+			goto fail;
+		}
+		r_list_append (res, out);
+	}
+	r_strbuf_free (sb);
+	return res;
+fail:
+	r_strbuf_free (sb);
+	r_list_free (res);
+	return NULL;
+}
+
+/* like r2pipe_open, but talk to the spawned r2 -0 over shared memory when
+ * both sides support it. falls back to the pipes otherwise */
+R_API R2Pipe *r2pipe_open_shm(const char *cmd) {
+#if R2PIPE_SHM
+	r_return_val_if_fail (R_STR_ISNOTEMPTY (cmd), NULL);
+	char *name = NULL;
+	int fd = r_file_mkstemp ("r2pipe", &name);
+	if (fd == -1) {
+		free (name);
+		return r2pipe_open (cmd);
+	}
+	r_file_rm (name);
+	free (name);
+	R2PipeShm *shm = shm_map (fd, false);
+	if (!shm) {
+		close (fd);
+		return r2pipe_open (cmd);
+	}
+	char *sfd = r_str_newf ("%d", fd);
+	r_sys_setenv ("R2PIPE_SHM", sfd);
+	free (sfd);
+	R2Pipe *r2p = r2pipe_open (cmd);
+	r_sys_setenv ("R2PIPE_SHM", NULL);
+	close (fd);
+	/* the server flags the rings before printing the initial null byte */
+	if (r2p && SHM_LOAD (shm->hdr->ready)) {
+		shm->peer = r2p->child;
+		shm->peer_is_child = true;
+		r2p->shm = shm;
+	} else {
+		shm_free (shm);
+	}
+	return r2p;
+#else
+	return r2pipe_open (cmd);
+#endif
+}
+
+/* server side, used by r2 -0: attach to the rings passed in R2PIPE_SHM */
+R_API R2Pipe *r2pipe_shm_listen(void) {
+#if R2PIPE_SHM
+	char *sfd = r_sys_getenv ("R2PIPE_SHM");
+	if (R_STR_ISEMPTY (sfd)) {
+		free (sfd);
+		return NULL;
+	}
+	int fd = atoi (sfd);
+	free (sfd);
+	r_sys_setenv ("R2PIPE_SHM", NULL);
+	R2PipeShm *shm = shm_map (fd, true);
+	close (fd);
+	R2Pipe *r2p = shm? r2pipe_new (): NULL;
+	if (!r2p) {
+		shm_free (shm);
+		return NULL;
+	}
+	r2p->shm = shm;
+	SHM_STORE (shm->hdr->ready, 1);
+	return r2p;
+#else
+	return NULL;
+#endif
+}
+
+/* run the commands received on the rings until the client quits or dies */
+R_API int r2pipe_shm_serve(R2Pipe *r2p, RCoreBind *coreb) {
+	r_return_val_if_fail (r2p && coreb && coreb->cmdstr, -1);
+#if R2PIPE_SHM
+	char *cmd;
+	while (r2p->shm && (cmd = shm_read (r2p->shm, '\n'))) {
+		bool quit = !strcmp (cmd, "q") || !strcmp (cmd, "q!");
+		char *out = quit? NULL: coreb->cmdstr (coreb->core, cmd);
+		const char *res = out? out: "";
+		bool ok = shm_write (r2p->shm, (const ut8 *)res, strlen (res) + 1);
+		free (out);
+		free (cmd);
+		if (quit || !ok) {
+			break;
+		}
+	}
+	return 0;
+#else
+	return -1;
+#endif
+}
+
 R_API char *r2pipe_cmdf(R2Pipe *r2p, const char *fmt, ...) {
 	int ret, ret2;
 	char *p, string[1024];
@@ -497,6 +497,9 @@ R_API bool r_socket_listen(RSocket *s, const char *port, const char *certfile) {
 		return false;
 	}
 #endif
+	if (!s->proto) {
+		s->proto = R_SOCKET_PROTO_TCP;
+	}
 
 	switch (s->proto) {
 	case R_SOCKET_PROTO_TCP:
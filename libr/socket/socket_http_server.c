@@ -9,108 +9,199 @@ R_API void r_socket_http_server_set_breaked(bool *b) {
 	breaked = b;
 }
 
-R_API RSocketHTTPRequest *r_socket_http_accept (RSocket *s, RSocketHTTPOptions *so) {
-	int content_length = 0, xx, yy;
-	int pxx = 1, first = 0;
+#define HTTP_RBUF_SIZE 4096
+
+/* make sure there are buffered bytes, returns how many or -1 on eof */
+static int http_fill(RSocketHTTPRequest *hr) {
+	if (hr->rbuf_pos < hr->rbuf_len) {
+		return hr->rbuf_len - hr->rbuf_pos;
+	}
+	if (!hr->rbuf) {
+		hr->rbuf = malloc (HTTP_RBUF_SIZE);
+		if (!hr->rbuf) {
+			return -1;
+		}
+	}
+	int n = r_socket_read (hr->s, hr->rbuf, HTTP_RBUF_SIZE);
+	if (n < 1) {
+		return -1;
+	}
+	hr->rbuf_len = n;
+	hr->rbuf_pos = 0;
+	return n;
+}
+
+/* read one line, stripping the \r\n, returns -1 on eof or error */
+static int http_gets(RSocketHTTPRequest *hr, char *buf, int size) {
+	int i = 0;
+	while (i < size - 1) {
+		if (http_fill (hr) < 0) {
+			buf[i] = 0;
+			return i > 0? i: -1;
+		}
+		buf[i] = hr->rbuf[hr->rbuf_pos++];
+		if (buf[i] == '\n') {
+			break;
+		}
+		i++;
+	}
+	if (i > 0 && buf[i - 1] == '\r') {
+		i--;
+	}
+	buf[i] = 0;
+	return i;
+}
+
+/* parse the request line, headers and body of the next request in the stream */
+/* read the body, taking the buffered bytes first */
+static void http_read_block(RSocketHTTPRequest *hr, ut8 *buf, int len) {
+	int n = R_MIN (len, hr->rbuf_len - hr->rbuf_pos);
+	if (n > 0) {
+		memcpy (buf, hr->rbuf + hr->rbuf_pos, n);
+		hr->rbuf_pos += n;
+	}
+	if (n < len) {
+		r_socket_read_block (hr->s, buf + n, len - n);
+	}
+}
+
+/* parse the request line, headers and body of the next request in the
+ * stream, prev is the request before it on a keep-alive connection */
+static RSocketHTTPRequest *http_read_request(RSocket *s, RSocketHTTPOptions *so, RSocketHTTPRequest *prev) {
+	int content_length = 0, len;
+	bool first = true, conn_close = false, conn_keep = false;
 	char buf[1500], *p, *q;
 	RSocketHTTPRequest *hr = R_NEW0 (RSocketHTTPRequest);
 	if (!hr) {
+		r_socket_free (s);
 		return NULL;
 	}
-	if (so->accept_timeout) {
-		hr->s = r_socket_accept_timeout (s, 1);
-	} else {
-		hr->s = r_socket_accept (s);
-	}
-	if (!hr->s) {
-		free (hr);
-		return NULL;
-	}
-	if (so->timeout > 0) {
-		r_socket_block_time (hr->s, 1, so->timeout, 0);
-	}
+	hr->s = s;
 	hr->auth = !so->httpauth;
+	if (prev) {
+		hr->rbuf = prev->rbuf;
+		hr->rbuf_len = prev->rbuf_len;
+		hr->rbuf_pos = prev->rbuf_pos;
+		prev->rbuf = NULL;
+	}
 	for (;;) {
 #if __WINDOWS__
 		if (breaked && *breaked) {
-			r_socket_http_close (hr);
-			return NULL;
+			goto fail;
 		}
 #endif
-		memset (buf, 0, sizeof (buf));
-		xx = r_socket_gets (hr->s, buf, sizeof (buf));
-		yy = r_socket_ready (hr->s, 0, 20 * 1000); //this function uses usecs as argument
-//		eprintf ("READ %d (%s) READY %d\n", xx, buf, yy);
-		if (!yy || (!xx && !pxx)) {
+		len = http_gets (hr, buf, sizeof (buf));
+		if (len < 0) {
+			if (first) {
+				goto fail;
+			}
 			break;
 		}
-		pxx = xx;
-
-		if (first == 0) {
-			first = 1;
-			if (strlen (buf)<3) {
-				r_socket_http_close (hr);
-				return NULL;
+		if (first) {
+			if (len < 3) {
+				goto fail;
 			}
+			first = false;
 			p = strchr (buf, ' ');
 			if (p) {
 				*p = 0;
 			}
 			hr->method = strdup (buf);
 			if (p) {
-				q = strstr (p+1, " HTTP"); //strchr (p+1, ' ');
+				q = strstr (p + 1, " HTTP"); //strchr (p+1, ' ');
 				if (q) {
+					hr->version = !strncmp (q, " HTTP/1.1", 9);
 					*q = 0;
 				}
-				hr->path = strdup (p+1);
+				hr->path = strdup (p + 1);
+			}
+			continue;
+		}
+		if (!len) {
+			break;
+		}
+		if (!hr->referer && !strncmp (buf, "Referer: ", 9)) {
+			hr->referer = strdup (buf + 9);
+		} else if (!hr->agent && !strncmp (buf, "User-Agent: ", 12)) {
+			hr->agent = strdup (buf + 12);
+		} else if (!hr->host && !strncmp (buf, "Host: ", 6)) {
+			hr->host = strdup (buf + 6);
+		} else if (!strncmp (buf, "Content-Length: ", 16)) {
+			content_length = atoi (buf + 16);
+		} else if (!r_str_ncasecmp (buf, "Connection: ", 12)) {
+			conn_close = !r_str_ncasecmp (buf + 12, "close", 5);
+			conn_keep = !r_str_ncasecmp (buf + 12, "keep-alive", 10);
+		} else if (so->httpauth && !strncmp (buf, "Authorization: Basic ", 21)) {
+			char *authtoken = buf + 21;
+			size_t authlen = strlen (authtoken);
+			char *curauthtoken;
+			RListIter *iter;
+			char *decauthtoken = calloc (4, authlen + 1);
+			if (!decauthtoken) {
+				eprintf ("Could not allocate decoding buffer\n");
+				return hr;
 			}
-		} else {
-			if (!hr->referer && !strncmp (buf, "Referer: ", 9)) {
-				hr->referer = strdup (buf + 9);
-			} else if (!hr->agent && !strncmp (buf, "User-Agent: ", 12)) {
-				hr->agent = strdup (buf + 12);
-			} else if (!hr->host && !strncmp (buf, "Host: ", 6)) {
-				hr->host = strdup (buf + 6);
-			} else if (!strncmp (buf, "Content-Length: ", 16)) {
-				content_length = atoi (buf + 16);
-			} else if (so->httpauth && !strncmp (buf, "Authorization: Basic ", 21)) {
-				char *authtoken = buf + 21;
-				size_t authlen = strlen (authtoken);
-				char *curauthtoken;
-				RListIter *iter;
-				char *decauthtoken = calloc (4, authlen + 1);
-				if (!decauthtoken) {
-					eprintf ("Could not allocate decoding buffer\n");
-					return hr;
-				}
 
-				if (r_base64_decode ((ut8 *)decauthtoken, authtoken, authlen) == -1) {
-					eprintf ("Could not decode authorization token\n");
-				} else {
-					r_list_foreach (so->authtokens, iter, curauthtoken) {
-						if (!strcmp (decauthtoken, curauthtoken)) {
-							hr->auth = true;
-							break;
-						}
+			if (r_base64_decode ((ut8 *)decauthtoken, authtoken, authlen) == -1) {
+				eprintf ("Could not decode authorization token\n");
+			} else {
+				r_list_foreach (so->authtokens, iter, curauthtoken) {
+					if (!strcmp (decauthtoken, curauthtoken)) {
+						hr->auth = true;
+						break;
 					}
 				}
+			}
 
-				free (decauthtoken);
+			free (decauthtoken);
 
-				if (!hr->auth) {
-					eprintf ("Failed attempt login from '%s'\n", hr->host);
-				}
+			if (!hr->auth) {
+				eprintf ("Failed attempt login from '%s'\n", hr->host);
 			}
 		}
 	}
-	if (content_length>0) {
-		r_socket_read_block (hr->s, (ut8*)buf, 1); // one missing byte wtf
-		hr->data = malloc (content_length+1);
+	hr->keepalive = so->keepalive && (hr->version? !conn_close: conn_keep);
+	if (content_length > 0) {
+		hr->data = malloc (content_length + 1);
+		if (!hr->data) {
+			goto fail;
+		}
 		hr->data_length = content_length;
-		r_socket_read_block (hr->s, hr->data, hr->data_length);
+		http_read_block (hr, hr->data, hr->data_length);
 		hr->data[content_length] = 0;
 	}
 	return hr;
+fail:
+	r_socket_http_close (hr);
+	return NULL;
+}
+
+R_API RSocketHTTPRequest *r_socket_http_accept (RSocket *s, RSocketHTTPOptions *so) {
+	RSocket *c = so->accept_timeout
+		? r_socket_accept_timeout (s, 1)
+		: r_socket_accept (s);
+	if (!c) {
+		return NULL;
+	}
+	if (so->timeout > 0) {
+		r_socket_block_time (c, 1, so->timeout, 0);
+	}
+	return http_read_request (c, so, NULL);
+}
+
+/* wait for the next request on a keep-alive connection, consuming the
+ * previous one. returns NULL and closes the connection when there is none */
+R_API RSocketHTTPRequest *r_socket_http_next(RSocketHTTPRequest *rs, RSocketHTTPOptions *so) {
+	r_return_val_if_fail (rs && so, NULL);
+	if (!rs->keepalive) {
+		r_socket_http_close (rs);
+		return NULL;
+	}
+	RSocket *c = rs->s;
+	rs->s = NULL;
+	RSocketHTTPRequest *hr = http_read_request (c, so, rs);
+	r_socket_http_close (rs);
+	return hr;
 }
 
 R_API void r_socket_http_response (RSocketHTTPRequest *rs, int code, const char *out, int len, const char *headers) {
@@ -121,6 +212,7 @@ R_API void r_socket_http_response (RSocketHTTPRequest *rs, int code, const char
 		code==401?"Unauthorized":
 		code==403?"Permission denied":
 		code==404?"not found":
+		code==503?"Service unavailable":
 		"UNKNOWN";
 	if (len < 1) {
 		len = out ? strlen (out) : 0;
@@ -128,12 +220,30 @@ R_API void r_socket_http_response (RSocketHTTPRequest *rs, int code, const char
 	if (!headers) {
 		headers = code == 401 ? "WWW-Authenticate: Basic realm=\"R2 Web UI Access\"\n" : "";
 	}
-	r_socket_printf (rs->s, "HTTP/1.0 %d %s\r\n%s"
-		"Connection: close\r\nContent-Length: %d\r\n\r\n",
-		code, strcode, headers, len);
+	char *hdr = r_str_newf ("HTTP/1.%d %d %s\r\n%s"
+		"Connection: %s\r\nContent-Length: %d\r\n\r\n",
+		rs->version, code, strcode, headers,
+		rs->keepalive? "keep-alive": "close", len);
+	if (!hdr) {
+		return;
+	}
+	/* send headers and body in a single write, two small writes stall
+	 * keep-alive clients on the delayed ack of the first one */
+	int hdrlen = strlen (hdr);
 	if (out && len > 0) {
-		r_socket_write (rs->s, (void *)out, len);
+		char *msg = realloc (hdr, hdrlen + len);
+		if (!msg) {
+			r_socket_write (rs->s, hdr, hdrlen);
+			r_socket_write (rs->s, (void *)out, len);
+			free (hdr);
+			return;
+		}
+		hdr = msg;
+		memcpy (hdr + hdrlen, out, len);
+		hdrlen += len;
 	}
+	r_socket_write (rs->s, hdr, hdrlen);
+	free (hdr);
 }
 
 R_API ut8 *r_socket_http_handle_upload(const ut8 *str, int len, int *retlen) {
@@ -188,8 +298,10 @@ R_API void r_socket_http_close (RSocketHTTPRequest *rs) {
 	free (rs->path);
 	free (rs->host);
 	free (rs->agent);
+	free (rs->referer);
 	free (rs->method);
 	free (rs->data);
+	free (rs->rbuf);
 	free (rs);
 }
 
@@ -135,6 +135,116 @@ R_API bool r_interval_tree_insert(RIntervalTree *tree, ut64 start, ut64 end, voi
 	return r;
 }
 
+static int item_cmp(const void *a, const void *b) {
+	const RIntervalTreeItem *x = a, *y = b;
+	if (x->start == y->start) {
+		return 0;
+	}
+	return x->start < y->start? -1: 1;
+}
+
+// balanced tree out of nodes sorted by start, only the nodes at the deepest
+// level are red so every path has the same number of black nodes
+static RIntervalNode *build(RIntervalNode **nodes, size_t lo, size_t hi, int depth, int red_depth) {
+	if (lo >= hi) {
+		return NULL;
+	}
+	size_t mid = lo + (hi - lo) / 2;
+	RIntervalNode *node = nodes[mid];
+	RIntervalNode *left = build (nodes, lo, mid, depth + 1, red_depth);
+	RIntervalNode *right = build (nodes, mid + 1, hi, depth + 1, red_depth);
+	node->node.child[0] = left? &left->node: NULL;
+	node->node.child[1] = right? &right->node: NULL;
+	node->node.red = depth && depth == red_depth;
+	node_max (&node->node);
+	return node;
+}
+
+R_API bool r_interval_tree_insert_all(RIntervalTree *tree, RIntervalTreeItem *items, size_t n) {
+	r_return_val_if_fail (tree && (items || !n), false);
+	RIntervalNode *node;
+	RBIter it;
+	size_t i, j, k, old = 0;
+	if (!n) {
+		return true;
+	}
+	for (i = 0; i < n; i++) {
+		r_return_val_if_fail (items[i].end >= items[i].start, false);
+	}
+	qsort (items, n, sizeof (RIntervalTreeItem), item_cmp);
+	if (tree->root) {
+		r_rbtree_foreach (&tree->root->node, it, node, RIntervalNode, node) {
+			old++;
+		}
+	}
+	// the entries of the tree followed by the new ones, then merged
+	RIntervalNode **nodes = R_NEWS0 (RIntervalNode *, 2 * (old + n));
+	if (!nodes) {
+		return false;
+	}
+	// every node is allocated before the tree changes
+	for (i = 0; i < n; i++) {
+		node = R_NEW0 (RIntervalNode);
+		if (!node) {
+			while (i-- > 0) {
+				free (nodes[old + i]);
+			}
+			free (nodes);
+			return false;
+		}
+		node->start = items[i].start;
+		node->end = items[i].end;
+		node->data = items[i].data;
+		nodes[old + i] = node;
+	}
+	if (n < old / 8) {
+		// a few entries into a big tree
+		for (i = 0; i < n; i++) {
+			RBNode *root = &tree->root->node;
+			node = nodes[old + i];
+			bool r = r_rbtree_aug_insert (&root, &node->start, &node->node, cmp, NULL, node_max);
+			tree->root = unwrap (root);
+			if (!r) {
+				break;
+			}
+		}
+		if (i < n) {
+			// take the ones already in back out, the caller still owns all the data
+			for (j = 0; j < i; j++) {
+				r_interval_tree_delete (tree, nodes[old + j], false);
+			}
+			for (; i < n; i++) {
+				free (nodes[old + i]);
+			}
+			free (nodes);
+			return false;
+		}
+		free (nodes);
+		return true;
+	}
+	RIntervalNode **merged = nodes + old + n;
+	i = 0;
+	if (tree->root) {
+		r_rbtree_foreach (&tree->root->node, it, node, RIntervalNode, node) {
+			nodes[i++] = node;
+		}
+	}
+	for (i = 0, j = old, k = 0; k < old + n; k++) {
+		if (i < old && (j == old + n || nodes[i]->start <= nodes[j]->start)) {
+			merged[k] = nodes[i++];
+		} else {
+			merged[k] = nodes[j++];
+		}
+	}
+	int red_depth = 0;
+	for (k = old + n; k > 1; k >>= 1) {
+		red_depth++;
+	}
+	tree->root = build (merged, 0, old + n, 0, red_depth);
+	free (nodes);
+	return true;
+}
+
 R_API bool r_interval_tree_delete(RIntervalTree *tree, RIntervalNode *node, bool free) {
 	RBNode *root = &tree->root->node;
 	RBIter path_cache = { 0 };
@@ -0,0 +1,113 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_util.h>
+
+#define POOL_NODE_ALIGN 8
+#define POOL_DEFAULT_SIZE 256
+#define POOL_DEFAULT_COUNT 16
+
+// Fixed-size node allocator. Nodes are carved out of big chunks and
+// recycled through a free list, so hot objects don't hit malloc each
+// time and all of them go away at once on r_mem_pool_deinit().
+//
+// Pools are not thread-safe: the free list and the chunk array are
+// updated without locks, so a pool shared between threads must be
+// serialized by its owner.
+
+R_API RMemoryPool *r_mem_pool_new(int nodesize, int poolsize, int poolcount) {
+	r_return_val_if_fail (nodesize > 0, NULL);
+	RMemoryPool *pool = R_NEW0 (RMemoryPool);
+	if (!pool) {
+		return NULL;
+	}
+	nodesize = R_MAX (nodesize, (int)sizeof (void *));
+	pool->nodesize = R_ROUND (nodesize, POOL_NODE_ALIGN);
+	pool->poolsize = poolsize > 0? poolsize: POOL_DEFAULT_SIZE;
+	pool->poolcount = poolcount > 0? poolcount: POOL_DEFAULT_COUNT;
+	pool->nodes = R_NEWS0 (ut8 *, pool->poolcount);
+	if (!pool->nodes) {
+		free (pool);
+		return NULL;
+	}
+	return pool;
+}
+
+// Free all chunks at once, invalidating every node handed out so far.
+R_API RMemoryPool *r_mem_pool_deinit(RMemoryPool *pool) {
+	if (pool) {
+		int i;
+		for (i = 0; i < pool->npool; i++) {
+			free (pool->nodes[i]);
+			pool->nodes[i] = NULL;
+		}
+		pool->npool = 0;
+		pool->ncount = 0;
+		pool->freelist = NULL;
+		pool->live = 0;
+	}
+	return pool;
+}
+
+R_API RMemoryPool *r_mem_pool_free(RMemoryPool *pool) {
+	if (pool) {
+		r_mem_pool_deinit (pool);
+		free (pool->nodes);
+		free (pool);
+	}
+	return NULL;
+}
+
+static bool pool_grow(RMemoryPool *pool) {
+	if (pool->npool == pool->poolcount) {
+		int count = pool->poolcount * 2;
+		ut8 **nodes = realloc (pool->nodes, count * sizeof (ut8 *));
+		if (!nodes) {
+			return false;
+		}
+		memset (nodes + pool->poolcount, 0, (count - pool->poolcount) * sizeof (ut8 *));
+		pool->nodes = nodes;
+		pool->poolcount = count;
+	}
+	ut8 *chunk = malloc ((size_t)pool->nodesize * pool->poolsize);
+	if (!chunk) {
+		return false;
+	}
+	pool->nodes[pool->npool++] = chunk;
+	pool->ncount = 0;
+	return true;
+}
+
+// Returns a zero-filled node
+R_API void *r_mem_pool_alloc(RMemoryPool *pool) {
+	r_return_val_if_fail (pool, NULL);
+	void *p = pool->freelist;
+	if (p) {
+		pool->freelist = *(void **)p;
+	} else {
+		if (!pool->npool || pool->ncount == pool->poolsize) {
+			if (!pool_grow (pool)) {
+				return NULL;
+			}
+		}
+		p = pool->nodes[pool->npool - 1] + (size_t)pool->ncount * pool->nodesize;
+		pool->ncount++;
+	}
+	memset (p, 0, pool->nodesize);
+	pool->allocs++;
+	pool->live++;
+	if (pool->live > pool->peak) {
+		pool->peak = pool->live;
+	}
+	return p;
+}
+
+// Give a node back to the pool it was allocated from
+R_API void r_mem_pool_release(RMemoryPool *pool, void *p) {
+	r_return_if_fail (pool);
+	if (!p) {
+		return;
+	}
+	*(void **)p = pool->freelist;
+	pool->freelist = p;
+	pool->live--;
+}
@@ -2,6 +2,10 @@
 
 #include "r_util/r_str_constpool.h"
 
+// the value of every key is its reference count, or PINNED when it must
+// stay until the pool is gone
+#define PINNED ((void *)SIZE_MAX)
+
 static void kv_fini(HtPPKv *kv) {
 	free (kv->key);
 }
@@ -15,18 +19,68 @@ R_API void r_str_constpool_fini(RStrConstPool *pool) {
 	ht_pp_free (pool->ht);
 }
 
+static HtPPKv *constpool_kv(RStrConstPool *pool, const char *str, void *value) {
+	HtPPKv *kv = ht_pp_find_kv (pool->ht, str, NULL);
+	if (kv) {
+		return kv;
+	}
+	ht_pp_insert (pool->ht, str, value);
+	return ht_pp_find_kv (pool->ht, str, NULL);
+}
+
 R_API const char *r_str_constpool_get(RStrConstPool *pool, const char *str) {
 	if (!str) {
 		return NULL;
 	}
-	HtPPKv *kv = ht_pp_find_kv (pool->ht, str, NULL);
-	if (kv) {
-		return kv->key;
-	}
-	ht_pp_insert (pool->ht, str, NULL);
-	kv = ht_pp_find_kv (pool->ht, str, NULL);
+	HtPPKv *kv = constpool_kv (pool, str, PINNED);
 	if (kv) {
+		kv->value = PINNED;
 		return kv->key;
 	}
 	return NULL;
 }
+
+R_API const char *r_str_constpool_ref(RStrConstPool *pool, const char *str) {
+	if (!str) {
+		return NULL;
+	}
+	HtPPKv *kv = constpool_kv (pool, str, NULL);
+	if (!kv) {
+		return NULL;
+	}
+	if (kv->value != PINNED) {
+		kv->value = (void *)((size_t)kv->value + 1);
+	}
+	return kv->key;
+}
+
+R_API void r_str_constpool_unref(RStrConstPool *pool, const char *str) {
+	if (!str) {
+		return;
+	}
+	HtPPKv *kv = ht_pp_find_kv (pool->ht, str, NULL);
+	if (!kv || kv->value == PINNED) {
+		return;
+	}
+	if ((size_t)kv->value > 1) {
+		kv->value = (void *)((size_t)kv->value - 1);
+	} else {
+		ht_pp_delete (pool->ht, str);
+	}
+}
+
+static bool stats_cb(void *user, const void *key, const void *value) {
+	RStrConstPoolStats *stats = user;
+	size_t size = strlen (key) + 1;
+	size_t refs = value == PINNED? 1: (size_t)value;
+	stats->strings++;
+	stats->refs += refs;
+	stats->bytes += size;
+	stats->saved += (refs - 1) * size;
+	return true;
+}
+
+R_API void r_str_constpool_stats(RStrConstPool *pool, RStrConstPoolStats *stats) {
+	memset (stats, 0, sizeof (*stats));
+	ht_pp_foreach (pool->ht, stats_cb, stats);
+}
@@ -81,6 +81,11 @@ EXT_SO=.dll
 LDFLAGS_SHARED=-shared
 endif
 
+# concurrent hashtables use pthread rwlocks
+ifneq (${OS},w32)
+LDFLAGS+=-pthread
+endif
+
 # create .d files
 ifeq (,$(findstring tcc,${CC}))
 CFLAGS+=-MMD
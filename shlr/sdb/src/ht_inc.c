@@ -16,6 +16,156 @@ static const ut32 ht_primes_sizes[] = {
 	4166287, 4999559, 5999471, 7199369
 };
 
+/*
+ * Concurrent hashtables.
+ *
+ * Ht_(set_concurrent) gives the hashtable HT_LOCK_STRIPES reader/writer
+ * locks, bucket i is guarded by stripe i % HT_LOCK_STRIPES. Lookups and
+ * writes only take the stripe of the key, shared or exclusive, so threads
+ * only wait for each other when they touch the same stripe. Growing,
+ * foreach and update_key take every stripe exclusive, the thread holding
+ * them can keep using the hashtable (e.g. from foreach callbacks).
+ * A lookup picks its stripe from the size it read before locking, and
+ * retries if the table grew meanwhile.
+ *
+ * Only the table is protected: values returned by find are not, so
+ * whoever deletes entries that other threads may still be reading has
+ * to make sure they are not freed under their feet.
+ */
+#ifndef SDB_HT_LOCKS
+#define SDB_HT_LOCKS 1
+
+#define HT_LOCK_STRIPES 64
+
+#if __SDB_WINDOWS__
+#define HT_HAVE_LOCKS 1
+#define HT_RWLOCK_T SRWLOCK
+#define HT_TID_T DWORD
+#define ht_rwlock_init(l) InitializeSRWLock (l)
+#define ht_rwlock_fini(l)
+#define ht_rdlock(l) AcquireSRWLockShared (l)
+#define ht_rdunlock(l) ReleaseSRWLockShared (l)
+#define ht_wrlock(l) AcquireSRWLockExclusive (l)
+#define ht_wrunlock(l) ReleaseSRWLockExclusive (l)
+#define ht_tid() GetCurrentThreadId ()
+#define ht_atomic_add(p, n) InterlockedExchangeAdd ((volatile LONG *)(p), (LONG)(n))
+#define ht_atomic_get(p) InterlockedCompareExchange ((volatile LONG *)(p), 0, 0)
+#define ht_atomic_set(p, v) InterlockedExchange ((volatile LONG *)(p), (LONG)(v))
+#elif __wasi__ || __EMSCRIPTEN__
+#define HT_HAVE_LOCKS 0
+#define ht_atomic_add(p, n) (*(p) += (n))
+#define ht_atomic_get(p) (*(p))
+#define ht_atomic_set(p, v) (*(p) = (v))
+#else
+#include <pthread.h>
+#define HT_HAVE_LOCKS 1
+#define HT_RWLOCK_T pthread_rwlock_t
+#define HT_TID_T pthread_t
+#define ht_rwlock_init(l) pthread_rwlock_init (l, NULL)
+#define ht_rwlock_fini(l) pthread_rwlock_destroy (l)
+#define ht_rdlock(l) pthread_rwlock_rdlock (l)
+#define ht_rdunlock(l) pthread_rwlock_unlock (l)
+#define ht_wrlock(l) pthread_rwlock_wrlock (l)
+#define ht_wrunlock(l) pthread_rwlock_unlock (l)
+#define ht_tid() pthread_self ()
+#define ht_atomic_add(p, n) __atomic_add_fetch ((p), (n), __ATOMIC_RELAXED)
+#define ht_atomic_get(p) __atomic_load_n ((p), __ATOMIC_RELAXED)
+#define ht_atomic_set(p, v) __atomic_store_n ((p), (v), __ATOMIC_RELAXED)
+#endif
+
+#if HT_HAVE_LOCKS
+typedef struct ht_locks_t {
+	HT_RWLOCK_T stripe[HT_LOCK_STRIPES];
+	HT_TID_T owner; // thread holding every stripe, if any
+} HtLocks;
+#else
+typedef struct ht_locks_t HtLocks;
+#endif
+
+typedef struct {
+	HtLocks *locks; // NULL when nothing was taken
+	ut32 stripe;
+	bool write;
+} HtHeld;
+
+static HtLocks *ht_locks_new(void) {
+#if HT_HAVE_LOCKS
+	HtLocks *l = calloc (1, sizeof (HtLocks));
+	if (l) {
+		int i;
+		for (i = 0; i < HT_LOCK_STRIPES; i++) {
+			ht_rwlock_init (&l->stripe[i]);
+		}
+	}
+	return l;
+#else
+	return NULL;
+#endif
+}
+
+static void ht_locks_free(HtLocks *l) {
+#if HT_HAVE_LOCKS
+	if (l) {
+		int i;
+		for (i = 0; i < HT_LOCK_STRIPES; i++) {
+			ht_rwlock_fini (&l->stripe[i]);
+		}
+		free (l);
+	}
+#endif
+}
+
+static inline bool ht_locks_owned(HtLocks *l) {
+#if HT_HAVE_LOCKS
+	HT_TID_T owner = ht_atomic_get (&l->owner);
+	return owner && owner == ht_tid ();
+#else
+	return true;
+#endif
+}
+
+// takes every stripe exclusive, false if there is nothing to release later
+static bool ht_lock_table(HtLocks *l) {
+#if HT_HAVE_LOCKS
+	if (l && !ht_locks_owned (l)) {
+		int i;
+		// always in the same order, so two of these can't deadlock
+		for (i = 0; i < HT_LOCK_STRIPES; i++) {
+			ht_wrlock (&l->stripe[i]);
+		}
+		ht_atomic_set (&l->owner, ht_tid ());
+		return true;
+	}
+#endif
+	return false;
+}
+
+static void ht_unlock_table(HtLocks *l) {
+#if HT_HAVE_LOCKS
+	int i;
+	ht_atomic_set (&l->owner, 0);
+	for (i = HT_LOCK_STRIPES - 1; i >= 0; i--) {
+		ht_wrunlock (&l->stripe[i]);
+	}
+#endif
+}
+
+static void ht_unlock_stripe(HtHeld *h) {
+#if HT_HAVE_LOCKS
+	if (!h->locks) {
+		return;
+	}
+	if (h->write) {
+		ht_wrunlock (&h->locks->stripe[h->stripe]);
+	} else {
+		ht_rdunlock (&h->locks->stripe[h->stripe]);
+	}
+	h->locks = NULL;
+#endif
+}
+
+#endif
+
 static inline ut32 hashfn(HtName_(Ht) *ht, const KEY_TYPE k) {
 	return ht->opt.hashfn ? ht->opt.hashfn (k) : KEY_TO_HASH (k);
 }
@@ -89,6 +239,48 @@ static inline HT_(Kv) *next_kv(HtName_(Ht) *ht, HT_(Kv) *kv) {
 		     (j) < (bt)->count;					\
 		     (j) = (count) == (ht)->count? j + 1: j, (kv) = (count) == (ht)->count? next_kv (ht, kv): kv, (count) = (ht)->count)
 
+static inline void count_add(HtName_(Ht) *ht, int n) {
+#if HT_HAVE_LOCKS
+	if (ht->locks) {
+		ht_atomic_add (&ht->count, n);
+		return;
+	}
+#endif
+	ht->count += n;
+}
+
+// takes the stripe of key's bucket
+static inline HtHeld lock_key(HtName_(Ht) *ht, const KEY_TYPE key, bool write) {
+	HtHeld h = { NULL, 0, write };
+#if HT_HAVE_LOCKS
+	HtLocks *l = ht->locks;
+	if (!l || ht_locks_owned (l)) {
+		return h;
+	}
+	const ut32 hash = hashfn (ht, key);
+	for (;;) {
+		const ut32 size = ht_atomic_get (&ht->size);
+		h.stripe = (hash % size) % HT_LOCK_STRIPES;
+		if (write) {
+			ht_wrlock (&l->stripe[h.stripe]);
+		} else {
+			ht_rdlock (&l->stripe[h.stripe]);
+		}
+		// growing holds every stripe, so the size can't change from here on
+		if (ht->size == size) {
+			break;
+		}
+		if (write) {
+			ht_wrunlock (&l->stripe[h.stripe]);
+		} else {
+			ht_rdunlock (&l->stripe[h.stripe]);
+		}
+	}
+	h.locks = l;
+#endif
+	return h;
+}
+
 // Create a new hashtable and return a pointer to it.
 // size - number of buckets in the hashtable
 // hashfunction - the function that does the hashing, must not be null.
@@ -144,6 +336,7 @@ SDB_API void Ht_(free)(HtName_(Ht)* ht) {
 		free (bt->arr);
 	}
 	free (ht->table);
+	ht_locks_free (ht->locks);
 	free (ht);
 }
 
@@ -171,10 +364,16 @@ static void internal_ht_grow(HtName_(Ht)* ht) {
 			Ht_(insert_kv) (ht2, kv, false);
 		}
 	}
-	// And now swap the internals.
+	// And now swap the buckets, the locks stay where they are
 	swap = *ht;
-	*ht = *ht2;
-	*ht2 = swap;
+	ht_atomic_set (&ht->size, ht2->size);
+	ht->count = ht2->count;
+	ht->table = ht2->table;
+	ht->prime_idx = ht2->prime_idx;
+	ht2->size = swap.size;
+	ht2->count = swap.count;
+	ht2->table = swap.table;
+	ht2->prime_idx = swap.prime_idx;
 
 	ht2->opt.freefn = NULL;
 	Ht_(free) (ht2);
@@ -186,6 +385,22 @@ static void check_growing(HtName_(Ht) *ht) {
 	}
 }
 
+// releases the locks taken for a write and grows the hashtable if needed
+static void unlock_write(HtName_(Ht) *ht, HtHeld *h, bool inserted) {
+	if (!h->locks) {
+		if (inserted) {
+			check_growing (ht);
+		}
+		return;
+	}
+	bool grow = inserted && ht_atomic_get (&ht->count) >= LOAD_FACTOR * ht_atomic_get (&ht->size);
+	ht_unlock_stripe (h);
+	if (grow && ht_lock_table (ht->locks)) {
+		check_growing (ht);
+		ht_unlock_table (ht->locks);
+	}
+}
+
 static HT_(Kv) *reserve_kv(HtName_(Ht) *ht, const KEY_TYPE key, const int key_len, bool update) {
 	HT_(Bucket) *bt = &ht->table[bucketfn (ht, key)];
 	HT_(Kv) *kvtmp;
@@ -208,22 +423,21 @@ static HT_(Kv) *reserve_kv(HtName_(Ht) *ht, const KEY_TYPE key, const int key_le
 
 	bt->arr = newkvarr;
 	bt->count++;
-	ht->count++;
+	count_add (ht, 1);
 	return kv_at (ht, bt, bt->count - 1);
 }
 
 SDB_API bool Ht_(insert_kv)(HtName_(Ht) *ht, HT_(Kv) *kv, bool update) {
+	HtHeld h = lock_key (ht, kv->key, true);
 	HT_(Kv) *kv_dst = reserve_kv (ht, kv->key, kv->key_len, update);
-	if (!kv_dst) {
-		return false;
+	if (kv_dst) {
+		memcpy (kv_dst, kv, ht->opt.elem_size);
 	}
-
-	memcpy (kv_dst, kv, ht->opt.elem_size);
-	check_growing (ht);
-	return true;
+	unlock_write (ht, &h, kv_dst != NULL);
+	return kv_dst != NULL;
 }
 
-static bool insert_update(HtName_(Ht) *ht, const KEY_TYPE key, VALUE_TYPE value, bool update) {
+static bool put(HtName_(Ht) *ht, const KEY_TYPE key, VALUE_TYPE value, bool update) {
 	ut32 key_len = calcsize_key (ht, key);
 	HT_(Kv)* kv_dst = reserve_kv (ht, key, key_len, update);
 	if (!kv_dst) {
@@ -234,10 +448,16 @@ static bool insert_update(HtName_(Ht) *ht, const KEY_TYPE key, VALUE_TYPE value,
 	kv_dst->key_len = key_len;
 	kv_dst->value = dupval (ht, value);
 	kv_dst->value_len = calcsize_val (ht, value);
-	check_growing (ht);
 	return true;
 }
 
+static bool insert_update(HtName_(Ht) *ht, const KEY_TYPE key, VALUE_TYPE value, bool update) {
+	HtHeld h = lock_key (ht, key, true);
+	bool ret = put (ht, key, value, update);
+	unlock_write (ht, &h, ret);
+	return ret;
+}
+
 // Inserts the key value pair key, value into the hashtable.
 // Doesn't allow for "update" of the value.
 SDB_API bool Ht_(insert)(HtName_(Ht)* ht, const KEY_TYPE key, VALUE_TYPE value) {
@@ -250,17 +470,29 @@ SDB_API bool Ht_(update)(HtName_(Ht)* ht, const KEY_TYPE key, VALUE_TYPE value)
 	return insert_update (ht, key, value, true);
 }
 
-// Update the key of an element that has old_key as key and replace it with new_key
-SDB_API bool Ht_(update_key)(HtName_(Ht)* ht, const KEY_TYPE old_key, const KEY_TYPE new_key) {
+static HT_(Kv) *find_kv(HtName_(Ht)* ht, const KEY_TYPE key) {
+	HT_(Bucket) *bt = &ht->table[bucketfn (ht, key)];
+	ut32 key_len = calcsize_key (ht, key);
+	HT_(Kv) *kv;
+	ut32 j;
+
+	BUCKET_FOREACH (ht, bt, j, kv) {
+		if (is_kv_equal (ht, key, key_len, kv)) {
+			return kv;
+		}
+	}
+	return NULL;
+}
+
+static bool update_key(HtName_(Ht)* ht, const KEY_TYPE old_key, const KEY_TYPE new_key) {
 	// First look for the value associated with old_key
-	bool found;
-	VALUE_TYPE value = Ht_(find) (ht, old_key, &found);
-	if (!found) {
+	HT_(Kv) *old_kv = find_kv (ht, old_key);
+	if (!old_kv) {
 		return false;
 	}
 
 	// Associate the existing value with new_key
-	bool inserted = insert_update (ht, new_key, value, false);
+	bool inserted = put (ht, new_key, old_kv->value, false);
 	if (!inserted) {
 		return false;
 	}
@@ -286,7 +518,7 @@ SDB_API bool Ht_(update_key)(HtName_(Ht)* ht, const KEY_TYPE old_key, const KEY_
 			void *src = next_kv (ht, kv);
 			memmove (kv, src, (bt->count - j - 1) * ht->opt.elem_size);
 			bt->count--;
-			ht->count--;
+			count_add (ht, -1);
 			return true;
 		}
 	}
@@ -294,6 +526,17 @@ SDB_API bool Ht_(update_key)(HtName_(Ht)* ht, const KEY_TYPE old_key, const KEY_
 	return false;
 }
 
+// Update the key of an element that has old_key as key and replace it with new_key
+SDB_API bool Ht_(update_key)(HtName_(Ht)* ht, const KEY_TYPE old_key, const KEY_TYPE new_key) {
+	bool locked = ht_lock_table (ht->locks);
+	bool ret = update_key (ht, old_key, new_key);
+	check_growing (ht);
+	if (locked) {
+		ht_unlock_table (ht->locks);
+	}
+	return ret;
+}
+
 // Returns the corresponding SdbKv entry from the key.
 // If `found` is not NULL, it will be set to true if the entry was found, false
 // otherwise.
@@ -302,36 +545,42 @@ SDB_API HT_(Kv)* Ht_(find_kv)(HtName_(Ht)* ht, const KEY_TYPE key, bool* found)
 		*found = false;
 	}
 	if (!ht) {
-		*found = false;
 		return NULL;
 	}
 
-	HT_(Bucket) *bt = &ht->table[bucketfn (ht, key)];
-	ut32 key_len = calcsize_key (ht, key);
-	HT_(Kv) *kv;
-	ut32 j;
-
-	BUCKET_FOREACH (ht, bt, j, kv) {
-		if (is_kv_equal (ht, key, key_len, kv)) {
-			if (found) {
-				*found = true;
-			}
-			return kv;
-		}
+	HtHeld h = lock_key (ht, key, false);
+	HT_(Kv) *kv = find_kv (ht, key);
+	ht_unlock_stripe (&h);
+	if (kv && found) {
+		*found = true;
 	}
-	return NULL;
+	return kv;
 }
 
 // Looks up the corresponding value from the key.
 // If `found` is not NULL, it will be set to true if the entry was found, false
 // otherwise.
 SDB_API VALUE_TYPE Ht_(find)(HtName_(Ht)* ht, const KEY_TYPE key, bool* found) {
-	HT_(Kv) *res = Ht_(find_kv) (ht, key, found);
-	return res ? res->value : HT_NULL_VALUE;
+	if (found) {
+		*found = false;
+	}
+	if (!ht) {
+		return HT_NULL_VALUE;
+	}
+
+	HtHeld h = lock_key (ht, key, false);
+	HT_(Kv) *kv = find_kv (ht, key);
+	VALUE_TYPE res = kv ? kv->value : HT_NULL_VALUE;
+	ht_unlock_stripe (&h);
+	if (kv && found) {
+		*found = true;
+	}
+	return res;
 }
 
 // Deletes a entry from the hash table from the key, if the pair exists.
 SDB_API bool Ht_(delete)(HtName_(Ht)* ht, const KEY_TYPE key) {
+	HtHeld h = lock_key (ht, key, true);
 	HT_(Bucket) *bt = &ht->table[bucketfn (ht, key)];
 	ut32 key_len = calcsize_key (ht, key);
 	HT_(Kv) *kv;
@@ -343,14 +592,17 @@ SDB_API bool Ht_(delete)(HtName_(Ht)* ht, const KEY_TYPE key) {
 			void *src = next_kv (ht, kv);
 			memmove (kv, src, (bt->count - j - 1) * ht->opt.elem_size);
 			bt->count--;
-			ht->count--;
+			count_add (ht, -1);
+			ht_unlock_stripe (&h);
 			return true;
 		}
 	}
+	ht_unlock_stripe (&h);
 	return false;
 }
 
 SDB_API void Ht_(foreach)(HtName_(Ht) *ht, HT_(ForeachCallback) cb, void *user) {
+	bool locked = ht_lock_table (ht->locks);
 	ut32 i;
 
 	for (i = 0; i < ht->size; ++i) {
@@ -360,8 +612,24 @@ SDB_API void Ht_(foreach)(HtName_(Ht) *ht, HT_(ForeachCallback) cb, void *user)
 
 		BUCKET_FOREACH_SAFE (ht, bt, j, count, kv) {
 			if (!cb (user, kv->key, kv->value)) {
-				return;
+				goto beach;
 			}
 		}
 	}
+beach:
+	if (locked) {
+		ht_unlock_table (ht->locks);
+	}
+}
+
+SDB_API bool Ht_(set_concurrent)(HtName_(Ht) *ht, bool enable) {
+	if (!enable) {
+		ht_locks_free (ht->locks);
+		ht->locks = NULL;
+		return true;
+	}
+	if (!ht->locks) {
+		ht->locks = ht_locks_new ();
+	}
+	return ht->locks != NULL;
 }
@@ -75,6 +75,8 @@ typedef struct Ht_(options_t) {
 	size_t elem_size;		// Size of each HtKv element (useful for subclassing like SdbKv)
 } HT_(Options);
 
+struct ht_locks_t;
+
 /* Ht is the hashtable structure */
 typedef struct Ht_(t) {
 	ut32 size;	  // size of the hash table in buckets.
@@ -82,6 +84,7 @@ typedef struct Ht_(t) {
 	HT_(Bucket)* table;  // Actual table.
 	ut32 prime_idx;
 	HT_(Options) opt;
+	struct ht_locks_t *locks; // NULL unless the hashtable is concurrent
 } HtName_(Ht);
 
 // Create a new Ht with the provided Options
@@ -102,7 +105,12 @@ SDB_API VALUE_TYPE Ht_(find)(HtName_(Ht)* ht, const KEY_TYPE key, bool* found);
 // If the cb returns false, the iteration is stopped.
 // cb should not modify the hashtable.
 // NOTE: cb can delete the current element, but it should be avoided
+// On concurrent hashtables the other threads wait for the iteration to end.
 SDB_API void Ht_(foreach)(HtName_(Ht) *ht, HT_(ForeachCallback) cb, void *user);
 
+// On concurrent hashtables the Kv is only valid until another thread writes to it.
 SDB_API HT_(Kv)* Ht_(find_kv)(HtName_(Ht)* ht, const KEY_TYPE key, bool* found);
 SDB_API bool Ht_(insert_kv)(HtName_(Ht) *ht, HT_(Kv) *kv, bool update);
+// Make the hashtable safe (or not) to use from several threads at once.
+// Call it before sharing the hashtable. Returns false if threads are not supported.
+SDB_API bool Ht_(set_concurrent)(HtName_(Ht) *ht, bool enable);
@@ -0,0 +1 @@
+#define SDB_VERSION "1.5.1-git"
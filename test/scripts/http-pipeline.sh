@@ -0,0 +1,13 @@
+#!/bin/bash
+# start an http server with connection workers and send it three pipelined
+# requests over a single keep-alive connection, the last one stops it
+PORT=${1:-9391}
+radare2 -N -q -e http.root=. -e http.port=$PORT -e http.workers=2 -e http.sandbox=false -c =h malloc://32 2>/dev/null &
+for i in $(seq 50); do
+	(exec 3<>/dev/tcp/127.0.0.1/$PORT) 2>/dev/null && break
+	sleep 0.1
+done
+exec 3<>/dev/tcp/127.0.0.1/$PORT
+printf "GET /cmd/?e%%20one HTTP/1.1\r\n\r\nGET /cmd/?e%%20two HTTP/1.1\r\n\r\nGET /cmd/=h-- HTTP/1.1\r\nConnection: close\r\n\r\n" >&3
+tr -d '\r' <&3
+wait
@@ -0,0 +1,20 @@
+#!/bin/bash
+# a slow read-only command must not hold the answer to another client
+PORT=${1:-9392}
+radare2 -N -q -e http.root=. -e http.port=$PORT -e http.workers=2 -e http.sandbox=false -c =h malloc://0x1000000 2>/dev/null &
+for i in $(seq 50); do
+	(exec 3<>/dev/tcp/127.0.0.1/$PORT) 2>/dev/null && break
+	sleep 0.1
+done
+exec 3<>/dev/tcp/127.0.0.1/$PORT
+printf "GET /cmd/pc%%200x1000000 HTTP/1.1\r\nConnection: close\r\n\r\n" >&3
+(tr -d '\r' <&3 | grep -c 0x00 | sed 's/^/slow /') &
+sleep 0.2
+exec 4<>/dev/tcp/127.0.0.1/$PORT
+printf "GET /cmd/?e%%20fast HTTP/1.1\r\nConnection: close\r\n\r\n" >&4
+tr -d '\r' <&4 | tail -n 1
+wait %2
+exec 5<>/dev/tcp/127.0.0.1/$PORT
+printf "GET /cmd/=h-- HTTP/1.1\r\nConnection: close\r\n\r\n" >&5
+cat <&5 >/dev/null
+wait
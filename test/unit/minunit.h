@@ -54,6 +54,12 @@ void sprint_mem(char *out, const ut8 *buf, size_t len) {
 
 #define mu_ignore do { printf(TYELLOW "IGN\n" TRESET); return MU_PASSED; } while(0)
 
+// benchmarks only run when R2_BENCH is set, to keep the default run quick and quiet
+#define mu_bench_only do { \
+		const char *bench__ = getenv ("R2_BENCH"); \
+		if (!bench__ || !*bench__) { mu_ignore; } \
+	} while(0)
+
 #define mu_end do { \
 		printf(TGREEN "OK\n" TRESET); \
 		return MU_PASSED; \
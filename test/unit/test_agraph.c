@@ -99,8 +99,93 @@ bool test_graph_to_agraph() {
 	mu_end;
 }
 
+static void build_big_cfg(RAGraph *g, int n_blocks) {
+	RANode **bb = R_NEWS0 (RANode *, n_blocks);
+	char title[32];
+	int i, j;
+
+	for (i = 0; i < n_blocks; i++) {
+		snprintf (title, sizeof (title), "0x%08x", 0x1000 + i * 0x10);
+		bb[i] = r_agraph_add_node (g, title, "mov eax, ebx\ncmp eax, 1\njne 0x1337\n");
+	}
+	for (i = 0; i + 1 < n_blocks; i++) {
+		if (i % 100 == 0 && i + 40 < n_blocks) {
+			/* switch dispatcher with 32 cases falling through to a join block */
+			for (j = 1; j <= 32; j++) {
+				r_agraph_add_edge (g, bb[i], bb[i + j]);
+				r_agraph_add_edge (g, bb[i + j], bb[i + 33]);
+			}
+			i += 32;
+			continue;
+		}
+		r_agraph_add_edge (g, bb[i], bb[i + 1]);
+		if (i % 7 == 0 && i + 3 < n_blocks) {
+			r_agraph_add_edge (g, bb[i], bb[i + 3]);
+		}
+		if (i % 13 == 0 && i > 20) {
+			/* loop back edge */
+			r_agraph_add_edge (g, bb[i], bb[i - 20]);
+		}
+	}
+	free (bb);
+}
+
+bool test_agraph_layout_big() {
+	r_cons_new ();
+	RConsCanvas *can = r_cons_canvas_new (1, 1);
+	RAGraph *g = r_agraph_new (can);
+	mu_assert_notnull (g, "Couldn't create the graph");
+
+	build_big_cfg (g, 3000);
+	r_agraph_layout (g);
+	RANode *first = r_agraph_get_node (g, "0x00001000");
+	RANode *last = r_agraph_get_node (g, "0x0000cb70");
+	mu_assert_notnull (first, "first block");
+	mu_assert_notnull (last, "last block");
+	mu_assert ("last block is below the entry", last->y > first->y);
+	const int x = first->x, y = last->y;
+	mu_assert_notnull (g->layout_cache, "layout cached");
+
+	/* same graph again: the layout is served from the cache */
+	r_agraph_reset (g);
+	build_big_cfg (g, 3000);
+	r_agraph_layout (g);
+	first = r_agraph_get_node (g, "0x00001000");
+	last = r_agraph_get_node (g, "0x0000cb70");
+	mu_assert_eq (first->x, x, "cached x position");
+	mu_assert_eq (last->y, y, "cached y position");
+
+	r_agraph_free (g);
+	r_cons_free ();
+	mu_end;
+}
+
+bool test_agraph_layout_bench() {
+	mu_bench_only;
+	const int n_blocks = 3000;
+	r_cons_new ();
+	RConsCanvas *can = r_cons_canvas_new (1, 1);
+	RAGraph *g = r_agraph_new (can);
+	build_big_cfg (g, n_blocks);
+	ut64 t0 = r_time_now_mono ();
+	r_agraph_layout (g);
+	ut64 t1 = r_time_now_mono ();
+	eprintf ("layout of %d blocks: %.3fs\n", n_blocks, (double)(t1 - t0) / R_USEC_PER_SEC);
+	r_agraph_reset (g);
+	build_big_cfg (g, n_blocks);
+	t0 = r_time_now_mono ();
+	r_agraph_layout (g);
+	t1 = r_time_now_mono ();
+	eprintf ("cached relayout: %.3fs\n", (double)(t1 - t0) / R_USEC_PER_SEC);
+	r_agraph_free (g);
+	r_cons_free ();
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test (test_graph_to_agraph);
+	mu_run_test (test_agraph_layout_big);
+	mu_run_test (test_agraph_layout_bench);
 	return tests_passed != tests_run;
 }
 
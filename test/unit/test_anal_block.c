@@ -486,6 +486,130 @@ bool addr_list_cb(ut64 addr, void *user) {
 	return true;
 }
 
+static bool sorted_cb(RAnalBlock *block, void *user) {
+	ut64 *prev = user;
+	if (block->addr < *prev) {
+		*prev = UT64_MAX;
+		return false;
+	}
+	*prev = block->addr;
+	return true;
+}
+
+bool test_r_anal_block_index() {
+	RAnal *anal = r_anal_new ();
+	size_t i;
+	for (i = 0; i < 0x1000; i++) {
+		r_anal_create_block (anal, i * 0x10, 0x20);
+	}
+	mu_assert_eq (anal->bb_index.count, 0, "index not built while mutating");
+
+	// enough lookups without mutations make the index kick in
+	for (i = 0; i < 0x1000; i++) {
+		ut64 prev = 0;
+		r_anal_blocks_foreach_in (anal, i * 0x10 + 8, sorted_cb, &prev);
+		mu_assert ("blocks in address order", prev != UT64_MAX);
+		RList *in = r_anal_get_blocks_in (anal, i * 0x10 + 8);
+		mu_assert_eq (r_list_length (in), i? 2: 1, "blocks in");
+		r_list_free (in);
+	}
+	mu_assert_eq (anal->bb_index.count, 0x1000, "index built");
+	mu_assert_eq (anal->bb_index.epoch, anal->bb_epoch, "index up to date");
+
+	// any mutation invalidates it
+	RAnalBlock *block = r_anal_get_block_at (anal, 0x100);
+	r_anal_block_set_size (block, 0x100);
+	mu_assert ("index stale", anal->bb_index.epoch != anal->bb_epoch);
+	RList *in = r_anal_get_blocks_in (anal, 0x1f8);
+	mu_assert_eq (r_list_length (in), 3, "resized block found from stale index");
+	r_list_free (in);
+
+	// the index answers like a linear scan of the blocks
+	for (i = 0; i < 0x2000; i++) {
+		ut64 addr = (i * 0x1337) % 0x10010;
+		size_t j, expected = 0;
+		for (j = 0; j < 0x1000; j++) {
+			ut64 size = j == 0x10? 0x100: 0x20;
+			expected += j * 0x10 <= addr && addr < j * 0x10 + size;
+		}
+		ut64 prev = 0;
+		mu_assert ("lookups in order", r_anal_blocks_foreach_in (anal, addr, sorted_cb, &prev));
+		in = r_anal_get_blocks_in (anal, addr);
+		mu_assert_eq ((size_t)r_list_length (in), expected, "blocks in from the index");
+		r_list_free (in);
+	}
+	mu_assert_eq (anal->bb_index.epoch, anal->bb_epoch, "index rebuilt");
+
+	for (i = 0; i < 0x1000; i++) {
+		r_anal_block_unref (r_anal_get_block_at (anal, i * 0x10));
+	}
+	assert_leaks (anal);
+	r_anal_free (anal);
+	mu_end;
+}
+
+static bool count_cb(RAnalBlock *block, void *user) {
+	(*(int *)user)++;
+	return true;
+}
+
+bool test_r_anal_block_intersect_end() {
+	RAnal *anal = r_anal_new ();
+	RAnalBlock *a = r_anal_create_block (anal, 0x1000, 0x20);
+	RAnalBlock *b = r_anal_create_block (anal, 0xffffffffffffff00ULL, 0x80);
+	size_t i;
+	for (i = 0; i < 2; i++) {
+		// ranges wrapping around the address space are clamped, from the tree and from the index
+		int count = 0;
+		r_anal_blocks_foreach_intersect (anal, 0xffffffffffffff40ULL, 0x1000, count_cb, &count);
+		mu_assert_eq (count, 1, "range past UT64_MAX");
+		count = 0;
+		r_anal_blocks_foreach_intersect (anal, 0xffffffffffffff80ULL, UT64_MAX, count_cb, &count);
+		mu_assert_eq (count, 0, "after the last block");
+		count = 0;
+		r_anal_blocks_foreach_intersect (anal, 0x1010, UT64_MAX, count_cb, &count);
+		mu_assert_eq (count, 2, "up to UT64_MAX");
+		RList *list = r_anal_get_blocks_intersect (anal, 0xfffffffffffffff0ULL, 0x20);
+		mu_assert_eq (r_list_length (list), 0, "wrapped range does not match the start");
+		r_list_free (list);
+		// enough lookups build the index for the second round
+		size_t j;
+		for (j = 0; j < 0x100; j++) {
+			r_anal_blocks_foreach_in (anal, 0x1000, count_cb, &count);
+		}
+		mu_assert_eq (anal->bb_index.epoch, anal->bb_epoch, "index built");
+	}
+	r_anal_block_unref (a);
+	r_anal_block_unref (b);
+	assert_leaks (anal);
+	r_anal_free (anal);
+	mu_end;
+}
+
+bool test_r_anal_block_index_bench() {
+	mu_bench_only;
+	RAnal *anal = r_anal_new ();
+	size_t i;
+	for (i = 0; i < 0x1000; i++) {
+		r_anal_create_block (anal, i * 0x10, 0x20);
+	}
+	const size_t lookups = 1000000;
+	size_t found = 0;
+	ut64 start = r_time_now_mono ();
+	for (i = 0; i < lookups; i++) {
+		ut64 prev = 0;
+		found += !r_anal_blocks_foreach_in (anal, (i * 0x1337) % 0x10000, sorted_cb, &prev);
+	}
+	ut64 elapsed = R_MAX (r_time_now_mono () - start, 1);
+	mu_assert_eq (found, 0, "lookups in order");
+	printf ("r_anal_blocks_foreach_in: %"PFMT64u" lookups/s\n", (ut64)lookups * 1000000 / elapsed);
+	for (i = 0; i < 0x1000; i++) {
+		r_anal_block_unref (r_anal_get_block_at (anal, i * 0x10));
+	}
+	r_anal_free (anal);
+	mu_end;
+}
+
 bool test_r_anal_block_successors() {
 	RAnal *anal = r_anal_new ();
 	assert_invariants (anal);
@@ -682,6 +806,9 @@ int all_tests() {
 	mu_run_test (test_r_anal_block_set_size);
 	mu_run_test (test_r_anal_block_relocate);
 	mu_run_test (test_r_anal_block_query);
+	mu_run_test (test_r_anal_block_index);
+	mu_run_test (test_r_anal_block_intersect_end);
+	mu_run_test (test_r_anal_block_index_bench);
 	mu_run_test (test_r_anal_block_successors);
 	mu_run_test (test_r_anal_block_automerge);
 	return tests_passed != tests_run;
@@ -333,8 +333,31 @@ bool test_r_anal_hints_##name() { \
 RANGED_TEST(arch, "6502", NULL, mu_assert_nullable_streq)
 RANGED_TEST(bits, 16, 0, mu_assert_eq)
 
+bool test_r_anal_hints_changes() {
+	RAnal *anal = r_anal_new ();
+	ut64 epoch = anal->hint_epoch;
+	r_anal_hint_set_esil (anal, 0x100, "1,r16,=");
+	mu_assert_eq (anal->hint_epoch, epoch + 1, "new hint is one change");
+	r_anal_hint_set_esil (anal, 0x100, "1,r16,=");
+	mu_assert_eq (anal->hint_epoch, epoch + 1, "same string");
+	r_anal_hint_set_esil (anal, 0x100, "2,r16,=");
+	mu_assert_eq (anal->hint_epoch, epoch + 2, "other string of the same length");
+	r_anal_hint_set_jump (anal, 0x100, 0x200);
+	mu_assert_eq (anal->hint_epoch, epoch + 3, "new jump hint");
+	r_anal_hint_set_jump (anal, 0x100, 0x200);
+	mu_assert_eq (anal->hint_epoch, epoch + 3, "same jump");
+	r_anal_hint_set_jump (anal, 0x100, 0x300);
+	mu_assert_eq (anal->hint_epoch, epoch + 4, "other jump");
+	r_anal_hint_set_high (anal, 0x100);
+	r_anal_hint_set_high (anal, 0x100);
+	mu_assert_eq (anal->hint_epoch, epoch + 5, "high set once");
+	r_anal_free (anal);
+	mu_end;
+}
+
 bool all_tests() {
 	mu_run_test(test_r_anal_addr_hints);
+	mu_run_test(test_r_anal_hints_changes);
 	mu_run_test(test_r_anal_hints_arch);
 	mu_run_test(test_r_anal_hints_bits);
 	return tests_passed != tests_run;
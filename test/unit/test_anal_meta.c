@@ -591,6 +591,102 @@ bool test_meta_spaces() {
 	mu_end;
 }
 
+bool test_meta_bulk() {
+	RAnal *anal = r_anal_new ();
+	r_meta_set_string (anal, R_META_TYPE_COMMENT, 0x100, "old");
+
+	r_meta_bulk_begin (anal);
+	r_meta_set_string (anal, R_META_TYPE_COMMENT, 0x100, "merged");
+	r_meta_set (anal, R_META_TYPE_DATA, 0x200, 4, NULL);
+	r_meta_set (anal, R_META_TYPE_DATA, 0x200, 8, NULL);
+	r_meta_bulk_begin (anal);
+	r_meta_set_string (anal, R_META_TYPE_COMMENT, 0x300, "nested");
+	r_meta_bulk_end (anal);
+	mu_assert_null (r_meta_get_at (anal, 0x300, R_META_TYPE_ANY, NULL), "not visible before the outermost end");
+	r_meta_bulk_end (anal);
+
+	size_t count = 0;
+	RIntervalTreeIter it;
+	RAnalMetaItem *item;
+	r_interval_tree_foreach (&anal->meta, it, item) {
+		count++;
+	}
+	mu_assert_eq (count, 3, "one item per type and address");
+	item = r_meta_get_at (anal, 0x100, R_META_TYPE_COMMENT, NULL);
+	mu_assert_streq (item->str, "merged", "existing item updated");
+	ut64 size;
+	item = r_meta_get_at (anal, 0x200, R_META_TYPE_DATA, &size);
+	mu_assert_notnull (item, "data");
+	mu_assert_eq (size, 8, "last set wins");
+	item = r_meta_get_at (anal, 0x300, R_META_TYPE_COMMENT, NULL);
+	mu_assert_streq (item->str, "nested", "nested bulk");
+	r_anal_free (anal);
+	mu_end;
+}
+
+#define BULK_STRINGS 100000
+
+static ut64 meta_set_strings(bool bulk) {
+	RAnal *anal = r_anal_new ();
+	ut64 t = r_time_now_mono ();
+	if (bulk) {
+		r_meta_bulk_begin (anal);
+	}
+	int i;
+	for (i = 0; i < BULK_STRINGS; i++) {
+		r_meta_set (anal, R_META_TYPE_STRING, 0x1000 + i * 0x10, 8, "hello");
+	}
+	if (bulk) {
+		r_meta_bulk_end (anal);
+	}
+	t = r_time_now_mono () - t;
+	r_anal_free (anal);
+	return t;
+}
+
+bool test_meta_bulk_bench() {
+	mu_bench_only;
+	ut64 single = meta_set_strings (false);
+	ut64 bulk = meta_set_strings (true);
+	eprintf ("%d strings: r_meta_set %"PFMT64u"us bulk %"PFMT64u"us\n", BULK_STRINGS, single, bulk);
+	mu_end;
+}
+
+bool test_meta_comment_interned() {
+	RAnal *anal = r_anal_new ();
+	RStrConstPoolStats st0, st;
+	r_str_constpool_stats (&anal->constpool, &st0);
+	r_meta_set_string (anal, R_META_TYPE_COMMENT, 0x100, "reached");
+	r_meta_set_string (anal, R_META_TYPE_COMMENT, 0x200, "reached");
+	r_meta_bulk_begin (anal);
+	r_meta_set_string (anal, R_META_TYPE_COMMENT, 0x300, "reached");
+	r_meta_set_string (anal, R_META_TYPE_COMMENT, 0x300, "reached");
+	r_meta_bulk_end (anal);
+	r_meta_set_string (anal, R_META_TYPE_STRING, 0x400, "reached");
+	const char *c = r_meta_get_string (anal, R_META_TYPE_COMMENT, 0x100);
+	mu_assert_ptreq (r_meta_get_string (anal, R_META_TYPE_COMMENT, 0x200), c, "shared");
+	mu_assert_ptreq (r_meta_get_string (anal, R_META_TYPE_COMMENT, 0x300), c, "shared after bulk");
+	mu_assert_ptrneq (r_meta_get_string (anal, R_META_TYPE_STRING, 0x400), c, "only comments are interned");
+	r_str_constpool_stats (&anal->constpool, &st);
+	mu_assert_eq (st.refs - st0.refs, 3, "refs");
+	mu_assert_eq (st.saved - st0.saved, 2 * sizeof ("reached"), "saved");
+
+	// set a comment to its own string
+	r_meta_set_string (anal, R_META_TYPE_COMMENT, 0x100, c);
+	mu_assert_streq (r_meta_get_string (anal, R_META_TYPE_COMMENT, 0x100), "reached", "self assign");
+	r_meta_set_string (anal, R_META_TYPE_COMMENT, 0x200, "other");
+	r_meta_del (anal, R_META_TYPE_COMMENT, 0x300, 1);
+	r_str_constpool_stats (&anal->constpool, &st);
+	mu_assert_eq (st.refs - st0.refs, 2, "refs after change and delete");
+	r_anal_purge (anal);
+	r_str_constpool_stats (&anal->constpool, &st);
+	mu_assert_eq (st.strings, st0.strings, "released by purge");
+
+	r_meta_set_string (anal, R_META_TYPE_COMMENT, 0x100, "leftover");
+	r_anal_free (anal);
+	mu_end;
+}
+
 bool all_tests() {
 	mu_run_test(test_meta_set);
 	mu_run_test(test_meta_get_at);
@@ -601,6 +697,9 @@ bool all_tests() {
 	mu_run_test(test_meta_del);
 	mu_run_test(test_meta_rebase);
 	mu_run_test(test_meta_spaces);
+	mu_run_test(test_meta_bulk);
+	mu_run_test(test_meta_bulk_bench);
+	mu_run_test(test_meta_comment_interned);
 	return tests_passed != tests_run;
 }
 
@@ -0,0 +1,162 @@
+#include <r_anal.h>
+#include <r_core.h>
+#include "minunit.h"
+
+static const ut8 jmp[] = { 0x0c, 0x94, 0x34, 0x00 }; // jmp 0x68
+static const ut8 ret[] = { 0x08, 0x95 };
+
+static RAnal *opcache_anal(size_t size) {
+	RAnal *anal = r_anal_new ();
+	r_anal_use (anal, "avr");
+	r_anal_set_cpu (anal, "ATmega8");
+	r_anal_set_reg_profile (anal);
+	anal->opcache = r_anal_opcache_new (size);
+	return anal;
+}
+
+static int decode(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *buf, int len, int mask) {
+	r_anal_op_fini (op);
+	return r_anal_op (anal, op, addr, buf, len, mask);
+}
+
+static bool test_anal_opcache_hit(void) {
+	RAnal *anal = opcache_anal (16);
+	RAnalOpCache *c = anal->opcache;
+	RAnalOp op = {0};
+	mu_assert_eq (decode (anal, &op, 0x10, jmp, sizeof (jmp), R_ANAL_OP_MASK_ALL), 4, "decoded");
+	mu_assert_eq (c->misses, 1, "first decode misses");
+	char *esil = strdup (r_strbuf_get (&op.esil));
+	mu_assert_eq (decode (anal, &op, 0x10, jmp, sizeof (jmp), R_ANAL_OP_MASK_ALL), 4, "cached");
+	mu_assert_eq (c->hits, 1, "second decode hits");
+	mu_assert_eq (op.type, R_ANAL_OP_TYPE_JMP, "type");
+	mu_assert_eq (op.jump, 0x68, "jump");
+	mu_assert_eq (op.addr, 0x10, "addr");
+	mu_assert_streq (r_strbuf_get (&op.esil), esil, "same esil");
+	free (esil);
+
+	// other masks and other bytes at the same address are separate
+	decode (anal, &op, 0x10, jmp, sizeof (jmp), R_ANAL_OP_MASK_BASIC);
+	mu_assert_eq (c->misses, 2, "basic mask misses");
+	decode (anal, &op, 0x10, ret, sizeof (ret), R_ANAL_OP_MASK_ALL);
+	mu_assert_eq (c->misses, 3, "new bytes miss");
+	mu_assert_eq (op.type, R_ANAL_OP_TYPE_RET, "new bytes decoded");
+	decode (anal, &op, 0x10, jmp, 2, R_ANAL_OP_MASK_ALL);
+	mu_assert_eq (c->hits, 1, "short buffer does not hit");
+
+	// hints drop the ops in their range, the decoder settings start a new epoch
+	decode (anal, &op, 0x10, ret, sizeof (ret), R_ANAL_OP_MASK_ALL);
+	mu_assert_eq (c->hits, 2, "ret hits");
+	r_anal_hint_set_immbase (anal, 0x20, 10);
+	decode (anal, &op, 0x10, ret, sizeof (ret), R_ANAL_OP_MASK_ALL);
+	mu_assert_eq (c->hits, 3, "hint elsewhere keeps the op");
+	r_anal_hint_set_immbase (anal, 0x11, 10);
+	decode (anal, &op, 0x10, ret, sizeof (ret), R_ANAL_OP_MASK_ALL);
+	mu_assert_eq (c->hits, 3, "hint inside the op invalidates");
+	r_anal_set_cpu (anal, "ATmega16");
+	decode (anal, &op, 0x10, ret, sizeof (ret), R_ANAL_OP_MASK_ALL);
+	mu_assert_eq (c->hits, 3, "cpu invalidates");
+	decode (anal, &op, 0x10, ret, sizeof (ret), R_ANAL_OP_MASK_ALL);
+	mu_assert_eq (c->hits, 4, "hits again");
+
+	r_anal_op_fini (&op);
+	r_anal_free (anal);
+	mu_end;
+}
+
+static bool test_anal_opcache_text(void) {
+	RAnal *anal = opcache_anal (16);
+	int size = 0, payload = 0, ret = 0;
+	mu_assert_null (r_anal_opcache_get_text (anal, 0x10, 1, jmp, 4, &size, &payload, &ret), "empty");
+	r_anal_opcache_set_text (anal, 0x10, 1, jmp, 4, 0, "jmp 0x68", 4);
+	const char *text = r_anal_opcache_get_text (anal, 0x10, 1, jmp, 4, &size, &payload, &ret);
+	mu_assert_streq (text, "jmp 0x68", "cached text");
+	mu_assert_eq (size, 4, "size");
+	mu_assert_null (r_anal_opcache_get_text (anal, 0x10, 2, jmp, 4, NULL, NULL, NULL), "other asm state");
+	mu_assert_eq (anal->opcache->text_hits, 1, "text hits");
+	r_anal_free (anal);
+	mu_end;
+}
+
+static bool test_anal_opcache_bounded(void) {
+	RAnal *anal = opcache_anal (4);
+	RAnalOp op = {0};
+	ut64 a;
+	for (a = 0; a < 64; a += 2) {
+		decode (anal, &op, a, ret, sizeof (ret), R_ANAL_OP_MASK_BASIC);
+	}
+	mu_assert_eq (anal->opcache->ht->count, 4, "only the newest entries are kept");
+	decode (anal, &op, 62, ret, sizeof (ret), R_ANAL_OP_MASK_BASIC);
+	decode (anal, &op, 0, ret, sizeof (ret), R_ANAL_OP_MASK_BASIC);
+	mu_assert_eq (anal->opcache->hits, 1, "newest hits, oldest was evicted");
+	r_anal_opcache_clear (anal->opcache);
+	mu_assert_eq (anal->opcache->ht->count, 0, "cleared");
+	r_anal_op_fini (&op);
+	r_anal_free (anal);
+	mu_end;
+}
+
+static bool test_core_opcache_parser(void) {
+	RCore *core = r_core_new ();
+	r_config_set (core->config, "asm.arch", "avr");
+	r_config_set (core->config, "asm.cpu", "ATmega8");
+	RAsmOp op = {0};
+	mu_assert ("output filter", r_asm_filter_output (core->rasm, "avr.pseudo"));
+	r_core_asm_disassemble (core, &op, jmp, sizeof (jmp));
+	r_asm_op_fini (&op);
+	r_core_asm_disassemble (core, &op, jmp, sizeof (jmp));
+	r_asm_op_fini (&op);
+	ut64 hits = core->anal->opcache->text_hits;
+	mu_assert_eq (hits, 1, "same parser hits");
+	// the same RParse with another plugin makes other text
+	mu_assert ("other parser", r_parse_use (core->rasm->ofilter, "6502.pseudo"));
+	r_core_asm_disassemble (core, &op, jmp, sizeof (jmp));
+	r_asm_op_fini (&op);
+	mu_assert_eq (core->anal->opcache->text_hits, hits, "parser change misses");
+	r_core_free (core);
+	mu_end;
+}
+
+static bool test_core_opcache_writes(void) {
+	RCore *core = r_core_new ();
+	r_core_cmd0 (core, "o malloc://64");
+	r_config_set (core->config, "asm.arch", "bf");
+	RAnal *anal = core->anal;
+	RAnalOp op = {0};
+	const ut8 *loop = (const ut8 *)"[++";
+	const ut8 *inc = (const ut8 *)"++";
+	// ops decoded from their own bytes only survive writes elsewhere
+	decode (anal, &op, 0x10, inc, 2, R_ANAL_OP_MASK_BASIC);
+	r_core_write_at (core, 0x20, inc, 2);
+	decode (anal, &op, 0x10, inc, 2, R_ANAL_OP_MASK_BASIC);
+	mu_assert_eq (anal->opcache->hits, 1, "write elsewhere hits");
+	r_core_write_at (core, 0x11, inc, 1);
+	decode (anal, &op, 0x10, inc, 2, R_ANAL_OP_MASK_BASIC);
+	mu_assert_eq (anal->opcache->hits, 1, "write inside the op misses");
+
+	r_core_write_at (core, 0, (const ut8 *)"[++++]", 6);
+	// the matching bracket is read from io, past the bytes of the op
+	decode (anal, &op, 0, loop, 3, R_ANAL_OP_MASK_BASIC);
+	mu_assert_eq (op.jump, 6, "jump after ]");
+	decode (anal, &op, 0, loop, 3, R_ANAL_OP_MASK_BASIC);
+	mu_assert_eq (anal->opcache->hits, 2, "cached");
+	r_core_write_at (core, 5, (const ut8 *)"+]", 2);
+	decode (anal, &op, 0, loop, 3, R_ANAL_OP_MASK_BASIC);
+	mu_assert_eq (anal->opcache->hits, 2, "write past the op misses");
+	mu_assert_eq (op.jump, 7, "new jump");
+	r_anal_op_fini (&op);
+	r_core_free (core);
+	mu_end;
+}
+
+static int all_tests(void) {
+	mu_run_test (test_anal_opcache_hit);
+	mu_run_test (test_anal_opcache_text);
+	mu_run_test (test_anal_opcache_bounded);
+	mu_run_test (test_core_opcache_parser);
+	mu_run_test (test_core_opcache_writes);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests ();
+}
@@ -1,4 +1,5 @@
 #include <r_anal.h>
+#include <r_core.h>
 #include <r_parse.h>
 #include "minunit.h"
 
@@ -66,9 +67,8 @@ static bool test_anal_get_base_type_struct(void) {
 	mu_assert_streq (member->type, "int32_t", "Incorrect type for struct member");
 	mu_assert_streq (member->name, "cow", "Incorrect name for struct member");
 
-	r_vector_fini (&base->struct_data.members);
+	r_anal_free_base_type (base);
 	r_anal_free (anal);
-	free (base);
 	mu_end;
 }
 
@@ -94,9 +94,8 @@ static bool test_anal_get_base_type_union(void) {
 	mu_assert_streq (member->type, "int32_t", "Incorrect type for union member");
 	mu_assert_streq (member->name, "cow", "Incorrect name for union member");
 
-	r_vector_fini (&base->union_data.members);
+	r_anal_free_base_type (base);
 	r_anal_free (anal);
-	free (base);
 	mu_end;
 }
 
@@ -122,9 +121,8 @@ static bool test_anal_get_base_type_enum(void) {
 	mu_assert_eq (cas->val, 2, "Incorrect value for enum case");
 	mu_assert_streq (cas->name, "secondCase", "Incorrect name for enum case");
 
-	r_vector_fini (&base->enum_data.cases);
+	r_anal_free_base_type (base);
 	r_anal_free (anal);
-	free (base);
 	mu_end;
 }
 
@@ -151,11 +149,142 @@ static bool test_anal_get_base_type_not_found(void) {
 	mu_end;
 }
 
+static bool test_anal_base_type_cache(void) {
+	RAnal *anal = r_anal_new ();
+	setup_sdb_for_struct (anal->sdb_types);
+
+	const RAnalBaseType *t = r_anal_base_type_get (anal, "kappa");
+	mu_assert_notnull (t, "struct kappa");
+	mu_assert_eq (t, r_anal_base_type_get (anal, "kappa"), "second lookup hits the cache");
+	mu_assert_streq (t->name, "kappa", "name of the compiled type");
+
+	ut64 off = UT64_MAX;
+	mu_assert_true (r_anal_base_type_member_offset (anal, "kappa", "cow", &off), "member cow");
+	mu_assert_eq (off, 4, "offset of cow");
+	mu_assert_false (r_anal_base_type_member_offset (anal, "kappa", "moo", &off), "no member moo");
+	mu_assert_null (r_anal_base_type_get (anal, "nope"), "unknown type");
+
+	// writes to sdb invalidate the compiled type, misses included
+	sdb_set (anal->sdb_types, "struct.kappa.cow", "int32_t,8,0", 0);
+	mu_assert_true (r_anal_base_type_member_offset (anal, "kappa", "cow", &off), "member cow");
+	mu_assert_eq (off, 8, "offset of cow after sdb_set");
+	setup_sdb_for_enum (anal->sdb_types);
+	sdb_set (anal->sdb_types, "nope", "enum", 0);
+	sdb_set (anal->sdb_types, "enum.nope", "yep", 0);
+	sdb_set (anal->sdb_types, "enum.nope.yep", "0x1", 0);
+	t = r_anal_base_type_get (anal, "nope");
+	mu_assert_notnull (t, "type added after a miss");
+	mu_assert_eq (t->kind, R_ANAL_BASE_TYPE_KIND_ENUM, "kind of nope");
+
+	RAnalBaseType *base = r_anal_new_base_type (R_ANAL_BASE_TYPE_KIND_UNION);
+	base->name = strdup ("kappa");
+	r_vector_init (&base->union_data.members, sizeof (RAnalUnionMember), NULL, NULL);
+	RAnalUnionMember m = { .name = "cow", .type = "int64_t" };
+	r_vector_push (&base->union_data.members, &m);
+	r_anal_save_base_type (anal, base);
+	r_vector_clear (&base->union_data.members);
+	r_anal_free_base_type (base);
+	t = r_anal_base_type_get (anal, "kappa");
+	mu_assert_eq (t->kind, R_ANAL_BASE_TYPE_KIND_UNION, "saved type replaces the cached one");
+	mu_assert_true (r_anal_base_type_member_offset (anal, "kappa", "cow", &off), "member cow");
+	mu_assert_eq (off, 0, "offset of union member");
+
+	sdb_reset (anal->sdb_types);
+	mu_assert_null (r_anal_base_type_get (anal, "kappa"), "cache dropped on sdb_reset");
+
+	r_anal_free (anal);
+	mu_end;
+}
+
+static bool test_anal_type_lookups_cache(void) {
+	RAnal *anal = r_anal_new ();
+	Sdb *TDB = anal->sdb_types;
+	sdb_set (TDB, "int32_t", "type", 0);
+	sdb_set (TDB, "type.int32_t.size", "32", 0);
+	setup_sdb_for_struct (TDB);
+	// struct outer {struct kappa k; int32_t z;};
+	sdb_set (TDB, "outer", "struct", 0);
+	sdb_set (TDB, "struct.outer", "k,z", 0);
+	sdb_set (TDB, "struct.outer.k", "struct kappa,0,0", 0);
+	sdb_set (TDB, "struct.outer.z", "int32_t,8,0", 0);
+
+	mu_assert_eq (r_anal_type_get_bitsize (anal, "outer"), 96, "size of outer");
+	mu_assert_eq (r_anal_type_get_bitsize (anal, "outer"), r_type_get_bitsize (TDB, "outer"), "cached size");
+	mu_assert_eq (r_anal_type_get_bitsize (anal, "nope"), 0, "unknown type");
+	char *memb = r_anal_type_get_struct_memb (anal, "outer", 4);
+	mu_assert_streq_free (memb, "outer.k.cow", "nested member");
+	memb = r_anal_type_get_struct_memb (anal, "outer", 8);
+	mu_assert_streq_free (memb, "outer.z", "member after the nested struct");
+	mu_assert_null (r_anal_type_get_struct_memb (anal, "outer", 12), "past the end");
+	RList *offtypes = r_anal_type_get_by_offset (anal, 4);
+	mu_assert_eq (r_list_length (offtypes), 2, "structs with a member at 4");
+	r_list_free (offtypes);
+
+	// members of nested types change the results of the outer one
+	sdb_set (TDB, "struct.kappa", "bar,cow,moo", 0);
+	sdb_set (TDB, "struct.kappa.moo", "int32_t,8,0", 0);
+	mu_assert_eq (r_anal_type_get_bitsize (anal, "outer"), 128, "nested struct grew");
+	memb = r_anal_type_get_struct_memb (anal, "outer", 8);
+	mu_assert_streq_free (memb, "outer.k.moo", "nested member at 8");
+	memb = r_anal_type_get_struct_memb (anal, "outer", 12);
+	mu_assert_streq_free (memb, "outer.z", "z moved");
+
+	sdb_reset (TDB);
+	mu_assert_eq (r_anal_type_get_bitsize (anal, "outer"), 0, "dropped on sdb_reset");
+	mu_assert_null (r_anal_type_get_struct_memb (anal, "outer", 12), "no members after sdb_reset");
+
+	r_anal_free (anal);
+	mu_end;
+}
+
+static bool test_core_type_match_key(void) {
+	RCore *core = r_core_new ();
+	r_core_cmd0 (core, "o malloc://0x1000");
+	RAnal *anal = core->anal;
+	Sdb *TDB = anal->sdb_types;
+	sdb_set (TDB, "inner", "struct", 0);
+	sdb_set (TDB, "struct.inner", "x", 0);
+	sdb_set (TDB, "struct.inner.x", "int32_t,0,0", 0);
+	sdb_set (TDB, "outer", "struct", 0);
+	sdb_set (TDB, "struct.outer", "a,in", 0);
+	sdb_set (TDB, "struct.outer.a", "int32_t,0,0", 0);
+	sdb_set (TDB, "struct.outer.in", "struct inner,4,0", 0);
+	RAnalFunction *fcn = r_anal_create_function (anal, "fcn.caller", 0x100, R_ANAL_FCN_TYPE_FCN, NULL);
+	RAnalFunction *callee = r_anal_create_function (anal, "fcn.callee", 0x200, R_ANAL_FCN_TYPE_FCN, NULL);
+	RAnalBlock *bb = r_anal_create_block (anal, 0x100, 0x10);
+	bb->ninstr = 1;
+	r_anal_function_add_block (fcn, bb);
+	r_anal_block_unref (bb);
+	bb = r_anal_create_block (anal, 0x200, 0x10);
+	r_anal_function_add_block (callee, bb);
+	r_anal_block_unref (bb);
+	r_anal_function_set_var (fcn, -8, R_ANAL_VAR_KIND_BPV, "struct outer *", 4, false, "local_8h");
+	r_anal_xrefs_set (anal, 0x100, 0x200, R_ANAL_REF_TYPE_CALL);
+
+	ut64 key = r_core_anal_type_match_key (core, fcn);
+	mu_assert_eq (r_core_anal_type_match_key (core, fcn), key, "stable key");
+	sdb_set (TDB, "struct.inner.x", "int64_t,0,0", 0);
+	ut64 nested = r_core_anal_type_match_key (core, fcn);
+	mu_assert_neq (nested, key, "nested struct member changed");
+	callee->is_noreturn = true;
+	ut64 noret = r_core_anal_type_match_key (core, fcn);
+	mu_assert_neq (noret, nested, "callee became noreturn");
+	callee->is_noreturn = false;
+	r_anal_noreturn_add (anal, NULL, 0x200);
+	mu_assert_neq (r_core_anal_type_match_key (core, fcn), nested, "noreturn address");
+
+	r_core_free (core);
+	mu_end;
+}
+
 int all_tests(void) {
 	mu_run_test (test_anal_get_base_type_struct);
 	mu_run_test (test_anal_get_base_type_union);
 	mu_run_test (test_anal_get_base_type_enum);
 	mu_run_test (test_anal_get_base_type_not_found);
+	mu_run_test (test_anal_base_type_cache);
+	mu_run_test (test_anal_type_lookups_cache);
+	mu_run_test (test_core_type_match_key);
 	return tests_passed != tests_run;
 }
 
@@ -223,8 +223,46 @@ bool test_r_anal_var() {
 	mu_end;
 }
 
+bool test_r_anal_var_interned() {
+	RAnal *anal = r_anal_new ();
+	RAnalFunction *f0 = r_anal_create_function (anal, "f0", 0x100, R_ANAL_FCN_TYPE_FCN, NULL);
+	RAnalFunction *f1 = r_anal_create_function (anal, "f1", 0x200, R_ANAL_FCN_TYPE_FCN, NULL);
+	RStrConstPoolStats st0, st;
+	r_str_constpool_stats (&anal->constpool, &st0);
+
+	char *name = strdup ("var_8h");
+	RAnalVar *a = r_anal_function_set_var (f0, -8, R_ANAL_VAR_KIND_BPV, "int32_t", 4, false, name);
+	RAnalVar *b = r_anal_function_set_var (f1, -8, R_ANAL_VAR_KIND_BPV, "int32_t", 4, false, name);
+	free (name);
+	mu_assert_ptreq (a->name, b->name, "same name shared");
+	mu_assert_ptreq (a->type, b->type, "same type shared");
+	r_str_constpool_stats (&anal->constpool, &st);
+	mu_assert_eq (st.strings - st0.strings, 2, "one copy each");
+	mu_assert_eq (st.saved - st0.saved, sizeof ("var_8h") + sizeof ("int32_t"), "saved");
+
+	// setting a var again with its own strings
+	RAnalVar *c = r_anal_function_set_var (f0, -8, R_ANAL_VAR_KIND_BPV, a->type, 4, false, a->name);
+	mu_assert_ptreq (c, a, "same var");
+	mu_assert_streq (c->name, "var_8h", "name kept");
+	r_anal_var_set_type (a, "char *");
+	mu_assert_streq (a->type, "char *", "retyped");
+	mu_assert_streq (b->type, "int32_t", "other var untouched");
+	mu_assert ("rename", r_anal_var_rename (b, "var_ch", false));
+	mu_assert_streq (a->name, "var_8h", "other var untouched");
+
+	r_anal_function_delete_all_vars (f0);
+	r_anal_function_delete_all_vars (f1);
+	r_str_constpool_stats (&anal->constpool, &st);
+	mu_assert_eq (st.strings, st0.strings, "released with the vars");
+	mu_assert_eq (st.refs, st0.refs, "no refs left");
+
+	r_anal_free (anal);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test (test_r_anal_var);
+	mu_run_test (test_r_anal_var_interned);
 	return tests_passed != tests_run;
 }
 
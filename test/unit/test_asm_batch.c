@@ -0,0 +1,363 @@
+#include <r_asm.h>
+#include <r_anal.h>
+#include "minunit.h"
+
+// ldi r16, 0x10; mov r1, r16; jmp 0x68; nop; ret; and an odd trailing byte
+static const ut8 code[] = {
+	0x00, 0xe1, 0x10, 0x2e, 0x0c, 0x94, 0x34, 0x00,
+	0x00, 0x00, 0x08, 0x95, 0xff
+};
+
+#define SWEEP (64 * 1024)
+
+/* two bytes per op, the second one is a pc relative target. The batch
+ * callbacks stop at 0xee to leave it to the single op path */
+static const ut8 tcode[] = {
+	0x01, 0x10, 0x02, 0x20, 0xee, 0x04, 0x01, 0x30,
+	0x03, 0x00, 0x05
+};
+
+static int asm_batch_calls = 0;
+static int anal_batch_calls = 0;
+
+static void test_op_text(RAsmOp *op, const ut8 *buf, ut64 pc) {
+	op->size = 2;
+	r_strbuf_setf (&op->buf_asm, "op%d 0x%"PFMT64x, buf[0], pc + buf[1]);
+}
+
+static int test_disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
+	if (len < 2) {
+		op->size = 1;
+		r_strbuf_set (&op->buf_asm, "invalid");
+		return 1;
+	}
+	test_op_text (op, buf, a->pc);
+	return op->size;
+}
+
+static int test_disassemble_batch(RAsm *a, RAsmOp *ops, int n, const ut8 *buf, int len) {
+	int i, off = 0;
+	asm_batch_calls++;
+	for (i = 0; i < n && off + 2 <= len && buf[off] != 0xee; i++) {
+		test_op_text (&ops[i], buf + off, a->pc + off);
+		off += 2;
+	}
+	return i;
+}
+
+static int test_op_decode(RAnalOp *op, ut64 addr, const ut8 *buf, int len) {
+	if (len < 2) {
+		return -1;
+	}
+	op->size = 2;
+	if (buf[0] == 0x01) {
+		op->type = R_ANAL_OP_TYPE_JMP;
+		op->jump = addr + buf[1];
+	} else {
+		op->type = R_ANAL_OP_TYPE_MOV;
+	}
+	r_strbuf_setf (&op->esil, "%d,r0,=", buf[0]);
+	return op->size;
+}
+
+static int test_op(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
+	return test_op_decode (op, addr, buf, len);
+}
+
+static int test_op_batch(RAnal *anal, RAnalOp *ops, int n, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
+	int i, off = 0;
+	anal_batch_calls++;
+	for (i = 0; i < n && off + 2 <= len && buf[off] != 0xee; i++) {
+		off += test_op_decode (&ops[i], addr + off, buf + off, len - off);
+	}
+	return i;
+}
+
+static RAsmPlugin test_asm_plugin = {
+	.name = "batchtest",
+	.arch = "batchtest",
+	.bits = 16,
+	.endian = R_SYS_ENDIAN_LITTLE,
+	.disassemble = &test_disassemble,
+	.disassemble_batch = &test_disassemble_batch,
+};
+
+static RAnalPlugin test_anal_plugin = {
+	.name = "batchtest",
+	.arch = "batchtest",
+	.bits = 16,
+	.op = &test_op,
+	.op_batch = &test_op_batch,
+};
+
+static RAsm *batch_asm(void) {
+	RAsm *a = r_asm_new ();
+	r_asm_use (a, "avr");
+	r_asm_set_cpu (a, "ATmega8");
+	return a;
+}
+
+static RAnal *batch_anal(void) {
+	RAnal *anal = r_anal_new ();
+	r_anal_use (anal, "avr");
+	r_anal_set_cpu (anal, "ATmega8");
+	r_anal_set_reg_profile (anal);
+	return anal;
+}
+
+static bool test_asm_disassemble_batch(void) {
+	RAsm *a = batch_asm ();
+	RAsmOp ops[8], op;
+	r_asm_set_pc (a, 0x100);
+	int i, off = 0, n = r_asm_disassemble_batch (a, ops, R_ARRAY_SIZE (ops), code, sizeof (code));
+	mu_assert_eq (n, 6, "stops when the buffer runs out");
+	mu_assert_eq (a->pc, 0x100, "pc restored");
+	for (i = 0; i < n; i++) {
+		r_asm_set_pc (a, 0x100 + off);
+		r_asm_op_init (&op);
+		int ret = r_asm_disassemble (a, &op, code + off, sizeof (code) - off);
+		mu_assert_eq (ops[i].size, op.size, "same size");
+		mu_assert_streq (r_asm_op_get_asm (&ops[i]), r_asm_op_get_asm (&op), "same text");
+		mu_assert_memeq (r_strbuf_getbin (&ops[i].buf, NULL), code + off, R_MIN (op.size, sizeof (code) - off), "same bytes");
+		off += R_MAX (ret, 1);
+		r_asm_op_fini (&op);
+		r_asm_op_fini (&ops[i]);
+	}
+	mu_assert_eq (off, sizeof (code), "whole buffer covered");
+	r_asm_free (a);
+	mu_end;
+}
+
+static bool test_anal_op_batch(void) {
+	RAnal *anal = batch_anal ();
+	RAnalOp ops[8], op;
+	int i, off = 0, n = r_anal_op_batch (anal, ops, 3, 0x100, code, sizeof (code), R_ANAL_OP_MASK_ALL);
+	mu_assert_eq (n, 3, "stops at n");
+	for (i = 0; i < n; i++) {
+		r_anal_op_fini (&ops[i]);
+	}
+	n = r_anal_op_batch (anal, ops, R_ARRAY_SIZE (ops), 0x100, code, sizeof (code), R_ANAL_OP_MASK_ALL);
+	mu_assert_eq (n, 6, "stops when the buffer runs out");
+	for (i = 0; i < n; i++) {
+		r_anal_op_init (&op);
+		r_anal_op (anal, &op, 0x100 + off, code + off, sizeof (code) - off, R_ANAL_OP_MASK_ALL);
+		mu_assert_eq (ops[i].addr, 0x100 + off, "consecutive");
+		mu_assert_eq (ops[i].type, op.type, "same type");
+		mu_assert_eq (ops[i].jump, op.jump, "same jump");
+		mu_assert_streq (r_strbuf_get (&ops[i].esil), r_strbuf_get (&op.esil), "same esil");
+		off += R_MAX (ops[i].size, 1);
+		r_anal_op_fini (&op);
+		r_anal_op_fini (&ops[i]);
+	}
+	mu_assert_eq (ops[1].type, R_ANAL_OP_TYPE_MOV, "mov");
+	mu_assert_eq (ops[2].jump, 0x68, "jmp");
+	mu_assert_eq (off, sizeof (code), "whole buffer covered");
+	r_anal_free (anal);
+	mu_end;
+}
+
+static bool test_asm_plugin_batch(void) {
+	RAsm *a = r_asm_new ();
+	mu_assert ("add plugin", r_asm_add (a, &test_asm_plugin));
+	mu_assert ("use plugin", r_asm_use (a, "batchtest"));
+	RAsmOp ops[8], op;
+	asm_batch_calls = 0;
+	r_asm_set_pc (a, 0x100);
+	int i, off = 0, n = r_asm_disassemble_batch (a, ops, R_ARRAY_SIZE (ops), tcode, sizeof (tcode));
+	mu_assert_eq (n, 6, "stops when the buffer runs out");
+	mu_assert_eq (a->pc, 0x100, "pc restored");
+	// the two bulk runs, plus the calls that stop at 0xee and at the odd byte
+	mu_assert_eq (asm_batch_calls, 4, "batch callback used");
+	for (i = 0; i < n; i++) {
+		r_asm_set_pc (a, 0x100 + off);
+		r_asm_op_init (&op);
+		r_asm_disassemble (a, &op, tcode + off, sizeof (tcode) - off);
+		mu_assert_eq (ops[i].size, op.size, "same size");
+		mu_assert_streq (r_asm_op_get_asm (&ops[i]), r_asm_op_get_asm (&op), "same text");
+		mu_assert_memeq (r_strbuf_getbin (&ops[i].buf, NULL), tcode + off, op.size, "same bytes");
+		off += op.size;
+		r_asm_op_fini (&op);
+		r_asm_op_fini (&ops[i]);
+	}
+	mu_assert_eq (off, sizeof (tcode), "whole buffer covered");
+	r_asm_set_pc (a, 0x100);
+	n = r_asm_disassemble_batch (a, ops, R_ARRAY_SIZE (ops), tcode, sizeof (tcode));
+	mu_assert_streq (r_asm_op_get_asm (&ops[3]), "op1 0x136", "pc of the op");
+	for (i = 0; i < n; i++) {
+		r_asm_op_fini (&ops[i]);
+	}
+	r_asm_free (a);
+	mu_end;
+}
+
+static bool test_anal_plugin_batch(void) {
+	RAnal *anal = r_anal_new ();
+	r_anal_add (anal, &test_anal_plugin);
+	mu_assert ("use plugin", r_anal_use (anal, "batchtest"));
+	RAnalOp ops[8], op;
+	anal_batch_calls = 0;
+	int i, off = 0, n = r_anal_op_batch (anal, ops, R_ARRAY_SIZE (ops), 0x100, tcode, sizeof (tcode), R_ANAL_OP_MASK_ALL);
+	mu_assert_eq (n, 6, "stops when the buffer runs out");
+	mu_assert_eq (anal_batch_calls, 4, "batch callback used");
+	for (i = 0; i < n; i++) {
+		r_anal_op_init (&op);
+		if (r_anal_op (anal, &op, 0x100 + off, tcode + off, sizeof (tcode) - off, R_ANAL_OP_MASK_ALL) < 1) {
+			op.size = 1;
+		}
+		mu_assert_eq (ops[i].addr, 0x100 + off, "consecutive");
+		mu_assert_eq (ops[i].size, op.size, "same size");
+		mu_assert_eq (ops[i].type, op.type, "same type");
+		mu_assert_eq (ops[i].jump, op.jump, "same jump");
+		mu_assert_streq (r_strbuf_get (&ops[i].esil), r_strbuf_get (&op.esil), "same esil");
+		off += R_MAX (ops[i].size, 1);
+		r_anal_op_fini (&op);
+		r_anal_op_fini (&ops[i]);
+	}
+	mu_assert_eq (off, sizeof (tcode), "whole buffer covered");
+	n = r_anal_op_batch (anal, ops, R_ARRAY_SIZE (ops), 0x100, tcode, sizeof (tcode), R_ANAL_OP_MASK_ALL);
+	mu_assert_eq (ops[3].jump, 0x136, "jump of the op");
+	for (i = 0; i < n; i++) {
+		r_anal_op_fini (&ops[i]);
+	}
+	r_anal_free (anal);
+	mu_end;
+}
+
+static ut64 sweep_asm(RAsm *a, const ut8 *buf, bool batch) {
+	RAsmOp ops[32];
+	int i, n, off = 0;
+	ut64 t = r_time_now_mono ();
+	while (off < SWEEP) {
+		r_asm_set_pc (a, off);
+		if (batch) {
+			n = r_asm_disassemble_batch (a, ops, R_ARRAY_SIZE (ops), buf + off, SWEEP - off);
+		} else {
+			r_asm_op_init (&ops[0]);
+			r_asm_disassemble (a, &ops[0], buf + off, SWEEP - off);
+			n = 1;
+		}
+		for (i = 0; i < n; i++) {
+			off += R_MAX (ops[i].size, 1);
+			r_asm_op_fini (&ops[i]);
+		}
+	}
+	return r_time_now_mono () - t;
+}
+
+static ut64 sweep_anal(RAnal *anal, const ut8 *buf, bool batch) {
+	RAnalOp ops[32];
+	int i, n, off = 0;
+	ut64 t = r_time_now_mono ();
+	while (off < SWEEP) {
+		if (batch) {
+			n = r_anal_op_batch (anal, ops, R_ARRAY_SIZE (ops), off, buf + off, SWEEP - off, R_ANAL_OP_MASK_BASIC);
+		} else {
+			r_anal_op_init (&ops[0]);
+			r_anal_op (anal, &ops[0], off, buf + off, SWEEP - off, R_ANAL_OP_MASK_BASIC);
+			if (ops[0].size < 1) {
+				ops[0].size = 1;
+			}
+			n = 1;
+		}
+		for (i = 0; i < n; i++) {
+			off += R_MAX (ops[i].size, 1);
+			r_anal_op_fini (&ops[i]);
+		}
+	}
+	return r_time_now_mono () - t;
+}
+
+static bool test_batch_throughput(void) {
+	mu_bench_only;
+	ut8 *buf = malloc (SWEEP);
+	mu_assert_notnull (buf, "buffer");
+	int i;
+	for (i = 0; i < SWEEP; i++) {
+		buf[i] = code[i % (sizeof (code) - 1)];
+	}
+	RAsm *a = batch_asm ();
+	RAnal *anal = batch_anal ();
+	ut64 single = sweep_asm (a, buf, false);
+	ut64 batch = sweep_asm (a, buf, true);
+	eprintf ("asm %d bytes: per-op %"PFMT64u"us batch %"PFMT64u"us\n", SWEEP, single, batch);
+	single = sweep_anal (anal, buf, false);
+	batch = sweep_anal (anal, buf, true);
+	eprintf ("anal %d bytes: per-op %"PFMT64u"us batch %"PFMT64u"us\n", SWEEP, single, batch);
+	r_asm_free (a);
+	r_anal_free (anal);
+	free (buf);
+	mu_end;
+}
+
+// the batch decodes buf like r_asm_disassemble does op by op
+static bool batch_matches_single(RAsm *a, const ut8 *buf, int len) {
+	RAsmOp ops[16], op;
+	bool ok = true;
+	int i, off = 0, n = r_asm_disassemble_batch (a, ops, R_ARRAY_SIZE (ops), buf, len);
+	for (i = 0; i < n; i++) {
+		r_asm_set_pc (a, 0x1000 + off);
+		r_asm_op_init (&op);
+		int ret = r_asm_disassemble (a, &op, buf + off, len - off);
+		if (ops[i].size != op.size || strcmp (r_asm_op_get_asm (&ops[i]), r_asm_op_get_asm (&op))) {
+			eprintf ("0x%x: batch %s, single %s\n", 0x1000 + off, r_asm_op_get_asm (&ops[i]), r_asm_op_get_asm (&op));
+			ok = false;
+		}
+		off += R_MAX (ret, 1);
+		r_asm_op_fini (&op);
+		r_asm_op_fini (&ops[i]);
+	}
+	r_asm_set_pc (a, 0x1000);
+	return ok && off == len;
+}
+
+static bool test_asm_capstone_batch(void) {
+	// push rbp; mov rbp, rsp; nop; ret
+	static const ut8 x86[] = { 0x55, 0x48, 0x89, 0xe5, 0x90, 0xc3 };
+	// push {r4, lr}; mov r0, 1; bx lr
+	static const ut8 arm[] = { 0x10, 0x40, 0x2d, 0xe9, 0x01, 0x00, 0xa0, 0xe3, 0x1e, 0xff, 0x2f, 0xe1 };
+	// mov x0, 1; bti c; nop; bti j; ret, the bti are decoded by the hacks
+	static const ut8 arm64[] = {
+		0x20, 0x00, 0x80, 0xd2, 0x5f, 0x24, 0x03, 0xd5, 0x1f, 0x20, 0x03, 0xd5,
+		0x9f, 0x24, 0x03, 0xd5, 0xc0, 0x03, 0x5f, 0xd6
+	};
+	// addiu sp, sp, -0x20; nop; jr ra
+	static const ut8 mips[] = { 0xe0, 0xff, 0xbd, 0x27, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0xe0, 0x03 };
+	static const struct {
+		const char *arch;
+		int bits;
+		const ut8 *buf;
+		int len;
+	} runs[] = {
+		{ "x86", 64, x86, sizeof (x86) },
+		{ "arm", 32, arm, sizeof (arm) },
+		{ "arm", 64, arm64, sizeof (arm64) },
+		{ "mips", 32, mips, sizeof (mips) },
+	};
+	RAsm *a = r_asm_new ();
+	size_t i;
+	for (i = 0; i < R_ARRAY_SIZE (runs); i++) {
+		// only with the capstone plugins built in
+		if (!r_asm_use (a, runs[i].arch)) {
+			continue;
+		}
+		r_asm_set_bits (a, runs[i].bits);
+		r_asm_set_pc (a, 0x1000);
+		mu_assert (runs[i].arch, batch_matches_single (a, runs[i].buf, runs[i].len));
+	}
+	r_asm_free (a);
+	mu_end;
+}
+
+static int all_tests() {
+	mu_run_test (test_asm_disassemble_batch);
+	mu_run_test (test_anal_op_batch);
+	mu_run_test (test_asm_plugin_batch);
+	mu_run_test (test_anal_plugin_batch);
+	mu_run_test (test_asm_capstone_batch);
+	mu_run_test (test_batch_throughput);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests ();
+}
@@ -22,9 +22,125 @@ bool test_r_bin(void) {
 	mu_end;
 }
 
+// a one image arm64 shared cache with two local symbols
+static void dyldcache_fixture(ut8 *buf) {
+	memset (buf, 0, 0x2000);
+	memcpy (buf, "dyld_v1   arm64", 15);
+	r_write_le32 (buf + 0x10, 0x100); // mappingOffset
+	r_write_le32 (buf + 0x14, 2);
+	r_write_le32 (buf + 0x18, 0x180); // imagesOffset
+	r_write_le32 (buf + 0x1c, 1);
+	r_write_le64 (buf + 0x38, 0x1000); // slideInfoOffset
+	r_write_le64 (buf + 0x40, 0x100);
+	r_write_le64 (buf + 0x48, 0x1100); // localSymbolsOffset
+	r_write_le64 (buf + 0x50, 0x100);
+	// text and data mappings
+	r_write_le64 (buf + 0x100, 0x180000000);
+	r_write_le64 (buf + 0x108, 0x1000);
+	r_write_le64 (buf + 0x110, 0);
+	r_write_le32 (buf + 0x11c, 5);
+	r_write_le64 (buf + 0x120, 0x180001000);
+	r_write_le64 (buf + 0x128, 0x1000);
+	r_write_le64 (buf + 0x130, 0x1000);
+	r_write_le32 (buf + 0x13c, 3);
+	// the image, its path and an empty mach-o header
+	r_write_le64 (buf + 0x180, 0x180000400);
+	r_write_le32 (buf + 0x198, 0x200);
+	strcpy ((char *)buf + 0x200, "/usr/lib/libfixture.dylib");
+	r_write_le32 (buf + 0x400, 0xfeedfacf);
+	r_write_le32 (buf + 0x404, 0x0100000c);
+	r_write_le32 (buf + 0x40c, 6);
+	// v3 slide info without pages
+	r_write_le32 (buf + 0x1000, 3);
+	r_write_le32 (buf + 0x1004, 0x1000);
+	// local symbols: info, one entry, two nlists and their strings
+	r_write_le32 (buf + 0x1100, 0x30);
+	r_write_le32 (buf + 0x1104, 2);
+	r_write_le32 (buf + 0x1108, 0x60);
+	r_write_le32 (buf + 0x110c, 0x20);
+	r_write_le32 (buf + 0x1110, 0x18);
+	r_write_le32 (buf + 0x1114, 1);
+	r_write_le32 (buf + 0x1118, 0x400);
+	r_write_le32 (buf + 0x1120, 2);
+	r_write_le32 (buf + 0x1130, 1);
+	r_write_le64 (buf + 0x1138, 0x180000500);
+	r_write_le32 (buf + 0x1140, 12);
+	r_write_le64 (buf + 0x1148, 0x180000600);
+	memcpy (buf + 0x1160, "\0_local_one\0_local_two", 23);
+}
+
+static int dyldcache_locals(RBin *bin, ut64 *first) {
+	int n = 0;
+	RListIter *iter;
+	RBinSymbol *sym;
+	RList *symbols = r_bin_get_symbols (bin);
+	r_list_foreach (symbols, iter, sym) {
+		if (sym->type && !strcmp (sym->type, "LOCAL")) {
+			if (!n++) {
+				*first = sym->vaddr;
+			}
+		}
+	}
+	return n;
+}
+
+bool test_r_bin_dyldcache_locals(void) {
+	ut8 *buf = calloc (1, 0x2000);
+	dyldcache_fixture (buf);
+	char *file = r_file_temp ("dyldcache");
+	mu_assert ("fixture could not be written", r_file_dump (file, buf, 0x2000, false));
+
+	RBin *bin = r_bin_new ();
+	RIO *io = r_io_new ();
+	r_io_bind (io, &bin->iob);
+	RBinOptions opt = {0};
+	ut64 first = 0;
+	r_sys_setenv ("R_DYLDCACHE_FILTER", NULL);
+	mu_assert ("cache could not be opened", r_bin_open (bin, file, &opt));
+	mu_assert_streq (bin->cur->o->plugin->name, "dyldcache", "plugin");
+	mu_assert_eq (dyldcache_locals (bin, &first), 0, "no local symbols without a filter");
+	r_bin_free (bin);
+	r_io_free (io);
+
+	// from the mapped file
+	bin = r_bin_new ();
+	io = r_io_new ();
+	r_io_bind (io, &bin->iob);
+	r_sys_setenv ("R_DYLDCACHE_FILTER", "libfixture");
+	memset (&opt, 0, sizeof (opt));
+	mu_assert ("cache could not be opened", r_bin_open (bin, file, &opt));
+mu_assert_eq (dyldcache_locals (bin, &first), 2, "local symbols of the filtered image");
+	mu_assert_eq (first, 0x180000500, "first local symbol");
+	RBinSymbol *sym = r_list_last (r_bin_get_symbols (bin));
+	mu_assert_streq (sym->name, "_local_two", "local symbol name");
+	r_bin_free (bin);
+	r_io_free (io);
+
+	// from a buffer, without a file to map
+	bin = r_bin_new ();
+	io = r_io_new ();
+	r_io_bind (io, &bin->iob);
+	RBuffer *b = r_buf_new_with_bytes (buf, 0x2000);
+	memset (&opt, 0, sizeof (opt));
+	opt.filename = "dyldcache.buf";
+	mu_assert ("cache buffer could not be opened", r_bin_open_buf (bin, b, &opt));
+	mu_assert_eq (dyldcache_locals (bin, &first), 2, "local symbols from a buffer");
+	sym = r_list_last (r_bin_get_symbols (bin));
+	mu_assert_streq (sym->name, "_local_two", "local symbol name from a buffer");
+	r_buf_free (b);
+	r_bin_free (bin);
+	r_io_free (io);
+
+	r_sys_setenv ("R_DYLDCACHE_FILTER", NULL);
+	r_file_rm (file);
+	free (file);
+	free (buf);
+	mu_end;
+}
 
 bool all_tests() {
 	mu_run_test(test_r_bin);
+	mu_run_test(test_r_bin_dyldcache_locals);
 	return tests_passed != tests_run;
 }
 
@@ -0,0 +1,94 @@
+#include <r_bin.h>
+#include "minunit.h"
+
+static RIO *io = NULL;
+
+static RBinFile *open_bin(RBin *bin) {
+	r_io_bind (io, &bin->iob);
+	RBuffer *buf = r_buf_new_with_bytes ((const ut8 *)"\x00\x00\x00\x00", 4);
+	RBinOptions opt;
+	r_bin_options_init (&opt, -1, 0, 0, false);
+	opt.filename = "demangle";
+	bool res = r_bin_open_buf (bin, buf, &opt);
+	r_buf_free (buf);
+	return res? r_bin_cur (bin): NULL;
+}
+
+static bool test_demangle_cache(void) {
+	RBin *bin = r_bin_new ();
+	RBinFile *bf = open_bin (bin);
+	mu_assert ("bin file", bf && bf->o);
+	char *res = r_bin_demangle (bf, "cxx", "_ZN3foo3barEv", 0, false);
+	mu_assert_streq (res, "foo::bar()", "demangled");
+	free (res);
+	mu_assert_notnull (bf->o->demangled, "cache");
+	mu_assert_eq (bf->o->demangled->count, 1, "cached");
+	res = r_bin_demangle (bf, "cxx", "_ZN3foo3barEv", 0, false);
+	mu_assert_streq (res, "foo::bar()", "from the cache");
+	free (res);
+	mu_assert_eq (bf->o->demangled->count, 1, "cached once");
+	// failures are cached too
+	mu_assert_null (r_bin_demangle (bf, "cxx", "_Znot_mangled", 0, false), "failure");
+	mu_assert_null (r_bin_demangle (bf, "cxx", "_Znot_mangled", 0, false), "cached failure");
+	mu_assert_eq (bf->o->demangled->count, 2, "failure cached");
+
+	// the external demangler gives different results for the same name
+	free (r_bin_demangle (bf, "swift", "_TFC5swift3foo", 0, false));
+	mu_assert_eq (bf->o->demangled->count, 3, "swift");
+	bin->demanglercmd = true;
+	free (r_bin_demangle (bf, "swift", "_TFC5swift3foo", 0, false));
+	mu_assert_eq (bf->o->demangled->count, 4, "swift with demanglercmd");
+	bin->demanglercmd = false;
+	free (r_bin_demangle (bf, "swift", "_TFC5swift3foo", 0, false));
+	mu_assert_eq (bf->o->demangled->count, 4, "swift without demanglercmd");
+	r_bin_free (bin);
+	mu_end;
+}
+
+static bool test_demangle_batch(void) {
+	const char *names[][2] = {
+		{ "_ZN3foo3barEv", "foo::bar()" },
+		{ "_ZN3foo3bazEi", "foo::baz(int)" },
+		{ "_ZN3bar3fooEv", "bar::foo()" },
+		{ "_Z4mainv", "main()" },
+		{ "_ZN3foo3barEv", "foo::bar()" },
+		{ "plain_name", NULL },
+	};
+	RBin *bin = r_bin_new ();
+	RBinFile *bf = open_bin (bin);
+	mu_assert ("bin file", bf && bf->o);
+	RList *syms = r_list_newf (r_bin_symbol_free);
+	size_t i;
+	for (i = 0; i < R_ARRAY_SIZE (names); i++) {
+		r_list_append (syms, r_bin_symbol_new (names[i][0], i * 0x10, 0x1000 + i * 0x10));
+	}
+	mu_assert_eq (r_bin_demangle_batch (bf, "cxx", syms, 4), 5, "unique names");
+	mu_assert_eq (r_bin_demangle_batch (bf, "cxx", syms, 4), 0, "already cached");
+	mu_assert_eq (bf->o->demangled->count, 5, "cache size");
+	for (i = 0; i < R_ARRAY_SIZE (names); i++) {
+		char *res = r_bin_demangle (bf, "cxx", names[i][0], 0, false);
+		if (names[i][1]) {
+			mu_assert_streq (res, names[i][1], "batch result");
+		} else {
+			mu_assert_null (res, "not mangled");
+		}
+		free (res);
+	}
+	mu_assert_eq (bf->o->demangled->count, 5, "served from the cache");
+	r_list_free (syms);
+	r_bin_free (bin);
+	mu_end;
+}
+
+static int all_tests() {
+	mu_run_test (test_demangle_cache);
+	mu_run_test (test_demangle_batch);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	io = r_io_new ();
+	int res = all_tests ();
+	r_io_free (io);
+	return res;
+}
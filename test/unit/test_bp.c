@@ -0,0 +1,176 @@
+#include <r_bp.h>
+#include "minunit.h"
+
+static ut8 mem[0x4000];
+static int writes;
+static bool fail_reads;
+static bool fail_writes;
+
+static bool mem_read_at(RIO *io, ut64 addr, ut8 *buf, int len) {
+	if (fail_reads) {
+		return false;
+	}
+	memset (buf, 0xff, len);
+	if (addr < sizeof (mem)) {
+		memcpy (buf, mem + addr, R_MIN (len, sizeof (mem) - addr));
+	}
+	return true;
+}
+
+static bool mem_write_at(RIO *io, ut64 addr, const ut8 *buf, int len) {
+	if (fail_writes) {
+		return false;
+	}
+	if (addr + len <= sizeof (mem)) {
+		memcpy (mem + addr, buf, len);
+	}
+	writes++;
+	return true;
+}
+
+static RBreakpoint *bp_new(void) {
+	RBreakpoint *bp = r_bp_new ();
+	r_bp_use (bp, "x86", 64);
+	bp->iob.read_at = mem_read_at;
+	bp->iob.write_at = mem_write_at;
+	size_t i;
+	for (i = 0; i < sizeof (mem); i++) {
+		mem[i] = i & 0x7f;
+	}
+	writes = 0;
+	fail_reads = fail_writes = false;
+	return bp;
+}
+
+bool test_r_bp_index(void) {
+	RBreakpoint *bp = bp_new ();
+	ut64 addr;
+	for (addr = 0x100; addr < 0x1100; addr += 0x10) {
+		mu_assert_notnull (r_bp_add_sw (bp, addr, 1, R_BP_PROT_EXEC), "add");
+	}
+	mu_assert_null (r_bp_add_sw (bp, 0x100, 1, R_BP_PROT_EXEC), "no duplicates");
+	RBreakpointItem *b = r_bp_get_at (bp, 0x200);
+	mu_assert_notnull (b, "get_at");
+	mu_assert_eq (b->addr, 0x200, "get_at addr");
+	mu_assert_null (r_bp_get_at (bp, 0x201), "get_at miss");
+	mu_assert_eq (r_bp_get_index_at (bp, 0x200), 16, "index");
+	mu_assert_ptreq (r_bp_get_index (bp, 16), b, "get_index");
+
+	RBreakpointItem *w = r_bp_watch_add (bp, 0x3000, 0x20, true, R_BP_PROT_WRITE);
+	mu_assert_notnull (w, "watch");
+	mu_assert_ptreq (r_bp_get_in (bp, 0x301f, 0), w, "get_in range end");
+	mu_assert_null (r_bp_get_in (bp, 0x3020, 0), "get_in past range");
+
+	r_bp_item_relocate (bp, b, 0x2000);
+	mu_assert_null (r_bp_get_at (bp, 0x200), "relocated away");
+	mu_assert_ptreq (r_bp_get_at (bp, 0x2000), b, "relocated");
+
+	mu_assert ("del", r_bp_del (bp, 0x2000));
+	mu_assert_null (r_bp_get_at (bp, 0x2000), "deleted");
+	mu_assert_eq (r_list_length (bp->bps), 256, "count");
+	mu_assert ("del_index", r_bp_del_index (bp, 17));
+	mu_assert_null (r_bp_get_at (bp, 0x210), "deleted by index");
+	r_bp_free (bp);
+	mu_end;
+}
+
+bool test_r_bp_restore_batched(void) {
+	RBreakpoint *bp = bp_new ();
+	ut64 addr;
+	for (addr = 0x100; addr < 0x2100; addr += 0x20) {
+		r_bp_add_sw (bp, addr, 1, R_BP_PROT_EXEC);
+	}
+	r_bp_restore (bp, true);
+	mu_assert_eq (writes, 3, "one write per page");
+	for (addr = 0x100; addr < 0x2100; addr += 0x20) {
+		mu_assert_eq (mem[addr], 0xcc, "bp set");
+		mu_assert_eq (mem[addr + 1], (addr + 1) & 0x7f, "untouched");
+	}
+	r_bp_restore (bp, false);
+	for (addr = 0x100; addr < 0x2100; addr++) {
+		mu_assert_eq (mem[addr], addr & 0x7f, "restored");
+	}
+	r_bp_free (bp);
+	mu_end;
+}
+
+bool test_r_bp_restore_failures(void) {
+	RBreakpoint *bp = bp_new ();
+	ut64 addr;
+	for (addr = 0x100; addr < 0x200; addr += 0x20) {
+		r_bp_add_sw (bp, addr, 1, R_BP_PROT_EXEC);
+	}
+	// without the bytes in between, every breakpoint is written alone
+	fail_reads = true;
+	mu_assert ("restored", r_bp_restore (bp, true));
+	mu_assert_eq (writes, 8, "one write per breakpoint");
+	for (addr = 0x100; addr < 0x200; addr += 0x20) {
+		mu_assert_eq (mem[addr], 0xcc, "bp set");
+		mu_assert_eq (mem[addr + 1], (addr + 1) & 0x7f, "untouched");
+	}
+	fail_writes = true;
+	mu_assert ("write failure reported", !r_bp_restore (bp, false));
+	fail_reads = false;
+	mu_assert ("write failure reported for a batch", !r_bp_restore (bp, false));
+	r_bp_free (bp);
+	mu_end;
+}
+
+bool test_r_bp_coverage(void) {
+	RBreakpoint *bp = bp_new ();
+	ut64 addrs[] = { 0x30, 0x10, 0x20, 0x10, 0x1010 };
+	mu_assert_eq (r_bp_add_coverage (bp, addrs, 5), 4, "added, dups skipped");
+	RBreakpointItem *b = r_bp_get_at (bp, 0x20);
+	mu_assert ("coverage", b && b->coverage);
+	mu_assert_eq (b->obytes[0], 0x20, "original bytes");
+	mu_assert ("hit", r_bp_coverage_hit (bp, b));
+	mu_assert ("disabled after hit", !b->enabled);
+	mu_assert_eq (r_bitmap_test (bp->cov_hits, b->cov_idx), 1, "hit recorded");
+	mu_assert_eq (r_bp_del_coverage (bp), 4, "del");
+	mu_assert_eq (r_list_length (bp->bps), 0, "all gone");
+	r_bp_free (bp);
+	mu_end;
+}
+
+static void count_write_cb(REvent *ev, int type, void *user, void *data) {
+	(*(int *)user)++;
+}
+
+bool test_r_bp_restore_no_event(void) {
+	RIO *io = r_io_new ();
+	mu_assert_notnull (r_io_open_at (io, "malloc://0x4000", R_PERM_RW, 0644, 0), "open");
+	io->ev = r_event_new (NULL);
+	int events = 0;
+	r_event_hook (io->ev, R_EVENT_IO_WRITE, count_write_cb, &events);
+	RBreakpoint *bp = r_bp_new ();
+	r_bp_use (bp, "x86", 64);
+	r_io_bind (io, &bp->iob);
+	r_bp_add_sw (bp, 0x100, 1, R_BP_PROT_EXEC);
+	r_bp_add_sw (bp, 0x2000, 1, R_BP_PROT_EXEC);
+	r_bp_restore (bp, true);
+	ut8 b = 0;
+	r_io_read_at (io, 0x100, &b, 1);
+	mu_assert_eq (b, 0xcc, "bp set");
+	r_bp_restore (bp, false);
+	mu_assert_eq (events, 0, "breakpoints are not writes");
+	r_io_write_at (io, 0x100, (const ut8 *)"\x90", 1);
+	mu_assert_eq (events, 1, "writes are");
+	r_bp_free (bp);
+	r_event_free (io->ev);
+	io->ev = NULL;
+	r_io_free (io);
+	mu_end;
+}
+
+int all_tests(void) {
+	mu_run_test (test_r_bp_index);
+	mu_run_test (test_r_bp_restore_batched);
+	mu_run_test (test_r_bp_restore_failures);
+	mu_run_test (test_r_bp_coverage);
+	mu_run_test (test_r_bp_restore_no_event);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests ();
+}
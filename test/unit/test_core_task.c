@@ -0,0 +1,125 @@
+#include <r_core.h>
+#include "minunit.h"
+
+#define SEARCH_CMD "/xj 41424344"
+
+static RCore *task_core(int slice) {
+	RCore *core = r_core_new ();
+	r_core_cmd0 (core, "o malloc://0x4000000");
+	r_core_cmd0 (core, "e search.in=io.maps");
+	r_core_cmdf (core, "e cmd.timeslice=%d", slice);
+	r_core_task_sync_begin (&core->tasks);
+	return core;
+}
+
+/* start a background search and return how long the prompt has to wait
+ * to get the core back after letting the task run for 100ms */
+static ut64 task_latency(RCore *core, RCoreTask **bg) {
+	RCoreTask *task = r_core_task_new (core, true, SEARCH_CMD, NULL, NULL);
+	r_core_task_enqueue (&core->tasks, task);
+	RCoreTask *main_task = core->tasks.main_task;
+	r_core_task_sleep_begin (main_task);
+	r_sys_usleep (100000);
+	ut64 t = r_time_now_mono ();
+	r_core_task_sleep_end (main_task);
+	*bg = task;
+	return r_time_now_mono () - t;
+}
+
+static bool test_core_task_preempt(void) {
+	RCore *core = task_core (20);
+	RCoreTask *bg;
+	task_latency (core, &bg);
+	mu_assert_eq (bg->state, R_CORE_TASK_STATE_RUNNING, "background task still running");
+	mu_assert_streq (r_core_task_status (bg), "preempted", "background task preempted");
+	mu_assert_eq (core->tasks.unsafe, 1, "one task suspended in the middle of a command");
+
+	// read-only commands run right away and see the seek of the prompt
+	char *s = r_core_cmd_str (core, "p8 4");
+	mu_assert_streq (s, "00000000\n", "reader output");
+	free (s);
+	mu_assert_eq (core->offset, 0, "prompt keeps its own seek");
+	mu_assert_eq (bg->state, R_CORE_TASK_STATE_RUNNING, "reader did not wait for the task");
+
+	// and resize their own block, not the one of the preempted command
+	ut8 *bg_block = bg->block;
+	ut32 bg_blocksize = bg->blocksize;
+	ut32 bsize = core->blocksize;
+	mu_assert_notnull (bg_block, "preempted task keeps its block");
+	mu_assert ("prompt has its own block", core->block != bg_block);
+	s = r_core_cmd_str (core, "p8 0x2000");
+	mu_assert_eq (strlen (s), 0x4001, "reader output");
+	free (s);
+	mu_assert_eq (core->blocksize, bsize, "prompt blocksize restored");
+	mu_assert ("preempted block untouched", bg->block == bg_block && bg->blocksize == bg_blocksize);
+
+	// writers wait for the preempted command to finish
+	r_core_cmd0 (core, "s 0x100");
+	mu_assert_eq (core->tasks.unsafe, 0, "no task suspended after a writer");
+	mu_assert_eq (core->offset, 0x100, "seek after writer");
+	r_core_task_join (&core->tasks, core->tasks.main_task, bg->id);
+	mu_assert_eq (bg->state, R_CORE_TASK_STATE_DONE, "background task done");
+	r_core_task_sync_end (&core->tasks);
+	r_core_free (core);
+
+	// without a time slice the prompt only gets the core once the task is done
+	core = task_core (0);
+	task_latency (core, &bg);
+	mu_assert_eq (bg->state, R_CORE_TASK_STATE_DONE, "background task ran to the end");
+	mu_assert_eq (core->tasks.unsafe, 0, "nothing preempted");
+	r_core_task_sync_end (&core->tasks);
+	r_core_free (core);
+	mu_end;
+}
+
+static bool test_core_task_preempt_bench(void) {
+	mu_bench_only;
+	RCoreTask *bg;
+	RCore *core = task_core (20);
+	ut64 lat = task_latency (core, &bg);
+	r_core_task_join (&core->tasks, core->tasks.main_task, bg->id);
+	r_core_task_sync_end (&core->tasks);
+	r_core_free (core);
+	core = task_core (0);
+	ut64 base = task_latency (core, &bg);
+	r_core_task_sync_end (&core->tasks);
+	r_core_free (core);
+	eprintf ("prompt latency with a background search: preempted %"PFMT64u"us, not preempted %"PFMT64u"us\n", lat, base);
+	mu_end;
+}
+
+static bool test_core_task_free_cores(void) {
+	RCore *core = r_core_new ();
+	r_core_free (core);
+	core = r_core_new ();
+	r_core_free (core);
+	mu_assert_null (r_cons_singleton ()->user, "no core left in cons");
+	// the break callback must not reach the freed cores
+	r_cons_is_breaked ();
+	mu_end;
+}
+
+static bool test_core_task_priority(void) {
+	RCore *core = task_core (20);
+	r_core_cmd0 (core, "&p 5 ?e hi");
+	r_core_cmd0 (core, "&&");
+	char *s = r_core_cmd_str (core, "&j");
+	mu_assert ("task priority listed", strstr (s, "\"priority\":5"));
+	mu_assert ("main task priority listed", strstr (s, "\"priority\":10"));
+	free (s);
+	r_core_task_sync_end (&core->tasks);
+	r_core_free (core);
+	mu_end;
+}
+
+static int all_tests() {
+	mu_run_test (test_core_task_preempt);
+	mu_run_test (test_core_task_priority);
+	mu_run_test (test_core_task_preempt_bench);
+	mu_run_test (test_core_task_free_cores);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests ();
+}
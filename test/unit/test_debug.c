@@ -1,4 +1,5 @@
 #include <r_debug.h>
+#include <r_anal.h>
 #include "minunit.h"
 #if __linux__
 #include <sys/user.h>
@@ -52,9 +53,97 @@ bool test_r_debug_reg_offset(void) {
 	mu_end;
 }
 
+static const char *profile = "=PC pc\n"
+	"gpr pc .32 0 0\n"
+	"gpr r0 .32 4 0\n";
+
+bool test_r_debug_trace_rec_replay(void) {
+	char *file = r_file_temp ("r2trace");
+	RDebugTraceRec *rec = r_debug_trace_rec_new (file);
+	mu_assert_notnull (rec, "recorder");
+	RDebug *dbg = r_debug_new (true);
+	r_reg_set_profile_string (dbg->reg, profile);
+	r_reg_setv (dbg->reg, "r0", 1);
+	r_debug_trace_rec_regs (rec, dbg->reg);
+	RRegItem *r0 = r_reg_get (dbg->reg, "r0", -1);
+	r_debug_trace_rec_step (rec, 0x10);
+	r_debug_trace_rec_reg (rec, r0->arena, r0->offset, 0x1234);
+	r_debug_trace_rec_mem (rec, 0x20, (const ut8 *)"ABCD", 4);
+	r_debug_trace_rec_step (rec, 0x14);
+	r_debug_trace_rec_mem (rec, 0x22, (const ut8 *)"XY", 2);
+	r_debug_trace_rec_step (rec, 0x18);
+	r_debug_trace_rec_free (rec);
+
+	RIO *io = r_io_new ();
+	r_io_open_at (io, "malloc://64", R_PERM_RW, 0644, 0);
+	r_io_bind (io, &dbg->iob);
+	r_reg_setv (dbg->reg, "r0", 0);
+	mu_assert_eq (r_debug_trace_rec_replay (dbg, file, 1), 1, "steps replayed");
+	mu_assert_eq (r_reg_getv (dbg->reg, "r0"), 0x1234, "register replayed");
+	mu_assert_eq (r_reg_getv (dbg->reg, "pc"), 0x14, "pc of the next step");
+	mu_assert_eq (io->cached, 0, "io.cache.read is left to the user");
+	io->cached = R_PERM_R;
+	ut8 buf[4];
+	r_io_read_at (io, 0x20, buf, sizeof (buf));
+	mu_assert_memeq (buf, (const ut8 *)"ABCD", 4, "memory from the cache");
+	mu_assert_eq (r_debug_trace_rec_replay (dbg, file, 2), 2, "two steps replayed");
+	r_io_read_at (io, 0x20, buf, sizeof (buf));
+	mu_assert_memeq (buf, (const ut8 *)"ABXY", 4, "later writes win");
+
+	// the target itself was not written
+	io->cached = 0;
+	r_io_read_at (io, 0x20, buf, sizeof (buf));
+	mu_assert_memeq (buf, (const ut8 *)"\x00\x00\x00\x00", 4, "target untouched");
+
+	r_debug_free (dbg);
+	r_io_free (io);
+	r_file_rm (file);
+	free (file);
+	mu_end;
+}
+
+bool test_r_debug_trace_ops(void) {
+	RDebug *dbg = r_debug_new (true);
+	RAnal *anal = r_anal_new ();
+	RIO *io = r_io_new ();
+	r_io_open_at (io, "malloc://64", R_PERM_RW, 0644, 0);
+	r_io_write_at (io, 0, (const ut8 *)"\x08\x95\x08\x95", 4); // ret; ret
+	r_io_bind (io, &dbg->iob);
+	r_anal_use (anal, "avr");
+	r_anal_set_cpu (anal, "ATmega8");
+	r_reg_set_profile_string (dbg->reg, profile);
+	r_reg_free (anal->reg);
+	anal->reg = dbg->reg;
+	dbg->anal = anal;
+
+	mu_assert ("decoded", r_debug_trace_ins_before (dbg));
+	RAnalOp *op = dbg->cur_op;
+	mu_assert ("cached", r_debug_trace_ins_before (dbg) && dbg->cur_op == op);
+	mu_assert_eq (dbg->trace->ops->count, 1, "one op");
+
+	// the ops hold register items, a new profile drops them
+	r_reg_set_profile_string (dbg->reg, "=PC pc\ngpr pc .32 0 0\ngpr r1 .32 4 0\n");
+	mu_assert ("decoded again", r_debug_trace_ins_before (dbg));
+	mu_assert_eq (dbg->trace->ops_reg_epoch, dbg->reg->epoch, "synced with the profile");
+	mu_assert_eq (dbg->trace->ops->count, 1, "old op dropped");
+	r_anal_set_bits (anal, 16);
+	r_debug_trace_ops_clear (dbg);
+	mu_assert_null (dbg->cur_op, "no current op");
+	mu_assert_eq (dbg->trace->ops->count, 0, "cleared");
+
+	dbg->anal = NULL;
+	anal->reg = NULL;
+	r_debug_free (dbg);
+	r_anal_free (anal);
+	r_io_free (io);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test (test_r_debug_use);
 	mu_run_test (test_r_debug_reg_offset);
+	mu_run_test (test_r_debug_trace_rec_replay);
+	mu_run_test (test_r_debug_trace_ops);
 	return tests_passed != tests_run;
 }
 
@@ -190,9 +190,97 @@ static bool test_session_load(void) {
 	mu_end;
 }
 
+typedef struct {
+	int steps, regs, mems, arenas;
+	ut64 last_pc;
+	ut8 last_mem[4];
+} TraceCount;
+
+static bool count_events(void *user, const RDebugTraceEvent *ev) {
+	TraceCount *c = user;
+	switch (ev->type) {
+	case R_DEBUG_TRACE_REC_REGS:
+		c->arenas++;
+		break;
+	case R_DEBUG_TRACE_REC_STEP:
+		c->steps++;
+		c->last_pc = ev->pc;
+		break;
+	case R_DEBUG_TRACE_REC_REG:
+		c->regs++;
+		break;
+	case R_DEBUG_TRACE_REC_MEM:
+		c->mems++;
+		memcpy (c->last_mem, ev->data, R_MIN (ev->len, 4));
+		break;
+	}
+	return true;
+}
+
+static bool test_trace_rec(void) {
+	char *file = r_file_temp ("trace");
+	RDebug *dbg = r_debug_new (true);
+	RIO *io = r_io_new ();
+	r_io_open_at (io, "malloc://0x1000", R_PERM_RW, 0644, 0);
+	r_io_bind (io, &dbg->iob);
+	r_reg_set_profile_string (dbg->reg, "=PC pc\ngpr pc .64 0 0\ngpr r0 .64 8 0\n");
+	RRegItem *pc = r_reg_get (dbg->reg, "pc", -1);
+	RRegItem *r0 = r_reg_get (dbg->reg, "r0", -1);
+	r_reg_set_value (dbg->reg, r0, 0x1234);
+
+	// 100k steps, enough to wrap the block ring several times
+	RDebugTraceRec *rec = r_debug_trace_rec_new (file);
+	mu_assert_notnull (rec, "recorder");
+	r_debug_trace_rec_regs (rec, dbg->reg);
+	ut32 i;
+	for (i = 1; i <= 100000; i++) {
+		ut8 data[4];
+		r_write_le32 (data, i);
+		r_debug_trace_rec_step (rec, 0x1000 + i * 4);
+		r_debug_trace_rec_reg (rec, r0->arena, r0->offset, i);
+		r_debug_trace_rec_mem (rec, 0x100 + (i % 16) * 4, data, sizeof (data));
+	}
+	mu_assert_true (r_debug_trace_rec_flush (rec), "flush");
+	r_debug_trace_rec_free (rec);
+
+	TraceCount c = {0};
+	mu_assert_true (r_debug_trace_rec_foreach (file, count_events, &c), "foreach");
+	mu_assert_eq (c.arenas, 1, "one arena snapshot (gpr)");
+	mu_assert_eq (c.steps, 100000, "steps");
+	mu_assert_eq (c.regs, 100000, "reg events");
+	mu_assert_eq (c.mems, 100000, "mem events");
+	mu_assert_eq (c.last_pc, 0x1000 + 100000 * 4, "last pc");
+	mu_assert_eq (r_read_le32 (c.last_mem), 100000, "last write");
+
+	// replay the state after step 42 without any process around
+	r_reg_set_value (dbg->reg, r0, 0);
+	ut64 n = r_debug_trace_rec_replay (dbg, file, 42);
+	mu_assert_eq (n, 42, "replayed steps");
+	mu_assert_eq (r_reg_get_value (dbg->reg, r0), 42, "r0 after step 42");
+	mu_assert_eq (r_reg_get_value (dbg->reg, pc), 0x1000 + 43 * 4, "pc of step 43");
+	io->cached = R_PERM_R;
+	ut8 buf[4];
+	r_io_read_at (io, 0x100 + (42 % 16) * 4, buf, sizeof (buf));
+	mu_assert_eq (r_read_le32 (buf), 42, "memory written by step 42");
+	r_io_read_at (io, 0x100 + (43 % 16) * 4, buf, sizeof (buf));
+	mu_assert_eq (r_read_le32 (buf), 27, "memory last written by step 27");
+
+	// the initial snapshot restores the registers of step 0
+	n = r_debug_trace_rec_replay (dbg, file, 0);
+	mu_assert_eq (n, 0, "nothing replayed");
+	mu_assert_eq (r_reg_get_value (dbg->reg, r0), 0x1234, "r0 before the first step");
+
+	r_file_rm (file);
+	free (file);
+	r_debug_free (dbg);
+	r_io_free (io);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test (test_session_save);
 	mu_run_test (test_session_load);
+	mu_run_test (test_trace_rec);
 	return tests_passed != tests_run;
 }
 
@@ -324,9 +324,48 @@ bool test_dwarf4_cpp_multiple_modules(void) {
 	mu_end;
 }
 
+bool test_dwarf4_cpp_multiple_modules_threaded(void) {
+	RBin *bin = r_bin_new ();
+	RIO *io = r_io_new ();
+	r_io_bind (io, &bin->iob);
+
+	RBinOptions opt = { 0 };
+	bool res = r_bin_open (bin, "bins/elf/dwarf4_many_comp_units.elf", &opt);
+	mu_assert ("dwarf4_many_comp_units.elf binary could not be opened", res);
+
+	RBinDwarfDebugAbbrev *da = r_bin_dwarf_parse_abbrev (bin, MODE);
+	RBinDwarfDebugInfo *serial = r_bin_dwarf_parse_info (da, bin, MODE);
+	mu_assert_notnull (serial, "Failed parsing of debug_info");
+	bin->dbginfo_threads = 2;
+	RBinDwarfDebugInfo *info = r_bin_dwarf_parse_info (da, bin, MODE);
+	mu_assert_notnull (info, "Failed parallel parsing of debug_info");
+	mu_assert_eq (info->count, serial->count, "Incorrect number of info compilation units");
+
+	size_t i, j;
+	for (i = 0; i < info->count; i++) {
+		RBinDwarfCompUnit *a = &serial->comp_units[i];
+		RBinDwarfCompUnit *b = &info->comp_units[i];
+		mu_assert_eq (b->offset, a->offset, "Wrong compilation unit order");
+		mu_assert_eq (b->count, a->count, "Wrong number of DIEs");
+		for (j = 0; j < b->count; j++) {
+			mu_assert_eq (b->dies[j].offset, a->dies[j].offset, "Wrong DIE offset");
+			mu_assert_eq (b->dies[j].tag, a->dies[j].tag, "Wrong DIE tag");
+			mu_assert_eq (b->dies[j].count, a->dies[j].count, "Wrong DIE length");
+		}
+	}
+
+	r_bin_dwarf_free_debug_info (serial);
+	r_bin_dwarf_free_debug_info (info);
+	r_bin_dwarf_free_debug_abbrev (da);
+	r_bin_free (bin);
+	r_io_free (io);
+	mu_end;
+}
+
 bool all_tests() {
 	mu_run_test (test_dwarf3_c);
 	mu_run_test (test_dwarf4_cpp_multiple_modules);
+	mu_run_test (test_dwarf4_cpp_multiple_modules_threaded);
 	return tests_passed != tests_run;
 }
 
@@ -0,0 +1,90 @@
+#include <r_anal.h>
+#include <r_reg.h>
+#include <r_util.h>
+#include "minunit.h"
+
+static void trace_expr(RAnalEsil *esil, ut64 addr, const char *expr) {
+	RAnalOp op = {0};
+	r_anal_op_init (&op);
+	op.addr = addr;
+	r_strbuf_set (&op.esil, expr);
+	r_anal_esil_trace (esil, &op);
+	r_anal_op_fini (&op);
+}
+
+static RAnalEsil *trace_esil(RAnal *anal) {
+	r_anal_use (anal, "avr");
+	r_anal_set_cpu (anal, "ATmega8");
+	r_anal_set_reg_profile (anal);
+	RAnalEsil *esil = r_anal_esil_new (4096, 0, 1);
+	r_anal_esil_setup (esil, anal, 0, 0, 0);
+	return esil;
+}
+
+bool test_esil_trace_steps(void) {
+	RAnal *anal = r_anal_new ();
+	RAnalEsil *esil = trace_esil (anal);
+	trace_expr (esil, 0x100, "0x33,r16,=");
+	trace_expr (esil, 0x102, "r16,r17,=,0x44,r16,=");
+	trace_expr (esil, 0x104, "r17,0x80,=[1]");
+	RAnalEsilTrace *trace = esil->trace;
+	mu_assert_notnull (trace, "trace created on demand");
+	mu_assert_eq (r_anal_esil_trace_last (trace), 2, "last step");
+
+	RAnalEsilTraceStep *step = r_anal_esil_trace_step (trace, 1);
+	mu_assert_notnull (step, "step 1");
+	mu_assert_eq (step->addr, 0x102, "step address");
+	mu_assert_null (r_anal_esil_trace_step (trace, 3), "no step past the end");
+
+	ut64 v = 0;
+	mu_assert_true (r_anal_esil_trace_reg_read (trace, 1, "r16", &v), "r16 read");
+	mu_assert_eq (v, 0x33, "r16 read value");
+	mu_assert_true (r_anal_esil_trace_reg_write (trace, 1, "r16", &v), "r16 written");
+	mu_assert_eq (v, 0x44, "last write wins");
+	mu_assert_true (r_anal_esil_trace_reg_write (trace, 1, "r17", NULL), "r17 written");
+	mu_assert_false (r_anal_esil_trace_reg_write (trace, 0, "r17", NULL), "r17 not written in step 0");
+	mu_assert_false (r_anal_esil_trace_reg_read (trace, 1, "r30", NULL), "unknown register");
+
+	step = r_anal_esil_trace_step (trace, 2);
+	mu_assert_eq (step->mem_write.len, 1, "one memory write");
+	RAnalEsilTraceMem *m = r_vector_index_ptr (&step->mem_write, 0);
+	mu_assert_eq (m->addr, 0x80, "memory write address");
+	mu_assert_eq (m->len, 1, "memory write size");
+	mu_assert_eq (m->data[0], 0x33, "memory write data");
+
+	r_anal_esil_trace_reset (trace);
+	mu_assert_null (r_anal_esil_trace_step (trace, 0), "reset drops the steps");
+	trace_expr (esil, 0x106, "0x1,r18,=");
+	step = r_anal_esil_trace_step (trace, 3);
+	mu_assert_notnull (step, "indices continue after a reset");
+	mu_assert_eq (step->addr, 0x106, "step address after reset");
+
+	r_anal_esil_free (esil);
+	r_anal_free (anal);
+	mu_end;
+}
+
+bool test_esil_trace_sdb(void) {
+	RAnal *anal = r_anal_new ();
+	RAnalEsil *esil = trace_esil (anal);
+	trace_expr (esil, 0x100, "0x33,r16,=,r16,r17,=");
+	Sdb *db = r_anal_esil_trace_sdb (esil->trace);
+	mu_assert_streq (sdb_const_get (db, "idx", 0), "0", "idx");
+	mu_assert_streq (sdb_const_get (db, "0.addr", 0), "0x100", "addr");
+	mu_assert_streq (sdb_const_get (db, "0.reg.write", 0), "r16,r17", "written registers");
+	mu_assert_streq (sdb_const_get (db, "0.reg.read.r16", 0), "0x33", "read value");
+	sdb_free (db);
+	r_anal_esil_free (esil);
+	r_anal_free (anal);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_esil_trace_steps);
+	mu_run_test (test_esil_trace_sdb);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests ();
+}
@@ -128,10 +128,159 @@ bool test_r_flag_get_at() {
 	mu_end;
 }
 
+static bool count_cb(RFlagItem *fi, void *user) {
+	(*(int *)user)++;
+	return true;
+}
+
+bool test_r_flag_bulk(void) {
+	RFlag *flag = r_flag_new ();
+	r_flag_set (flag, "a", 0x100, 0);
+	r_flag_bulk_begin (flag);
+	r_flag_set (flag, "c", 0x300, 0);
+	r_flag_set (flag, "b", 0x100, 0);
+	RFlagItem *d = r_flag_set (flag, "d", 0x200, 0);
+	r_flag_set (flag, "e", 0x400, 0);
+	r_flag_set (flag, "e", 0x500, 0);
+	mu_assert_ptreq (r_flag_get_i (flag, 0x200), d, "lookups work in bulk");
+	r_flag_set (flag, "f", 0x100, 0);
+	r_flag_unset_name (flag, "c");
+	r_flag_bulk_end (flag);
+
+	char *s = r_flag_get_liststr (flag, 0x100);
+	mu_assert_streq (s, "a,b,f:", "flags at an offset keep their order");
+	free (s);
+	mu_assert_null (r_flag_get_list (flag, 0x300), "unset in bulk");
+	mu_assert_null (r_flag_get_list (flag, 0x400), "moved in bulk");
+	mu_assert_ptreq (r_flag_get_at (flag, 0x350, true), d, "closest skips removed offsets");
+	mu_assert_streq (r_flag_get_at (flag, 0x600, true)->name, "e", "closest");
+	int n = 0;
+	r_flag_foreach_range (flag, 0x100, 0x500, count_cb, &n);
+	mu_assert_eq (n, 4, "flags in range");
+	mu_assert_eq (r_flag_count (flag, NULL), 5, "flags");
+	r_flag_free (flag);
+	mu_end;
+}
+
+static bool set_next_cb(RFlagItem *fi, void *user) {
+	RFlag *flag = user;
+	char name[32];
+	snprintf (name, sizeof (name), "%s.next", fi->name);
+	if (!strstr (fi->name, ".next")) {
+		r_flag_set (flag, name, fi->offset + 1, 0);
+	}
+	return true;
+}
+
+bool test_r_flag_lookups_keep_index(void) {
+	RFlag *flag = r_flag_new ();
+	char name[32];
+	int i;
+	for (i = 0; i < 10; i++) {
+		snprintf (name, sizeof (name), "f.%d", i);
+		r_flag_set (flag, name, 0x1000 - i * 0x10, 0);
+	}
+	size_t log = flag->by_off_log.len;
+	mu_assert ("offsets in the log", log > 0);
+	mu_assert_eq (flag->by_off_log_sorted, log, "log kept sorted");
+	mu_assert_streq (r_flag_get_at (flag, 0xf85, true)->name, "f.8", "closest");
+	mu_assert_notnull (r_flag_get_list (flag, 0x1000), "list");
+	int n = 0;
+	r_flag_foreach (flag, count_cb, &n);
+	mu_assert_eq (n, 10, "foreach");
+	mu_assert_eq (flag->by_off_log.len, log, "lookups do not merge");
+
+	// offsets set while iterating are merged when the iteration ends
+	r_flag_foreach (flag, set_next_cb, flag);
+	mu_assert_eq (flag->by_off_log_sorted, flag->by_off_log.len, "merged");
+	mu_assert_eq (r_flag_count (flag, NULL), 20, "flags set from the callback");
+	mu_assert_null (r_flag_get_at (flag, 0x1005, false), "nothing at");
+	mu_assert_streq (r_flag_get_at (flag, 0x1001, false)->name, "f.0.next", "set from the callback");
+	ut64 last = 0;
+	RListIter *iter;
+	RFlagItem *fi;
+	RList *all = r_flag_all_list (flag, false);
+	r_list_foreach (all, iter, fi) {
+		mu_assert ("sorted by offset", fi->offset >= last);
+		last = fi->offset;
+	}
+	r_list_free (all);
+	r_flag_free (flag);
+	mu_end;
+}
+
+bool test_r_flag_unset_glob(void) {
+	RFlag *flag = r_flag_new ();
+	char name[32];
+	int i;
+	for (i = 0; i < 1000; i++) {
+		snprintf (name, sizeof (name), "%s.%d", (i % 10)? "sym": "str", i);
+		r_flag_set (flag, name, i * 0x10, 0);
+	}
+	mu_assert_eq (r_flag_unset_glob (flag, "sym.*"), 900, "unset");
+	mu_assert_eq (r_flag_count (flag, NULL), 100, "left");
+	RFlagItem *fi = r_flag_get_at (flag, 0x95, true);
+	mu_assert_streq (fi->name, "str.0", "closest over removed flags");
+	fi = r_flag_get_at (flag, 0xa0, true);
+	mu_assert_streq (fi->name, "str.10", "closest at exact");
+	mu_assert_null (r_flag_get_i (flag, 0x10), "removed");
+	r_flag_rename (flag, fi, "str.ten");
+	mu_assert_ptreq (r_flag_get (flag, "str.ten"), fi, "renamed");
+	mu_assert_null (r_flag_get (flag, "str.10"), "old name");
+	r_flag_free (flag);
+	mu_end;
+}
+
+#define BENCH_FLAGS 200000
+
+static ut64 bench_set(bool bulk) {
+	RFlag *flag = r_flag_new ();
+	char name[32];
+	int i;
+	ut64 t = r_time_now_mono ();
+	if (bulk) {
+		r_flag_bulk_begin (flag);
+	}
+	for (i = 0; i < BENCH_FLAGS; i++) {
+		// symbols do not come sorted by address
+		ut64 addr = ((ut64)i * 7919) % BENCH_FLAGS * 0x10;
+		snprintf (name, sizeof (name), "sym.fcn_%d", i);
+		r_flag_set (flag, name, addr, 0);
+	}
+	if (bulk) {
+		r_flag_bulk_end (flag);
+	}
+	r_flag_get_i (flag, 0);
+	t = r_time_now_mono () - t;
+	ut64 l = r_time_now_mono ();
+	for (i = 0; i < BENCH_FLAGS; i++) {
+		r_flag_get_at (flag, (ut64)i * 0x10 + 8, true);
+	}
+	l = r_time_now_mono () - l;
+	if (bulk) {
+		eprintf ("%d flags: bulk set %"PFMT64u"us, closest lookups %"PFMT64u"us\n", BENCH_FLAGS, t, l);
+	} else {
+		eprintf ("%d flags: set %"PFMT64u"us, closest lookups %"PFMT64u"us\n", BENCH_FLAGS, t, l);
+	}
+	r_flag_free (flag);
+	return t;
+}
+
+bool test_r_flag_bench(void) {
+	mu_bench_only;
+	bench_set (false);
+	bench_set (true);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test (test_r_flag_get_set);
 	mu_run_test (test_r_flag_by_spaces);
 	mu_run_test (test_r_flag_get_at);
+	mu_run_test (test_r_flag_bulk);
+	mu_run_test (test_r_flag_lookups_keep_index);
+	mu_run_test (test_r_flag_unset_glob);
+	mu_run_test (test_r_flag_bench);
 	return tests_passed != tests_run;
 }
 
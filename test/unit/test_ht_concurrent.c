@@ -0,0 +1,339 @@
+#include <r_util.h>
+#include <r_th.h>
+#include <r_anal.h>
+#include <r_flag.h>
+#include "minunit.h"
+
+#define THREADS 4
+#define KEYS (64 * 1024)
+
+typedef struct {
+	HtUP *ht;
+	ut64 start;
+	ut64 end;
+	ut64 misses;
+	ut64 ops;
+	ut64 us;
+} HtJob;
+
+static bool find_cb(void *user, const ut64 k, const void *v) {
+	HtUP *ht = user;
+	// the iterating thread can keep using the table
+	return ht_up_find (ht, k, NULL) == v;
+}
+
+static bool delete_odd_cb(void *user, const ut64 k, const void *v) {
+	if (k & 1) {
+		ht_up_delete (user, k);
+	}
+	return true;
+}
+
+static bool test_ht_up_concurrent(void) {
+	HtUP *ht = ht_up_new0 ();
+	mu_assert ("set concurrent", ht_up_set_concurrent (ht, true));
+	mu_assert_notnull (ht->locks, "locks");
+	ut64 i;
+	for (i = 0; i < 1000; i++) {
+		mu_assert ("insert", ht_up_insert (ht, i, (void *)(size_t)(i + 1)));
+	}
+	mu_assert ("no duplicates", !ht_up_insert (ht, 7, NULL));
+	mu_assert ("update", ht_up_update (ht, 7, (void *)(size_t)70));
+	mu_assert ("update_key", ht_up_update_key (ht, 7, 7000));
+	bool found;
+	mu_assert_null (ht_up_find (ht, 7, &found), "old key");
+	mu_assert ("old key not found", !found);
+	mu_assert_eq ((size_t)ht_up_find (ht, 7000, &found), 70, "moved value");
+	mu_assert ("found", found);
+	mu_assert_eq (ht->count, 1000, "count");
+	ut64 size = ht->size;
+	mu_assert ("grown", size >= 1000);
+
+	ht_up_foreach (ht, find_cb, ht);
+	ht_up_foreach (ht, delete_odd_cb, ht);
+	mu_assert_eq (ht->count, 501, "deleted from foreach");
+	for (i = 0; i < 1000; i++) {
+		size_t v = (size_t)ht_up_find (ht, i, NULL);
+		mu_assert_eq (v, (i & 1 || i == 7)? 0: i + 1, "values kept");
+	}
+	mu_assert ("delete", ht_up_delete (ht, 0));
+	mu_assert ("delete twice", !ht_up_delete (ht, 0));
+
+	mu_assert ("set not concurrent", ht_up_set_concurrent (ht, false));
+	mu_assert_null (ht->locks, "no locks");
+	mu_assert ("insert", ht_up_insert (ht, 0, (void *)1));
+	mu_assert_eq (ht->count, 501, "count");
+	ht_up_set_concurrent (ht, true);
+	ht_up_free (ht);
+	mu_end;
+}
+
+static bool test_ht_pp_concurrent(void) {
+	HtPP *ht = ht_pp_new0 ();
+	mu_assert ("set concurrent", ht_pp_set_concurrent (ht, true));
+	mu_assert ("insert", ht_pp_insert (ht, "foo", (void *)1));
+	mu_assert ("insert", ht_pp_insert (ht, "bar", (void *)2));
+	mu_assert ("update_key", ht_pp_update_key (ht, "foo", "baz"));
+	mu_assert_null (ht_pp_find (ht, "foo", NULL), "old key");
+	mu_assert_eq ((size_t)ht_pp_find (ht, "baz", NULL), 1, "new key");
+	HtPPKv *kv = ht_pp_find_kv (ht, "bar", NULL);
+	mu_assert_notnull (kv, "find_kv");
+	mu_assert_streq (kv->key, "bar", "kv key");
+	mu_assert ("delete", ht_pp_delete (ht, "bar"));
+	mu_assert_eq (ht->count, 1, "count");
+	ht_pp_free (ht);
+	mu_end;
+}
+
+static RThreadFunctionRet insert_th(RThread *th) {
+	HtJob *job = th->user;
+	ut64 t = r_time_now_mono ();
+	ut64 k;
+	for (k = job->start; k < job->end; k++) {
+		ht_up_insert (job->ht, k, (void *)(size_t)(k + 1));
+		// look up something this thread already wrote, and a key of the others
+		ut64 mine = job->start + (k - job->start) / 2;
+		if (ht_up_find (job->ht, mine, NULL) != (void *)(size_t)(mine + 1)) {
+			job->misses++;
+		}
+		ht_up_find (job->ht, (k * 7919) % KEYS, NULL);
+	}
+	job->ops = 3 * (job->end - job->start);
+	job->us = r_time_now_mono () - t;
+	return R_TH_STOP;
+}
+
+static RThreadFunctionRet find_th(RThread *th) {
+	HtJob *job = th->user;
+	ut64 t = r_time_now_mono ();
+	ut64 i, k;
+	for (i = 0; i < 4; i++) {
+		for (k = job->start; k < job->end; k++) {
+			if (ht_up_find (job->ht, (k * 7919) % KEYS, NULL) != (void *)(size_t)((k * 7919) % KEYS + 1)) {
+				job->misses++;
+			}
+		}
+	}
+	job->ops = 4 * (job->end - job->start);
+	job->us = r_time_now_mono () - t;
+	return R_TH_STOP;
+}
+
+static RThreadFunctionRet delete_th(RThread *th) {
+	HtJob *job = th->user;
+	ut64 k;
+	for (k = job->start; k < job->end; k += 2) {
+		if (!ht_up_delete (job->ht, k)) {
+			job->misses++;
+		}
+	}
+	return R_TH_STOP;
+}
+
+static void run_jobs(HtUP *ht, HtJob *jobs, int n, R_TH_FUNCTION(fun)) {
+	RThread *ths[THREADS];
+	int i;
+	for (i = 0; i < n; i++) {
+		jobs[i].ht = ht;
+		jobs[i].start = (ut64)KEYS * i / n;
+		jobs[i].end = (ut64)KEYS * (i + 1) / n;
+		jobs[i].misses = 0;
+		ths[i] = r_th_new (fun, &jobs[i], 0);
+	}
+	for (i = 0; i < n; i++) {
+		if (ths[i]) {
+			r_th_wait (ths[i]);
+			r_th_free (ths[i]);
+		} else {
+			fun (&(RThread){ .user = &jobs[i] });
+		}
+	}
+}
+
+static bool test_ht_concurrent_threads(void) {
+	HtJob jobs[THREADS];
+	HtUP *ht = ht_up_new0 ();
+	ht_up_set_concurrent (ht, true);
+	run_jobs (ht, jobs, THREADS, insert_th);
+	int i;
+	for (i = 0; i < THREADS; i++) {
+		mu_assert_eq (jobs[i].misses, 0, "own writes visible");
+	}
+	mu_assert_eq (ht->count, KEYS, "all inserted");
+	ut64 k;
+	for (k = 0; k < KEYS; k++) {
+		if (ht_up_find (ht, k, NULL) != (void *)(size_t)(k + 1)) {
+			break;
+		}
+	}
+	mu_assert_eq (k, KEYS, "all values");
+	run_jobs (ht, jobs, THREADS, delete_th);
+	for (i = 0; i < THREADS; i++) {
+		mu_assert_eq (jobs[i].misses, 0, "deleted");
+	}
+	mu_assert_eq (ht->count, KEYS / 2, "half left");
+	ht_up_free (ht);
+	mu_end;
+}
+
+// operations per microsecond of each thread, averaged over the threads
+static double bench(bool concurrent, int threads, bool lookups) {
+	HtJob jobs[THREADS];
+	HtUP *ht = ht_up_new0 ();
+	ht_up_set_concurrent (ht, concurrent);
+	if (lookups) {
+		run_jobs (ht, jobs, 1, insert_th);
+	}
+	run_jobs (ht, jobs, threads, lookups? find_th: insert_th);
+	ht_up_free (ht);
+	double rate = 0;
+	int i;
+	for (i = 0; i < threads; i++) {
+		rate += (double)jobs[i].ops / R_MAX (jobs[i].us, 1);
+	}
+	return rate / threads;
+}
+
+static bool test_ht_concurrent_bench(void) {
+	mu_bench_only;
+	eprintf ("ops/us per thread, %d keys: plain insert %.1f lookup %.1f\n",
+		KEYS, bench (false, 1, false), bench (false, 1, true));
+	int n;
+	for (n = 1; n <= THREADS; n *= 2) {
+		eprintf ("concurrent, %d threads: insert %.1f lookup %.1f\n",
+			n, bench (true, n, false), bench (true, n, true));
+	}
+	mu_end;
+}
+
+typedef struct {
+	RAnal *anal;
+	ut64 from;
+} XrefJob;
+
+static RThreadFunctionRet xrefs_set_th(RThread *th) {
+	XrefJob *job = th->user;
+	ut64 i;
+	for (i = 0; i < 2000; i++) {
+		// every thread refers to the same targets
+		r_anal_xrefs_set (job->anal, job->from + i, 0x100000 + i % 64, R_ANAL_REF_TYPE_CALL);
+	}
+	return R_TH_STOP;
+}
+
+static bool test_anal_xrefs_concurrent(void) {
+	RAnal *anal = r_anal_new ();
+	r_anal_set_concurrent (anal, true);
+	mu_assert_notnull (anal->ref_lock, "ref pool lock");
+	XrefJob jobs[THREADS];
+	RThread *ths[THREADS];
+	int i;
+	for (i = 0; i < THREADS; i++) {
+		jobs[i] = (XrefJob){ anal, 0x1000 + i * 0x10000 };
+		ths[i] = r_th_new (xrefs_set_th, &jobs[i], 0);
+	}
+	for (i = 0; i < THREADS; i++) {
+		if (ths[i]) {
+			r_th_wait (ths[i]);
+			r_th_free (ths[i]);
+		} else {
+			xrefs_set_th (&(RThread){ .user = &jobs[i] });
+		}
+	}
+	mu_assert_eq (r_anal_xrefs_count (anal), THREADS * 2000, "all refs");
+	RList *xrefs = r_anal_xrefs_get (anal, 0x100000);
+	mu_assert_eq (r_list_length (xrefs), THREADS * ((2000 + 63) / 64), "xrefs to a shared target");
+	r_list_free (xrefs);
+	r_anal_set_concurrent (anal, false);
+	mu_assert_null (anal->ref_lock, "no lock");
+	r_anal_free (anal);
+	mu_end;
+}
+
+typedef struct {
+	RFlag *flag;
+	int misses;
+} FlagJob;
+
+static RThreadFunctionRet flag_get_th(RThread *th) {
+	FlagJob *job = th->user;
+	int i, j;
+	for (j = 0; j < 100; j++) {
+		for (i = 0; i < 100; i++) {
+			char name[32];
+			snprintf (name, sizeof (name), "sym.fixed_%d", i);
+			RFlagItem *fi = r_flag_get (job->flag, name);
+			if (!fi || fi->offset != 0x1000 + i) {
+				job->misses++;
+			}
+		}
+	}
+	return R_TH_STOP;
+}
+
+static bool test_anal_flag_concurrent(void) {
+	RAnal *anal = r_anal_new ();
+	mu_assert ("anal concurrent", r_anal_set_concurrent (anal, true));
+	r_anal_create_function (anal, "f", 0x100, R_ANAL_FCN_TYPE_FCN, NULL);
+	r_anal_xrefs_set (anal, 0x100, 0x200, R_ANAL_REF_TYPE_CALL);
+	mu_assert_notnull (anal->ht_addr_fun->locks, "by address");
+	mu_assert_notnull (anal->ht_name_fun->locks, "by name");
+	mu_assert_notnull (anal->addr_hints->locks, "hints");
+	mu_assert_notnull (((HtUP *)ht_up_find (anal->dict_refs, 0x100, NULL))->locks, "refs from");
+	mu_assert_notnull (r_anal_get_function_at (anal, 0x100), "function");
+	r_anal_hint_clear (anal);
+	mu_assert_notnull (anal->addr_hints->locks, "hints after clear");
+	r_anal_xrefs_init (anal);
+	mu_assert_notnull (anal->dict_xrefs->locks, "xrefs after init");
+	r_anal_xrefs_set (anal, 0x100, 0x200, R_ANAL_REF_TYPE_CALL);
+	mu_assert_notnull (((HtUP *)ht_up_find (anal->dict_xrefs, 0x200, NULL))->locks, "refs to");
+	r_anal_set_concurrent (anal, false);
+	mu_assert_null (anal->ht_addr_fun->locks, "not concurrent");
+	r_anal_free (anal);
+
+	// lookups by name while flags are added
+	RFlag *flag = r_flag_new ();
+	mu_assert ("flag concurrent", r_flag_set_concurrent (flag, true));
+	int i;
+	for (i = 0; i < 100; i++) {
+		char name[32];
+		snprintf (name, sizeof (name), "sym.fixed_%d", i);
+		r_flag_set (flag, name, 0x1000 + i, 1);
+	}
+	FlagJob jobs[THREADS];
+	RThread *ths[THREADS];
+	for (i = 0; i < THREADS; i++) {
+		jobs[i] = (FlagJob){ flag, 0 };
+		ths[i] = r_th_new (flag_get_th, &jobs[i], 0);
+	}
+	for (i = 0; i < 10000; i++) {
+		char name[32];
+		snprintf (name, sizeof (name), "sym.new_%d", i);
+		r_flag_set (flag, name, 0x100000 + i, 1);
+	}
+	for (i = 0; i < THREADS; i++) {
+		if (ths[i]) {
+			r_th_wait (ths[i]);
+			r_th_free (ths[i]);
+		}
+		mu_assert_eq (jobs[i].misses, 0, "flags found");
+	}
+	r_flag_unset_all (flag);
+	mu_assert_notnull (flag->ht_name->locks, "still concurrent");
+	r_flag_free (flag);
+	mu_end;
+}
+
+static int all_tests() {
+	mu_run_test (test_ht_up_concurrent);
+	mu_run_test (test_ht_pp_concurrent);
+	mu_run_test (test_ht_concurrent_threads);
+	mu_run_test (test_ht_concurrent_bench);
+	mu_run_test (test_anal_flag_concurrent);
+	mu_run_test (test_anal_xrefs_concurrent);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests ();
+}
@@ -318,6 +318,116 @@ bool test_r_interval_tree_resize_end_only() {
 	return test_r_interval_tree_resize (true);
 }
 
+// black height of the subtree, -1 if the red-black invariants are broken
+static int black_height(RBNode *node) {
+	if (!node) {
+		return 1;
+	}
+	if (node->red && ((node->child[0] && node->child[0]->red) || (node->child[1] && node->child[1]->red))) {
+		return -1;
+	}
+	int l = black_height (node->child[0]);
+	int r = black_height (node->child[1]);
+	if (l < 0 || l != r) {
+		return -1;
+	}
+	return l + !node->red;
+}
+
+static bool count_cb(RIntervalNode *node, void *user) {
+	(*(size_t *)user)++;
+	return true;
+}
+
+static bool check_insert_all(RIntervalTree *tree, ut64 *start, ut64 *end, size_t n) {
+	if (!check_invariants (tree->root)) {
+		return false;
+	}
+	mu_assert ("red-black invariants", !tree->root || (!tree->root->node.red && black_height (&tree->root->node) > 0));
+	RIntervalTreeIter it;
+	size_t *data, count = 0;
+	ut64 last = 0;
+	r_interval_tree_foreach (tree, it, data) {
+		RIntervalNode *node = r_interval_tree_iter_get (&it);
+		mu_assert ("in order", node->start >= last);
+		mu_assert_eq (node->start, start[*data], "start");
+		mu_assert_eq (node->end, end[*data], "end");
+		last = node->start;
+		count++;
+	}
+	mu_assert_eq (count, n, "count");
+	return true;
+}
+
+bool test_r_interval_tree_insert_all() {
+#define BULK 1000
+	static ut64 start[2 * BULK + 3], end[2 * BULK + 3];
+	static size_t data[2 * BULK + 3];
+	RIntervalTreeItem items[BULK];
+	RIntervalTree tree;
+	r_interval_tree_init (&tree, NULL);
+	mu_assert ("empty insert", r_interval_tree_insert_all (&tree, items, 0));
+	mu_assert_null (tree.root, "still empty");
+	size_t i, n = 0;
+	for (i = 0; i < BULK; i++, n++) {
+		start[n] = rand () % 0x400;
+		end[n] = start[n] + rand () % 0x10;
+		data[n] = n;
+		items[i] = (RIntervalTreeItem){ start[n], end[n], &data[n] };
+	}
+	items[7].start = items[8].start = start[7] = start[8] = 0x1337;
+	items[7].end = items[8].end = end[7] = end[8] = 0x1340;
+	mu_assert ("bulk into empty tree", r_interval_tree_insert_all (&tree, items, BULK));
+	if (!check_insert_all (&tree, start, end, n)) {
+		return false;
+	}
+	size_t dups = 0;
+	r_interval_tree_all_at (&tree, 0x1337, count_cb, &dups);
+	mu_assert_eq (dups, 2, "duplicate starts kept");
+
+	// merge into the tree built above, and into one with a single node
+	for (i = 0; i < BULK; i++, n++) {
+		start[n] = rand () % 0x800;
+		end[n] = start[n] + rand () % 0x10;
+		data[n] = n;
+		items[i] = (RIntervalTreeItem){ start[n], end[n], &data[n] };
+	}
+	mu_assert ("bulk into tree", r_interval_tree_insert_all (&tree, items, BULK));
+	if (!check_insert_all (&tree, start, end, n)) {
+		return false;
+	}
+	// too few to rebuild the tree for
+	for (i = 0; i < 3; i++, n++) {
+		start[n] = rand () % 0x800;
+		end[n] = start[n] + rand () % 0x10;
+		data[n] = n;
+		items[i] = (RIntervalTreeItem){ start[n], end[n], &data[n] };
+	}
+	mu_assert ("few into a big tree", r_interval_tree_insert_all (&tree, items, 3));
+	if (!check_insert_all (&tree, start, end, n)) {
+		return false;
+	}
+	for (i = 0; i < n; i++) {
+		RIntervalNode *node = r_interval_tree_node_at_data (&tree, start[i], &data[i]);
+		mu_assert_notnull (node, "node found");
+		mu_assert ("delete", r_interval_tree_delete (&tree, node, false));
+	}
+	mu_assert_null (tree.root, "all deleted");
+	r_interval_tree_insert (&tree, start[0], end[0], &data[0]);
+	for (i = 0; i < 3; i++) {
+		items[i] = (RIntervalTreeItem){ start[i + 1], end[i + 1], &data[i + 1] };
+	}
+	mu_assert ("small bulk", r_interval_tree_insert_all (&tree, items, 3));
+	if (!check_insert_all (&tree, start, end, 4)) {
+		return false;
+	}
+	items[0] = (RIntervalTreeItem){ 10, 5, NULL };
+	mu_assert ("end before start", !r_interval_tree_insert_all (&tree, items, 1));
+	r_interval_tree_fini (&tree);
+	mu_end;
+#undef BULK
+}
+
 int all_tests() {
 	mu_run_test (test_r_interval_tree_insert_at);
 	mu_run_test (test_r_interval_tree_in_end_exclusive_point);
@@ -329,6 +439,7 @@ int all_tests() {
 	mu_run_test (test_r_interval_tree_delete);
 	mu_run_test (test_r_interval_tree_resize_start_and_end);
 	mu_run_test (test_r_interval_tree_resize_end_only);
+	mu_run_test (test_r_interval_tree_insert_all);
 	return tests_passed != tests_run;
 }
 
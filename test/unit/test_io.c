@@ -212,6 +212,67 @@ bool test_r_io_priority2(void) {
 	mu_end;
 }
 
+#if __linux__ && HAVE_PTRACE
+#include <signal.h>
+#include <sys/wait.h>
+
+static ut8 ptrace_buf[64];
+
+static void ptrace_child(void *user) {
+	ptrace (PTRACE_TRACEME, 0, NULL, NULL);
+	raise (SIGSTOP);
+	for (;;) {
+		pause ();
+	}
+}
+
+bool test_r_io_ptrace_rw(void) {
+	int i;
+	for (i = 0; i < sizeof (ptrace_buf); i++) {
+		ptrace_buf[i] = i;
+	}
+	RIO *io = r_io_new ();
+	pid_t pid = r_io_ptrace_fork (io, ptrace_child, NULL);
+	mu_assert ("fork failed", pid > 0);
+	int st = 0;
+	waitpid (pid, &st, 0);
+	mu_assert ("child did not stop", WIFSTOPPED (st));
+	char *uri = r_str_newf ("ptrace://%d", pid);
+	RIODesc *desc = r_io_open_nomap (io, uri, R_PERM_RW, 0);
+	free (uri);
+	mu_assert_notnull (desc, "ptrace:// could not be opened");
+	r_io_use_fd (io, desc->fd);
+	ut64 addr = (ut64)(size_t)ptrace_buf;
+
+	// process_vm_readv/writev, with the page cache
+	ut8 buf[sizeof (ptrace_buf)];
+	r_io_desc_read_at (desc, addr, buf, sizeof (buf));
+	mu_assert_memeq (buf, ptrace_buf, sizeof (buf), "vm read");
+	r_io_desc_write_at (desc, addr + 3, (const ut8 *)"\xaa\xbb", 2);
+	r_io_desc_read_at (desc, addr, buf, 8);
+	mu_assert_memeq (buf, (const ut8 *)"\x00\x01\x02\xaa\xbb\x05\x06\x07", 8, "vm read after write");
+	long w = r_io_ptrace (io, PTRACE_PEEKDATA, pid, (void *)(size_t)addr, R_PTRACE_NODATA);
+	mu_assert_memeq ((ut8 *)&w, (const ut8 *)"\x00\x01\x02\xaa", 4, "vm write reached the child");
+	// a poke made behind the plugin drops the cached pages
+	memcpy (&w, "\x10\x11\x12\x13", 4);
+	r_io_ptrace (io, PTRACE_POKEDATA, pid, (void *)(size_t)addr, (r_ptrace_data_t)w);
+	r_io_desc_read_at (desc, addr, buf, 4);
+	mu_assert_memeq (buf, (const ut8 *)"\x10\x11\x12\x13", 4, "vm read after a poke");
+
+	// the ptrace peek/poke fallback
+	free (r_io_system (io, "ptrace"));
+	r_io_desc_write_at (desc, addr + 8, (const ut8 *)"\xcc\xdd\xee", 3);
+	r_io_desc_read_at (desc, addr + 6, buf, 6);
+	mu_assert_memeq (buf, (const ut8 *)"\x06\x07\xcc\xdd\xee\x0b", 6, "ptrace read after write");
+
+	r_io_desc_close (desc);
+	kill (pid, SIGKILL);
+	waitpid (pid, &st, 0);
+	r_io_free (io);
+	mu_end;
+}
+#endif
+
 int all_tests() {
 	mu_run_test(test_r_io_mapsplit);
 	mu_run_test(test_r_io_mapsplit2);
@@ -221,6 +282,9 @@ int all_tests() {
 	mu_run_test(test_r_io_priority);
 	mu_run_test(test_r_io_priority2);
 	mu_run_test(test_va_malloc_zero);
+#if __linux__ && HAVE_PTRACE
+	mu_run_test(test_r_io_ptrace_rw);
+#endif
 	return tests_passed != tests_run;
 }
 
@@ -0,0 +1,114 @@
+#include <r_magic.h>
+#include <r_util.h>
+#include "minunit.h"
+
+#define MAGIC_DB "../libr/magic/d/default"
+#define WINDOW 256
+
+static const char *sigs[] = {
+	"\x7f" "ELF\x01\x01\x01\x00",
+	"\x89PNG\r\n\x1a\n\x00\x00\x00\x0dIHDR",
+	"PK\x03\x04\x14\x00\x00\x00\x08\x00",
+	"\x1f\x8b\x08\x00\x00\x00\x00\x00",
+	"MZ\x90\x00\x03\x00\x00\x00\x04\x00",
+	"%PDF-1.4\n",
+	"\xca\xfe\xba\xbe\x00\x00\x00\x02",
+};
+
+/* noise with some zero filled pages and a few embedded headers */
+static ut8 *magic_buf(size_t len) {
+	ut8 *buf = malloc (len);
+	ut32 seed = 0x31337;
+	size_t i;
+	for (i = 0; i < len; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = ((i / 4096) % 3)? (seed >> 16) & 0xff: 0;
+	}
+	for (i = 0; i < R_ARRAY_SIZE (sigs); i++) {
+		size_t at = (i + 1) * len / (R_ARRAY_SIZE (sigs) + 1) + i * 7;
+		memcpy (buf + at, sigs[i], strlen (sigs[i]) + 1);
+	}
+	return buf;
+}
+
+static bool magic_hit(RMagic *ms, const ut8 *buf, size_t len, size_t at) {
+	const char *str = r_magic_buffer (ms, buf + at, R_MIN (WINDOW, len - at));
+	return str && strcmp (str, "data");
+}
+
+static bool test_magic_index(void) {
+	RMagic *ms = r_magic_new (0);
+	mu_assert_true (r_magic_load (ms, MAGIC_DB), "load the magic database");
+	RMagicIndex *idx = r_magic_index_new (ms);
+	mu_assert_notnull (idx, "index");
+
+	const size_t len = 0x4000;
+	ut8 *buf = magic_buf (len);
+	ut8 *cand = malloc (len);
+	size_t n = r_magic_index_scan (idx, buf, len, WINDOW, cand);
+	size_t i, hits = 0, missed = 0;
+	for (i = 0; i < len; i++) {
+		if (magic_hit (ms, buf, len, i)) {
+			hits++;
+			if (!cand[i]) {
+				eprintf ("missed 0x%"PFMT64x" %s\n", (ut64)i,
+					r_magic_buffer (ms, buf + i, R_MIN (WINDOW, len - i)));
+				missed++;
+			}
+		}
+	}
+	mu_assert_eq (missed, 0, "every match is a candidate");
+	mu_assert ("embedded headers are found", hits >= R_ARRAY_SIZE (sigs));
+	mu_assert ("most offsets are filtered out", n < len / 4);
+	free (cand);
+	free (buf);
+	r_magic_index_free (idx);
+	r_magic_free (ms);
+	mu_end;
+}
+
+static bool test_magic_index_bench(void) {
+	mu_bench_only;
+	RMagic *ms = r_magic_new (0);
+	mu_assert_true (r_magic_load (ms, MAGIC_DB), "load the magic database");
+	RMagicIndex *idx = r_magic_index_new (ms);
+	const size_t len = 0x10000;
+	ut8 *buf = magic_buf (len);
+	ut8 *cand = malloc (len);
+	size_t i, hits = 0, fhits = 0;
+
+	ut64 t = r_time_now_mono ();
+	for (i = 0; i < len; i++) {
+		hits += magic_hit (ms, buf, len, i);
+	}
+	ut64 full = r_time_now_mono () - t;
+
+	t = r_time_now_mono ();
+	size_t n = r_magic_index_scan (idx, buf, len, WINDOW, cand);
+	for (i = 0; i < len; i++) {
+		if (cand[i]) {
+			fhits += magic_hit (ms, buf, len, i);
+		}
+	}
+	ut64 filtered = r_time_now_mono () - t;
+
+	eprintf ("magic scan of %d bytes: %"PFMT64u"us every offset, %"PFMT64u"us with the index (%d candidates)\n",
+		(int)len, full, filtered, (int)n);
+	mu_assert_eq (fhits, hits, "same matches with the index");
+	mu_assert ("the index is faster", filtered < full);
+	free (cand);
+	free (buf);
+	r_magic_index_free (idx);
+	r_magic_free (ms);
+	mu_end;
+}
+
+static int all_tests() {
+	mu_run_test (test_magic_index);
+	mu_run_test (test_magic_index_bench);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests ();
+}
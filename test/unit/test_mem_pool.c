@@ -0,0 +1,51 @@
+#include <r_util.h>
+#include "minunit.h"
+
+static bool test_r_mem_pool_alloc(void) {
+	RMemoryPool *pool = r_mem_pool_new (3, 4, 1);
+	mu_assert_notnull (pool, "pool");
+	mu_assert_eq (pool->nodesize, 8, "nodesize rounded up");
+	ut8 *nodes[10];
+	int i;
+	for (i = 0; i < 10; i++) {
+		nodes[i] = r_mem_pool_alloc (pool);
+		mu_assert_notnull (nodes[i], "alloc");
+		mu_assert ("zeroed", r_mem_is_zero (nodes[i], pool->nodesize));
+		memset (nodes[i], 0xff, pool->nodesize);
+	}
+	mu_assert_eq (pool->npool, 3, "chunks");
+	mu_assert_eq (pool->live, 10, "live");
+	r_mem_pool_free (pool);
+	mu_end;
+}
+
+static bool test_r_mem_pool_release(void) {
+	RMemoryPool *pool = r_mem_pool_new (16, 4, 0);
+	void *a = r_mem_pool_alloc (pool);
+	void *b = r_mem_pool_alloc (pool);
+	r_mem_pool_release (pool, a);
+	mu_assert_eq (pool->live, 1, "live after release");
+	void *c = r_mem_pool_alloc (pool);
+	mu_assert_ptreq (c, a, "released node is reused");
+	mu_assert ("reused node is zeroed", r_mem_is_zero (c, 16));
+	r_mem_pool_release (pool, b);
+	r_mem_pool_release (pool, c);
+	mu_assert_eq (pool->live, 0, "live");
+	mu_assert_eq (pool->peak, 2, "peak");
+	mu_assert_eq (pool->allocs, 3, "allocs");
+	r_mem_pool_deinit (pool);
+	mu_assert_eq (pool->npool, 0, "chunks freed");
+	mu_assert_notnull (r_mem_pool_alloc (pool), "alloc after deinit");
+	r_mem_pool_free (pool);
+	mu_end;
+}
+
+static int all_tests(void) {
+	mu_run_test (test_r_mem_pool_alloc);
+	mu_run_test (test_r_mem_pool_release);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests ();
+}
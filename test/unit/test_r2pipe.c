@@ -12,6 +12,88 @@ static bool test_r2pipe(void) {
 	mu_end;
 }
 
+static bool test_r2pipe_batch(void) {
+	const char *cmds[] = { "?e one", "?e two", "?vi 3+4" };
+	R2Pipe *r = r2pipe_open ("radare2 -q0 -");
+	mu_assert ("r2pipe can spawn", r);
+	RList *res = r2pipe_cmd_batch (r, cmds, 3);
+	mu_assert_notnull (res, "r2pipe batch");
+	mu_assert_eq (r_list_length (res), 3, "one reply per command");
+	mu_assert_streq (r_list_get_n (res, 0), "one\n", "first reply");
+	mu_assert_streq (r_list_get_n (res, 1), "two\n", "second reply");
+	mu_assert_streq (r_list_get_n (res, 2), "7\n", "third reply");
+	r_list_free (res);
+	char *hello = r2pipe_cmd (r, "?e hello world");
+	mu_assert_streq (hello, "hello world\n", "r2pipe after batch");
+	free (hello);
+	r2pipe_close (r);
+	mu_end;
+}
+
+static bool test_r2pipe_shm(void) {
+	const char *cmds[] = { "?e one", "?e two" };
+	R2Pipe *r = r2pipe_open_shm ("radare2 -q0 -");
+	mu_assert ("r2pipe can spawn", r);
+	char *hello = r2pipe_cmd (r, "?e hello world");
+	mu_assert_streq (hello, "hello world\n", "r2pipe shm hello world");
+	free (hello);
+	RList *res = r2pipe_cmd_batch (r, cmds, 2);
+	mu_assert_notnull (res, "r2pipe shm batch");
+	mu_assert_streq (r_list_get_n (res, 1), "two\n", "second reply");
+	r_list_free (res);
+	/* replies larger than the ring are streamed through it */
+	R2Pipe *p = r2pipe_open ("radare2 -q0 -");
+	mu_assert ("r2pipe can spawn", p);
+	char *a = r2pipe_cmd (r, "px 0x80000");
+	char *b = r2pipe_cmd (p, "px 0x80000");
+	mu_assert ("big reply", a && b && strlen (a) > 1024 * 1024);
+	mu_assert ("same output as the pipes", !strcmp (a, b));
+	free (a);
+	free (b);
+	r2pipe_close (p);
+	r2pipe_close (r);
+	mu_end;
+}
+
+/* time n round trips, UT64_MAX if a reply differs from expect */
+static ut64 r2pipe_bench(R2Pipe *r, const char *cmd, int n, const char *expect) {
+	ut64 t = r_time_now_mono ();
+	int i;
+	for (i = 0; i < n; i++) {
+		char *res = r2pipe_cmd (r, cmd);
+		bool ok = res && !strcmp (res, expect);
+		free (res);
+		if (!ok) {
+			return UT64_MAX;
+		}
+	}
+	return r_time_now_mono () - t;
+}
+
+static bool test_r2pipe_shm_bench(void) {
+	mu_bench_only;
+	R2Pipe *p = r2pipe_open ("radare2 -q0 -");
+	mu_assert ("r2pipe can spawn", p);
+	R2Pipe *r = r2pipe_open_shm ("radare2 -q0 -");
+	mu_assert ("r2pipe shm can spawn", r);
+	char *big = r2pipe_cmd (p, "pxj 0x10000");
+	mu_assert_notnull (big, "pxj reply");
+	ut64 pipe_small = r2pipe_bench (p, "?v 1", 2000, "0x1\n");
+	ut64 shm_small = r2pipe_bench (r, "?v 1", 2000, "0x1\n");
+	ut64 pipe_big = r2pipe_bench (p, "pxj 0x10000", 20, big);
+	ut64 shm_big = r2pipe_bench (r, "pxj 0x10000", 20, big);
+	free (big);
+	mu_assert ("pipe replies", pipe_small != UT64_MAX && pipe_big != UT64_MAX);
+	mu_assert ("shm replies", shm_small != UT64_MAX && shm_big != UT64_MAX);
+	eprintf ("r2pipe round trip: pipe %"PFMT64u"us shm %"PFMT64u"us\n",
+		pipe_small / 2000, shm_small / 2000);
+	eprintf ("r2pipe pxj 64K: pipe %"PFMT64u"us shm %"PFMT64u"us\n",
+		pipe_big / 20, shm_big / 20);
+	r2pipe_close (p);
+	r2pipe_close (r);
+	mu_end;
+}
+
 static bool test_r2pipe_404(void) {
 	R2Pipe *r = r2pipe_open ("rodoro2 -q0 -");
 	mu_assert ("r2pipe can spawn", !r);
@@ -20,6 +102,9 @@ static bool test_r2pipe_404(void) {
 
 static int all_tests() {
 	mu_run_test (test_r2pipe);
+	mu_run_test (test_r2pipe_batch);
+	mu_run_test (test_r2pipe_shm);
+	mu_run_test (test_r2pipe_shm_bench);
 	mu_run_test (test_r2pipe_404);
 	return tests_passed != tests_run;
 }
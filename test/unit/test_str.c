@@ -403,6 +403,48 @@ bool test_r_str_constpool(void) {
 	mu_end;
 }
 
+bool test_r_str_constpool_ref(void) {
+	RStrConstPool pool;
+	RStrConstPoolStats st;
+	mu_assert ("pool init success", r_str_constpool_init (&pool));
+
+	char *a_ref = strdup ("int32_t");
+	const char *a = r_str_constpool_ref (&pool, a_ref);
+	mu_assert_ptrneq (a, a_ref, "pooled != ref");
+	mu_assert_ptreq (r_str_constpool_ref (&pool, "int32_t"), a, "same on re-ref");
+	mu_assert_ptreq (r_str_constpool_ref (&pool, a_ref), a, "same on re-ref with different ptr");
+	free (a_ref);
+	const char *b = r_str_constpool_ref (&pool, "arg1");
+	r_str_constpool_stats (&pool, &st);
+	mu_assert_eq (st.strings, 2, "strings");
+	mu_assert_eq (st.refs, 4, "refs");
+	mu_assert_eq (st.bytes, 8 + 5, "bytes");
+	mu_assert_eq (st.saved, 2 * 8, "saved");
+
+	r_str_constpool_unref (&pool, a);
+	r_str_constpool_unref (&pool, "int32_t");
+	r_str_constpool_unref (&pool, b);
+	r_str_constpool_stats (&pool, &st);
+	mu_assert_eq (st.strings, 1, "released by the last unref");
+	mu_assert_eq (st.refs, 1, "refs after unref");
+	r_str_constpool_unref (&pool, a);
+	r_str_constpool_stats (&pool, &st);
+	mu_assert_eq (st.strings, 0, "empty");
+	r_str_constpool_unref (&pool, "unknown");
+
+	// strings from r_str_constpool_get stay for good
+	const char *c = r_str_constpool_ref (&pool, "amd64");
+	mu_assert_ptreq (r_str_constpool_get (&pool, "amd64"), c, "get returns the ref'd string");
+	r_str_constpool_unref (&pool, c);
+	r_str_constpool_unref (&pool, c);
+	r_str_constpool_stats (&pool, &st);
+	mu_assert_eq (st.strings, 1, "pinned");
+	mu_assert_ptreq (r_str_constpool_ref (&pool, "amd64"), c, "still there");
+
+	r_str_constpool_fini (&pool);
+	mu_end;
+}
+
 bool test_r_str_format_msvc_argv() {
 	// Examples from http://daviddeley.com/autohotkey/parameters/parameters.htm#WINCRULES
 	const char *a = "CallMePancake";
@@ -498,6 +540,7 @@ bool all_tests () {
 	mu_run_test (test_r_str_escape_sh);
 	mu_run_test (test_r_str_unescape);
 	mu_run_test (test_r_str_constpool);
+	mu_run_test (test_r_str_constpool_ref);
 	mu_run_test (test_r_str_format_msvc_argv);
 	mu_run_test (test_r_str_str_xy);
 	return tests_passed != tests_run;